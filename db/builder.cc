@@ -18,6 +18,7 @@
 #include "db/filename.h"
 #include "db/internal_stats.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/version_edit.h"
 #include "rocksdb/db.h"
@@ -43,19 +44,20 @@ TableBuilder* NewTableBuilder(
         int_tbl_prop_collector_factories,
     uint32_t column_family_id, WritableFileWriter* file,
     const CompressionType compression_type,
-    const CompressionOptions& compression_opts, const bool skip_filters) {
+    const CompressionOptions& compression_opts, const bool skip_filters,
+    const std::string* compression_dict) {
   return ioptions.table_factory->NewTableBuilder(
       TableBuilderOptions(ioptions, internal_comparator,
                           int_tbl_prop_collector_factories, compression_type,
-                          compression_opts, skip_filters),
+                          compression_opts, skip_filters, compression_dict),
       column_family_id, file);
 }
 
 Status BuildTable(
     const std::string& dbname, Env* env, const ImmutableCFOptions& ioptions,
     const EnvOptions& env_options, TableCache* table_cache,
-    InternalIterator* iter, FileMetaData* meta,
-    const InternalKeyComparator& internal_comparator,
+    InternalIterator* iter, std::unique_ptr<InternalIterator> range_del_iter,
+    FileMetaData* meta, const InternalKeyComparator& internal_comparator,
     const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
         int_tbl_prop_collector_factories,
     uint32_t column_family_id, std::vector<SequenceNumber> snapshots,
@@ -68,10 +70,16 @@ Status BuildTable(
   Status s;
   meta->fd.file_size = 0;
   iter->SeekToFirst();
+  RangeDelAggregator range_del_agg(internal_comparator, snapshots);
+  s = range_del_agg.AddTombstones(std::move(range_del_iter));
+  if (!s.ok()) {
+    // may be non-ok if a range tombstone key is unparsable
+    return s;
+  }
 
   std::string fname = TableFileName(ioptions.db_paths, meta->fd.GetNumber(),
                                     meta->fd.GetPathId());
-  if (iter->Valid()) {
+  if (iter->Valid() || !range_del_agg.empty()) {
     TableBuilder* builder;
     unique_ptr<WritableFileWriter> file_writer;
     {
@@ -97,7 +105,10 @@ Status BuildTable(
 
     CompactionIterator c_iter(iter, internal_comparator.user_comparator(),
                               &merge, kMaxSequenceNumber, &snapshots, env,
-                              true /* internal key corruption is not ok */);
+                              true /* internal key corruption is not ok */,
+                              nullptr /* compaction */,
+                              nullptr /* compaction_filter */,
+                              nullptr /* log_buffer */, &range_del_agg);
     c_iter.SeekToFirst();
     for (; c_iter.Valid(); c_iter.Next()) {
       const Slice& key = c_iter.key();
@@ -113,9 +124,17 @@ Status BuildTable(
       }
     }
 
+    s = c_iter.status();
+    // Range tombstones of a flush are not clipped, and never dropped since
+    // there may be older data in the rest of the tree.
+    if (s.ok()) {
+      s = range_del_agg.AddToBuilder(builder, nullptr /* lower_bound */,
+                                     nullptr /* upper_bound */, meta,
+                                     false /* bottommost_level */);
+    }
+
     // Finish and check for builder errors
     bool empty = builder->NumEntries() == 0;
-    s = c_iter.status();
     if (!s.ok() || empty) {
       builder->Abandon();
     } else {
@@ -125,6 +144,9 @@ Status BuildTable(
     if (s.ok() && !empty) {
       meta->fd.file_size = builder->FileSize();
       meta->marked_for_compaction = builder->NeedCompact();
+      if (!meta->has_range_deletions) {
+        meta->newest_entry_time = builder->NewestEntryTime();
+      }
       assert(meta->fd.GetFileSize() > 0);
       if (table_properties) {
         *table_properties = builder->GetTableProperties();
@@ -205,6 +205,19 @@ ColumnFamilyOptions SanitizeOptions(const DBOptions& db_options,
          result.level0_slowdown_writes_trigger,
          result.level0_file_num_compaction_trigger);
   }
+  if (!result.level_path_ids.empty()) {
+    if (result.compaction_style != kCompactionStyleLevel) {
+      Warn(db_options.info_log.get(),
+           "level_path_ids is only supported by level compaction, ignoring "
+           "it");
+      result.level_path_ids.clear();
+    }
+    uint32_t max_path_id = static_cast<uint32_t>(
+        std::max(db_options.db_paths.size(), static_cast<size_t>(1)) - 1);
+    for (auto& path_id : result.level_path_ids) {
+      path_id = std::min(path_id, max_path_id);
+    }
+  }
   if (result.level_compaction_dynamic_level_bytes) {
     if (result.compaction_style != kCompactionStyleLevel ||
         db_options.db_paths.size() > 1U) {
@@ -308,6 +321,7 @@ ColumnFamilyData::ColumnFamilyData(
       prev_(nullptr),
       log_number_(0),
       column_family_set_(column_family_set),
+      prev_compaction_needed_bytes_(0),
       pending_flush_(false),
       pending_compaction_(false) {
   Ref();
@@ -427,6 +441,77 @@ void ColumnFamilyData::SetDropped() {
   column_family_set_->RemoveColumnFamily(this);
 }
 
+namespace {
+// The delayed write rate never goes below this, so that a delayed DB keeps
+// making progress.
+const uint64_t kMinDelayedWriteRate = 16 * 1024u;
+// Applied to the delayed write rate each time the stall conditions are
+// recalculated while writes are delayed: slow down while the compaction debt
+// does not shrink, speed up once it does, and slow down faster right after a
+// stop or when a stop is one step away. Once no column family needs a delay
+// any more, the rate recovers faster than it was lowered.
+const double kIncSlowdownRatio = 0.8;
+const double kDecSlowdownRatio = 1 / kIncSlowdownRatio;
+const double kNearStopSlowdownRatio = 0.6;
+const double kDelayRecoverSlowdownRatio = 1.4;
+
+// Returns how close "value" is to "stop", from 0.0 at "slowdown" to 1.0 at
+// "stop".
+double StallProximity(double value, double slowdown, double stop) {
+  if (stop <= slowdown || value <= slowdown) {
+    return 0.0;
+  }
+  return std::min(1.0, (value - slowdown) / (stop - slowdown));
+}
+
+uint64_t BoundDelayedWriteRate(double write_rate, uint64_t max_write_rate) {
+  uint64_t min_write_rate = std::min(kMinDelayedWriteRate, max_write_rate);
+  if (write_rate < min_write_rate) {
+    return min_write_rate;
+  }
+  if (write_rate > max_write_rate) {
+    return max_write_rate;
+  }
+  return static_cast<uint64_t>(write_rate);
+}
+
+// Computes the delayed write rate from the previous one and takes a delay
+// token for it. "proximity" tells how close the column family is to a stop
+// condition and caps the rate proportionally to it, which keeps writes from
+// running into the stop at full speed before the debt feedback kicks in.
+std::unique_ptr<WriteControllerToken> SetupDelay(
+    WriteController* write_controller, uint64_t compaction_needed_bytes,
+    uint64_t prev_compaction_needed_bytes, bool penalize_stop,
+    double proximity, bool auto_compactions_disabled) {
+  const uint64_t max_write_rate = write_controller->max_delayed_write_rate();
+  double write_rate =
+      static_cast<double>(write_controller->delayed_write_rate());
+  if (auto_compactions_disabled) {
+    // Nothing pays the compaction debt off, so there is no feedback to follow.
+    return write_controller->GetDelayToken(max_write_rate);
+  } else if (write_controller->NeedsDelay()) {
+    // Already delayed: adjust based on how the compaction debt evolved since
+    // the last recalculation. When several column families are delayed, the
+    // rate follows whichever recalculated last.
+    if (penalize_stop) {
+      write_rate *= kNearStopSlowdownRatio;
+    } else if (prev_compaction_needed_bytes > 0 &&
+               prev_compaction_needed_bytes <= compaction_needed_bytes) {
+      // A debt that does not shrink usually means that flushes and
+      // compactions cannot keep up with the writes.
+      write_rate *= kIncSlowdownRatio;
+    } else if (prev_compaction_needed_bytes > compaction_needed_bytes) {
+      write_rate *= kDecSlowdownRatio;
+    }
+  } else if (penalize_stop) {
+    write_rate *= kNearStopSlowdownRatio;
+  }
+  write_rate = std::min(write_rate, max_write_rate * (1.0 - proximity));
+  return write_controller->GetDelayToken(
+      BoundDelayedWriteRate(write_rate, max_write_rate));
+}
+}  // namespace
+
 void ColumnFamilyData::RecalculateWriteStallConditions(
       const MutableCFOptions& mutable_cf_options) {
   if (current_ != nullptr) {
@@ -434,6 +519,30 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
     const double score = vstorage->max_compaction_score();
     const int max_level = vstorage->max_compaction_score_level();
     auto write_controller = column_family_set_->write_controller_;
+    const uint64_t compaction_needed_bytes =
+        vstorage->estimated_compaction_needed_bytes();
+    const int l0_files = vstorage->l0_delay_trigger_count();
+    const bool was_stopped = write_controller->IsStopped();
+
+    // How close L0 and the compaction debt are to stopping writes.
+    double proximity = StallProximity(
+        l0_files, mutable_cf_options.level0_slowdown_writes_trigger,
+        mutable_cf_options.level0_stop_writes_trigger);
+    if (mutable_cf_options.soft_pending_compaction_bytes_limit > 0) {
+      proximity = std::max(
+          proximity,
+          StallProximity(
+              static_cast<double>(compaction_needed_bytes),
+              static_cast<double>(
+                  mutable_cf_options.soft_pending_compaction_bytes_limit),
+              static_cast<double>(
+                  mutable_cf_options.hard_pending_compaction_bytes_limit)));
+    }
+    // Only used for L0: the memtable slowdown already is one step away from
+    // a stop by definition, so penalizing it would lower the rate on every
+    // recalculation whatever the debt does.
+    const bool near_stop =
+        l0_files >= mutable_cf_options.level0_stop_writes_trigger - 2;
 
     if (imm()->NumNotFlushed() >= mutable_cf_options.max_write_buffer_number) {
       write_controller_token_ = write_controller->GetStopToken();
@@ -443,8 +552,7 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
           "(waiting for flush), max_write_buffer_number is set to %d",
           name_.c_str(), imm()->NumNotFlushed(),
           mutable_cf_options.max_write_buffer_number);
-    } else if (vstorage->l0_delay_trigger_count() >=
-               mutable_cf_options.level0_stop_writes_trigger) {
+    } else if (l0_files >= mutable_cf_options.level0_stop_writes_trigger) {
       write_controller_token_ = write_controller->GetStopToken();
       internal_stats_->AddCFStats(InternalStats::LEVEL0_NUM_FILES_TOTAL, 1);
       if (compaction_picker_->IsLevel0CompactionInProgress()) {
@@ -455,7 +563,7 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
           "[%s] Stopping writes because we have %d level-0 files",
           name_.c_str(), vstorage->l0_delay_trigger_count());
     } else if (mutable_cf_options.hard_pending_compaction_bytes_limit > 0 &&
-               vstorage->estimated_compaction_needed_bytes() >=
+               compaction_needed_bytes >=
                    mutable_cf_options.hard_pending_compaction_bytes_limit) {
       write_controller_token_ = write_controller->GetStopToken();
       internal_stats_->AddCFStats(
@@ -463,29 +571,78 @@ void ColumnFamilyData::RecalculateWriteStallConditions(
       Log(InfoLogLevel::WARN_LEVEL, ioptions_.info_log,
           "[%s] Stopping writes because estimated pending compaction "
           "bytes exceed %" PRIu64,
-          name_.c_str(), vstorage->estimated_compaction_needed_bytes());
+          name_.c_str(), compaction_needed_bytes);
+    } else if (mutable_cf_options.max_write_buffer_number > 3 &&
+               imm()->NumNotFlushed() >=
+                   mutable_cf_options.max_write_buffer_number - 1) {
+      // One more full memtable would stop writes. Slow down to give the
+      // flushes a chance to catch up.
+      write_controller_token_ =
+          SetupDelay(write_controller, compaction_needed_bytes,
+                     prev_compaction_needed_bytes_, was_stopped, proximity,
+                     mutable_cf_options.disable_auto_compactions);
+      internal_stats_->AddCFStats(InternalStats::MEMTABLE_SLOWDOWN, 1);
+      Log(InfoLogLevel::WARN_LEVEL, ioptions_.info_log,
+          "[%s] Stalling writes because we have %d immutable memtables "
+          "(waiting for flush), max_write_buffer_number is set to %d "
+          "rate %" PRIu64,
+          name_.c_str(), imm()->NumNotFlushed(),
+          mutable_cf_options.max_write_buffer_number,
+          write_controller->delayed_write_rate());
     } else if (mutable_cf_options.level0_slowdown_writes_trigger >= 0 &&
-               vstorage->l0_delay_trigger_count() >=
-                   mutable_cf_options.level0_slowdown_writes_trigger) {
-      write_controller_token_ = write_controller->GetDelayToken();
+               l0_files >= mutable_cf_options.level0_slowdown_writes_trigger) {
+      write_controller_token_ =
+          SetupDelay(write_controller, compaction_needed_bytes,
+                     prev_compaction_needed_bytes_, was_stopped || near_stop,
+                     proximity, mutable_cf_options.disable_auto_compactions);
       internal_stats_->AddCFStats(InternalStats::LEVEL0_SLOWDOWN_TOTAL, 1);
       if (compaction_picker_->IsLevel0CompactionInProgress()) {
         internal_stats_->AddCFStats(
             InternalStats::LEVEL0_SLOWDOWN_WITH_COMPACTION, 1);
       }
       Log(InfoLogLevel::WARN_LEVEL, ioptions_.info_log,
-          "[%s] Stalling writes because we have %d level-0 files",
-          name_.c_str(), vstorage->l0_delay_trigger_count());
+          "[%s] Stalling writes because we have %d level-0 files "
+          "rate %" PRIu64,
+          name_.c_str(), l0_files, write_controller->delayed_write_rate());
+    } else if (mutable_cf_options.soft_pending_compaction_bytes_limit > 0 &&
+               compaction_needed_bytes >=
+                   mutable_cf_options.soft_pending_compaction_bytes_limit) {
+      write_controller_token_ =
+          SetupDelay(write_controller, compaction_needed_bytes,
+                     prev_compaction_needed_bytes_, was_stopped, proximity,
+                     mutable_cf_options.disable_auto_compactions);
+      internal_stats_->AddCFStats(
+          InternalStats::SOFT_PENDING_COMPACTION_BYTES_LIMIT, 1);
+      Log(InfoLogLevel::WARN_LEVEL, ioptions_.info_log,
+          "[%s] Stalling writes because of estimated pending compaction "
+          "bytes %" PRIu64 " rate %" PRIu64,
+          name_.c_str(), compaction_needed_bytes,
+          write_controller->delayed_write_rate());
     } else if (mutable_cf_options.soft_rate_limit > 0.0 &&
                score > mutable_cf_options.soft_rate_limit) {
-      write_controller_token_ = write_controller->GetDelayToken();
+      write_controller_token_ =
+          SetupDelay(write_controller, compaction_needed_bytes,
+                     prev_compaction_needed_bytes_, was_stopped, proximity,
+                     mutable_cf_options.disable_auto_compactions);
       internal_stats_->RecordLevelNSlowdown(max_level, true);
       Log(InfoLogLevel::WARN_LEVEL, ioptions_.info_log,
-          "[%s] Stalling writes because we hit soft limit on level %d",
-          name_.c_str(), max_level);
+          "[%s] Stalling writes because we hit soft limit on level %d "
+          "rate %" PRIu64,
+          name_.c_str(), max_level, write_controller->delayed_write_rate());
     } else {
       write_controller_token_.reset();
+      if (!write_controller->NeedsDelay()) {
+        // No column family needs a delay. Recover the rate faster than delays
+        // lower it, so that it does not drift downwards over several delay
+        // episodes, but step by step, so that a delay that starts again soon
+        // starts from a rate close to the one that was sustainable.
+        write_controller->set_delayed_write_rate(BoundDelayedWriteRate(
+            write_controller->delayed_write_rate() *
+                kDelayRecoverSlowdownRatio,
+            write_controller->max_delayed_write_rate()));
+      }
     }
+    prev_compaction_needed_bytes_ = compaction_needed_bytes;
   }
 }
 
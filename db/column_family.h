@@ -201,6 +201,11 @@ class ColumnFamilyData {
   // thread-safe
   const EnvOptions* soptions() const;
   const ImmutableCFOptions* ioptions() const { return &ioptions_; }
+  // thread-safe
+  // The path flushes write level-0 files to
+  uint32_t GetFlushPathId() const {
+    return ioptions_.level_path_ids.empty() ? 0 : ioptions_.level_path_ids[0];
+  }
   // REQUIRES: DB mutex held
   // This returns the MutableCFOptions used by current SuperVersion
   // You shoul use this API to reference MutableCFOptions most of the time.
@@ -376,6 +381,11 @@ class ColumnFamilyData {
 
   std::unique_ptr<WriteControllerToken> write_controller_token_;
 
+  // Estimated pending compaction bytes when the write stall conditions were
+  // last recalculated. Whether the debt grows or shrinks steers the delayed
+  // write rate.
+  uint64_t prev_compaction_needed_bytes_;
+
   // If true --> this ColumnFamily is currently present in DBImpl::flush_queue_
   bool pending_flush_;
 
@@ -148,6 +148,8 @@ Status CompactedDBImpl::Open(const Options& options,
     return Status::InvalidArgument("merge operator is not supported");
   }
   DBOptions db_options(options);
+  // Gets go straight to the table readers, which have to be open
+  db_options.open_files_lazily = false;
   std::unique_ptr<CompactedDBImpl> db(new CompactedDBImpl(db_options, dbname));
   Status s = db->Init(options);
   if (s.ok()) {
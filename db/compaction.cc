@@ -261,6 +261,11 @@ bool Compaction::KeyNotExistsBeyondOutputLevel(
   if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return bottommost_level_;
   }
+  if (output_level_ == 0) {
+    // An intra-L0 compaction leaves the older L0 files out of its inputs and
+    // they may hold the key as well.
+    return false;
+  }
   // Maybe use binary search to find right entry instead of linear search?
   const Comparator* user_cmp = cfd_->user_comparator();
   for (int lvl = output_level_ + 1; lvl < number_levels_; lvl++) {
@@ -416,11 +421,11 @@ void Compaction::Summary(char* output, int len) {
 uint64_t Compaction::OutputFilePreallocationSize() {
   uint64_t preallocation_size = 0;
 
-  if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel ||
-      output_level() > 0) {
+  if (output_level() > 0) {
     preallocation_size = max_output_file_size_;
   } else {
-    // output_level() == 0
+    // output_level() == 0: universal compactions and intra-L0 compactions
+    // write a single file no larger than their inputs.
     assert(num_input_levels() > 0);
     for (const auto& f : inputs_[0].files) {
       preallocation_size += f->fd.GetFileSize();
@@ -453,7 +458,7 @@ bool Compaction::ShouldFormSubcompactions() const {
     return false;
   }
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
-    return start_level_ == 0 && !IsOutputLevelEmpty();
+    return start_level_ == 0 && output_level_ > 0 && !IsOutputLevelEmpty();
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
   } else {
@@ -14,7 +14,8 @@ CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
     SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
     Env* env, bool expect_valid_internal_key, Compaction* compaction,
-    const CompactionFilter* compaction_filter, LogBuffer* log_buffer)
+    const CompactionFilter* compaction_filter, LogBuffer* log_buffer,
+    RangeDelAggregator* range_del_agg)
     : input_(input),
       cmp_(cmp),
       merge_helper_(merge_helper),
@@ -24,6 +25,7 @@ CompactionIterator::CompactionIterator(
       compaction_(compaction),
       compaction_filter_(compaction_filter),
       log_buffer_(log_buffer),
+      range_del_agg_(range_del_agg),
       merge_out_iter_(merge_helper_) {
   assert(compaction_filter_ == nullptr || compaction_ != nullptr);
   bottommost_level_ =
@@ -48,6 +50,7 @@ void CompactionIterator::ResetRecordCounts() {
   iter_stats_.num_record_drop_user = 0;
   iter_stats_.num_record_drop_hidden = 0;
   iter_stats_.num_record_drop_obsolete = 0;
+  iter_stats_.num_record_drop_range_del = 0;
 }
 
 void CompactionIterator::SeekToFirst() {
@@ -187,7 +190,13 @@ void CompactionIterator::NextFromInput() {
         visible_at_tip_ ? visible_at_tip_ : findEarliestVisibleSnapshot(
                                                 ikey_.sequence, &prev_snapshot);
 
-    if (ikey_.type == kTypeSingleDeletion) {
+    if (range_del_agg_ != nullptr && range_del_agg_->ShouldDelete(ikey_)) {
+      // Deleted by a range tombstone that is visible in the same snapshots
+      // as this key. Older versions of the key in this snapshot stripe are
+      // either covered as well or hidden.
+      ++iter_stats_.num_record_drop_range_del;
+      input_->Next();
+    } else if (ikey_.type == kTypeSingleDeletion) {
       ParsedInternalKey next_ikey;
       input_->Next();
 
@@ -276,7 +285,8 @@ void CompactionIterator::NextFromInput() {
       // have hit (A)
       // We encapsulate the merge related state machine in a different
       // object to minimize change to the existing flow.
-      merge_helper_->MergeUntil(input_, prev_snapshot, bottommost_level_);
+      merge_helper_->MergeUntil(input_, prev_snapshot, bottommost_level_,
+                                range_del_agg_);
       merge_out_iter_.SeekToFirst();
 
       if (merge_out_iter_.Valid()) {
@@ -13,6 +13,7 @@
 
 #include "db/compaction.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "rocksdb/compaction_filter.h"
 #include "util/log_buffer.h"
 
@@ -23,6 +24,7 @@ struct CompactionIteratorStats {
   int64_t num_record_drop_user = 0;
   int64_t num_record_drop_hidden = 0;
   int64_t num_record_drop_obsolete = 0;
+  int64_t num_record_drop_range_del = 0;
   uint64_t total_filter_time = 0;
 
   // Input statistics
@@ -43,7 +45,8 @@ class CompactionIterator {
                      bool expect_valid_internal_key,
                      Compaction* compaction = nullptr,
                      const CompactionFilter* compaction_filter = nullptr,
-                     LogBuffer* log_buffer = nullptr);
+                     LogBuffer* log_buffer = nullptr,
+                     RangeDelAggregator* range_del_agg = nullptr);
 
   void ResetRecordCounts();
 
@@ -93,6 +96,7 @@ class CompactionIterator {
   Compaction* compaction_;
   const CompactionFilter* compaction_filter_;
   LogBuffer* log_buffer_;
+  RangeDelAggregator* range_del_agg_;
   bool bottommost_level_;
   bool valid_ = false;
   SequenceNumber visible_at_tip_;
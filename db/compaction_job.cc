@@ -34,6 +34,8 @@
 #include "db/memtable_list.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
+#include "db/table_cache.h"
 #include "db/version_set.h"
 #include "port/likely.h"
 #include "port/port.h"
@@ -46,6 +48,7 @@
 #include "table/block_based_table_factory.h"
 #include "table/merger.h"
 #include "table/table_builder.h"
+#include "table/table_reader.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
 #include "util/iostats_context_imp.h"
@@ -103,6 +106,9 @@ struct CompactionJob::SubcompactionState {
   uint64_t num_output_records;
   CompactionJobStats compaction_job_stats;
   uint64_t approx_size;
+  // Samples of the first output file, used to compress the data blocks of
+  // the following output files. Empty if dictionary compression is off.
+  std::string compression_dict;
 
   SubcompactionState(Compaction* c, Slice* _start, Slice* _end,
                      uint64_t size = 0)
@@ -133,6 +139,7 @@ struct CompactionJob::SubcompactionState {
     num_output_records = std::move(o.num_output_records);
     compaction_job_stats = std::move(o.compaction_job_stats);
     approx_size = std::move(o.approx_size);
+    compression_dict = std::move(o.compression_dict);
     return *this;
   }
 
@@ -455,6 +462,12 @@ Status CompactionJob::Run() {
   assert(num_threads > 0);
   const uint64_t start_micros = env_->NowMicros();
 
+  if (compact_->compaction->column_family_data()
+          ->ioptions()
+          ->compaction_warm_block_cache) {
+    CollectHotRanges();
+  }
+
   // Launch a thread for each of subcompactions 1...num_threads-1
   std::vector<std::thread> thread_pool;
   thread_pool.reserve(num_threads - 1);
@@ -522,6 +535,14 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options,
   if (status.ok()) {
     status = InstallCompactionResults(mutable_cf_options, db_mutex);
   }
+  if (!input_table_handles_.empty()) {
+    // The blocks of the inputs will not be read anymore once the outputs are
+    // installed. Erasing them may read the index of the inputs, so do it
+    // without the mutex.
+    db_mutex->Unlock();
+    ReleaseInputTables(status.ok());
+    db_mutex->Lock();
+  }
   VersionStorageInfo::LevelSummaryStorage tmp;
   auto vstorage = cfd->current()->storage_info();
   const auto& stats = compaction_stats_;
@@ -585,8 +606,52 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options,
 
 void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   assert(sub_compact != nullptr);
-  std::unique_ptr<InternalIterator> input(
-      versions_->MakeInputIterator(sub_compact->compaction));
+  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
+
+  // Collect the range tombstones of all the input files. Files whose whole
+  // content is deleted by them are not read at all.
+  RangeDelAggregator range_del_agg(cfd->internal_comparator(),
+                                   existing_snapshots_);
+  Status status;
+  std::set<uint64_t> skip_files;
+  for (size_t which = 0; which < sub_compact->compaction->num_input_levels();
+       which++) {
+    for (const FileMetaData* f :
+         *sub_compact->compaction->inputs(which)) {
+      if (!f->has_range_deletions) {
+        continue;
+      }
+      status = range_del_agg.AddTombstones(
+          std::unique_ptr<InternalIterator>(
+              cfd->table_cache()->NewRangeTombstoneIterator(
+                  ReadOptions(), cfd->internal_comparator(), f->fd)));
+      if (!status.ok()) {
+        sub_compact->status = status;
+        return;
+      }
+    }
+  }
+  if (!range_del_agg.empty()) {
+    for (size_t which = 0;
+         which < sub_compact->compaction->num_input_levels(); which++) {
+      for (const FileMetaData* f :
+           *sub_compact->compaction->inputs(which)) {
+        if (range_del_agg.ShouldDeleteRange(
+                f->smallest.user_key(), f->largest.user_key(),
+                f->smallest_seqno, f->largest_seqno)) {
+          skip_files.insert(f->fd.GetNumber());
+          TEST_SYNC_POINT("CompactionJob::ProcessKeyValueCompaction:SkipFile");
+          Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+              "[%s] [JOB %d] Skipping table #%" PRIu64
+              ": deleted by range tombstones",
+              cfd->GetName().c_str(), job_id_, f->fd.GetNumber());
+        }
+      }
+    }
+  }
+
+  std::unique_ptr<InternalIterator> input(versions_->MakeInputIterator(
+      sub_compact->compaction, skip_files.empty() ? nullptr : &skip_files));
 
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_PROCESS_KV);
@@ -607,7 +672,6 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     prev_prepare_write_nanos = iostats_context.prepare_write_nanos;
   }
 
-  ColumnFamilyData* cfd = sub_compact->compaction->column_family_data();
   auto compaction_filter = cfd->ioptions()->compaction_filter;
   std::unique_ptr<CompactionFilter> compaction_filter_from_factory = nullptr;
   if (compaction_filter == nullptr) {
@@ -635,14 +699,42 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     input->SeekToFirst();
   }
 
-  Status status;
   sub_compact->c_iter.reset(new CompactionIterator(
       input.get(), cfd->user_comparator(), &merge, versions_->LastSequence(),
       &existing_snapshots_, env_, false, sub_compact->compaction,
-      compaction_filter));
+      compaction_filter, nullptr /* log_buffer */, &range_del_agg));
   auto c_iter = sub_compact->c_iter.get();
   c_iter->SeekToFirst();
   const auto& c_iter_stats = c_iter->iter_stats();
+  // Range tombstones written to an output file are clipped to the key range
+  // between the first key of the file and the first key of the next one, so
+  // the output files never overlap. A file can only be closed once the next
+  // key is known, and never between two versions of the same user key.
+  std::string output_lower_bound;
+  bool has_output_lower_bound = false;
+  if (start != nullptr) {
+    output_lower_bound = start->ToString();
+    has_output_lower_bound = true;
+  }
+  bool output_file_full = false;
+  std::string last_user_key;
+
+  // Compactions into the bottommost level sample the key/value stream of
+  // their first output file every "sample_stride" bytes, and use the samples
+  // as the compression dictionary of the following output files.
+  const size_t kSampleBytes = 64;
+  const size_t max_dict_bytes =
+      cfd->ioptions()->compression_opts.max_dict_bytes;
+  uint64_t sample_stride = 0;
+  if (bottommost_level_ && max_dict_bytes >= kSampleBytes &&
+      sub_compact->compaction->output_compression() != kNoCompression) {
+    sample_stride = std::max<uint64_t>(
+        kSampleBytes, sub_compact->compaction->max_output_file_size() /
+                          (max_dict_bytes / kSampleBytes));
+  }
+  std::string dict_sample_data;
+  uint64_t sampled_data_bytes = 0;
+  uint64_t next_sample_offset = 0;
   // TODO(noetzli): check whether we could check !shutting_down_->... only
   // only occasionally (see diff D42687)
   while (status.ok() && !shutting_down_->load(std::memory_order_acquire) &&
@@ -657,12 +749,29 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     if (end != nullptr &&
         cfd->user_comparator()->Compare(c_iter->user_key(), *end) >= 0) {
       break;
-    } else if (sub_compact->compaction->ShouldStopBefore(key) &&
-               sub_compact->builder != nullptr) {
-      status = FinishCompactionOutputFile(input->status(), sub_compact);
+    }
+    if (sub_compact->compaction->ShouldStopBefore(key) &&
+        sub_compact->builder != nullptr) {
+      output_file_full = true;
+    }
+    if (output_file_full &&
+        (range_del_agg.empty() ||
+         cfd->user_comparator()->Compare(c_iter->user_key(), last_user_key) !=
+             0)) {
+      output_file_full = false;
+      Slice lower_bound(output_lower_bound);
+      Slice next_lower_bound = c_iter->user_key();
+      status = FinishCompactionOutputFile(
+          input->status(), sub_compact, &range_del_agg,
+          has_output_lower_bound ? &lower_bound : nullptr, &next_lower_bound);
+      output_lower_bound = next_lower_bound.ToString();
+      has_output_lower_bound = true;
       if (!status.ok()) {
         break;
       }
+      if (sample_stride > 0 && sub_compact->compression_dict.empty()) {
+        sub_compact->compression_dict = std::move(dict_sample_data);
+      }
     }
 
     if (c_iter_stats.num_input_records % kRecordStatsEvery ==
@@ -685,6 +794,28 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     sub_compact->current_output()->meta.UpdateBoundaries(
         key, c_iter->ikey().sequence);
     sub_compact->num_output_records++;
+    if (sample_stride > 0 && sub_compact->outputs.size() == 1) {
+      uint64_t data_end = sampled_data_bytes + key.size() + value.size();
+      while (next_sample_offset < data_end &&
+             dict_sample_data.size() < max_dict_bytes) {
+        size_t pos = static_cast<size_t>(next_sample_offset -
+                                         sampled_data_bytes);
+        Slice part = key;
+        if (pos >= key.size()) {
+          pos -= key.size();
+          part = value;
+        }
+        size_t len = std::min(std::min(kSampleBytes, part.size() - pos),
+                              max_dict_bytes - dict_sample_data.size());
+        dict_sample_data.append(part.data() + pos, len);
+        next_sample_offset += sample_stride;
+      }
+      sampled_data_bytes = data_end;
+    }
+    if (!range_del_agg.empty()) {
+      last_user_key.assign(c_iter->user_key().data(),
+                           c_iter->user_key().size());
+    }
 
     // Close output file if it is big enough
     // TODO(aekmekji): determine if file should be closed earlier than this
@@ -693,7 +824,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     // and 0.6MB instead of 1MB and 0.2MB)
     if (sub_compact->builder->FileSize() >=
         sub_compact->compaction->max_output_file_size()) {
-      status = FinishCompactionOutputFile(input->status(), sub_compact);
+      output_file_full = true;
     }
 
     c_iter->Next();
@@ -719,8 +850,18 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     status = Status::ShutdownInProgress(
         "Database shutdown or Column family drop during compaction");
   }
+  Slice lower_bound(output_lower_bound);
+  if (status.ok() && sub_compact->builder == nullptr &&
+      range_del_agg.HasTombstonesToOutput(
+          has_output_lower_bound ? &lower_bound : nullptr, end,
+          bottommost_level_)) {
+    // Only range tombstones are left for this key range.
+    status = OpenCompactionOutputFile(sub_compact);
+  }
   if (status.ok() && sub_compact->builder != nullptr) {
-    status = FinishCompactionOutputFile(input->status(), sub_compact);
+    status = FinishCompactionOutputFile(
+        input->status(), sub_compact, &range_del_agg,
+        has_output_lower_bound ? &lower_bound : nullptr, end);
   }
   if (status.ok()) {
     status = input->status();
@@ -771,7 +912,9 @@ void CompactionJob::RecordDroppedKeys(
 }
 
 Status CompactionJob::FinishCompactionOutputFile(
-    const Status& input_status, SubcompactionState* sub_compact) {
+    const Status& input_status, SubcompactionState* sub_compact,
+    RangeDelAggregator* range_del_agg, const Slice* lower_bound,
+    const Slice* upper_bound) {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_SYNC_FILE);
   assert(sub_compact != nullptr);
@@ -786,8 +929,15 @@ Status CompactionJob::FinishCompactionOutputFile(
   // Check for iterator errors
   Status s = input_status;
   auto meta = &sub_compact->current_output()->meta;
+  if (s.ok() && range_del_agg != nullptr) {
+    s = range_del_agg->AddToBuilder(sub_compact->builder.get(), lower_bound,
+                                    upper_bound, meta, bottommost_level_);
+  }
   const uint64_t current_entries = sub_compact->builder->NumEntries();
   meta->marked_for_compaction = sub_compact->builder->NeedCompact();
+  if (!meta->has_range_deletions) {
+    meta->newest_entry_time = sub_compact->builder->NewestEntryTime();
+  }
   if (s.ok()) {
     s = sub_compact->builder->Finish();
   } else {
@@ -824,6 +974,17 @@ Status CompactionJob::FinishCompactionOutputFile(
     }
 
     delete iter;
+    if (s.ok() && !hot_ranges_.empty()) {
+      // Not being able to warm up the cache does not fail the compaction
+      Status warm_up_status = WarmUpOutputFile(*meta);
+      if (!warm_up_status.ok()) {
+        Log(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+            "[%s] [JOB %d] Could not warm up the block cache for table #%"
+            PRIu64 ": %s",
+            cfd->GetName().c_str(), job_id_, output_number,
+            warm_up_status.ToString().c_str());
+      }
+    }
     if (s.ok()) {
       auto tp = sub_compact->builder->GetTableProperties();
       sub_compact->current_output()->table_properties =
@@ -943,7 +1104,9 @@ Status CompactionJob::OpenCompactionOutputFile(
       *cfd->ioptions(), cfd->internal_comparator(),
       cfd->int_tbl_prop_collector_factories(), cfd->GetID(),
       sub_compact->outfile.get(), sub_compact->compaction->output_compression(),
-      cfd->ioptions()->compression_opts, skip_filters));
+      cfd->ioptions()->compression_opts, skip_filters,
+      sub_compact->compression_dict.empty() ? nullptr
+                                            : &sub_compact->compression_dict));
   LogFlush(db_options_.info_log);
   return s;
 }
@@ -1108,4 +1271,106 @@ void CompactionJob::LogCompaction() {
   }
 }
 
+void CompactionJob::CollectHotRanges() {
+  Compaction* c = compact_->compaction;
+  ColumnFamilyData* cfd = c->column_family_data();
+  const InternalKeyComparator& icmp = cfd->internal_comparator();
+  for (size_t which = 0; which < c->num_input_levels(); which++) {
+    for (size_t i = 0; i < c->num_input_files(which); i++) {
+      Cache::Handle* handle = nullptr;
+      Status s = cfd->table_cache()->FindTable(env_options_, icmp,
+                                               c->input(which, i)->fd, &handle);
+      if (!s.ok()) {
+        // The compaction itself will report the error
+        continue;
+      }
+      input_table_handles_.push_back(handle);
+      cfd->table_cache()->GetTableReaderFromHandle(handle)->GetCachedRanges(
+          &hot_ranges_);
+    }
+  }
+
+  // Merge the overlapping ranges of the input files. Ranges that start at
+  // the beginning of their file (empty first key) overlap each other.
+  typedef std::pair<std::string, std::string> KeyRange;
+  std::sort(hot_ranges_.begin(), hot_ranges_.end(),
+            [&icmp](const KeyRange& a, const KeyRange& b) {
+              if (a.first.empty() || b.first.empty()) {
+                return a.first.empty() && !b.first.empty();
+              }
+              return icmp.Compare(a.first, b.first) < 0;
+            });
+  size_t num_ranges = 0;
+  for (size_t i = 0; i < hot_ranges_.size(); i++) {
+    if (num_ranges > 0 &&
+        (hot_ranges_[i].first.empty() ||
+         icmp.Compare(hot_ranges_[i].first,
+                      hot_ranges_[num_ranges - 1].second) <= 0)) {
+      KeyRange& last = hot_ranges_[num_ranges - 1];
+      if (icmp.Compare(hot_ranges_[i].second, last.second) > 0) {
+        last.second.swap(hot_ranges_[i].second);
+      }
+    } else {
+      if (num_ranges != i) {
+        hot_ranges_[num_ranges] = std::move(hot_ranges_[i]);
+      }
+      num_ranges++;
+    }
+  }
+  hot_ranges_.resize(num_ranges);
+  Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+      "[%s] [JOB %d] %" ROCKSDB_PRIszt
+      " key ranges of the inputs are in the block cache",
+      cfd->GetName().c_str(), job_id_, hot_ranges_.size());
+}
+
+Status CompactionJob::WarmUpOutputFile(const FileMetaData& meta) {
+  ColumnFamilyData* cfd = compact_->compaction->column_family_data();
+  const InternalKeyComparator& icmp = cfd->internal_comparator();
+  Cache::Handle* handle = nullptr;
+  Status s =
+      cfd->table_cache()->FindTable(env_options_, icmp, meta.fd, &handle);
+  if (!s.ok()) {
+    return s;
+  }
+  TableReader* table_reader =
+      cfd->table_cache()->GetTableReaderFromHandle(handle);
+  const Slice smallest = meta.smallest.Encode();
+  const Slice largest = meta.largest.Encode();
+  for (const auto& range : hot_ranges_) {
+    if (!range.first.empty() && icmp.Compare(range.first, largest) > 0) {
+      break;
+    }
+    if (icmp.Compare(range.second, smallest) < 0) {
+      continue;
+    }
+    Slice begin = smallest;
+    if (!range.first.empty() && icmp.Compare(range.first, smallest) > 0) {
+      begin = range.first;
+    }
+    Slice end = largest;
+    if (icmp.Compare(range.second, largest) < 0) {
+      end = range.second;
+    }
+    s = table_reader->Prefetch(&begin, &end);
+    if (!s.ok()) {
+      break;
+    }
+  }
+  cfd->table_cache()->ReleaseHandle(handle);
+  return s;
+}
+
+void CompactionJob::ReleaseInputTables(bool erase) {
+  TableCache* table_cache =
+      compact_->compaction->column_family_data()->table_cache();
+  for (Cache::Handle* handle : input_table_handles_) {
+    if (erase) {
+      table_cache->GetTableReaderFromHandle(handle)->EraseFromBlockCache();
+    }
+    table_cache->ReleaseHandle(handle);
+  }
+  input_table_handles_.clear();
+}
+
 }  // namespace rocksdb
@@ -92,8 +92,13 @@ class CompactionJob {
   // kv-pairs
   void ProcessKeyValueCompaction(SubcompactionState* sub_compact);
 
+  // Range tombstones of "range_del_agg" that fall in the user key range
+  // [lower_bound, upper_bound) are written to the file before it is closed.
   Status FinishCompactionOutputFile(const Status& input_status,
-                                    SubcompactionState* sub_compact);
+                                    SubcompactionState* sub_compact,
+                                    RangeDelAggregator* range_del_agg = nullptr,
+                                    const Slice* lower_bound = nullptr,
+                                    const Slice* upper_bound = nullptr);
   Status InstallCompactionResults(const MutableCFOptions& mutable_cf_options,
                                   InstrumentedMutex* db_mutex);
   void RecordCompactionIOStats();
@@ -110,6 +115,15 @@ class CompactionJob {
 
   void LogCompaction();
 
+  // Collects hot_ranges_ from the input files and keeps them open.
+  void CollectHotRanges();
+  // Loads the blocks of a new output file that overlap hot_ranges_ into the
+  // block cache.
+  Status WarmUpOutputFile(const FileMetaData& meta);
+  // Releases the input files kept open by CollectHotRanges(), erasing their
+  // blocks from the block cache first if "erase" is true.
+  void ReleaseInputTables(bool erase);
+
   int job_id_;
 
   // CompactionJob state
@@ -145,6 +159,11 @@ class CompactionJob {
   std::vector<Slice> boundaries_;
   // Stores the approx size of keys covered in the range of each subcompaction
   std::vector<uint64_t> sizes_;
+  // The internal key ranges of the input files whose data blocks were in the
+  // block cache when the compaction started, sorted and disjoint. Only
+  // collected with compaction_warm_block_cache.
+  std::vector<std::pair<std::string, std::string>> hot_ranges_;
+  std::vector<Cache::Handle*> input_table_handles_;
 };
 
 }  // namespace rocksdb
@@ -14,6 +14,7 @@
 #endif
 
 #include <inttypes.h>
+#include <algorithm>
 #include <limits>
 #include <queue>
 #include <string>
@@ -539,6 +540,12 @@ Compaction* CompactionPicker::CompactRange(
     assert(output_level > 0);
   }
   output_level_inputs.level = output_level;
+  // Levels mapped onto paths take precedence over the requested path
+  if (!ioptions_.level_path_ids.empty()) {
+    output_path_id =
+        LevelCompactionPicker::GetPathId(ioptions_, mutable_cf_options,
+                                         output_level);
+  }
   if (input_level != output_level) {
     int parent_index = -1;
     if (!SetupOtherInputs(cf_name, mutable_cf_options, vstorage, &inputs,
@@ -810,11 +817,69 @@ bool LevelCompactionPicker::NeedsCompaction(const VersionStorageInfo* vstorage)
   if (!vstorage->FilesMarkedForCompaction().empty()) {
     return true;
   }
+  if (vstorage->MinNewestEntryTime() != 0 &&
+      vstorage->MinNewestEntryTime() <
+          ExpiredFileThreshold(ioptions_.env, ioptions_.expired_files_ttl)) {
+    return true;
+  }
   for (int i = 0; i <= vstorage->MaxInputLevel(); i++) {
     if (vstorage->CompactionScore(i) >= 1) {
       return true;
     }
   }
+  int level;
+  FileMetaData* file;
+  return FindFileToMigrate(vstorage, &level, &file);
+}
+
+bool LevelCompactionPicker::FindFileToMigrate(
+    const VersionStorageInfo* vstorage, int* level,
+    FileMetaData** file) const {
+  if (ioptions_.level_path_ids.empty()) {
+    return false;
+  }
+  // L0 files are left alone, they are compacted into L1 soon anyway
+  for (int l = 1; l < vstorage->num_non_empty_levels(); l++) {
+    const size_t i = std::min(static_cast<size_t>(l),
+                              ioptions_.level_path_ids.size() - 1);
+    const uint32_t path_id = ioptions_.level_path_ids[i];
+    for (FileMetaData* f : vstorage->LevelFiles(l)) {
+      if (!f->being_compacted && f->fd.GetPathId() != path_id) {
+        *level = l;
+        *file = f;
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+bool LevelCompactionPicker::PickExpiredFiles(VersionStorageInfo* vstorage,
+                                             CompactionInputFiles* inputs) {
+  const uint64_t threshold =
+      ExpiredFileThreshold(ioptions_.env, ioptions_.expired_files_ttl);
+  if (vstorage->MinNewestEntryTime() == 0 ||
+      vstorage->MinNewestEntryTime() >= threshold) {
+    return false;
+  }
+  for (int level = 0; level < vstorage->num_non_empty_levels(); level++) {
+    if (level == 0 && !level0_compactions_in_progress_.empty()) {
+      continue;
+    }
+    inputs->level = level;
+    const std::vector<FileMetaData*>& files = vstorage->LevelFiles(level);
+    for (size_t i = 0; i < files.size(); i++) {
+      const uint64_t newest_entry_time =
+          vstorage->ExpirableNewestEntryTime(level, i);
+      if (!files[i]->being_compacted && newest_entry_time != 0 &&
+          newest_entry_time < threshold) {
+        inputs->files.push_back(files[i]);
+      }
+    }
+    if (!inputs->empty()) {
+      return true;
+    }
+  }
   return false;
 }
 
@@ -871,6 +936,27 @@ Compaction* LevelCompactionPicker::PickCompaction(
   CompactionInputFiles inputs;
   double score = 0;
 
+  // Dropping expired files is cheap and frees space for good, so it goes
+  // first
+  if (PickExpiredFiles(vstorage, &inputs)) {
+    level = inputs.level;
+    LogToBuffer(log_buffer,
+                "[%s] Level: picking %" ROCKSDB_PRIszt
+                " expired files of level %d for deletion\n",
+                cf_name.c_str(), inputs.size(), level);
+    auto c = new Compaction(vstorage, mutable_cf_options, {inputs}, level, 0,
+                            0, 0, kNoCompression, {}, /* is manual */ false,
+                            vstorage->CompactionScore(0),
+                            /* is deletion compaction */ true);
+    if (level == 0) {
+      level0_compactions_in_progress_.insert(c);
+    }
+    CompactionOptionsFIFO dummy_compaction_options_fifo;
+    vstorage->ComputeCompactionScore(mutable_cf_options,
+                                     dummy_compaction_options_fifo);
+    return c;
+  }
+
   // Find the compactions by size on all levels.
   for (int i = 0; i < NumberLevels() - 1; i++) {
     score = vstorage->CompactionScore(i);
@@ -886,6 +972,14 @@ Compaction* LevelCompactionPicker::PickCompaction(
       } else {
         // didn't find the compaction, clear the inputs
         inputs.clear();
+        // L0->base_level may be blocked by a running L0 compaction or by a
+        // compaction out of base_level. Merging L0 files among themselves
+        // still keeps the L0 file count down in the meantime.
+        if (level == 0 &&
+            PickIntraL0Compaction(vstorage, mutable_cf_options, &inputs)) {
+          output_level = 0;
+          break;
+        }
       }
     }
   }
@@ -899,14 +993,30 @@ Compaction* LevelCompactionPicker::PickCompaction(
     PickFilesMarkedForCompactionExperimental(cf_name, vstorage, &inputs, &level,
                                              &output_level);
   }
+  // Move a file whose level is mapped onto another path, e.g. a file that
+  // was trivially moved to a cold level before level_path_ids was set
+  bool is_migration = false;
+  FileMetaData* file_to_migrate;
+  if (inputs.empty() &&
+      FindFileToMigrate(vstorage, &level, &file_to_migrate)) {
+    is_manual = false;
+    is_migration = true;
+    output_level = level;
+    inputs.level = level;
+    inputs.files = {file_to_migrate};
+    if (!ExpandWhileOverlapping(cf_name, vstorage, &inputs)) {
+      inputs.clear();
+    }
+  }
   if (inputs.empty()) {
     return nullptr;
   }
   assert(level >= 0 && output_level >= 0);
 
   // Two level 0 compaction won't run at the same time, so don't need to worry
-  // about files on level 0 being compacted.
-  if (level == 0) {
+  // about files on level 0 being compacted. Intra-L0 compactions only pick
+  // files that are not being compacted.
+  if (level == 0 && output_level != 0) {
     assert(level0_compactions_in_progress_.empty());
     InternalKey smallest, largest;
     GetRange(inputs, &smallest, &largest);
@@ -922,16 +1032,36 @@ Compaction* LevelCompactionPicker::PickCompaction(
     GetRange(inputs, &smallest, &largest);
     if (RangeInCompaction(vstorage, &smallest, &largest, output_level,
                           &parent_index)) {
-      return nullptr;
+      inputs.clear();
+      if (!PickIntraL0Compaction(vstorage, mutable_cf_options, &inputs)) {
+        return nullptr;
+      }
+      output_level = 0;
     }
     assert(!inputs.files.empty());
   }
 
+  const bool is_intra_l0 = (level == 0 && output_level == 0);
+  if (is_intra_l0) {
+    LogToBuffer(log_buffer,
+                "[%s] Level: picked intra-L0 compaction of %" ROCKSDB_PRIszt
+                " files\n",
+                cf_name.c_str(), inputs.size());
+  }
+  if (is_migration) {
+    LogToBuffer(log_buffer,
+                "[%s] Level: moving %" ROCKSDB_PRIszt
+                " files of level %d to path %" PRIu32 "\n",
+                cf_name.c_str(), inputs.size(), level,
+                GetPathId(ioptions_, mutable_cf_options, level));
+  }
+
   // Setup input files from output level
   CompactionInputFiles output_level_inputs;
   output_level_inputs.level = output_level;
-  if (!SetupOtherInputs(cf_name, mutable_cf_options, vstorage, &inputs,
-                   &output_level_inputs, &parent_index, base_index)) {
+  if (!is_intra_l0 && !is_migration &&
+      !SetupOtherInputs(cf_name, mutable_cf_options, vstorage, &inputs,
+                        &output_level_inputs, &parent_index, base_index)) {
     return nullptr;
   }
 
@@ -941,11 +1071,18 @@ Compaction* LevelCompactionPicker::PickCompaction(
   }
 
   std::vector<FileMetaData*> grandparents;
-  GetGrandparents(vstorage, inputs, output_level_inputs, &grandparents);
+  if (!is_intra_l0 && !is_migration) {
+    GetGrandparents(vstorage, inputs, output_level_inputs, &grandparents);
+  }
+  // An intra-L0 compaction writes a single file: L0 files are ordered by
+  // sequence number, which several outputs covering the same sequence numbers
+  // would not allow.
   auto c = new Compaction(
       vstorage, mutable_cf_options, std::move(compaction_inputs), output_level,
-      mutable_cf_options.MaxFileSizeForLevel(output_level),
-      mutable_cf_options.MaxGrandParentOverlapBytes(level),
+      is_intra_l0 ? port::kMaxUint64
+                  : mutable_cf_options.MaxFileSizeForLevel(output_level),
+      is_intra_l0 ? port::kMaxUint64
+                  : mutable_cf_options.MaxGrandParentOverlapBytes(level),
       GetPathId(ioptions_, mutable_cf_options, output_level),
       GetCompressionType(ioptions_, output_level, vstorage->base_level()),
       std::move(grandparents), is_manual, score);
@@ -974,11 +1111,18 @@ Compaction* LevelCompactionPicker::PickCompaction(
 /*
  * Find the optimal path to place a file
  * Given a level, finds the path where levels up to it will fit in levels
- * up to and including this path
+ * up to and including this path, unless level_path_ids maps the level onto
+ * a path
  */
 uint32_t LevelCompactionPicker::GetPathId(
     const ImmutableCFOptions& ioptions,
     const MutableCFOptions& mutable_cf_options, int level) {
+  if (!ioptions.level_path_ids.empty()) {
+    size_t i = std::min(static_cast<size_t>(level),
+                        ioptions.level_path_ids.size() - 1);
+    return ioptions.level_path_ids[i];
+  }
+
   uint32_t p = 0;
   assert(!ioptions.db_paths.empty());
 
@@ -1069,6 +1213,58 @@ bool LevelCompactionPicker::PickCompactionBySize(VersionStorageInfo* vstorage,
   return inputs->size() > 0;
 }
 
+bool LevelCompactionPicker::PickIntraL0Compaction(
+    VersionStorageInfo* vstorage, const MutableCFOptions& mutable_cf_options,
+    CompactionInputFiles* inputs) {
+  // Merging fewer files than this does not reduce the file count enough to
+  // be worth the rewrite.
+  static const size_t kMinFilesForIntraL0Compaction = 4;
+
+  inputs->clear();
+  const std::vector<FileMetaData*>& level_files = vstorage->LevelFiles(0);
+  if (level_files.size() <
+          std::max(kMinFilesForIntraL0Compaction,
+                   static_cast<size_t>(
+                       mutable_cf_options.level0_file_num_compaction_trigger +
+                       2)) ||
+      level_files[0]->being_compacted) {
+    // Only resort to intra-L0 compactions when L0 keeps growing past the
+    // compaction trigger.
+    return false;
+  }
+
+  // L0 files are sorted newest first. The picked files have to be the newest
+  // ones and contiguous, so that the output can take their place in the
+  // sequence number order. Stop pulling in older files once the bytes
+  // rewritten per file removed from L0 start to grow, so that a large old
+  // file is not rewritten again and again.
+  const uint64_t max_compaction_bytes =
+      mutable_cf_options.ExpandedCompactionByteSizeLimit(0);
+  uint64_t compact_bytes = level_files[0]->fd.GetFileSize();
+  uint64_t compact_bytes_per_del_file = port::kMaxUint64;
+  size_t limit = 1;
+  for (; limit < level_files.size(); limit++) {
+    FileMetaData* f = level_files[limit];
+    if (f->being_compacted ||
+        compact_bytes + f->fd.GetFileSize() > max_compaction_bytes) {
+      break;
+    }
+    uint64_t new_compact_bytes_per_del_file =
+        (compact_bytes + f->fd.GetFileSize()) / limit;
+    if (new_compact_bytes_per_del_file > compact_bytes_per_del_file) {
+      break;
+    }
+    compact_bytes += f->fd.GetFileSize();
+    compact_bytes_per_del_file = new_compact_bytes_per_del_file;
+  }
+  if (limit < kMinFilesForIntraL0Compaction) {
+    return false;
+  }
+  inputs->level = 0;
+  inputs->files.assign(level_files.begin(), level_files.begin() + limit);
+  return true;
+}
+
 #ifndef ROCKSDB_LITE
 bool UniversalCompactionPicker::NeedsCompaction(
     const VersionStorageInfo* vstorage) const {
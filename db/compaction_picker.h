@@ -199,6 +199,20 @@ class LevelCompactionPicker : public CompactionPicker {
                             int level);
 
  private:
+  // Finds a file of level 1 or higher that is not being compacted and is not
+  // on the path ImmutableCFOptions::level_path_ids maps its level to. Such a
+  // file is rewritten into its own level on the right path. Returns false if
+  // there is none.
+  bool FindFileToMigrate(const VersionStorageInfo* vstorage, int* level,
+                         FileMetaData** file) const;
+
+  // Picks the files of the first level that holds files whose newest entry
+  // is older than ImmutableCFOptions::expired_files_ttl, that no older file
+  // overlaps and that are not being compacted. They are deleted without
+  // being rewritten. Returns false if there is none.
+  bool PickExpiredFiles(VersionStorageInfo* vstorage,
+                        CompactionInputFiles* inputs);
+
   // For the specfied level, pick a file that we want to compact.
   // Returns false if there is no file to compact.
   // If it returns true, inputs->files.size() will be exactly one.
@@ -208,6 +222,15 @@ class LevelCompactionPicker : public CompactionPicker {
                             int output_level, CompactionInputFiles* inputs,
                             int* parent_index, int* base_index);
 
+  // Used when L0 has to be compacted but L0->base_level is blocked by
+  // another compaction. Picks a run of the newest L0 files that are not being
+  // compacted to merge into a single L0 file, which lowers the L0 file count
+  // and thus read amplification and the chance of a write stall. Returns
+  // false if there is no such run worth compacting.
+  bool PickIntraL0Compaction(VersionStorageInfo* vstorage,
+                             const MutableCFOptions& mutable_cf_options,
+                             CompactionInputFiles* inputs);
+
   // If there is any file marked for compaction, put put it into inputs.
   // This is still experimental. It will return meaningful results only if
   // clients call experimental feature SuggestCompactRange()
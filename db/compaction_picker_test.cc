@@ -160,6 +160,47 @@ TEST_F(CompactionPickerTest, Level0Trigger) {
   ASSERT_EQ(2U, compaction->input(0, 1)->fd.GetNumber());
 }
 
+TEST_F(CompactionPickerTest, IntraL0WhenL0ToL1Blocked) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+  // Five small L0 files, newest first, and an old, large one.
+  for (uint32_t i = 6; i >= 2; i--) {
+    Add(0, i, "150", "200", 1000U, 0, i * 10, i * 10);
+  }
+  Add(0, 1U, "150", "200", 100000000U, 0, 10, 10);
+  // L0->L1 is blocked by a compaction out of L1.
+  Add(1, 7U, "100", "300", 1000U);
+  file_map_[7U].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(0, compaction->start_level());
+  ASSERT_EQ(0, compaction->output_level());
+  ASSERT_EQ(1U, compaction->num_input_levels());
+  // The large file is left out.
+  ASSERT_EQ(5U, compaction->num_input_files(0));
+  for (size_t i = 0; i < compaction->num_input_files(0); i++) {
+    ASSERT_NE(1U, compaction->input(0, i)->fd.GetNumber());
+  }
+}
+
+TEST_F(CompactionPickerTest, NoIntraL0WithFewFiles) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  mutable_cf_options_.level0_file_num_compaction_trigger = 2;
+  for (uint32_t i = 3; i >= 1; i--) {
+    Add(0, i, "150", "200", 1000U, 0, i * 10, i * 10);
+  }
+  Add(1, 4U, "100", "300", 1000U);
+  file_map_[4U].first->being_compacted = true;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, vstorage_.get(), &log_buffer_));
+  ASSERT_TRUE(compaction.get() == nullptr);
+}
+
 TEST_F(CompactionPickerTest, Level1Trigger) {
   NewVersionStorage(6, kCompactionStyleLevel);
   Add(1, 66U, "150", "200", 1000000000U);
@@ -344,6 +344,12 @@ DEFINE_int64(cache_size, -1, "Number of bytes to use as a cache of uncompressed"
 DEFINE_bool(cache_index_and_filter_blocks, false,
             "Cache index/filter blocks in block cache.");
 
+DEFINE_bool(compaction_warm_block_cache,
+            rocksdb::Options().compaction_warm_block_cache,
+            "Load the blocks of compaction outputs that cover the key ranges"
+            " cached from the inputs into the block cache, and erase the"
+            " blocks of the inputs from it.");
+
 DEFINE_int32(block_size,
              static_cast<int32_t>(rocksdb::BlockBasedTableOptions().block_size),
              "Number of bytes in a block.");
@@ -353,6 +359,19 @@ DEFINE_int32(block_restart_interval,
              "Number of keys between restart points "
              "for delta encoding of keys.");
 
+DEFINE_bool(use_delta_encoding,
+            rocksdb::BlockBasedTableOptions().use_delta_encoding,
+            "Delta encode the keys of data blocks.");
+
+DEFINE_bool(data_block_hash_index,
+            rocksdb::BlockBasedTableOptions().data_block_hash_index,
+            "Append a hash index to data blocks for point lookups.");
+
+DEFINE_int32(parallel_compression_threads,
+             rocksdb::BlockBasedTableOptions().parallel_compression_threads,
+             "Number of threads each table builder uses to compress data "
+             "blocks.");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -360,6 +379,15 @@ DEFINE_int64(row_cache_size, 0,
              "Number of bytes to use as a cache of individual rows"
              " (0 = disabled).");
 
+DEFINE_bool(row_cache_admission_filter,
+            rocksdb::Options().row_cache_admission_filter,
+            "Only insert rows into the row cache whose keys were looked up"
+            " at least twice recently.");
+
+DEFINE_uint64(row_cache_budget, rocksdb::Options().row_cache_budget,
+              "Maximum number of bytes of the row cache the rows of a column"
+              " family may use (0 = no limit).");
+
 DEFINE_int32(open_files, rocksdb::Options().max_open_files,
              "Maximum number of files to keep open at the same time"
              " (use default if == 0)");
@@ -368,6 +396,10 @@ DEFINE_int32(file_opening_threads, rocksdb::Options().max_file_opening_threads,
              "If open_files is set to -1, this option set the number of "
              "threads that will be used to open files during DB::Open()");
 
+DEFINE_bool(open_files_lazily, rocksdb::Options().open_files_lazily,
+            "If open_files is set to -1, open the files in the background"
+            " after DB::Open() returns instead of during DB::Open()");
+
 DEFINE_int32(new_table_reader_for_compaction_inputs, true,
              "If true, uses a separate file handle for compaction inputs");
 
@@ -377,6 +409,9 @@ DEFINE_int32(bloom_bits, -1, "Bloom filter bits per key. Negative means"
              " use default settings.");
 DEFINE_int32(memtable_bloom_bits, 0, "Bloom filter bits per key for memtable. "
              "Negative means no bloom filter.");
+DEFINE_bool(memtable_whole_key_filtering, false,
+            "Add whole keys to the memtable bloom filter, which then does not"
+            " need a prefix extractor.");
 
 DEFINE_bool(use_existing_db, false, "If true, do not destroy the existing"
             " database.  If you set this flag and also specify a benchmark that"
@@ -568,6 +603,10 @@ static bool ValidateCompressionLevel(const char* flagname, int32_t value) {
 static const bool FLAGS_compression_level_dummy __attribute__((unused)) =
     RegisterFlagValidator(&FLAGS_compression_level, &ValidateCompressionLevel);
 
+DEFINE_int32(compression_max_dict_bytes, 0,
+             "Maximum size of dictionary used to prime the compression "
+             "library.");
+
 DEFINE_int32(min_level_to_compress, -1, "If non-negative, compression starts"
              " from this level. Levels with number < min_level_to_compress are"
              " not compressed. Otherwise, apply compression_type to "
@@ -624,12 +663,15 @@ DEFINE_double(soft_rate_limit, 0.0, "");
 
 DEFINE_double(hard_rate_limit, 0.0, "DEPRECATED");
 
+DEFINE_uint64(soft_pending_compaction_bytes_limit, 64ull * 1024 * 1024 * 1024,
+              "Slowdown writes if pending compaction bytes exceed this number");
+
 DEFINE_uint64(hard_pending_compaction_bytes_limit, 128u * 1024 * 1024 * 1024,
               "Stop writes if pending compaction bytes exceed this number");
 
 DEFINE_uint64(delayed_write_rate, 2097152u,
-              "Limited bytes allowed to DB when soft_rate_limit or "
-              "level0_slowdown_writes_trigger triggers");
+              "Maximum bytes allowed to DB per second while writes are "
+              "delayed");
 
 DEFINE_int32(rate_limit_delay_max_milliseconds, 1000,
              "When hard_rate_limit is set then this is the max time a put will"
@@ -683,6 +725,10 @@ DEFINE_string(flashcache_dev, "", "Path to flashcache device");
 DEFINE_bool(use_tailing_iterator, false,
             "Use tailing iterator to access a series of keys instead of get");
 
+DEFINE_bool(pin_data, false,
+            "Pin the data blocks read by sequential scans for the lifetime of "
+            "the iterator instead of copying keys and values");
+
 DEFINE_bool(use_adaptive_mutex, rocksdb::Options().use_adaptive_mutex,
             "Use adaptive mutex");
 
@@ -774,6 +820,9 @@ DEFINE_bool(use_hash_search, false, "if use kHashSearch "
 DEFINE_bool(use_block_based_filter, false, "if use kBlockBasedFilter "
             "instead of kFullFilter for filter block. "
             "This is valid if only we use BlockTable");
+DEFINE_bool(use_blocked_full_filter, false, "if use the cache-line-blocked "
+            "format for kFullFilter filter blocks. "
+            "This is valid if only we use BlockTable");
 DEFINE_string(merge_operator, "", "The merge operator to use with the database."
               "If a new merge operator is specified, be sure to use fresh"
               " database The possible merge operators are defined in"
@@ -1677,7 +1726,8 @@ class Benchmark {
                               : nullptr),
         filter_policy_(FLAGS_bloom_bits >= 0
                            ? NewBloomFilterPolicy(FLAGS_bloom_bits,
-                                                  FLAGS_use_block_based_filter)
+                                                  FLAGS_use_block_based_filter,
+                                                  FLAGS_use_blocked_full_filter)
                            : nullptr),
         prefix_extractor_(NewFixedPrefixTransform(FLAGS_prefix_size)),
         num_(FLAGS_num),
@@ -2269,9 +2319,11 @@ class Benchmark {
       }
     }
     options.memtable_prefix_bloom_bits = FLAGS_memtable_bloom_bits;
+    options.memtable_whole_key_filtering = FLAGS_memtable_whole_key_filtering;
     options.bloom_locality = FLAGS_bloom_locality;
     options.max_open_files = FLAGS_open_files;
     options.max_file_opening_threads = FLAGS_file_opening_threads;
+    options.open_files_lazily = FLAGS_open_files_lazily;
     options.new_table_reader_for_compaction_inputs =
         FLAGS_new_table_reader_for_compaction_inputs;
     options.compaction_readahead_size = FLAGS_compaction_readahead_size;
@@ -2318,6 +2370,8 @@ class Benchmark {
       } else {
         options.row_cache = NewLRUCache(FLAGS_row_cache_size);
       }
+      options.row_cache_admission_filter = FLAGS_row_cache_admission_filter;
+      options.row_cache_budget = FLAGS_row_cache_budget;
     }
     if ((FLAGS_prefix_size == 0) && (FLAGS_rep_factory == kPrefixHash ||
                                      FLAGS_rep_factory == kHashLinkedList)) {
@@ -2413,9 +2467,14 @@ class Benchmark {
       block_based_options.cache_index_and_filter_blocks =
           FLAGS_cache_index_and_filter_blocks;
       block_based_options.block_cache = cache_;
+      options.compaction_warm_block_cache = FLAGS_compaction_warm_block_cache;
       block_based_options.block_cache_compressed = compressed_cache_;
       block_based_options.block_size = FLAGS_block_size;
       block_based_options.block_restart_interval = FLAGS_block_restart_interval;
+      block_based_options.use_delta_encoding = FLAGS_use_delta_encoding;
+      block_based_options.data_block_hash_index = FLAGS_data_block_hash_index;
+      block_based_options.parallel_compression_threads =
+          FLAGS_parallel_compression_threads;
       block_based_options.filter_policy = filter_policy_;
       block_based_options.format_version = 2;
       options.table_factory.reset(
@@ -2438,6 +2497,7 @@ class Benchmark {
       FLAGS_level0_slowdown_writes_trigger;
     options.compression = FLAGS_compression_type_e;
     options.compression_opts.level = FLAGS_compression_level;
+    options.compression_opts.max_dict_bytes = FLAGS_compression_max_dict_bytes;
     options.WAL_ttl_seconds = FLAGS_wal_ttl_seconds;
     options.WAL_size_limit_MB = FLAGS_wal_size_limit_MB;
     options.max_total_wal_size = FLAGS_max_total_wal_size;
@@ -2455,6 +2515,8 @@ class Benchmark {
     }
     options.soft_rate_limit = FLAGS_soft_rate_limit;
     options.hard_rate_limit = FLAGS_hard_rate_limit;
+    options.soft_pending_compaction_bytes_limit =
+        FLAGS_soft_pending_compaction_bytes_limit;
     options.hard_pending_compaction_bytes_limit =
         FLAGS_hard_pending_compaction_bytes_limit;
     options.delayed_write_rate = FLAGS_delayed_write_rate;
@@ -2769,6 +2831,7 @@ class Benchmark {
   void ReadSequential(ThreadState* thread, DB* db) {
     ReadOptions options(FLAGS_verify_checksum, true);
     options.tailing = FLAGS_use_tailing_iterator;
+    options.pin_data = FLAGS_pin_data;
 
     Iterator* iter = db->NewIterator(options);
     int64_t i = 0;
@@ -1073,6 +1073,100 @@ TEST_P(DBCompactionTestWithParam, LevelCompactionPathUse) {
   Destroy(options);
 }
 
+TEST_F(DBCompactionTest, LevelCompactionPathMapping) {
+  Options options = CurrentOptions();
+  options.db_paths.emplace_back(dbname_, 1);
+  options.db_paths.emplace_back(dbname_ + "_cold", 1024 * 1024 * 1024);
+  // L0 and L1 are hot, L2 and L3 cold
+  options.level_path_ids = {0, 0, 1};
+  options.compaction_style = kCompactionStyleLevel;
+  options.num_levels = 4;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 100;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "value" + ToString(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ("1", FilesPerLevel(0));
+  // The target size of the first path is ignored
+  ASSERT_EQ(1, GetSstFileCount(dbname_));
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel(0));
+  ASSERT_EQ(1, GetSstFileCount(dbname_));
+  ASSERT_EQ(0, GetSstFileCount(options.db_paths[1].path));
+
+  // Moving the file down to L2 rewrites it into the cold path
+  ASSERT_OK(dbfull()->TEST_CompactRange(1, nullptr, nullptr));
+  ASSERT_EQ("0,0,1", FilesPerLevel(0));
+  ASSERT_EQ(0, GetSstFileCount(dbname_));
+  ASSERT_EQ(1, GetSstFileCount(options.db_paths[1].path));
+
+  // Files are migrated once their level is mapped onto another path
+  options.level_path_ids = {0};
+  options.disable_auto_compactions = false;
+  Reopen(options);
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ("0,0,1", FilesPerLevel(0));
+  ASSERT_EQ(1, GetSstFileCount(dbname_));
+  ASSERT_EQ(0, GetSstFileCount(options.db_paths[1].path));
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ("value" + ToString(i), Get(Key(i)));
+  }
+  Destroy(options);
+}
+
+TEST_F(DBCompactionTest, CompactionWarmBlockCache) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.compression = kNoCompression;
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.compaction_warm_block_cache = true;
+  std::shared_ptr<Cache> block_cache = NewLRUCache(8 << 20);
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = block_cache;
+  table_options.block_size = 1024;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Two overlapping L0 files
+  const int kNumKeys = 1000;
+  for (int file = 0; file < 2; file++) {
+    for (int i = file; i < kNumKeys; i += 2) {
+      ASSERT_OK(Put(Key(i), std::string(100, 'a' + file)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ("2", FilesPerLevel(0));
+
+  const int kNumHotKeys = 100;
+  for (int i = 0; i < kNumHotKeys; i++) {
+    Get(Key(i));
+  }
+  const size_t usage_before = block_cache->GetUsage();
+  ASSERT_GT(usage_before, 0U);
+
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel(0));
+  // The blocks of the inputs were replaced by those of the output
+  const size_t usage_after = block_cache->GetUsage();
+  ASSERT_GT(usage_after, 0U);
+  ASSERT_LT(usage_after, usage_before * 3 / 2);
+
+  Statistics* stats = options.statistics.get();
+  uint64_t misses = stats->getTickerCount(BLOCK_CACHE_DATA_MISS);
+  for (int i = 0; i < kNumHotKeys; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 2), Get(Key(i)));
+  }
+  ASSERT_EQ(misses, stats->getTickerCount(BLOCK_CACHE_DATA_MISS));
+  // Cold ranges are not loaded
+  ASSERT_EQ(std::string(100, 'b'), Get(Key(kNumKeys - 1)));
+  ASSERT_EQ(misses + 1, stats->getTickerCount(BLOCK_CACHE_DATA_MISS));
+}
+
 TEST_P(DBCompactionTestWithParam, ConvertCompactionStyle) {
   Random rnd(301);
   int max_key_level_insert = 200;
@@ -1842,6 +1936,224 @@ TEST_P(DBCompactionTestWithParam, ForceBottommostLevelCompaction) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBCompactionTest, CompressionDictionary) {
+  if (!Zlib_Supported()) {
+    return;
+  }
+  // Small blocks of values built from a small vocabulary compress much better
+  // once the compressor is primed with samples of the data.
+  const char* kWords[] = {"rocksdb", "compaction", "dictionary", "level",
+                          "memtable", "snapshot", "iterator", "sequence"};
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 2000; i++) {
+    std::string value;
+    for (int j = 0; j < 12; j++) {
+      value.append(kWords[rnd.Uniform(8)]);
+      value.append(ToString(rnd.Uniform(10)));
+    }
+    values.push_back(value);
+  }
+
+  auto compacted_data_size = [&](uint32_t max_dict_bytes) {
+    Options options = CurrentOptions();
+    options.compression = kZlibCompression;
+    options.compression_opts.max_dict_bytes = max_dict_bytes;
+    options.target_file_size_base = 32 << 10;
+    options.disable_auto_compactions = true;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 256;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    // Two overlapping L0 files, so that the compaction rewrites them.
+    for (int parity = 0; parity < 2; parity++) {
+      for (int i = parity; i < 2000; i += 2) {
+        EXPECT_OK(Put(Key(i), values[i]));
+      }
+      EXPECT_OK(Flush());
+    }
+    EXPECT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    EXPECT_EQ(0, NumTableFilesAtLevel(0));
+    EXPECT_GT(NumTableFilesAtLevel(1), 2);
+
+    Reopen(options);
+    for (int i = 0; i < 2000; i++) {
+      EXPECT_EQ(values[i], Get(Key(i)));
+    }
+    TablePropertiesCollection props;
+    EXPECT_OK(db_->GetPropertiesOfAllTables(&props));
+    uint64_t data_size = 0;
+    for (const auto& p : props) {
+      data_size += p.second->data_size;
+    }
+    return data_size;
+  };
+
+  uint64_t size_without_dict = compacted_data_size(0);
+  uint64_t size_with_dict = compacted_data_size(4 << 10);
+  ASSERT_LT(size_with_dict, size_without_dict * 9 / 10);
+}
+
+TEST_F(DBCompactionTest, IntraL0Compaction) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_background_compactions = 2;
+  options.write_buffer_size = 10 << 20;
+  DestroyAndReopen(options);
+  env_->SetBackgroundThreads(2, Env::LOW);
+
+  // Hold the L0->L1 compaction so that L0 can only shrink by compacting its
+  // files among themselves. The compaction is picked with the DB mutex held,
+  // so it is held later, once it runs on its own.
+  std::thread::id l0_to_l1_thread;
+  std::atomic<bool> l0_to_l1_started(false);
+  std::atomic<bool> release_l0_to_l1(false);
+  std::atomic<int> intra_l0_compactions(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:NonTrivial", [&](void* arg) {
+        if (*static_cast<int*>(arg) > 0) {
+          l0_to_l1_thread = std::this_thread::get_id();
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Start", [&](void* arg) {
+        if (std::this_thread::get_id() == l0_to_l1_thread &&
+            !release_l0_to_l1) {
+          l0_to_l1_started = true;
+          while (!release_l0_to_l1) {
+            env_->SleepForMicroseconds(1000);
+          }
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "LevelCompactionPicker::PickCompaction:Return", [&](void* arg) {
+        Compaction* c = static_cast<Compaction*>(arg);
+        if (c->start_level() == 0 && c->output_level() == 0) {
+          ASSERT_EQ(port::kMaxUint64, c->max_output_file_size());
+          intra_l0_compactions++;
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  auto write_file = [&](int file) {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(file)));
+    }
+    ASSERT_OK(Put("file" + ToString(file), "x"));
+    ASSERT_OK(Flush());
+  };
+  write_file(0);
+  write_file(1);
+  while (!l0_to_l1_started) {
+    env_->SleepForMicroseconds(1000);
+  }
+  for (int file = 2; file < 7; file++) {
+    write_file(file);
+  }
+  // Of the five files flushed while L0->L1 is held, at least four are merged
+  // into one.
+  for (int i = 0; i < 10000 && NumTableFilesAtLevel(0) > 4; i++) {
+    env_->SleepForMicroseconds(1000);
+  }
+  int l0_files_while_held = NumTableFilesAtLevel(0);
+  release_l0_to_l1 = true;
+  dbfull()->TEST_WaitForCompact();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_LE(l0_files_while_held, 4);
+  ASSERT_GE(intra_l0_compactions, 1);
+  // Reopening checks the sequence number order of the L0 files.
+  Reopen(options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_EQ("v6", Get(Key(i)));
+  }
+  for (int file = 0; file < 7; file++) {
+    ASSERT_EQ("x", Get("file" + ToString(file)));
+  }
+}
+
+TEST_F(DBCompactionTest, IntraL0CompactionKeepsDeletions) {
+  Options options = CurrentOptions();
+  options.compression = kNoCompression;
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_background_compactions = 2;
+  options.write_buffer_size = 10 << 20;
+  DestroyAndReopen(options);
+  env_->SetBackgroundThreads(2, Env::LOW);
+
+  // Hold the L0->L1 compaction of the two oldest files, so that the
+  // intra-L0 compaction of the newer files leaves them out.
+  std::thread::id l0_to_l1_thread;
+  std::atomic<bool> l0_to_l1_started(false);
+  std::atomic<bool> release_l0_to_l1(false);
+  std::atomic<int> intra_l0_compactions(0);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:NonTrivial", [&](void* arg) {
+        if (*static_cast<int*>(arg) > 0) {
+          l0_to_l1_thread = std::this_thread::get_id();
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::Run():Start", [&](void* arg) {
+        if (std::this_thread::get_id() == l0_to_l1_thread &&
+            !release_l0_to_l1) {
+          l0_to_l1_started = true;
+          while (!release_l0_to_l1) {
+            env_->SleepForMicroseconds(1000);
+          }
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "LevelCompactionPicker::PickCompaction:Return", [&](void* arg) {
+        Compaction* c = static_cast<Compaction*>(arg);
+        if (c->start_level() == 0 && c->output_level() == 0) {
+          intra_l0_compactions++;
+        }
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  auto write_file = [&](int file) {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_OK(Put(Key(i), "v" + ToString(file)));
+    }
+    if (file == 1) {
+      ASSERT_OK(Put("deleted", "x"));
+      ASSERT_OK(Put("single_deleted", "x"));
+    } else if (file == 3) {
+      ASSERT_OK(Delete("deleted"));
+      ASSERT_OK(SingleDelete("single_deleted"));
+    }
+    ASSERT_OK(Flush());
+  };
+  write_file(0);
+  write_file(1);
+  while (!l0_to_l1_started) {
+    env_->SleepForMicroseconds(1000);
+  }
+  for (int file = 2; file < 7; file++) {
+    write_file(file);
+  }
+  for (int i = 0; i < 10000 && intra_l0_compactions == 0; i++) {
+    env_->SleepForMicroseconds(1000);
+  }
+  ASSERT_GE(intra_l0_compactions, 1);
+  release_l0_to_l1 = true;
+  dbfull()->TEST_WaitForCompact();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // The deletions have to outlive the intra-L0 compaction, since the puts
+  // they hide were still in the older L0 files.
+  ASSERT_EQ("NOT_FOUND", Get("deleted"));
+  ASSERT_EQ("NOT_FOUND", Get("single_deleted"));
+  ASSERT_OK(dbfull()->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_EQ("NOT_FOUND", Get("deleted"));
+  ASSERT_EQ("NOT_FOUND", Get("single_deleted"));
+}
+
 INSTANTIATE_TEST_CASE_P(DBCompactionTestWithParam, DBCompactionTestWithParam,
                         ::testing::Values(1, 4));
 #endif  // !(defined NDEBUG) || !defined(OS_WIN)
@@ -43,6 +43,7 @@
 #include "db/memtable_list.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
+#include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/table_properties_collector.h"
 #include "db/transaction_log_impl.h"
@@ -65,6 +66,7 @@
 #include "rocksdb/version.h"
 #include "table/block.h"
 #include "table/block_based_table_factory.h"
+#include "table/iterator_wrapper.h"
 #include "table/merger.h"
 #include "table/table_builder.h"
 #include "table/two_level_iterator.h"
@@ -318,6 +320,11 @@ DBImpl::~DBImpl() {
   // marker. After this we do a variant of the waiting and unschedule work
   // (to consider: moving all the waiting into CancelAllBackgroundWork(true))
   CancelAllBackgroundWork(false);
+  // The warm-up threads stop at the next file, and release their versions
+  // under the mutex
+  for (auto& t : table_warm_up_threads_) {
+    t.join();
+  }
   int compactions_unscheduled = env_->UnSchedule(this, Env::Priority::LOW);
   int flushes_unscheduled = env_->UnSchedule(this, Env::Priority::HIGH);
   mutex_.Lock();
@@ -1295,7 +1302,8 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
   mutex_.AssertHeld();
   const uint64_t start_micros = env_->NowMicros();
   FileMetaData meta;
-  meta.fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+  meta.fd =
+      FileDescriptor(versions_->NewFileNumber(), cfd->GetFlushPathId(), 0);
   auto pending_outputs_inserted_elem =
       CaptureCurrentFileNumberInPendingOutputs();
   ReadOptions ro;
@@ -1317,7 +1325,9 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
       TableFileCreationInfo info;
       s = BuildTable(
           dbname_, env_, *cfd->ioptions(), env_options_, cfd->table_cache(),
-          iter.get(), &meta, cfd->internal_comparator(),
+          iter.get(), std::unique_ptr<InternalIterator>(
+                          mem->NewRangeTombstoneIterator(ro)),
+          &meta, cfd->internal_comparator(),
           cfd->int_tbl_prop_collector_factories(), cfd->GetID(),
           snapshots_.GetAll(), GetCompressionFlush(*cfd->ioptions()),
           cfd->ioptions()->compression_opts, paranoid_file_checks,
@@ -1353,7 +1363,8 @@ Status DBImpl::WriteLevel0TableForRecovery(int job_id, ColumnFamilyData* cfd,
     edit->AddFile(level, meta.fd.GetNumber(), meta.fd.GetPathId(),
                   meta.fd.GetFileSize(), meta.smallest, meta.largest,
                   meta.smallest_seqno, meta.largest_seqno,
-                  meta.marked_for_compaction, meta.priv_meta);
+                  meta.marked_for_compaction, meta.priv_meta,
+                  meta.has_range_deletions, meta.newest_entry_time);
   }
 
   InternalStats::CompactionStats stats(1);
@@ -1377,7 +1388,8 @@ Status DBImpl::FlushMemTableToOutputFile(
   FlushJob flush_job(dbname_, cfd, db_options_, mutable_cf_options,
                      env_options_, versions_.get(), &mutex_, &shutting_down_,
                      snapshots_.GetAll(), job_context, log_buffer,
-                     directories_.GetDbDir(), directories_.GetDataDir(0U),
+                     directories_.GetDbDir(),
+                     directories_.GetDataDir(cfd->GetFlushPathId()),
                      GetCompressionFlush(*cfd->ioptions()), stats_,
                      &event_logger_);
 
@@ -1443,10 +1455,9 @@ void DBImpl::NotifyOnFlushCompleted(ColumnFamilyData* cfd,
   {
     FlushJobInfo info;
     info.cf_name = cfd->GetName();
-    // TODO(yhchiang): make db_paths dynamic in case flush does not
-    //                 go to L0 in the future.
-    info.file_path = MakeTableFileName(db_options_.db_paths[0].path,
-                                       file_meta->fd.GetNumber());
+    info.file_path = TableFileName(db_options_.db_paths,
+                                   file_meta->fd.GetNumber(),
+                                   file_meta->fd.GetPathId());
     info.thread_id = env_->GetThreadID();
     info.job_id = job_id;
     info.triggered_writes_slowdown = triggered_writes_slowdown;
@@ -1950,7 +1961,8 @@ Status DBImpl::ReFitLevel(ColumnFamilyData* cfd, int level, int target_level) {
       edit.AddFile(to_level, f->fd.GetNumber(), f->fd.GetPathId(),
                    f->fd.GetFileSize(), f->smallest, f->largest,
                    f->smallest_seqno, f->largest_seqno,
-                   f->marked_for_compaction, f->priv_meta);
+                   f->marked_for_compaction, f->priv_meta,
+                   f->has_range_deletions, f->newest_entry_time);
     }
     Log(InfoLogLevel::DEBUG_LEVEL, db_options_.info_log,
         "[%s] Apply version edit:\n%s", cfd->GetName().c_str(),
@@ -2398,6 +2410,108 @@ Status DBImpl::BackgroundFlush(bool* made_progress, JobContext* job_context,
   return status;
 }
 
+struct DBImpl::TableWarmUp {
+  struct File {
+    ColumnFamilyData* cfd;
+    FileDescriptor fd;
+    int level;
+  };
+
+  // Ordered by level
+  std::vector<File> files;
+  // Keep the files from being deleted until all of them are open
+  std::vector<Version*> versions;
+  std::atomic<size_t> next_file;
+  std::atomic<uint64_t> files_left;
+  std::atomic<int> threads_left;
+};
+
+void DBImpl::StartTableWarmUp() {
+  mutex_.AssertHeld();
+  assert(table_warm_up_ == nullptr);
+  table_warm_up_.reset(new TableWarmUp());
+  TableWarmUp* warm_up = table_warm_up_.get();
+  int max_levels = 0;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    cfd->Ref();
+    Version* v = cfd->current();
+    v->Ref();
+    warm_up->versions.push_back(v);
+    max_levels = std::max(max_levels, v->storage_info()->num_levels());
+  }
+  for (int level = 0; level < max_levels; level++) {
+    for (Version* v : warm_up->versions) {
+      if (level >= v->storage_info()->num_levels()) {
+        continue;
+      }
+      for (FileMetaData* f : v->storage_info()->LevelFiles(level)) {
+        warm_up->files.push_back({v->cfd(), f->fd, level});
+      }
+    }
+  }
+  warm_up->next_file.store(0);
+  warm_up->files_left.store(warm_up->files.size());
+
+  const int num_threads = std::max(db_options_.max_file_opening_threads, 1);
+  warm_up->threads_left.store(num_threads);
+  Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
+      "Opening %" ROCKSDB_PRIszt " table files in the background with %d "
+      "threads",
+      warm_up->files.size(), num_threads);
+  for (int i = 0; i < num_threads; i++) {
+    table_warm_up_threads_.emplace_back(&DBImpl::WarmUpTableReaders, this);
+  }
+}
+
+void DBImpl::WarmUpTableReaders() {
+  TEST_SYNC_POINT("DBImpl::WarmUpTableReaders:Start");
+  TableWarmUp* warm_up = table_warm_up_.get();
+  while (!shutting_down_.load(std::memory_order_acquire)) {
+    size_t i = warm_up->next_file.fetch_add(1);
+    if (i >= warm_up->files.size()) {
+      break;
+    }
+    const TableWarmUp::File& file = warm_up->files[i];
+    // The table cache keeps the table reader after the handle is released,
+    // as its capacity is unlimited with max_open_files == -1
+    Cache::Handle* handle = nullptr;
+    Status s = file.cfd->table_cache()->FindTable(
+        env_options_, file.cfd->internal_comparator(), file.fd, &handle,
+        false /* no_io */, true /* record_read_stats */,
+        file.cfd->internal_stats()->GetFileReadHist(file.level));
+    if (s.ok()) {
+      file.cfd->table_cache()->ReleaseHandle(handle);
+    } else {
+      Log(InfoLogLevel::WARN_LEVEL, db_options_.info_log,
+          "Could not open table file #%" PRIu64 ": %s",
+          file.fd.GetNumber(), s.ToString().c_str());
+    }
+    warm_up->files_left.fetch_sub(1);
+  }
+
+  if (warm_up->threads_left.fetch_sub(1) == 1) {
+    InstrumentedMutexLock l(&mutex_);
+    for (Version* v : warm_up->versions) {
+      ColumnFamilyData* cfd = v->cfd();
+      v->Unref();
+      if (cfd->Unref()) {
+        delete cfd;
+      }
+    }
+    warm_up->versions.clear();
+  }
+}
+
+uint64_t DBImpl::NumTableReadersToWarmUp() const {
+  if (table_warm_up_ == nullptr) {
+    return 0;
+  }
+  return table_warm_up_->files_left.load();
+}
+
 void DBImpl::BackgroundCallFlush() {
   bool made_progress = false;
   JobContext job_context(next_job_id_.fetch_add(1), true);
@@ -2664,9 +2778,10 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     // TODO(icanadi) Do we want to honor snapshots here? i.e. not delete old
     // file if there is alive snapshot pointing to it
     assert(c->num_input_files(1) == 0);
-    assert(c->level() == 0);
-    assert(c->column_family_data()->ioptions()->compaction_style ==
-           kCompactionStyleFIFO);
+    assert((c->level() == 0 &&
+            c->column_family_data()->ioptions()->compaction_style ==
+                kCompactionStyleFIFO) ||
+           c->column_family_data()->ioptions()->expired_files_ttl > 0);
 
     compaction_job_stats.num_input_files = c->num_input_files(0);
 
@@ -2704,7 +2819,8 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         c->edit()->AddFile(c->output_level(), f->fd.GetNumber(),
                            f->fd.GetPathId(), f->fd.GetFileSize(), f->smallest,
                            f->largest, f->smallest_seqno, f->largest_seqno,
-                           f->marked_for_compaction, f->priv_meta);
+                           f->marked_for_compaction, f->priv_meta,
+                           f->has_range_deletions, f->newest_entry_time);
 
         LogToBuffer(log_buffer,
                     "[%s] Moving #%" PRIu64 " to level-%d %" PRIu64 " bytes\n",
@@ -2864,10 +2980,10 @@ static void CleanupIteratorState(void* arg1, void* arg2) {
 }
 }  // namespace
 
-InternalIterator* DBImpl::NewInternalIterator(const ReadOptions& read_options,
-                                              ColumnFamilyData* cfd,
-                                              SuperVersion* super_version,
-                                              Arena* arena) {
+InternalIterator* DBImpl::NewInternalIterator(
+    const ReadOptions& read_options, ColumnFamilyData* cfd,
+    SuperVersion* super_version, Arena* arena,
+    RangeDelAggregator* range_del_agg) {
   InternalIterator* internal_iter;
   assert(arena != nullptr);
   // Need to create internal iterator from the arena.
@@ -2875,11 +2991,19 @@ InternalIterator* DBImpl::NewInternalIterator(const ReadOptions& read_options,
   // Collect iterator for mutable mem
   merge_iter_builder.AddIterator(
       super_version->mem->NewIterator(read_options, arena));
+  if (range_del_agg != nullptr) {
+    Status s = range_del_agg->AddTombstones(std::unique_ptr<InternalIterator>(
+        super_version->mem->NewRangeTombstoneIterator(read_options)));
+    if (!s.ok()) {
+      merge_iter_builder.AddIterator(NewErrorInternalIterator(s, arena));
+    }
+  }
   // Collect all needed child iterators for immutable memtables
-  super_version->imm->AddIterators(read_options, &merge_iter_builder);
+  super_version->imm->AddIterators(read_options, &merge_iter_builder,
+                                   range_del_agg);
   // Collect iterators for files in L0 - Ln
   super_version->current->AddIterators(read_options, env_options_,
-                                       &merge_iter_builder);
+                                       &merge_iter_builder, range_del_agg);
   internal_iter = merge_iter_builder.Finish();
   IterState* cleanup = new IterState(this, &mutex_, super_version);
   internal_iter->RegisterCleanup(CleanupIteratorState, cleanup, nullptr);
@@ -3566,10 +3690,11 @@ Iterator* DBImpl::NewIterator(const ReadOptions& read_options,
     ArenaWrappedDBIter* db_iter = NewArenaWrappedDbIterator(
         env_, *cfd->ioptions(), cfd->user_comparator(),
         snapshot, sv->mutable_cf_options.max_sequential_skip_in_iterations,
-        read_options.iterate_upper_bound);
+        read_options.iterate_upper_bound, read_options.pin_data);
 
     InternalIterator* internal_iter =
-        NewInternalIterator(read_options, cfd, sv, db_iter->GetArena());
+        NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
+                            db_iter->GetRangeDelAggregator());
     db_iter->SetIterUnderDBIter(internal_iter);
 
     return db_iter;
@@ -3634,9 +3759,11 @@ Status DBImpl::NewIterators(
 
       ArenaWrappedDBIter* db_iter = NewArenaWrappedDbIterator(
           env_, *cfd->ioptions(), cfd->user_comparator(), snapshot,
-          sv->mutable_cf_options.max_sequential_skip_in_iterations);
+          sv->mutable_cf_options.max_sequential_skip_in_iterations,
+          read_options.iterate_upper_bound, read_options.pin_data);
       InternalIterator* internal_iter =
-          NewInternalIterator(read_options, cfd, sv, db_iter->GetArena());
+          NewInternalIterator(read_options, cfd, sv, db_iter->GetArena(),
+                              db_iter->GetRangeDelAggregator());
       db_iter->SetIterUnderDBIter(internal_iter);
       iterators->push_back(db_iter);
     }
@@ -3695,6 +3822,12 @@ Status DBImpl::SingleDelete(const WriteOptions& write_options,
   return DB::SingleDelete(write_options, column_family, key);
 }
 
+Status DBImpl::DeleteRange(const WriteOptions& write_options,
+                           ColumnFamilyHandle* column_family,
+                           const Slice& begin_key, const Slice& end_key) {
+  return DB::DeleteRange(write_options, column_family, begin_key, end_key);
+}
+
 Status DBImpl::Write(const WriteOptions& write_options, WriteBatch* my_batch) {
   return WriteImpl(write_options, my_batch, nullptr);
 }
@@ -4611,6 +4744,14 @@ Status DB::SingleDelete(const WriteOptions& opt,
   return Write(opt, &batch);
 }
 
+Status DB::DeleteRange(const WriteOptions& opt,
+                       ColumnFamilyHandle* column_family,
+                       const Slice& begin_key, const Slice& end_key) {
+  WriteBatch batch;
+  batch.DeleteRange(column_family, begin_key, end_key);
+  return Write(opt, &batch);
+}
+
 Status DB::Merge(const WriteOptions& opt, ColumnFamilyHandle* column_family,
                  const Slice& key, const Slice& value) {
   WriteBatch batch;
@@ -4796,6 +4937,10 @@ Status DB::Open(const DBOptions& db_options, const std::string& dbname,
   if (s.ok()) {
     impl->opened_successfully_ = true;
     impl->MaybeScheduleFlushOrCompaction();
+    if (impl->db_options_.max_open_files == -1 &&
+        impl->db_options_.open_files_lazily) {
+      impl->StartTableWarmUp();
+    }
   }
   impl->mutex_.Unlock();
 
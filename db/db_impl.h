@@ -14,6 +14,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -52,6 +53,7 @@ class Version;
 class VersionEdit;
 class VersionSet;
 class Arena;
+class RangeDelAggregator;
 class WriteCallback;
 struct JobContext;
 struct ExternalSstFileInfo;
@@ -78,6 +80,11 @@ class DBImpl : public DB {
   virtual Status SingleDelete(const WriteOptions& options,
                               ColumnFamilyHandle* column_family,
                               const Slice& key) override;
+  using DB::DeleteRange;
+  virtual Status DeleteRange(const WriteOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& begin_key,
+                             const Slice& end_key) override;
   using DB::Write;
   virtual Status Write(const WriteOptions& options,
                        WriteBatch* updates) override;
@@ -325,6 +332,13 @@ class DBImpl : public DB {
 
   const SnapshotList& snapshots() const { return snapshots_; }
 
+  // REQUIRES: mutex locked
+  const WriteController& write_controller() const { return write_controller_; }
+
+  // Number of the files found by DB::Open() that still wait to be opened in
+  // the background, see DBOptions::open_files_lazily.
+  uint64_t NumTableReadersToWarmUp() const;
+
   void CancelAllBackgroundWork(bool wait);
 
   // Find Super version and reference it. Based on options, it might return
@@ -370,10 +384,11 @@ class DBImpl : public DB {
   const DBOptions db_options_;
   Statistics* stats_;
 
-  InternalIterator* NewInternalIterator(const ReadOptions&,
-                                        ColumnFamilyData* cfd,
-                                        SuperVersion* super_version,
-                                        Arena* arena);
+  // If "range_del_agg" is not nullptr, the range tombstones visible to the
+  // iterator are added to it.
+  InternalIterator* NewInternalIterator(
+      const ReadOptions&, ColumnFamilyData* cfd, SuperVersion* super_version,
+      Arena* arena, RangeDelAggregator* range_del_agg = nullptr);
 
   void NotifyOnFlushCompleted(ColumnFamilyData* cfd, FileMetaData* file_meta,
                               const MutableCFOptions& mutable_cf_options,
@@ -492,6 +507,11 @@ class DBImpl : public DB {
   void SchedulePendingCompaction(ColumnFamilyData* cfd);
   static void BGWorkCompaction(void* db);
   static void BGWorkFlush(void* db);
+  // Starts the threads that open the files of the current versions with
+  // DBOptions::open_files_lazily.
+  // REQUIRES: mutex locked
+  void StartTableWarmUp();
+  void WarmUpTableReaders();
   void BackgroundCallCompaction();
   void BackgroundCallFlush();
   Status BackgroundCompaction(bool* madeProgress, JobContext* job_context,
@@ -695,6 +715,12 @@ class DBImpl : public DB {
   // number of background memtable flush jobs, submitted to the HIGH pool
   int bg_flush_scheduled_;
 
+  // Files opened in the background by table_warm_up_threads_ after
+  // DB::Open() returned, see DBOptions::open_files_lazily
+  struct TableWarmUp;
+  std::unique_ptr<TableWarmUp> table_warm_up_;
+  std::vector<std::thread> table_warm_up_threads_;
+
   // Information for a manual compaction
   struct ManualCompaction {
     ColumnFamilyData* cfd;
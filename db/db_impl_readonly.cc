@@ -57,9 +57,11 @@ Iterator* DBImplReadOnly::NewIterator(const ReadOptions& read_options,
            ? reinterpret_cast<const SnapshotImpl*>(
                 read_options.snapshot)->number_
            : latest_snapshot),
-      super_version->mutable_cf_options.max_sequential_skip_in_iterations);
+      super_version->mutable_cf_options.max_sequential_skip_in_iterations,
+      read_options.iterate_upper_bound, read_options.pin_data);
   auto internal_iter = NewInternalIterator(
-      read_options, cfd, super_version, db_iter->GetArena());
+      read_options, cfd, super_version, db_iter->GetArena(),
+      db_iter->GetRangeDelAggregator());
   db_iter->SetIterUnderDBIter(internal_iter);
   return db_iter;
 }
@@ -84,9 +86,11 @@ Status DBImplReadOnly::NewIterators(
             ? reinterpret_cast<const SnapshotImpl*>(
                   read_options.snapshot)->number_
             : latest_snapshot),
-        sv->mutable_cf_options.max_sequential_skip_in_iterations);
+        sv->mutable_cf_options.max_sequential_skip_in_iterations,
+        read_options.iterate_upper_bound, read_options.pin_data);
     auto* internal_iter = NewInternalIterator(
-        read_options, cfd, sv, db_iter->GetArena());
+        read_options, cfd, sv, db_iter->GetArena(),
+        db_iter->GetRangeDelAggregator());
     db_iter->SetIterUnderDBIter(internal_iter);
     iterators->push_back(db_iter);
   }
@@ -59,6 +59,13 @@ class DBImplReadOnly : public DBImpl {
                               const Slice& key) override {
     return Status::NotSupported("Not supported operation in read only mode.");
   }
+  using DBImpl::DeleteRange;
+  virtual Status DeleteRange(const WriteOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& begin_key,
+                             const Slice& end_key) override {
+    return Status::NotSupported("Not supported operation in read only mode.");
+  }
   virtual Status Write(const WriteOptions& options,
                        WriteBatch* updates) override {
     return Status::NotSupported("Not supported operation in read only mode.");
@@ -15,16 +15,19 @@
 
 #include "db/filename.h"
 #include "db/dbformat.h"
+#include "db/range_del_aggregator.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/merge_operator.h"
 #include "table/internal_iterator.h"
+#include "table/pinned_iterators_manager.h"
 #include "util/arena.h"
 #include "util/logging.h"
 #include "util/mutexlock.h"
 #include "util/perf_context_imp.h"
+#include "util/string_util.h"
 
 namespace rocksdb {
 
@@ -62,7 +65,7 @@ class DBIter: public Iterator {
   DBIter(Env* env, const ImmutableCFOptions& ioptions, const Comparator* cmp,
          InternalIterator* iter, SequenceNumber s, bool arena_mode,
          uint64_t max_sequential_skip_in_iterations,
-         const Slice* iterate_upper_bound = nullptr)
+         const Slice* iterate_upper_bound = nullptr, bool pin_data = false)
       : arena_mode_(arena_mode),
         env_(env),
         logger_(ioptions.info_log),
@@ -73,14 +76,25 @@ class DBIter: public Iterator {
         direction_(kForward),
         valid_(false),
         current_entry_is_merged_(false),
+        is_value_pinned_(false),
         statistics_(ioptions.statistics),
-        iterate_upper_bound_(iterate_upper_bound) {
+        iterate_upper_bound_(iterate_upper_bound),
+        pin_thru_lifetime_(pin_data),
+        range_del_agg_(InternalKeyComparator(cmp), s) {
     RecordTick(statistics_, NO_ITERATORS);
     prefix_extractor_ = ioptions.prefix_extractor;
     max_skip_ = max_sequential_skip_in_iterations;
+    if (pin_thru_lifetime_) {
+      pinned_iters_mgr_.StartPinning();
+      if (iter_ != nullptr) {
+        iter_->SetPinnedItersMgr(&pinned_iters_mgr_);
+      }
+    }
   }
   virtual ~DBIter() {
     RecordTick(statistics_, NO_ITERATORS, -1);
+    // Release the pinned data blocks before the iterators they belong to
+    pinned_iters_mgr_.ReleasePinnedIterators();
     if (!arena_mode_) {
       delete iter_;
     } else {
@@ -90,6 +104,12 @@ class DBIter: public Iterator {
   virtual void SetIter(InternalIterator* iter) {
     assert(iter_ == nullptr);
     iter_ = iter;
+    if (pin_thru_lifetime_) {
+      iter_->SetPinnedItersMgr(&pinned_iters_mgr_);
+    }
+  }
+  virtual RangeDelAggregator* GetRangeDelAggregator() {
+    return &range_del_agg_;
   }
   virtual bool Valid() const override { return valid_; }
   virtual Slice key() const override {
@@ -98,8 +118,10 @@ class DBIter: public Iterator {
   }
   virtual Slice value() const override {
     assert(valid_);
-    return (direction_ == kForward && !current_entry_is_merged_) ?
-      iter_->value() : saved_value_;
+    if (direction_ == kForward && !current_entry_is_merged_) {
+      return iter_->value();
+    }
+    return is_value_pinned_ ? pinned_value_ : Slice(saved_value_);
   }
   virtual Status status() const override {
     if (status_.ok()) {
@@ -109,6 +131,26 @@ class DBIter: public Iterator {
     }
   }
 
+  virtual Status GetProperty(std::string prop_name,
+                             std::string* prop) override {
+    if (prop == nullptr) {
+      return Status::InvalidArgument("prop is nullptr");
+    }
+    if (prop_name == "rocksdb.iterator.is-key-pinned") {
+      if (valid_) {
+        *prop = (pin_thru_lifetime_ && saved_key_.IsKeyPinned()) ? "1" : "0";
+      } else {
+        *prop = "Iterator is not valid.";
+      }
+      return Status::OK();
+    }
+    if (prop_name == "rocksdb.iterator.pinned-memory-usage") {
+      *prop = ToString(pinned_iters_mgr_.PinnedMemoryUsage());
+      return Status::OK();
+    }
+    return Iterator::GetProperty(prop_name, prop);
+  }
+
   virtual void Next() override;
   virtual void Prev() override;
   virtual void Seek(const Slice& target) override;
@@ -128,6 +170,18 @@ class DBIter: public Iterator {
   bool ParseKey(ParsedInternalKey* key);
   void MergeValuesNewToOld();
 
+  // Keep the value of the current entry of iter_, referencing it in place
+  // when its block is pinned.
+  inline void SaveValue() {
+    if (pin_thru_lifetime_ && iter_->IsValuePinned()) {
+      pinned_value_ = iter_->value();
+      is_value_pinned_ = true;
+    } else {
+      saved_value_ = iter_->value().ToString();
+      is_value_pinned_ = false;
+    }
+  }
+
   inline void ClearSavedValue() {
     if (saved_value_.capacity() > 1048576) {
       std::string empty;
@@ -149,12 +203,21 @@ class DBIter: public Iterator {
   Status status_;
   IterKey saved_key_;
   std::string saved_value_;
+  // Value of the current entry when moving backwards, if it points into a
+  // pinned block instead of having been copied into saved_value_
+  Slice pinned_value_;
   Direction direction_;
   bool valid_;
   bool current_entry_is_merged_;
+  bool is_value_pinned_;
   Statistics* statistics_;
   uint64_t max_skip_;
   const Slice* iterate_upper_bound_;
+  // Keep the data blocks of the keys and values returned alive until the
+  // iterator is deleted, so they do not have to be copied
+  const bool pin_thru_lifetime_;
+  PinnedIteratorsManager pinned_iters_mgr_;
+  RangeDelAggregator range_del_agg_;
 
   // No copying allowed
   DBIter(const DBIter&);
@@ -169,6 +232,10 @@ inline bool DBIter::ParseKey(ParsedInternalKey* ikey) {
         iter_->key().ToString(true).c_str());
     return false;
   } else {
+    if (range_del_agg_.ShouldDelete(*ikey)) {
+      // Covered by a range tombstone: treat it as a point deletion.
+      ikey->type = kTypeDeletion;
+    }
     return true;
   }
 }
@@ -239,14 +306,16 @@ void DBIter::FindNextUserEntryInternal(bool skipping) {
             case kTypeSingleDeletion:
               // Arrange to skip all upcoming entries for this key since
               // they are hidden by this deletion.
-              saved_key_.SetKey(ikey.user_key);
+              saved_key_.SetKey(ikey.user_key,
+                                !iter_->IsKeyPinned() || !pin_thru_lifetime_);
               skipping = true;
               num_skipped = 0;
               PERF_COUNTER_ADD(internal_delete_skipped_count, 1);
               break;
             case kTypeValue:
               valid_ = true;
-              saved_key_.SetKey(ikey.user_key);
+              saved_key_.SetKey(ikey.user_key,
+                                !iter_->IsKeyPinned() || !pin_thru_lifetime_);
               return;
             case kTypeMerge:
               // By now, we are sure the current ikey is going to yield a value
@@ -405,7 +474,8 @@ void DBIter::PrevInternal() {
   ParsedInternalKey ikey;
 
   while (iter_->Valid()) {
-    saved_key_.SetKey(ExtractUserKey(iter_->key()));
+    saved_key_.SetKey(ExtractUserKey(iter_->key()),
+                      !iter_->IsKeyPinned() || !pin_thru_lifetime_);
     if (FindValueForCurrentKey()) {
       valid_ = true;
       if (!iter_->Valid()) {
@@ -441,6 +511,7 @@ bool DBIter::FindValueForCurrentKey() {
   // kTypeValue)
   ValueType last_not_merge_type = kTypeDeletion;
   ValueType last_key_entry_type = kTypeDeletion;
+  is_value_pinned_ = false;
 
   ParsedInternalKey ikey;
   FindParseableKey(&ikey, kReverse);
@@ -457,7 +528,7 @@ bool DBIter::FindValueForCurrentKey() {
     switch (last_key_entry_type) {
       case kTypeValue:
         operands.clear();
-        saved_value_ = iter_->value().ToString();
+        SaveValue();
         last_not_merge_type = kTypeValue;
         break;
       case kTypeDeletion:
@@ -488,6 +559,7 @@ bool DBIter::FindValueForCurrentKey() {
       return false;
     case kTypeMerge:
       if (last_not_merge_type == kTypeDeletion) {
+        is_value_pinned_ = false;
         StopWatchNano timer(env_, statistics_ != nullptr);
         PERF_TIMER_GUARD(merge_operator_time_nanos);
         user_merge_operator_->FullMerge(saved_key_.GetKey(), nullptr, operands,
@@ -496,8 +568,13 @@ bool DBIter::FindValueForCurrentKey() {
                    timer.ElapsedNanos());
       } else {
         assert(last_not_merge_type == kTypeValue);
-        std::string last_put_value = saved_value_;
-        Slice temp_slice(last_put_value);
+        std::string last_put_value;
+        Slice temp_slice = pinned_value_;
+        if (!is_value_pinned_) {
+          last_put_value = saved_value_;
+          temp_slice = last_put_value;
+        }
+        is_value_pinned_ = false;
         {
           StopWatchNano timer(env_, statistics_ != nullptr);
           PERF_TIMER_GUARD(merge_operator_time_nanos);
@@ -509,7 +586,7 @@ bool DBIter::FindValueForCurrentKey() {
       }
       break;
     case kTypeValue:
-      // do nothing - we've already has value in saved_value_
+      // do nothing - we've already has value in saved_value_ or pinned_value_
       break;
     default:
       assert(false);
@@ -527,6 +604,7 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
                                                  kValueTypeForSeek));
   iter_->Seek(last_key);
   RecordTick(statistics_, NUMBER_OF_RESEEKS_IN_ITERATION);
+  is_value_pinned_ = false;
 
   // assume there is at least one parseable key for this user key
   ParsedInternalKey ikey;
@@ -535,7 +613,7 @@ bool DBIter::FindValueForCurrentKeyUsingSeek() {
   if (ikey.type == kTypeValue || ikey.type == kTypeDeletion ||
       ikey.type == kTypeSingleDeletion) {
     if (ikey.type == kTypeValue) {
-      saved_value_ = iter_->value().ToString();
+      SaveValue();
       valid_ = true;
       return true;
     }
@@ -748,10 +826,10 @@ Iterator* NewDBIterator(Env* env, const ImmutableCFOptions& ioptions,
                         InternalIterator* internal_iter,
                         const SequenceNumber& sequence,
                         uint64_t max_sequential_skip_in_iterations,
-                        const Slice* iterate_upper_bound) {
+                        const Slice* iterate_upper_bound, bool pin_data) {
   return new DBIter(env, ioptions, user_key_comparator, internal_iter, sequence,
                     false, max_sequential_skip_in_iterations,
-                    iterate_upper_bound);
+                    iterate_upper_bound, pin_data);
 }
 
 ArenaWrappedDBIter::~ArenaWrappedDBIter() { db_iter_->~DBIter(); }
@@ -762,6 +840,10 @@ void ArenaWrappedDBIter::SetIterUnderDBIter(InternalIterator* iter) {
   static_cast<DBIter*>(db_iter_)->SetIter(iter);
 }
 
+RangeDelAggregator* ArenaWrappedDBIter::GetRangeDelAggregator() {
+  return db_iter_->GetRangeDelAggregator();
+}
+
 inline bool ArenaWrappedDBIter::Valid() const { return db_iter_->Valid(); }
 inline void ArenaWrappedDBIter::SeekToFirst() { db_iter_->SeekToFirst(); }
 inline void ArenaWrappedDBIter::SeekToLast() { db_iter_->SeekToLast(); }
@@ -773,6 +855,10 @@ inline void ArenaWrappedDBIter::Prev() { db_iter_->Prev(); }
 inline Slice ArenaWrappedDBIter::key() const { return db_iter_->key(); }
 inline Slice ArenaWrappedDBIter::value() const { return db_iter_->value(); }
 inline Status ArenaWrappedDBIter::status() const { return db_iter_->status(); }
+Status ArenaWrappedDBIter::GetProperty(std::string prop_name,
+                                       std::string* prop) {
+  return db_iter_->GetProperty(prop_name, prop);
+}
 void ArenaWrappedDBIter::RegisterCleanup(CleanupFunction function, void* arg1,
                                          void* arg2) {
   db_iter_->RegisterCleanup(function, arg1, arg2);
@@ -783,13 +869,13 @@ ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     const Comparator* user_key_comparator,
     const SequenceNumber& sequence,
     uint64_t max_sequential_skip_in_iterations,
-    const Slice* iterate_upper_bound) {
+    const Slice* iterate_upper_bound, bool pin_data) {
   ArenaWrappedDBIter* iter = new ArenaWrappedDBIter();
   Arena* arena = iter->GetArena();
   auto mem = arena->AllocateAligned(sizeof(DBIter));
   DBIter* db_iter = new (mem) DBIter(env, ioptions, user_key_comparator,
       nullptr, sequence, true, max_sequential_skip_in_iterations,
-      iterate_upper_bound);
+      iterate_upper_bound, pin_data);
 
   iter->SetDBIter(db_iter);
 
@@ -20,16 +20,19 @@ namespace rocksdb {
 class Arena;
 class DBIter;
 class InternalIterator;
+class RangeDelAggregator;
 
 // Return a new iterator that converts internal keys (yielded by
 // "*internal_iter") that were live at the specified "sequence" number
-// into appropriate user keys.
+// into appropriate user keys. If "pin_data" is true, the data blocks the
+// returned keys and values point to are kept until the iterator is deleted.
 extern Iterator* NewDBIterator(Env* env, const ImmutableCFOptions& options,
                                const Comparator* user_key_comparator,
                                InternalIterator* internal_iter,
                                const SequenceNumber& sequence,
                                uint64_t max_sequential_skip_in_iterations,
-                               const Slice* iterate_upper_bound = nullptr);
+                               const Slice* iterate_upper_bound = nullptr,
+                               bool pin_data = false);
 
 // A wrapper iterator which wraps DB Iterator and the arena, with which the DB
 // iterator is supposed be allocated. This class is used as an entry point of
@@ -51,6 +54,10 @@ class ArenaWrappedDBIter : public Iterator {
   // Set the internal iterator wrapped inside the DB Iterator. Usually it is
   // a merging iterator.
   virtual void SetIterUnderDBIter(InternalIterator* iter);
+
+  // The aggregator the range tombstones visible to the DB Iterator have to be
+  // added to.
+  virtual RangeDelAggregator* GetRangeDelAggregator();
   virtual bool Valid() const override;
   virtual void SeekToFirst() override;
   virtual void SeekToLast() override;
@@ -60,6 +67,8 @@ class ArenaWrappedDBIter : public Iterator {
   virtual Slice key() const override;
   virtual Slice value() const override;
   virtual Status status() const override;
+  virtual Status GetProperty(std::string prop_name,
+                             std::string* prop) override;
 
   void RegisterCleanup(CleanupFunction function, void* arg1, void* arg2);
 
@@ -73,6 +82,6 @@ extern ArenaWrappedDBIter* NewArenaWrappedDbIterator(
     Env* env, const ImmutableCFOptions& options,
     const Comparator* user_key_comparator,
     const SequenceNumber& sequence, uint64_t max_sequential_skip_in_iterations,
-    const Slice* iterate_upper_bound = nullptr);
+    const Slice* iterate_upper_bound = nullptr, bool pin_data = false);
 
 }  // namespace rocksdb
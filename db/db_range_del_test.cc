@@ -0,0 +1,321 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/db_test_util.h"
+#include "port/stack_trace.h"
+#include "rocksdb/table.h"
+#include "util/sync_point.h"
+#include "utilities/merge_operators.h"
+
+namespace rocksdb {
+
+class DBRangeDelTest : public DBTestBase {
+ public:
+  DBRangeDelTest() : DBTestBase("/db_range_del_test") {}
+
+  std::string Key(int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  }
+
+  // Returns the keys visible through an iterator, in order.
+  std::vector<std::string> VisibleKeys(const Snapshot* snapshot = nullptr) {
+    ReadOptions read_options;
+    read_options.snapshot = snapshot;
+    std::vector<std::string> keys;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      keys.push_back(iter->key().ToString());
+    }
+    EXPECT_OK(iter->status());
+    return keys;
+  }
+};
+
+TEST_F(DBRangeDelTest, WriteBatchRoundTrip) {
+  class Handler : public WriteBatch::Handler {
+   public:
+    std::string seen;
+    virtual Status PutCF(uint32_t column_family_id, const Slice& key,
+                         const Slice& value) override {
+      seen += "Put(" + key.ToString() + ")";
+      return Status::OK();
+    }
+    virtual Status DeleteRangeCF(uint32_t column_family_id,
+                                 const Slice& begin_key,
+                                 const Slice& end_key) override {
+      seen += "DeleteRange(" + begin_key.ToString() + ", " +
+              end_key.ToString() + ")";
+      return Status::OK();
+    }
+  };
+
+  WriteBatch batch;
+  batch.Put("a", "va");
+  batch.DeleteRange("b", "d");
+  ASSERT_EQ(2, batch.Count());
+  Handler handler;
+  ASSERT_OK(batch.Iterate(&handler));
+  ASSERT_EQ("Put(a)DeleteRange(b, d)", handler.seen);
+
+  // A handler that does not know about range deletions skips them, like the
+  // other record types.
+  WriteBatch::Handler default_handler;
+  ASSERT_OK(batch.Iterate(&default_handler));
+}
+
+TEST_F(DBRangeDelTest, NotSupported) {
+  Options options = CurrentOptions();
+  options.inplace_update_support = true;
+  DestroyAndReopen(options);
+  ASSERT_TRUE(db_->DeleteRange(WriteOptions(), "a", "b").IsNotSupported());
+
+  options = CurrentOptions();
+  options.table_factory.reset(NewPlainTableFactory());
+  options.prefix_extractor.reset(NewNoopTransform());
+  options.allow_mmap_reads = true;
+  DestroyAndReopen(options);
+  ASSERT_TRUE(db_->DeleteRange(WriteOptions(), "a", "b").IsNotSupported());
+
+  // A batch written with DB::Write() is rejected as well.
+  DestroyAndReopen(options);
+  WriteBatch batch;
+  batch.DeleteRange("a", "b");
+  ASSERT_TRUE(db_->Write(WriteOptions(), &batch).IsNotSupported());
+}
+
+TEST_F(DBRangeDelTest, GetFromMemtableAndFiles) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(3), Key(6)));
+  // Newer writes are not affected by the tombstone.
+  ASSERT_OK(Put(Key(4), "new"));
+
+  auto verify = [&]() {
+    ASSERT_EQ("v2", Get(Key(2)));
+    ASSERT_EQ("NOT_FOUND", Get(Key(3)));
+    ASSERT_EQ("new", Get(Key(4)));
+    ASSERT_EQ("NOT_FOUND", Get(Key(5)));
+  };
+  verify();
+  ASSERT_EQ("v6", Get(Key(6)));
+
+  // The tombstone and the keys it covers live in the same file.
+  ASSERT_OK(Flush());
+  verify();
+
+  // The tombstone lives in a newer file than the keys it covers.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(6), Key(8)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(6)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("NOT_FOUND", Get(Key(6)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(7)));
+  ASSERT_EQ("v8", Get(Key(8)));
+
+  // Recovering from the WAL restores the tombstones.
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(0), Key(1)));
+  Reopen(options);
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+  ASSERT_EQ("v1", Get(Key(1)));
+  verify();
+}
+
+TEST_F(DBRangeDelTest, GetFromFileWithOverlappingTombstones) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+  }
+  const Snapshot* before_deletes = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(2), Key(10)));
+  ASSERT_OK(Put(Key(5), "new"));
+  const Snapshot* after_first_delete = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(4), Key(15)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+  for (int i = 0; i < 20; i++) {
+    std::string expected = "v" + ToString(i);
+    ASSERT_EQ(expected, Get(Key(i), before_deletes));
+    ASSERT_EQ(i >= 2 && i < 10 ? (i == 5 ? "new" : "NOT_FOUND") : expected,
+              Get(Key(i), after_first_delete));
+    ASSERT_EQ(i >= 2 && i < 15 ? "NOT_FOUND" : expected, Get(Key(i)));
+  }
+  db_->ReleaseSnapshot(before_deletes);
+  db_->ReleaseSnapshot(after_first_delete);
+}
+
+TEST_F(DBRangeDelTest, Iterator) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 6; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(1), Key(4)));
+  ASSERT_OK(Put(Key(2), "v"));
+
+  std::vector<std::string> expected = {Key(0), Key(2), Key(4), Key(5)};
+  ASSERT_EQ(expected, VisibleKeys());
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->SeekToLast();
+  std::vector<std::string> reversed;
+  for (; iter->Valid(); iter->Prev()) {
+    reversed.push_back(iter->key().ToString());
+  }
+  ASSERT_EQ(std::vector<std::string>(expected.rbegin(), expected.rend()),
+            reversed);
+  iter->Seek(Key(1));
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ(Key(2), iter->key().ToString());
+
+  ASSERT_OK(Flush());
+  ASSERT_EQ(expected, VisibleKeys());
+}
+
+TEST_F(DBRangeDelTest, MergeOperands) {
+  Options options = CurrentOptions();
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  ASSERT_OK(db_->Merge(WriteOptions(), "key", "a"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), "k", "l"));
+  ASSERT_OK(db_->Merge(WriteOptions(), "key", "b"));
+  ASSERT_EQ("b", Get("key"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("b", Get("key"));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("b", Get("key"));
+}
+
+TEST_F(DBRangeDelTest, CompactionDropsCoveredKeys) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(10), Key(90)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(20U, VisibleKeys().size());
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(20U, VisibleKeys().size());
+  // Neither the covered keys nor the tombstone survive a compaction to the
+  // bottommost level.
+  ASSERT_EQ("[ ]", AllEntriesFor(Key(50)));
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  for (const auto& p : props) {
+    ASSERT_EQ(0U, p.second->num_range_deletions);
+  }
+}
+
+TEST_F(DBRangeDelTest, CompactionKeepsKeysForSnapshots) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(2), Key(8)));
+  ASSERT_OK(Flush());
+  CompactRangeOptions compact_options;
+  compact_options.bottommost_level_compaction =
+      BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(compact_options, nullptr, nullptr));
+
+  ASSERT_EQ(4U, VisibleKeys().size());
+  ASSERT_EQ(10U, VisibleKeys(snapshot).size());
+  ASSERT_EQ("v", Get(Key(5), snapshot));
+  ASSERT_EQ("NOT_FOUND", Get(Key(5)));
+
+  db_->ReleaseSnapshot(snapshot);
+  ASSERT_OK(db_->CompactRange(compact_options, nullptr, nullptr));
+  ASSERT_EQ(4U, VisibleKeys().size());
+  ASSERT_EQ("[ ]", AllEntriesFor(Key(5)));
+}
+
+TEST_F(DBRangeDelTest, CompactionSkipsDeletedFiles) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put(Key(i), "v"));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(20), "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(0), Key(10)));
+  ASSERT_OK(Flush());
+
+  int skipped = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "CompactionJob::ProcessKeyValueCompaction:SkipFile",
+      [&](void* arg) { skipped++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(1, skipped);
+  ASSERT_EQ(std::vector<std::string>({Key(20)}), VisibleKeys());
+}
+
+TEST_F(DBRangeDelTest, CompactionOutputFilesDoNotOverlap) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.target_file_size_base = 4 << 10;
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 200; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(50), Key(150)));
+  ASSERT_OK(Put(Key(0), RandomString(&rnd, 100)));
+  ASSERT_OK(Put(Key(199), RandomString(&rnd, 100)));
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+
+  // The tombstone is kept for the snapshot and split over the output files.
+  ASSERT_EQ(100U, VisibleKeys().size());
+  ASSERT_EQ(200U, VisibleKeys(snapshot).size());
+  for (int i = 0; i < 200; i += 7) {
+    ASSERT_EQ(i >= 50 && i < 150, Get(Key(i)) == "NOT_FOUND");
+  }
+  // Reopening checks that the files of a level do not overlap.
+  Reopen(options);
+  ASSERT_EQ(100U, VisibleKeys().size());
+  db_->ReleaseSnapshot(snapshot);
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  rocksdb::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
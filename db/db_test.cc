@@ -1504,6 +1504,49 @@ TEST_F(DBTest, GetFilterByPrefixBloom) {
   ASSERT_EQ(TestGetTickerCount(options, BLOOM_FILTER_USEFUL), 2);
 }
 
+TEST_F(DBTest, MemtableWholeKeyFiltering) {
+  Options options = CurrentOptions();
+  options.prefix_extractor.reset();
+  options.memtable_prefix_bloom_bits = 8 * 1024;
+  options.memtable_whole_key_filtering = true;
+  DestroyAndReopen(options);
+  SetPerfLevel(kEnableCount);
+
+  // No prefix extractor is needed
+  ASSERT_OK(Put("foo", "v1"));
+  ASSERT_OK(Put("bar", "v2"));
+  perf_context.Reset();
+  ASSERT_EQ("v1", Get("foo"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_hit_count);
+  ASSERT_EQ("NOT_FOUND", Get("baz"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_miss_count);
+
+  // With a prefix extractor, Get() checks the whole key and iterators still
+  // check the prefix
+  options.prefix_extractor.reset(NewFixedPrefixTransform(3));
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("foo1", "v1"));
+  perf_context.Reset();
+  ASSERT_EQ("NOT_FOUND", Get("foo2"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_miss_count);
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  iter->Seek("foo");
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("foo1", iter->key().ToString());
+  ASSERT_EQ(1, perf_context.bloom_memtable_hit_count);
+  iter.reset();
+
+  // Memtables created after the option is turned off only hold the prefixes
+  ASSERT_OK(dbfull()->SetOptions({{"memtable_whole_key_filtering", "false"}}));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("foo3", "v3"));
+  perf_context.Reset();
+  ASSERT_EQ("v1", Get("foo1"));
+  ASSERT_EQ(1, perf_context.bloom_memtable_hit_count);
+  ASSERT_EQ(0, perf_context.bloom_memtable_miss_count);
+  SetPerfLevel(kDisable);
+}
+
 TEST_F(DBTest, WholeKeyFilterProp) {
   Options options = last_options_;
   options.prefix_extractor.reset(NewFixedPrefixTransform(3));
@@ -2152,6 +2195,154 @@ TEST_F(DBTest, IterWithSnapshot) {
   } while (ChangeOptions(kSkipHashCuckoo));
 }
 
+TEST_F(DBTest, IterReadahead) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.no_block_cache = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  Random rnd(301);
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), RandomString(&rnd, 100)));
+  }
+  ASSERT_OK(Flush());
+
+  int table_reader_opens = 0;
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "TableCache::GetTableReader:0",
+      [&](void* arg) { table_reader_opens++; });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  auto count_keys = [&](const ReadOptions& read_options) {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    int keys = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      keys++;
+    }
+    EXPECT_OK(iter->status());
+    return keys;
+  };
+
+  // A scan prefetches the blocks ahead of it on its own.
+  ReadOptions read_options;
+  ASSERT_EQ(1000, count_keys(read_options));
+  uint64_t prefetches = TestGetTickerCount(options, NUMBER_BLOCK_PREFETCHES);
+  ASSERT_GT(prefetches, 0);
+  // The prefetched range grows, so there are far fewer prefetches than
+  // blocks.
+  ASSERT_LT(prefetches, 20);
+  ASSERT_EQ(0, table_reader_opens);
+
+  // Seeks that jump around do not.
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  for (int i = 0; i < 1000; i += 97) {
+    iter->Seek(Key(i));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(Key(i), iter->key().ToString());
+  }
+  iter.reset();
+  ASSERT_EQ(prefetches, TestGetTickerCount(options, NUMBER_BLOCK_PREFETCHES));
+
+  // An explicit readahead size reads the file through a private table
+  // reader instead.
+  read_options.readahead_size = 64 << 10;
+  ASSERT_EQ(1000, count_keys(read_options));
+  ASSERT_EQ(1, table_reader_opens);
+  ASSERT_EQ(prefetches, TestGetTickerCount(options, NUMBER_BLOCK_PREFETCHES));
+
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
+TEST_F(DBTest, PinnedDataIterator) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.use_delta_encoding = false;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Spread the keys over several files, the memtable and many data blocks,
+  // with overwrites and deletions in newer files.
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 500; i++) {
+    std::string value = RandomString(&rnd, 100);
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 500; i += 3) {
+    std::string value = RandomString(&rnd, 100);
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 500; i += 7) {
+    ASSERT_OK(Delete(Key(i)));
+    expected.erase(Key(i));
+  }
+  for (int i = 500; i < 550; i++) {
+    std::string value = RandomString(&rnd, 100);
+    ASSERT_OK(Put(Key(i), value));
+    expected[Key(i)] = value;
+  }
+
+  ReadOptions read_options;
+  read_options.pin_data = true;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  std::string prop;
+  ASSERT_OK(iter->GetProperty("rocksdb.iterator.pinned-memory-usage", &prop));
+  ASSERT_EQ("0", prop);
+
+  // The Slices returned stay valid after the iterator moves on.
+  std::vector<std::pair<Slice, Slice>> results;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_OK(iter->GetProperty("rocksdb.iterator.is-key-pinned", &prop));
+    ASSERT_EQ("1", prop);
+    results.emplace_back(iter->key(), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected.size(), results.size());
+  auto expected_it = expected.begin();
+  for (const auto& kv : results) {
+    ASSERT_EQ(expected_it->first, kv.first.ToString());
+    ASSERT_EQ(expected_it->second, kv.second.ToString());
+    ++expected_it;
+  }
+  ASSERT_OK(iter->GetProperty("rocksdb.iterator.pinned-memory-usage", &prop));
+  ASSERT_GT(std::stoull(prop), 50 * 1024U);
+
+  results.clear();
+  for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+    ASSERT_OK(iter->GetProperty("rocksdb.iterator.is-key-pinned", &prop));
+    ASSERT_EQ("1", prop);
+    results.emplace_back(iter->key(), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(expected.size(), results.size());
+  auto expected_rit = expected.rbegin();
+  for (const auto& kv : results) {
+    ASSERT_EQ(expected_rit->first, kv.first.ToString());
+    ASSERT_EQ(expected_rit->second, kv.second.ToString());
+    ++expected_rit;
+  }
+  iter.reset();
+
+  // Without pinning the keys are copied.
+  iter.reset(db_->NewIterator(ReadOptions()));
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_OK(iter->GetProperty("rocksdb.iterator.is-key-pinned", &prop));
+  ASSERT_EQ("0", prop);
+  ASSERT_TRUE(
+      iter->GetProperty("rocksdb.iterator.unknown", &prop).IsInvalidArgument());
+}
+
 TEST_F(DBTest, Recover) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -3306,6 +3497,41 @@ TEST_F(DBTest, MinLevelToCompress2) {
   MinLevelHelper(this, options);
 }
 
+// Flushes and compactions running at the same time share the compression
+// threads of the table factory.
+TEST_F(DBTest, ParallelCompressionSharedPool) {
+  if (!Zlib_Supported()) {
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compression = kZlibCompression;
+  options.write_buffer_size = 64 << 10;
+  options.target_file_size_base = 64 << 10;
+  options.level0_file_num_compaction_trigger = 2;
+  options.max_background_compactions = 4;
+  options.max_background_flushes = 2;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.parallel_compression_threads = 4;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  env_->SetBackgroundThreads(4, Env::LOW);
+  env_->SetBackgroundThreads(2, Env::HIGH);
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 5000; i++) {
+    values.push_back(RandomString(&rnd, 50) + std::string(50, 'a' + i % 26));
+    ASSERT_OK(Put(Key(i), values.back()));
+  }
+  dbfull()->TEST_WaitForFlushMemTable();
+  dbfull()->TEST_WaitForCompact();
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  for (int i = 0; i < 5000; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
 TEST_F(DBTest, RepeatedWritesToSameKey) {
   do {
     Options options;
@@ -8996,6 +9222,74 @@ TEST_F(DBTest, SoftLimit) {
   rocksdb::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBTest, DelayedWriteRateFollowsCompactionDebt) {
+  Options options;
+  options.env = env_;
+  env_->no_sleep_ = true;
+  options = CurrentOptions(options);
+  options.write_buffer_size = 100000;
+  options.max_write_buffer_number = 256;
+  options.level0_file_num_compaction_trigger = 2;
+  options.level0_slowdown_writes_trigger = 3;
+  options.level0_stop_writes_trigger = 20;
+  options.delayed_write_rate = 1000000;
+  options.compression = kNoCompression;
+
+  env_->SetBackgroundThreads(1, Env::LOW);
+  test::SleepingBackgroundTask sleeping_task_low;
+  env_->Schedule(&test::SleepingBackgroundTask::DoSleepTask, &sleeping_task_low,
+                 Env::Priority::LOW);
+  Reopen(options);
+
+  uint64_t rate;
+  uint64_t stopped;
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.actual-delayed-write-rate",
+                                       &rate));
+  ASSERT_EQ(0U, rate);
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.is-write-stopped", &stopped));
+  ASSERT_EQ(0U, stopped);
+
+  Random rnd(301);
+  auto flush_file = [&]() {
+    for (int i = 0; i < 10; i++) {
+      ASSERT_OK(Put(Key(i), RandomString(&rnd, 1000)));
+    }
+    ASSERT_OK(Flush());
+  };
+  flush_file();
+  flush_file();
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.actual-delayed-write-rate",
+                                       &rate));
+  ASSERT_EQ(0U, rate);
+
+  // Writes start to be delayed at full delayed rate.
+  flush_file();
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.actual-delayed-write-rate",
+                                       &rate));
+  ASSERT_EQ(options.delayed_write_rate, rate);
+
+  // As long as compactions cannot pay the debt off, the rate keeps going down
+  // without ever reaching zero.
+  for (int i = 0; i < 6; i++) {
+    uint64_t prev_rate = rate;
+    flush_file();
+    ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.actual-delayed-write-rate",
+                                         &rate));
+    ASSERT_LT(rate, prev_rate);
+    ASSERT_GT(rate, 0U);
+  }
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.is-write-stopped", &stopped));
+  ASSERT_EQ(0U, stopped);
+
+  sleeping_task_low.WakeUp();
+  sleeping_task_low.WaitUntilDone();
+  dbfull()->TEST_WaitForCompact();
+  ASSERT_TRUE(dbfull()->GetIntProperty("rocksdb.actual-delayed-write-rate",
+                                       &rate));
+  ASSERT_EQ(0U, rate);
+  env_->no_sleep_ = false;
+}
+
 TEST_F(DBTest, FailWhenCompressionNotSupportedTest) {
   CompressionType compressions[] = {kZlibCompression, kBZip2Compression,
                                     kLZ4Compression,  kLZ4HCCompression};
@@ -9035,6 +9329,112 @@ TEST_F(DBTest, RowCache) {
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
 }
 
+TEST_F(DBTest, RowCacheAdmissionFilter) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(1 << 20);
+  options.row_cache_admission_filter = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Put("baz", "qux"));
+  ASSERT_OK(Flush());
+
+  // A key read once is not cached
+  ASSERT_EQ(Get("baz"), "qux");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_REJECT), 1);
+
+  // The second read is admitted, the third one hits
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 3);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_REJECT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 0);
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  uint64_t usage;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kRowCacheUsage, &usage));
+  ASSERT_GT(usage, 0U);
+}
+
+TEST_F(DBTest, RowCacheAdmissionFilterCountsLookupsOnce) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(1 << 20);
+  options.row_cache_admission_filter = true;
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "v"));
+  ASSERT_OK(Put("c", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("b", "v"));
+  ASSERT_OK(Put("d", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_EQ(2, NumTableFilesAtLevel(0));
+
+  // A one-off read that searches both files is not cached
+  ASSERT_EQ(Get("c"), "v");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+  uint64_t usage;
+  ASSERT_TRUE(db_->GetIntProperty(DB::Properties::kRowCacheUsage, &usage));
+  ASSERT_EQ(usage, 0U);
+
+  // The second read is admitted, the third one hits
+  ASSERT_EQ(Get("c"), "v");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 0);
+  ASSERT_EQ(Get("c"), "v");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+}
+
+TEST_F(DBTest, RowCacheBudget) {
+  Options options = CurrentOptions();
+  options.statistics = rocksdb::CreateDBStatistics();
+  options.row_cache = NewLRUCache(1 << 20);
+  options.row_cache_budget = 1000;
+  options.disable_auto_compactions = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  const std::string value(100, 'v');
+  for (int i = 0; i < 20; i++) {
+    ASSERT_OK(Put(0, Key(i), value));
+    ASSERT_OK(Put(1, Key(i), value));
+  }
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+
+  for (int i = 0; i < 20; i++) {
+    ASSERT_EQ(value, Get(0, Key(i)));
+  }
+  // Only a few rows fit into the budget of the column family
+  uint64_t usage;
+  ASSERT_TRUE(db_->GetIntProperty(handles_[0], DB::Properties::kRowCacheUsage,
+                                  &usage));
+  ASSERT_GT(usage, 0U);
+  ASSERT_LE(usage, 1000U);
+  uint64_t rejected = TestGetTickerCount(options, ROW_CACHE_REJECT);
+  ASSERT_GT(rejected, 0U);
+  ASSERT_LT(rejected, 20U);
+
+  // The other column family has its own budget
+  ASSERT_EQ(value, Get(1, Key(0)));
+  ASSERT_EQ(rejected, TestGetTickerCount(options, ROW_CACHE_REJECT));
+
+  // Rows of deleted files stop counting against the budget
+  ASSERT_OK(Put(0, Key(0), value));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), handles_[0], nullptr,
+                              nullptr));
+  ASSERT_TRUE(db_->GetIntProperty(handles_[0], DB::Properties::kRowCacheUsage,
+                                  &usage));
+  ASSERT_EQ(0U, usage);
+  ASSERT_EQ(value, Get(0, Key(5)));
+  ASSERT_TRUE(db_->GetIntProperty(handles_[0], DB::Properties::kRowCacheUsage,
+                                  &usage));
+  ASSERT_GT(usage, 0U);
+}
+
 // TODO(3.13): fix the issue of Seek() + Prev() which might not necessary
 //             return the biggest key which is smaller than the seek key.
 TEST_F(DBTest, PrevAfterMerge) {
@@ -9326,6 +9726,45 @@ TEST_F(DBTest, OpenDBWithInfiniteMaxOpenFiles) {
   }
 }
 
+TEST_F(DBTest, OpenFilesLazily) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.max_open_files = -1;
+  options.max_file_opening_threads = 2;
+  DestroyAndReopen(options);
+  for (int i = 0; i < 6; i++) {
+    ASSERT_OK(Put(Key(i), "v" + ToString(i)));
+    ASSERT_OK(Flush());
+  }
+  Close();
+
+  // Hold the background threads until the DB was used
+  rocksdb::SyncPoint::GetInstance()->LoadDependency(
+      {{"DBTest::OpenFilesLazily:Opened", "DBImpl::WarmUpTableReaders:Start"}});
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  options.open_files_lazily = true;
+  Reopen(options);
+  uint64_t ready = 1;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kTableReadersReady, &ready));
+  ASSERT_EQ(0U, ready);
+  // Files that are not open yet are opened on first access
+  ASSERT_EQ("v3", Get(Key(3)));
+  TEST_SYNC_POINT("DBTest::OpenFilesLazily:Opened");
+
+  for (int i = 0; i < 1000 && ready == 0; i++) {
+    env_->SleepForMicroseconds(10000);
+    ASSERT_TRUE(
+        db_->GetIntProperty(DB::Properties::kTableReadersReady, &ready));
+  }
+  ASSERT_EQ(1U, ready);
+  for (int i = 0; i < 6; i++) {
+    ASSERT_EQ("v" + ToString(i), Get(Key(i)));
+  }
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBTest, GetTotalSstFilesSize) {
   Options options = CurrentOptions();
   options.disable_auto_compactions = true;
@@ -39,6 +39,8 @@ enum ValueType : unsigned char {
   kTypeColumnFamilyMerge = 0x6,     // WAL only.
   kTypeSingleDeletion = 0x7,
   kTypeColumnFamilySingleDeletion = 0x8,  // WAL only.
+  kTypeColumnFamilyRangeDeletion = 0xE,   // WAL only.
+  kTypeRangeDeletion = 0xF,               // meta block
   kMaxValue = 0x7F                        // Not used for storing records.
 };
 
@@ -48,12 +50,17 @@ enum ValueType : unsigned char {
 // and the value type is embedded as the low 8 bits in the sequence
 // number in internal keys, we need to use the highest-numbered
 // ValueType, not the lowest).
+// Range deletion tombstones never show up in point iterators, so they are
+// not taken into account here. A file boundary key of the form
+// (end, kMaxSequenceNumber, kTypeRangeDeletion) therefore sorts before every
+// seek key for `end`, which is what makes tombstone end keys exclusive.
 static const ValueType kValueTypeForSeek = kTypeSingleDeletion;
 
 // Checks whether a type is a value type (i.e. a type used in memtables and sst
 // files).
 inline bool IsValueType(ValueType t) {
-  return t <= kTypeMerge || t == kTypeSingleDeletion;
+  return t <= kTypeMerge || t == kTypeSingleDeletion ||
+         t == kTypeRangeDeletion;
 }
 
 // We leave eight bits empty at the bottom so a type and sequence#
@@ -271,7 +278,8 @@ inline LookupKey::~LookupKey() {
 
 class IterKey {
  public:
-  IterKey() : key_(space_), buf_size_(sizeof(space_)), key_size_(0) {}
+  IterKey()
+      : buf_(space_), key_(buf_), buf_size_(sizeof(space_)), key_size_(0) {}
 
   ~IterKey() { ResetBuffer(); }
 
@@ -295,33 +303,49 @@ class IterKey {
     assert(shared_len <= key_size_);
 
     size_t total_size = shared_len + non_shared_len;
-    if (total_size <= buf_size_) {
-      key_size_ = total_size;
-    } else {
+    if (IsKeyPinned()) {
+      // The shared prefix lives in external memory, copy it into buf_ first
+      const char* pinned_key = key_;
+      EnlargeBufferIfNeeded(total_size);
+      memcpy(buf_, pinned_key, shared_len);
+    } else if (total_size > buf_size_) {
       // Need to allocate space, delete previous space
       char* p = new char[total_size];
       memcpy(p, key_, shared_len);
 
-      if (key_ != space_) {
-        delete[] key_;
+      if (buf_ != space_) {
+        delete[] buf_;
       }
 
-      key_ = p;
-      key_size_ = total_size;
+      buf_ = p;
       buf_size_ = total_size;
     }
 
-    memcpy(key_ + shared_len, non_shared_data, non_shared_len);
+    memcpy(buf_ + shared_len, non_shared_data, non_shared_len);
+    key_ = buf_;
+    key_size_ = total_size;
   }
 
-  Slice SetKey(const Slice& key) {
+  // If copy is false, the key is not copied and the returned Slice, as well
+  // as GetKey(), reference the memory of "key" directly. The caller must
+  // then keep that memory alive for as long as the key is in use.
+  Slice SetKey(const Slice& key, bool copy = true) {
     size_t size = key.size();
-    EnlargeBufferIfNeeded(size);
-    memcpy(key_, key.data(), size);
+    if (copy) {
+      EnlargeBufferIfNeeded(size);
+      memcpy(buf_, key.data(), size);
+      key_ = buf_;
+    } else {
+      key_ = key.data();
+    }
     key_size_ = size;
     return Slice(key_, key_size_);
   }
 
+  // Returns true if the key references external memory instead of a copy
+  // owned by this IterKey.
+  bool IsKeyPinned() const { return key_ != buf_; }
+
   // Copies the content of key, updates the reference to the user key in ikey
   // and returns a Slice referencing the new copy.
   Slice SetKey(const Slice& key, ParsedInternalKey* ikey) {
@@ -336,8 +360,9 @@ class IterKey {
   // invalidate slices to the key (and the user key).
   void UpdateInternalKey(uint64_t seq, ValueType t) {
     assert(key_size_ >= 8);
+    assert(!IsKeyPinned());
     uint64_t newval = (seq << 8) | t;
-    EncodeFixed64(&key_[key_size_ - 8], newval);
+    EncodeFixed64(&buf_[key_size_ - 8], newval);
   }
 
   void SetInternalKey(const Slice& key_prefix, const Slice& user_key,
@@ -347,10 +372,11 @@ class IterKey {
     size_t usize = user_key.size();
     EnlargeBufferIfNeeded(psize + usize + sizeof(uint64_t));
     if (psize > 0) {
-      memcpy(key_, key_prefix.data(), psize);
+      memcpy(buf_, key_prefix.data(), psize);
     }
-    memcpy(key_ + psize, user_key.data(), usize);
-    EncodeFixed64(key_ + usize + psize, PackSequenceAndType(s, value_type));
+    memcpy(buf_ + psize, user_key.data(), usize);
+    EncodeFixed64(buf_ + usize + psize, PackSequenceAndType(s, value_type));
+    key_ = buf_;
     key_size_ = psize + usize + sizeof(uint64_t);
   }
 
@@ -361,6 +387,7 @@ class IterKey {
 
   void Reserve(size_t size) {
     EnlargeBufferIfNeeded(size);
+    key_ = buf_;
     key_size_ = size;
   }
 
@@ -377,21 +404,24 @@ class IterKey {
   void EncodeLengthPrefixedKey(const Slice& key) {
     auto size = key.size();
     EnlargeBufferIfNeeded(size + static_cast<size_t>(VarintLength(size)));
-    char* ptr = EncodeVarint32(key_, static_cast<uint32_t>(size));
+    char* ptr = EncodeVarint32(buf_, static_cast<uint32_t>(size));
     memcpy(ptr, key.data(), size);
+    key_ = buf_;
   }
 
  private:
-  char* key_;
+  char* buf_;
+  const char* key_;  // Points either into buf_ or to pinned external memory
   size_t buf_size_;
   size_t key_size_;
   char space_[32];  // Avoid allocation for short keys
 
   void ResetBuffer() {
-    if (key_ != space_) {
-      delete[] key_;
-      key_ = space_;
+    if (buf_ != space_) {
+      delete[] buf_;
+      buf_ = space_;
     }
+    key_ = buf_;
     buf_size_ = sizeof(space_);
     key_size_ = 0;
   }
@@ -407,7 +437,8 @@ class IterKey {
     if (key_size > buf_size_) {
       // Need to enlarge the buffer.
       ResetBuffer();
-      key_ = new char[key_size];
+      buf_ = new char[key_size];
+      key_ = buf_;
       buf_size_ = key_size;
     }
   }
@@ -186,8 +186,8 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
       ThreadStatus::STAGE_FLUSH_WRITE_L0);
   db_mutex_->AssertHeld();
   const uint64_t start_micros = db_options_.env->NowMicros();
-  // path 0 for level 0 file.
-  meta->fd = FileDescriptor(versions_->NewFileNumber(), 0, 0);
+  meta->fd =
+      FileDescriptor(versions_->NewFileNumber(), cfd_->GetFlushPathId(), 0);
 
   Version* base = cfd_->current();
   base->Ref();  // it is likely that we do not need this reference
@@ -198,6 +198,7 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
       log_buffer_->FlushBufferToLog();
     }
     std::vector<InternalIterator*> memtables;
+    std::vector<InternalIterator*> range_del_iters;
     ReadOptions ro;
     ro.total_order_seek = true;
     Arena arena;
@@ -208,6 +209,10 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
           "[%s] [JOB %d] Flushing memtable with next log file: %" PRIu64 "\n",
           cfd_->GetName().c_str(), job_context_->job_id, m->GetNextLogNumber());
       memtables.push_back(m->NewIterator(ro, &arena));
+      auto* range_del_iter = m->NewRangeTombstoneIterator(ro);
+      if (range_del_iter != nullptr) {
+        range_del_iters.push_back(range_del_iter);
+      }
       total_num_entries += m->num_entries();
       total_num_deletes += m->num_deletes();
       total_memory_usage += m->ApproximateMemoryUsage();
@@ -225,6 +230,12 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
       ScopedArenaIterator iter(
           NewMergingIterator(&cfd_->internal_comparator(), &memtables[0],
                              static_cast<int>(memtables.size()), &arena));
+      std::unique_ptr<InternalIterator> range_del_iter;
+      if (!range_del_iters.empty()) {
+        range_del_iter.reset(NewMergingIterator(
+            &cfd_->internal_comparator(), &range_del_iters[0],
+            static_cast<int>(range_del_iters.size())));
+      }
       Log(InfoLogLevel::INFO_LEVEL, db_options_.info_log,
           "[%s] [JOB %d] Level-0 flush table #%" PRIu64 ": started",
           cfd_->GetName().c_str(), job_context_->job_id, meta->fd.GetNumber());
@@ -232,7 +243,8 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:output_compression",
                                &output_compression_);
       s = BuildTable(dbname_, db_options_.env, *cfd_->ioptions(), env_options_,
-                     cfd_->table_cache(), iter.get(), meta,
+                     cfd_->table_cache(), iter.get(),
+                     std::move(range_del_iter), meta,
                      cfd_->internal_comparator(),
                      cfd_->int_tbl_prop_collector_factories(), cfd_->GetID(),
                      existing_snapshots_, output_compression_,
@@ -286,7 +298,8 @@ Status FlushJob::WriteLevel0Table(const autovector<MemTable*>& mems,
     edit->AddFile(0 /* level */, meta->fd.GetNumber(), meta->fd.GetPathId(),
                   meta->fd.GetFileSize(), meta->smallest, meta->largest,
                   meta->smallest_seqno, meta->largest_seqno,
-                  meta->marked_for_compaction, meta->priv_meta);
+                  meta->marked_for_compaction, meta->priv_meta,
+                  meta->has_range_deletions, meta->newest_entry_time);
   }
 
   InternalStats::CompactionStats stats(1);
@@ -126,6 +126,11 @@ static const std::string base_level = "base-level";
 static const std::string total_sst_files_size = "total-sst-files-size";
 static const std::string estimate_pending_comp_bytes =
     "estimate-pending-compaction-bytes";
+static const std::string actual_delayed_write_rate =
+    "actual-delayed-write-rate";
+static const std::string is_write_stopped = "is-write-stopped";
+static const std::string row_cache_usage = "row-cache-usage";
+static const std::string table_readers_ready = "table-readers-ready";
 static const std::string aggregated_table_properties =
     "aggregated-table-properties";
 static const std::string aggregated_table_properties_at_level =
@@ -177,6 +182,14 @@ const std::string DB::Properties::kTotalSstFilesSize =
                       rocksdb_prefix + total_sst_files_size;
 const std::string DB::Properties::kEstimatePendingCompactionBytes =
     rocksdb_prefix + estimate_pending_comp_bytes;
+const std::string DB::Properties::kActualDelayedWriteRate =
+    rocksdb_prefix + actual_delayed_write_rate;
+const std::string DB::Properties::kIsWriteStopped =
+    rocksdb_prefix + is_write_stopped;
+const std::string DB::Properties::kRowCacheUsage =
+    rocksdb_prefix + row_cache_usage;
+const std::string DB::Properties::kTableReadersReady =
+    rocksdb_prefix + table_readers_ready;
 const std::string DB::Properties::kAggregatedTableProperties =
     rocksdb_prefix + aggregated_table_properties;
 const std::string DB::Properties::kAggregatedTablePropertiesAtLevel =
@@ -260,6 +273,14 @@ DBPropertyType GetPropertyType(const Slice& property, bool* is_int_property,
     return kTotalSstFilesSize;
   } else if (in == estimate_pending_comp_bytes) {
     return kEstimatePendingCompactionBytes;
+  } else if (in == actual_delayed_write_rate) {
+    return kActualDelayedWriteRate;
+  } else if (in == is_write_stopped) {
+    return kIsWriteStopped;
+  } else if (in == row_cache_usage) {
+    return kRowCacheUsage;
+  } else if (in == table_readers_ready) {
+    return kTableReadersReady;
   }
   return kUnknown;
 }
@@ -457,6 +478,22 @@ bool InternalStats::GetIntProperty(DBPropertyType property_type,
     case kEstimatePendingCompactionBytes:
       *value = vstorage->estimated_compaction_needed_bytes();
       return true;
+    case kActualDelayedWriteRate: {
+      const WriteController& write_controller = db->write_controller();
+      *value = write_controller.NeedsDelay()
+                   ? write_controller.delayed_write_rate()
+                   : 0;
+      return true;
+    }
+    case kIsWriteStopped:
+      *value = db->write_controller().IsStopped() ? 1 : 0;
+      return true;
+    case kRowCacheUsage:
+      *value = cfd_->table_cache()->GetRowCacheUsage();
+      return true;
+    case kTableReadersReady:
+      *value = db->NumTableReadersToWarmUp() == 0 ? 1 : 0;
+      return true;
     default:
       return false;
   }
@@ -673,7 +710,9 @@ void InternalStats::DumpCFStats(std::string* value) {
           level == 0 ? (cf_stats_count_[LEVEL0_SLOWDOWN_TOTAL] +
                         cf_stats_count_[LEVEL0_NUM_FILES_TOTAL] +
                         cf_stats_count_[HARD_PENDING_COMPACTION_BYTES_LIMIT] +
-                        cf_stats_count_[MEMTABLE_COMPACTION])
+                        cf_stats_count_[SOFT_PENDING_COMPACTION_BYTES_LIMIT] +
+                        cf_stats_count_[MEMTABLE_COMPACTION] +
+                        cf_stats_count_[MEMTABLE_SLOWDOWN])
                      : (stall_leveln_slowdown_count_soft_[level] +
                         stall_leveln_slowdown_count_hard_[level]);
 
@@ -728,8 +767,12 @@ void InternalStats::DumpCFStats(std::string* value) {
                              "%" PRIu64
                              " pending_compaction_bytes, "
                              "%" PRIu64
+                             " pending_compaction_bytes_slowdown, "
+                             "%" PRIu64
                              " memtable_compaction, "
                              "%" PRIu64
+                             " memtable_slowdown, "
+                             "%" PRIu64
                              " leveln_slowdown_soft, "
                              "%" PRIu64 " leveln_slowdown_hard\n",
            cf_stats_count_[LEVEL0_SLOWDOWN_TOTAL],
@@ -737,7 +780,9 @@ void InternalStats::DumpCFStats(std::string* value) {
            cf_stats_count_[LEVEL0_NUM_FILES_TOTAL],
            cf_stats_count_[LEVEL0_NUM_FILES_WITH_COMPACTION],
            cf_stats_count_[HARD_PENDING_COMPACTION_BYTES_LIMIT],
-           cf_stats_count_[MEMTABLE_COMPACTION], total_slowdown_count_soft,
+           cf_stats_count_[SOFT_PENDING_COMPACTION_BYTES_LIMIT],
+           cf_stats_count_[MEMTABLE_COMPACTION],
+           cf_stats_count_[MEMTABLE_SLOWDOWN], total_slowdown_count_soft,
            total_slowdown_count_hard);
   value->append(buf);
 
@@ -64,6 +64,13 @@ enum DBPropertyType : uint32_t {
   kTotalSstFilesSize,               // Total size of all sst files.
   kBaseLevel,                       // The level that L0 data is compacted to
   kEstimatePendingCompactionBytes,  // Estimated bytes to compaction
+  kActualDelayedWriteRate,          // Current rate of delayed writes, 0 if
+                                    // writes are not delayed
+  kIsWriteStopped,                  // 1 if writes are stopped
+  kRowCacheUsage,                   // Bytes of the row cache used by the
+                                    // column family
+  kTableReadersReady,               // 1 if no file waits to be opened in the
+                                    // background
   kAggregatedTableProperties,  // Return a string that contains the aggregated
                                // table properties.
   kAggregatedTablePropertiesAtLevel,  // Return a string that contains the
@@ -86,6 +93,8 @@ class InternalStats {
     LEVEL0_NUM_FILES_TOTAL,
     LEVEL0_NUM_FILES_WITH_COMPACTION,
     HARD_PENDING_COMPACTION_BYTES_LIMIT,
+    SOFT_PENDING_COMPACTION_BYTES_LIMIT,
+    MEMTABLE_SLOWDOWN,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
     INTERNAL_CF_STATS_ENUM_MAX,
@@ -359,6 +368,8 @@ class InternalStats {
     LEVEL0_NUM_FILES_TOTAL,
     LEVEL0_NUM_FILES_WITH_COMPACTION,
     HARD_PENDING_COMPACTION_BYTES_LIMIT,
+    SOFT_PENDING_COMPACTION_BYTES_LIMIT,
+    MEMTABLE_SLOWDOWN,
     WRITE_STALLS_ENUM_MAX,
     BYTES_FLUSHED,
     INTERNAL_CF_STATS_ENUM_MAX,
@@ -15,6 +15,7 @@
 
 #include "db/dbformat.h"
 #include "db/merge_context.h"
+#include "db/range_del_aggregator.h"
 #include "db/writebuffer.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/env.h"
@@ -43,6 +44,8 @@ MemTableOptions::MemTableOptions(
         mutable_cf_options.memtable_prefix_bloom_probes),
     memtable_prefix_bloom_huge_page_tlb_size(
         mutable_cf_options.memtable_prefix_bloom_huge_page_tlb_size),
+    memtable_whole_key_filtering(
+        mutable_cf_options.memtable_whole_key_filtering),
     inplace_update_support(ioptions.inplace_update_support),
     inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
     inplace_callback(ioptions.inplace_callback),
@@ -50,6 +53,7 @@ MemTableOptions::MemTableOptions(
     filter_deletes(mutable_cf_options.filter_deletes),
     statistics(ioptions.statistics),
     merge_operator(ioptions.merge_operator),
+    table_factory(ioptions.table_factory),
     info_log(ioptions.info_log) {}
 
 MemTable::MemTable(const InternalKeyComparator& cmp,
@@ -68,6 +72,7 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
       data_size_(0),
       num_entries_(0),
       num_deletes_(0),
+      num_range_deletes_(0),
       flush_in_progress_(false),
       flush_completed_(false),
       file_number_(0),
@@ -84,8 +89,11 @@ MemTable::MemTable(const InternalKeyComparator& cmp,
   // if should_flush_ == true without an entry inserted, something must have
   // gone wrong already.
   assert(!should_flush_);
-  if (prefix_extractor_ && moptions_.memtable_prefix_bloom_bits > 0) {
-    prefix_bloom_.reset(new DynamicBloom(
+  // The bloom filter is allocated from the arena, so it counts against the
+  // write buffer size like the entries do
+  if ((prefix_extractor_ || moptions_.memtable_whole_key_filtering) &&
+      moptions_.memtable_prefix_bloom_bits > 0) {
+    bloom_filter_.reset(new DynamicBloom(
         &allocator_,
         moptions_.memtable_prefix_bloom_bits, ioptions.bloom_locality,
         moptions_.memtable_prefix_bloom_probes, nullptr,
@@ -99,6 +107,9 @@ MemTable::~MemTable() { assert(refs_ == 0); }
 size_t MemTable::ApproximateMemoryUsage() {
   size_t arena_usage = arena_.ApproximateMemoryUsage();
   size_t table_usage = table_->ApproximateMemoryUsage();
+  if (num_range_deletes() > 0) {
+    table_usage += range_del_table_->ApproximateMemoryUsage();
+  }
   // let MAX_USAGE =  std::numeric_limits<size_t>::max()
   // then if arena_usage + total_usage >= MAX_USAGE, return MAX_USAGE.
   // the following variation is to avoid numeric overflow.
@@ -122,6 +133,9 @@ bool MemTable::ShouldFlushNow() const {
   // shouldn't flush.
   auto allocated_memory =
       table_->ApproximateMemoryUsage() + arena_.MemoryAllocatedBytes();
+  if (num_range_deletes() > 0) {
+    allocated_memory += range_del_table_->ApproximateMemoryUsage();
+  }
 
   // if we can still allocate one more block without exceeding the
   // over-allocation ratio, then we should not flush.
@@ -205,14 +219,18 @@ const char* EncodeKey(std::string* scratch, const Slice& target) {
 
 class MemTableIterator : public InternalIterator {
  public:
-  MemTableIterator(
-      const MemTable& mem, const ReadOptions& read_options, Arena* arena)
+  MemTableIterator(const MemTable& mem, const ReadOptions& read_options,
+                   Arena* arena, bool use_range_del_table = false)
       : bloom_(nullptr),
         prefix_extractor_(mem.prefix_extractor_),
         valid_(false),
-        arena_mode_(arena != nullptr) {
-    if (prefix_extractor_ != nullptr && !read_options.total_order_seek) {
-      bloom_ = mem.prefix_bloom_.get();
+        arena_mode_(arena != nullptr),
+        value_pinned_(!mem.GetMemTableOptions()->inplace_update_support) {
+    if (use_range_del_table) {
+      iter_ = mem.range_del_table_->GetIterator(arena);
+    } else if (prefix_extractor_ != nullptr &&
+               !read_options.total_order_seek) {
+      bloom_ = mem.bloom_filter_.get();
       iter_ = mem.table_->GetDynamicPrefixIterator(arena);
     } else {
       iter_ = mem.table_->GetIterator(arena);
@@ -274,12 +292,19 @@ class MemTableIterator : public InternalIterator {
 
   virtual Status status() const override { return Status::OK(); }
 
+  // Entries live in the memtable arena, which outlives the iterator. Values
+  // may be overwritten in place when inplace_update_support is set.
+  virtual bool IsKeyPinned() const override { return true; }
+
+  virtual bool IsValuePinned() const override { return value_pinned_; }
+
  private:
   DynamicBloom* bloom_;
   const SliceTransform* const prefix_extractor_;
   MemTableRep::Iterator* iter_;
   bool valid_;
   bool arena_mode_;
+  bool value_pinned_;
 
   // No copying allowed
   MemTableIterator(const MemTableIterator&);
@@ -293,6 +318,15 @@ InternalIterator* MemTable::NewIterator(const ReadOptions& read_options,
   return new (mem) MemTableIterator(*this, read_options, arena);
 }
 
+InternalIterator* MemTable::NewRangeTombstoneIterator(
+    const ReadOptions& read_options) {
+  if (num_range_deletes() == 0) {
+    return nullptr;
+  }
+  return new MemTableIterator(*this, read_options, nullptr /* arena */,
+                              true /* use_range_del_table */);
+}
+
 port::RWMutex* MemTable::GetLock(const Slice& key) {
   static murmur_hash hash;
   return &locks_[hash(key) % locks_.size()];
@@ -333,7 +367,14 @@ void MemTable::Add(SequenceNumber s, ValueType type,
                                internal_key_size + VarintLength(val_size) +
                                val_size;
   char* buf = nullptr;
-  KeyHandle handle = table_->Allocate(encoded_len, &buf);
+  if (type == kTypeRangeDeletion && range_del_table_ == nullptr) {
+    range_del_table_.reset(SkipListFactory().CreateMemTableRep(
+        comparator_, &allocator_, nullptr /* transform */,
+        moptions_.info_log));
+  }
+  std::unique_ptr<MemTableRep>& table =
+      type == kTypeRangeDeletion ? range_del_table_ : table_;
+  KeyHandle handle = table->Allocate(encoded_len, &buf);
   assert(buf != nullptr);
   char* p = EncodeVarint32(buf, internal_key_size);
   memcpy(p, key.data(), key_size);
@@ -344,18 +385,26 @@ void MemTable::Add(SequenceNumber s, ValueType type,
   p = EncodeVarint32(p, val_size);
   memcpy(p, value.data(), val_size);
   assert((unsigned)(p + val_size - buf) == (unsigned)encoded_len);
-  table_->Insert(handle);
+  table->Insert(handle);
   num_entries_.store(num_entries_.load(std::memory_order_relaxed) + 1,
                      std::memory_order_relaxed);
   data_size_.store(data_size_.load(std::memory_order_relaxed) + encoded_len,
                    std::memory_order_relaxed);
   if (type == kTypeDeletion) {
     num_deletes_++;
+  } else if (type == kTypeRangeDeletion) {
+    num_range_deletes_.store(
+        num_range_deletes_.load(std::memory_order_relaxed) + 1,
+        std::memory_order_release);
   }
 
-  if (prefix_bloom_) {
-    assert(prefix_extractor_);
-    prefix_bloom_->Add(prefix_extractor_->Transform(key));
+  if (bloom_filter_ && type != kTypeRangeDeletion) {
+    if (prefix_extractor_) {
+      bloom_filter_->Add(prefix_extractor_->Transform(key));
+    }
+    if (moptions_.memtable_whole_key_filtering) {
+      bloom_filter_->Add(key);
+    }
   }
 
   // The first sequence number inserted into the memtable
@@ -390,9 +439,37 @@ struct Saver {
   Statistics* statistics;
   bool inplace_update_support;
   Env* env_;
+  // Entries older than this are deleted by a range tombstone
+  SequenceNumber max_covering_tombstone_seq;
 };
 }  // namespace
 
+// Resolves the lookup of a deleted key, merging pending operands, if any, on
+// top of nothing.
+static void SaveDeletion(Saver* s) {
+  if (*(s->merge_in_progress)) {
+    assert(s->merge_operator != nullptr);
+    *(s->status) = Status::OK();
+    bool merge_success = false;
+    {
+      StopWatchNano timer(s->env_, s->statistics != nullptr);
+      PERF_TIMER_GUARD(merge_operator_time_nanos);
+      merge_success = s->merge_operator->FullMerge(
+          s->key->user_key(), nullptr, s->merge_context->GetOperands(),
+          s->value, s->logger);
+      RecordTick(s->statistics, MERGE_OPERATION_TOTAL_TIME,
+                 timer.ElapsedNanos());
+    }
+    if (!merge_success) {
+      RecordTick(s->statistics, NUMBER_MERGE_FAILURES);
+      *(s->status) = Status::Corruption("Error: Could not perform merge.");
+    }
+  } else {
+    *(s->status) = Status::NotFound();
+  }
+  *(s->found_final_value) = true;
+}
+
 static bool SaveValue(void* arg, const char* entry) {
   Saver* s = reinterpret_cast<Saver*>(arg);
   MergeContext* merge_context = s->merge_context;
@@ -417,6 +494,9 @@ static bool SaveValue(void* arg, const char* entry) {
     const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
     ValueType type;
     UnPackSequenceAndType(tag, &s->seq, &type);
+    if (s->seq < s->max_covering_tombstone_seq) {
+      type = kTypeDeletion;
+    }
 
     switch (type) {
       case kTypeValue: {
@@ -453,28 +533,7 @@ static bool SaveValue(void* arg, const char* entry) {
       }
       case kTypeDeletion:
       case kTypeSingleDeletion: {
-        if (*(s->merge_in_progress)) {
-          assert(merge_operator != nullptr);
-          *(s->status) = Status::OK();
-          bool merge_success = false;
-          {
-            StopWatchNano timer(s->env_, s->statistics != nullptr);
-            PERF_TIMER_GUARD(merge_operator_time_nanos);
-            merge_success = merge_operator->FullMerge(
-                s->key->user_key(), nullptr, merge_context->GetOperands(),
-                s->value, s->logger);
-            RecordTick(s->statistics, MERGE_OPERATION_TOTAL_TIME,
-                       timer.ElapsedNanos());
-          }
-          if (!merge_success) {
-            RecordTick(s->statistics, NUMBER_MERGE_FAILURES);
-            *(s->status) =
-                Status::Corruption("Error: Could not perform merge.");
-          }
-        } else {
-          *(s->status) = Status::NotFound();
-        }
-        *(s->found_final_value) = true;
+        SaveDeletion(s);
         return false;
       }
       case kTypeMerge: {
@@ -515,37 +574,65 @@ bool MemTable::Get(const LookupKey& key, std::string* value, Status* s,
   Slice user_key = key.user_key();
   bool found_final_value = false;
   bool merge_in_progress = s->IsMergeInProgress();
-  bool const may_contain =
-      nullptr == prefix_bloom_
-          ? false
-          : prefix_bloom_->MayContain(prefix_extractor_->Transform(user_key));
-  if (prefix_bloom_ && !may_contain) {
-    // iter is null if prefix bloom says the key does not exist
+
+  // Range tombstones of this memtable hide every older entry of the key, in
+  // this memtable as well as in older memtables and files.
+  SequenceNumber max_covering_tombstone_seq = 0;
+  if (num_range_deletes() > 0) {
+    MemTableIterator range_del_iter(*this, ReadOptions(), nullptr /* arena */,
+                                    true /* use_range_del_table */);
+    max_covering_tombstone_seq = RangeDelAggregator::MaxCoveringTombstoneSeqnum(
+        &range_del_iter, comparator_.comparator.user_comparator(), user_key,
+        GetInternalKeySeqno(key.internal_key()));
+  }
+
+  Saver saver;
+  saver.status = s;
+  saver.found_final_value = &found_final_value;
+  saver.merge_in_progress = &merge_in_progress;
+  saver.key = &key;
+  saver.value = value;
+  saver.seq = kMaxSequenceNumber;
+  saver.mem = this;
+  saver.merge_context = merge_context;
+  saver.merge_operator = moptions_.merge_operator;
+  saver.logger = moptions_.info_log;
+  saver.inplace_update_support = moptions_.inplace_update_support;
+  saver.statistics = moptions_.statistics;
+  saver.env_ = env_;
+  saver.max_covering_tombstone_seq = max_covering_tombstone_seq;
+
+  bool may_contain = true;
+  if (bloom_filter_) {
+    // The whole key is more selective than its prefix
+    may_contain = moptions_.memtable_whole_key_filtering
+                      ? bloom_filter_->MayContain(user_key)
+                      : bloom_filter_->MayContain(
+                            prefix_extractor_->Transform(user_key));
+  }
+  if (!may_contain) {
+    // the bloom filter says the key does not exist
     PERF_COUNTER_ADD(bloom_memtable_miss_count, 1);
     *seq = kMaxSequenceNumber;
   } else {
-    if (prefix_bloom_) {
+    if (bloom_filter_) {
       PERF_COUNTER_ADD(bloom_memtable_hit_count, 1);
     }
-    Saver saver;
-    saver.status = s;
-    saver.found_final_value = &found_final_value;
-    saver.merge_in_progress = &merge_in_progress;
-    saver.key = &key;
-    saver.value = value;
-    saver.seq = kMaxSequenceNumber;
-    saver.mem = this;
-    saver.merge_context = merge_context;
-    saver.merge_operator = moptions_.merge_operator;
-    saver.logger = moptions_.info_log;
-    saver.inplace_update_support = moptions_.inplace_update_support;
-    saver.statistics = moptions_.statistics;
-    saver.env_ = env_;
     table_->Get(key, &saver, SaveValue);
 
     *seq = saver.seq;
   }
 
+  if (max_covering_tombstone_seq > 0) {
+    if (!found_final_value) {
+      // Nothing older than the tombstone can be visible
+      SaveDeletion(&saver);
+    }
+    if (*seq == kMaxSequenceNumber || *seq < max_covering_tombstone_seq) {
+      *seq = max_covering_tombstone_seq;
+    }
+  }
+
   // No change to value, since we have not yet found a Put/Delete
   if (!found_final_value && merge_in_progress) {
     *s = Status::MergeInProgress();
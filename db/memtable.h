@@ -42,6 +42,7 @@ struct MemTableOptions {
   uint32_t memtable_prefix_bloom_bits;
   uint32_t memtable_prefix_bloom_probes;
   size_t memtable_prefix_bloom_huge_page_tlb_size;
+  bool memtable_whole_key_filtering;
   bool inplace_update_support;
   size_t inplace_update_num_locks;
   UpdateStatus (*inplace_callback)(char* existing_value,
@@ -52,6 +53,7 @@ struct MemTableOptions {
   bool filter_deletes;
   Statistics* statistics;
   MergeOperator* merge_operator;
+  TableFactory* table_factory;
   Logger* info_log;
 };
 
@@ -143,6 +145,12 @@ class MemTable {
   //        those allocated in arena.
   InternalIterator* NewIterator(const ReadOptions& read_options, Arena* arena);
 
+  // Return an iterator over the range tombstones in this memtable, or nullptr
+  // if DeleteRange() was never applied to it. Keys are internal keys built
+  // from the begin key of each range, values are the (exclusive) end keys.
+  // The caller owns the returned iterator.
+  InternalIterator* NewRangeTombstoneIterator(const ReadOptions& read_options);
+
   // Add an entry into memtable that maps key to value at the
   // specified sequence number and with the specified type.
   // Typically value will be empty if type==kTypeDeletion.
@@ -222,6 +230,13 @@ class MemTable {
   // operations on the same MemTable (unless this Memtable is immutable).
   uint64_t num_deletes() const { return num_deletes_; }
 
+  // Get total number of range deletions in the mem table.
+  // REQUIRES: external synchronization to prevent simultaneous
+  // operations on the same MemTable (unless this Memtable is immutable).
+  uint64_t num_range_deletes() const {
+    return num_range_deletes_.load(std::memory_order_acquire);
+  }
+
   // Returns the edits area that is needed for flushing the memtable
   VersionEdit* GetEdits() { return &edit_; }
 
@@ -304,11 +319,16 @@ class MemTable {
   Arena arena_;
   MemTableAllocator allocator_;
   unique_ptr<MemTableRep> table_;
+  // Range tombstones are kept apart from point entries so that point lookups
+  // and iterators never have to skip over them. Created by the first range
+  // deletion; readers must check num_range_deletes() before touching it.
+  unique_ptr<MemTableRep> range_del_table_;
 
   // Total data size of all data inserted
   std::atomic<uint64_t> data_size_;
   std::atomic<uint64_t> num_entries_;
   uint64_t num_deletes_;
+  std::atomic<uint64_t> num_range_deletes_;
 
   // These are used to manage memtable flushes to storage
   bool flush_in_progress_; // started the flush
@@ -337,7 +357,9 @@ class MemTable {
   void operator=(const MemTable&);
 
   const SliceTransform* const prefix_extractor_;
-  std::unique_ptr<DynamicBloom> prefix_bloom_;
+  // Holds the prefixes of the keys if prefix_extractor_ is set and the whole
+  // keys if memtable_whole_key_filtering is true
+  std::unique_ptr<DynamicBloom> bloom_filter_;
 
   // a flag indicating if a memtable has met the criteria to flush
   bool should_flush_;
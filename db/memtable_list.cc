@@ -13,9 +13,11 @@
 #include <string>
 #include "rocksdb/db.h"
 #include "db/memtable.h"
+#include "db/range_del_aggregator.h"
 #include "db/version_set.h"
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
+#include "table/iterator_wrapper.h"
 #include "table/merger.h"
 #include "util/coding.h"
 #include "util/log_buffer.h"
@@ -147,10 +149,20 @@ void MemTableListVersion::AddIterators(
 }
 
 void MemTableListVersion::AddIterators(
-    const ReadOptions& options, MergeIteratorBuilder* merge_iter_builder) {
+    const ReadOptions& options, MergeIteratorBuilder* merge_iter_builder,
+    RangeDelAggregator* range_del_agg) {
   for (auto& m : memlist_) {
     merge_iter_builder->AddIterator(
         m->NewIterator(options, merge_iter_builder->GetArena()));
+    if (range_del_agg != nullptr) {
+      Status s = range_del_agg->AddTombstones(
+          std::unique_ptr<InternalIterator>(
+              m->NewRangeTombstoneIterator(options)));
+      if (!s.ok()) {
+        merge_iter_builder->AddIterator(NewErrorInternalIterator(
+            s, merge_iter_builder->GetArena()));
+      }
+    }
   }
 }
 
@@ -29,6 +29,7 @@ class ColumnFamilyData;
 class InternalKeyComparator;
 class InstrumentedMutex;
 class MergeIteratorBuilder;
+class RangeDelAggregator;
 
 // keeps a list of immutable memtables in a vector. the list is immutable
 // if refcount is bigger than one. It is used as a state for Get() and
@@ -77,8 +78,11 @@ class MemTableListVersion {
                     std::vector<InternalIterator*>* iterator_list,
                     Arena* arena);
 
+  // If "range_del_agg" is not nullptr, the range tombstones of the
+  // memtables are added to it.
   void AddIterators(const ReadOptions& options,
-                    MergeIteratorBuilder* merge_iter_builder);
+                    MergeIteratorBuilder* merge_iter_builder,
+                    RangeDelAggregator* range_del_agg = nullptr);
 
   uint64_t GetTotalNumEntries() const;
 
@@ -9,6 +9,7 @@
 #include <string>
 
 #include "db/dbformat.h"
+#include "db/range_del_aggregator.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/db.h"
 #include "rocksdb/merge_operator.h"
@@ -59,7 +60,8 @@ Status MergeHelper::TimedFullMerge(const Slice& key, const Slice* value,
 //       keys_[i] corresponds to operands_[i] for each i.
 Status MergeHelper::MergeUntil(InternalIterator* iter,
                                const SequenceNumber stop_before,
-                               const bool at_bottom) {
+                               const bool at_bottom,
+                               RangeDelAggregator* range_del_agg) {
   // Get a copy of the internal key, before it's invalidated by iter->Next()
   // Also maintain the list of merge operands seen.
   assert(HasOperator());
@@ -110,6 +112,10 @@ Status MergeHelper::MergeUntil(InternalIterator* iter,
     // At this point we are guaranteed that we need to process this key.
 
     assert(IsValueType(ikey.type));
+    if (range_del_agg != nullptr && range_del_agg->ShouldDelete(ikey)) {
+      // Deleted by a range tombstone; the history of the key ends here.
+      ikey.type = kTypeDeletion;
+    }
     if (ikey.type != kTypeMerge) {
       if (ikey.type != kTypeValue && ikey.type != kTypeDeletion) {
         // Merges operands can only be used with puts and deletions, single
@@ -23,6 +23,7 @@ class Logger;
 class MergeOperator;
 class Statistics;
 class InternalIterator;
+class RangeDelAggregator;
 
 class MergeHelper {
  public:
@@ -74,6 +75,8 @@ class MergeHelper {
   //                   0 means no restriction
   // at_bottom:   (IN) true if the iterator covers the bottem level, which means
   //                   we could reach the start of the history of this user key.
+  // range_del_agg: (IN) entries deleted by a range tombstone are treated as
+  //                     deletions. May be nullptr.
   //
   // Returns one of the following statuses:
   // - OK: Entries were successfully merged.
@@ -85,7 +88,8 @@ class MergeHelper {
   // REQUIRED: The first key in the input is not corrupted.
   Status MergeUntil(InternalIterator* iter,
                     const SequenceNumber stop_before = 0,
-                    const bool at_bottom = false);
+                    const bool at_bottom = false,
+                    RangeDelAggregator* range_del_agg = nullptr);
 
   // Filters a merge operand using the compaction filter specified
   // in the constructor. Returns true if the operand should be filtered out.
@@ -0,0 +1,386 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "db/range_del_aggregator.h"
+
+#include <algorithm>
+#include <functional>
+
+#include "db/version_edit.h"
+#include "table/table_builder.h"
+
+namespace rocksdb {
+
+RangeDelAggregator::RangeDelAggregator(
+    const InternalKeyComparator& icmp,
+    const std::vector<SequenceNumber>& snapshots)
+    : icmp_(icmp), upper_bound_(kMaxSequenceNumber), empty_(true) {
+  const Comparator* ucmp = icmp_.user_comparator();
+  for (auto snapshot : snapshots) {
+    stripes_.emplace(snapshot, TombstoneStripe(ucmp));
+  }
+  // Data newer than any snapshot falls in the last stripe.
+  stripes_.emplace(kMaxSequenceNumber, TombstoneStripe(ucmp));
+}
+
+RangeDelAggregator::RangeDelAggregator(const InternalKeyComparator& icmp,
+                                       SequenceNumber upper_bound)
+    : icmp_(icmp), upper_bound_(upper_bound), empty_(true) {
+  stripes_.emplace(kMaxSequenceNumber,
+                   TombstoneStripe(icmp_.user_comparator()));
+}
+
+SequenceNumber RangeDelAggregator::MaxCoveringTombstoneSeqnum(
+    InternalIterator* iter, const Comparator* ucmp, const Slice& user_key,
+    SequenceNumber snapshot) {
+  SequenceNumber max_seq = 0;
+  // Tombstones are sorted by their begin key, so we can stop at the first one
+  // that starts after the key.
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ParsedInternalKey parsed;
+    if (!ParseInternalKey(iter->key(), &parsed)) {
+      continue;
+    }
+    if (ucmp->Compare(parsed.user_key, user_key) > 0) {
+      break;
+    }
+    if (parsed.sequence > snapshot || parsed.sequence <= max_seq) {
+      continue;
+    }
+    if (ucmp->Compare(user_key, iter->value()) < 0) {
+      max_seq = parsed.sequence;
+    }
+  }
+  return max_seq;
+}
+
+RangeDelAggregator::TombstoneStripe& RangeDelAggregator::GetStripe(
+    SequenceNumber seq) {
+  // The stripe of a sequence number is the one of the earliest snapshot that
+  // can see it.
+  auto it = stripes_.lower_bound(seq);
+  assert(it != stripes_.end());
+  return it->second;
+}
+
+const RangeDelAggregator::FragmentVector& RangeDelAggregator::GetFragments(
+    TombstoneStripe* stripe) {
+  if (stripe->dirty) {
+    stripe->fragments.clear();
+    for (const auto& entry : stripe->tombstones) {
+      if (!stripe->fragments.empty() &&
+          stripe->fragments.back().second == entry.second) {
+        // Adjacent fragments with the same sequence number form one range.
+        continue;
+      }
+      stripe->fragments.emplace_back(Slice(entry.first), entry.second);
+    }
+    stripe->dirty = false;
+  }
+  return stripe->fragments;
+}
+
+int RangeDelAggregator::FindFragment(const FragmentVector& fragments,
+                                     const Slice& user_key) {
+  const Comparator* ucmp = icmp_.user_comparator();
+  auto it = std::upper_bound(
+      fragments.begin(), fragments.end(), user_key,
+      [ucmp](const Slice& key, const std::pair<Slice, SequenceNumber>& frag) {
+        return ucmp->Compare(key, frag.first) < 0;
+      });
+  return static_cast<int>(it - fragments.begin()) - 1;
+}
+
+void RangeDelAggregator::AddTombstone(const Slice& begin_key,
+                                      const Slice& end_key,
+                                      SequenceNumber seq) {
+  const Comparator* ucmp = icmp_.user_comparator();
+  if (ucmp->Compare(begin_key, end_key) >= 0) {
+    // Empty range
+    return;
+  }
+  TombstoneStripe& stripe = GetStripe(seq);
+  TombstoneMap& tombstones = stripe.tombstones;
+
+  // Split the existing fragments at both ends of the new range, keeping the
+  // sequence number that was in effect at each split point.
+  auto seq_at = [&tombstones](const std::string& key) -> SequenceNumber {
+    auto it = tombstones.upper_bound(key);
+    if (it == tombstones.begin()) {
+      return 0;
+    }
+    return (--it)->second;
+  };
+  std::string begin = begin_key.ToString();
+  std::string end = end_key.ToString();
+  if (tombstones.find(end) == tombstones.end()) {
+    SequenceNumber end_seq = seq_at(end);
+    tombstones.emplace(end, end_seq);
+  }
+  auto it = tombstones.find(begin);
+  if (it == tombstones.end()) {
+    it = tombstones.emplace(begin, seq_at(begin)).first;
+  }
+  for (; ucmp->Compare(it->first, end) < 0; ++it) {
+    it->second = std::max(it->second, seq);
+  }
+  stripe.dirty = true;
+  empty_ = false;
+}
+
+Status RangeDelAggregator::AddTombstones(
+    std::unique_ptr<InternalIterator> input) {
+  if (input == nullptr) {
+    return Status::OK();
+  }
+  for (input->SeekToFirst(); input->Valid(); input->Next()) {
+    ParsedInternalKey parsed;
+    if (!ParseInternalKey(input->key(), &parsed)) {
+      return Status::Corruption("Unable to parse range tombstone InternalKey");
+    }
+    if (parsed.sequence > upper_bound_) {
+      continue;
+    }
+    AddTombstone(parsed.user_key, input->value(), parsed.sequence);
+  }
+  return input->status();
+}
+
+bool RangeDelAggregator::ShouldDelete(const ParsedInternalKey& parsed) {
+  if (empty_) {
+    return false;
+  }
+  const FragmentVector& fragments = GetFragments(&GetStripe(parsed.sequence));
+  int idx = FindFragment(fragments, parsed.user_key);
+  return idx >= 0 && fragments[idx].second > parsed.sequence;
+}
+
+bool RangeDelAggregator::ShouldDeleteRange(const Slice& start,
+                                           const Slice& end,
+                                           SequenceNumber smallest_seqno,
+                                           SequenceNumber largest_seqno) {
+  if (empty_) {
+    return false;
+  }
+  TombstoneStripe* stripe = &GetStripe(smallest_seqno);
+  if (stripe != &GetStripe(largest_seqno)) {
+    // A snapshot sits between the keys of the range; some of them may have to
+    // be kept for it.
+    return false;
+  }
+  const Comparator* ucmp = icmp_.user_comparator();
+  const FragmentVector& fragments = GetFragments(stripe);
+  int idx = FindFragment(fragments, start);
+  if (idx < 0) {
+    return false;
+  }
+  for (size_t i = static_cast<size_t>(idx);
+       i < fragments.size() && ucmp->Compare(fragments[i].first, end) <= 0;
+       ++i) {
+    if (fragments[i].second <= largest_seqno) {
+      return false;
+    }
+  }
+  return true;
+}
+
+void RangeDelAggregator::CollectTombstones(
+    const Slice* lower_bound, const Slice* upper_bound, bool bottommost_level,
+    std::vector<RangeTombstone>* output) {
+  if (empty_) {
+    return;
+  }
+  const Comparator* ucmp = icmp_.user_comparator();
+  for (auto stripe_it = stripes_.begin(); stripe_it != stripes_.end();
+       ++stripe_it) {
+    if (bottommost_level && stripe_it == stripes_.begin()) {
+      // Tombstones not protected by any snapshot have already deleted all the
+      // keys they could cover.
+      continue;
+    }
+    const FragmentVector& fragments = GetFragments(&stripe_it->second);
+    for (size_t i = 0; i + 1 < fragments.size(); ++i) {
+      if (fragments[i].second == 0) {
+        continue;
+      }
+      Slice start = fragments[i].first;
+      Slice end = fragments[i + 1].first;
+      if (lower_bound != nullptr && ucmp->Compare(start, *lower_bound) < 0) {
+        start = *lower_bound;
+      }
+      if (upper_bound != nullptr && ucmp->Compare(*upper_bound, end) < 0) {
+        end = *upper_bound;
+      }
+      if (ucmp->Compare(start, end) >= 0) {
+        continue;
+      }
+      output->push_back(
+          {start.ToString(), end.ToString(), fragments[i].second});
+    }
+  }
+}
+
+bool RangeDelAggregator::HasTombstonesToOutput(const Slice* lower_bound,
+                                               const Slice* upper_bound,
+                                               bool bottommost_level) {
+  std::vector<RangeTombstone> tombstones;
+  CollectTombstones(lower_bound, upper_bound, bottommost_level, &tombstones);
+  return !tombstones.empty();
+}
+
+Status RangeDelAggregator::AddToBuilder(TableBuilder* builder,
+                                        const Slice* lower_bound,
+                                        const Slice* upper_bound,
+                                        FileMetaData* meta,
+                                        bool bottommost_level) {
+  std::vector<RangeTombstone> tombstones;
+  CollectTombstones(lower_bound, upper_bound, bottommost_level, &tombstones);
+  if (tombstones.empty()) {
+    return Status::OK();
+  }
+
+  std::vector<std::pair<InternalKey, const RangeTombstone*>> entries;
+  entries.reserve(tombstones.size());
+  for (const auto& tombstone : tombstones) {
+    entries.emplace_back(
+        InternalKey(tombstone.start_key, tombstone.seq, kTypeRangeDeletion),
+        &tombstone);
+  }
+  const InternalKeyComparator* icmp = &icmp_;
+  std::sort(entries.begin(), entries.end(),
+            [icmp](const std::pair<InternalKey, const RangeTombstone*>& a,
+                   const std::pair<InternalKey, const RangeTombstone*>& b) {
+              return icmp->Compare(a.first, b.first) < 0;
+            });
+
+  for (const auto& entry : entries) {
+    const RangeTombstone& tombstone = *entry.second;
+    Status s = builder->AddRangeTombstone(entry.first.Encode(),
+                                          tombstone.end_key);
+    if (!s.ok()) {
+      return s;
+    }
+
+    // The file has to cover the whole range so that lookups and compactions
+    // of the range find the tombstone. (end, kMaxSequenceNumber,
+    // kTypeRangeDeletion) sorts before every real entry of the end key, which
+    // keeps the end exclusive.
+    if (meta->smallest.size() == 0 ||
+        icmp_.Compare(entry.first, meta->smallest) < 0) {
+      meta->smallest = entry.first;
+    }
+    InternalKey largest(tombstone.end_key, kMaxSequenceNumber,
+                        kTypeRangeDeletion);
+    if (meta->largest.size() == 0 ||
+        icmp_.Compare(largest, meta->largest) > 0) {
+      meta->largest = largest;
+    }
+    meta->smallest_seqno = std::min(meta->smallest_seqno, tombstone.seq);
+    meta->largest_seqno = std::max(meta->largest_seqno, tombstone.seq);
+  }
+  meta->has_range_deletions = true;
+  return Status::OK();
+}
+
+FragmentedRangeTombstoneList::FragmentedRangeTombstoneList(
+    InternalIterator* iter, const Comparator* ucmp)
+    : ucmp_(ucmp) {
+  struct Tombstone {
+    std::string start_key;
+    std::string end_key;
+    SequenceNumber seq;
+  };
+  std::vector<Tombstone> tombstones;
+  std::vector<std::string> boundaries;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ParsedInternalKey parsed;
+    if (!ParseInternalKey(iter->key(), &parsed) ||
+        ucmp_->Compare(parsed.user_key, iter->value()) >= 0) {
+      continue;
+    }
+    tombstones.push_back({parsed.user_key.ToString(),
+                          iter->value().ToString(), parsed.sequence});
+    boundaries.push_back(tombstones.back().start_key);
+    boundaries.push_back(tombstones.back().end_key);
+  }
+  if (tombstones.empty()) {
+    return;
+  }
+
+  std::sort(boundaries.begin(), boundaries.end(),
+            [ucmp](const std::string& a, const std::string& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  boundaries.erase(
+      std::unique(boundaries.begin(), boundaries.end(),
+                  [ucmp](const std::string& a, const std::string& b) {
+                    return ucmp->Compare(a, b) == 0;
+                  }),
+      boundaries.end());
+
+  // Sweep the boundaries, keeping the tombstones that cover the fragment
+  // starting at each of them. The tombstones come sorted by internal key,
+  // hence by start key.
+  std::vector<const Tombstone*> active;
+  size_t next = 0;
+  for (size_t i = 0; i + 1 < boundaries.size(); i++) {
+    const std::string& start_key = boundaries[i];
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](const Tombstone* t) {
+                                  return ucmp_->Compare(t->end_key,
+                                                        start_key) <= 0;
+                                }),
+                 active.end());
+    for (; next < tombstones.size() &&
+           ucmp_->Compare(tombstones[next].start_key, start_key) <= 0;
+         next++) {
+      active.push_back(&tombstones[next]);
+    }
+    if (active.empty()) {
+      continue;
+    }
+    size_t seq_begin = seqs_.size();
+    for (const Tombstone* t : active) {
+      seqs_.push_back(t->seq);
+    }
+    std::sort(seqs_.begin() + seq_begin, seqs_.end(),
+              std::greater<SequenceNumber>());
+    fragments_.push_back(
+        {start_key, boundaries[i + 1], seq_begin, seqs_.size()});
+  }
+}
+
+SequenceNumber FragmentedRangeTombstoneList::MaxCoveringTombstoneSeqnum(
+    const Slice& user_key, SequenceNumber snapshot) const {
+  // Find the last fragment starting at or before the key.
+  auto it = std::upper_bound(
+      fragments_.begin(), fragments_.end(), user_key,
+      [this](const Slice& key, const Fragment& fragment) {
+        return ucmp_->Compare(key, fragment.start_key) < 0;
+      });
+  if (it == fragments_.begin()) {
+    return 0;
+  }
+  --it;
+  if (ucmp_->Compare(user_key, it->end_key) >= 0) {
+    return 0;
+  }
+  // The sequence numbers are sorted newest first.
+  auto seq = std::lower_bound(seqs_.begin() + it->seq_begin,
+                              seqs_.begin() + it->seq_end, snapshot,
+                              std::greater<SequenceNumber>());
+  return seq == seqs_.begin() + it->seq_end ? 0 : *seq;
+}
+
+size_t FragmentedRangeTombstoneList::ApproximateMemoryUsage() const {
+  size_t usage = fragments_.capacity() * sizeof(Fragment) +
+                 seqs_.capacity() * sizeof(SequenceNumber);
+  for (const auto& fragment : fragments_) {
+    usage += fragment.start_key.capacity() + fragment.end_key.capacity();
+  }
+  return usage;
+}
+
+}  // namespace rocksdb
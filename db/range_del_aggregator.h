@@ -0,0 +1,172 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/status.h"
+#include "table/internal_iterator.h"
+#include "util/stl_wrappers.h"
+
+namespace rocksdb {
+
+struct FileMetaData;
+class TableBuilder;
+
+// RangeDelAggregator collects the range tombstones written by DeleteRange()
+// and answers whether a point key is covered by one of them.
+//
+// Tombstones are partitioned into stripes by the snapshots they were created
+// under: a tombstone may only delete keys that fall in the same snapshot
+// stripe, because every snapshot in between still has to see the key. Within
+// a stripe, overlapping tombstones are flattened into non-overlapping
+// fragments that remember the newest sequence number covering them.
+//
+// Reads use a single stripe bounded by the read sequence number, while flush
+// and compaction use one stripe per live snapshot so that they can drop
+// covered keys and re-emit the tombstones that still matter to their output.
+class RangeDelAggregator {
+ public:
+  // For flush and compaction. "snapshots" must be sorted in ascending order.
+  RangeDelAggregator(const InternalKeyComparator& icmp,
+                     const std::vector<SequenceNumber>& snapshots);
+
+  // For reads. Tombstones newer than "upper_bound" are ignored.
+  RangeDelAggregator(const InternalKeyComparator& icmp,
+                     SequenceNumber upper_bound);
+
+  // Scans the tombstones produced by "iter" and returns the largest sequence
+  // number, no newer than "snapshot", of a tombstone covering "user_key".
+  // Returns 0 if no such tombstone exists. Used by point lookups in a
+  // memtable, whose tombstones change with every DeleteRange(). Table files
+  // use a FragmentedRangeTombstoneList instead.
+  static SequenceNumber MaxCoveringTombstoneSeqnum(InternalIterator* iter,
+                                                   const Comparator* ucmp,
+                                                   const Slice& user_key,
+                                                   SequenceNumber snapshot);
+
+  // Adds all the tombstones produced by "input" to the aggregator. The
+  // iterator keys are encoded (begin_key, seq, kTypeRangeDeletion) and the
+  // values are the exclusive end keys.
+  Status AddTombstones(std::unique_ptr<InternalIterator> input);
+
+  // Returns whether "parsed" is deleted by a tombstone in its own stripe.
+  bool ShouldDelete(const ParsedInternalKey& parsed);
+
+  // Returns whether every key in the user key range [start, end] with a
+  // sequence number in [smallest_seqno, largest_seqno] is deleted. Used to
+  // skip whole compaction input files without reading them.
+  bool ShouldDeleteRange(const Slice& start, const Slice& end,
+                         SequenceNumber smallest_seqno,
+                         SequenceNumber largest_seqno);
+
+  // Returns whether AddToBuilder() would write any tombstone for the user key
+  // range [lower_bound, upper_bound). A nullptr bound is unbounded.
+  bool HasTombstonesToOutput(const Slice* lower_bound, const Slice* upper_bound,
+                             bool bottommost_level);
+
+  // Writes the tombstones clipped to [lower_bound, upper_bound) into
+  // "builder" and extends the boundaries of "meta" to cover them. When
+  // "bottommost_level" is set, tombstones older than the earliest snapshot are
+  // dropped since there is no older data left for them to delete. Fails if
+  // the table format can not store range tombstones.
+  Status AddToBuilder(TableBuilder* builder, const Slice* lower_bound,
+                    const Slice* upper_bound, FileMetaData* meta,
+                    bool bottommost_level);
+
+  bool empty() const { return empty_; }
+
+ private:
+  // Maps the start key of each fragment to the sequence number of the newest
+  // tombstone covering it, 0 meaning "not covered". A fragment extends up to
+  // the next entry of the map.
+  typedef std::map<std::string, SequenceNumber, stl_wrappers::LessOfComparator>
+      TombstoneMap;
+  // Coalesced, contiguous copy of a TombstoneMap used for lookups, so that
+  // they neither allocate nor chase map nodes.
+  typedef std::vector<std::pair<Slice, SequenceNumber>> FragmentVector;
+
+  struct TombstoneStripe {
+    explicit TombstoneStripe(const Comparator* ucmp)
+        : tombstones(stl_wrappers::LessOfComparator(ucmp)), dirty(false) {}
+    TombstoneMap tombstones;
+    FragmentVector fragments;
+    bool dirty;
+  };
+  // Keyed by the upper sequence number bound of each stripe.
+  typedef std::map<SequenceNumber, TombstoneStripe> StripeMap;
+
+  struct RangeTombstone {
+    std::string start_key;
+    std::string end_key;
+    SequenceNumber seq;
+  };
+
+  TombstoneStripe& GetStripe(SequenceNumber seq);
+  const FragmentVector& GetFragments(TombstoneStripe* stripe);
+  // Returns the index of the fragment containing "user_key", or -1 if the key
+  // is before the first fragment.
+  int FindFragment(const FragmentVector& fragments, const Slice& user_key);
+  void AddTombstone(const Slice& begin_key, const Slice& end_key,
+                    SequenceNumber seq);
+  void CollectTombstones(const Slice* lower_bound, const Slice* upper_bound,
+                         bool bottommost_level,
+                         std::vector<RangeTombstone>* output);
+
+  const InternalKeyComparator icmp_;
+  const SequenceNumber upper_bound_;
+  StripeMap stripes_;
+  bool empty_;
+
+  // No copying allowed
+  RangeDelAggregator(const RangeDelAggregator&);
+  void operator=(const RangeDelAggregator&);
+};
+
+// The range tombstones of a table file, split into sorted, non-overlapping
+// fragments. It is built once when the table is opened, so that point
+// lookups binary search it instead of scanning every tombstone.
+class FragmentedRangeTombstoneList {
+ public:
+  // Reads the tombstones produced by "iter", keyed as for
+  // RangeDelAggregator::AddTombstones().
+  FragmentedRangeTombstoneList(InternalIterator* iter, const Comparator* ucmp);
+
+  // Returns the largest sequence number, no newer than "snapshot", of a
+  // tombstone covering "user_key", or 0 if no such tombstone exists.
+  SequenceNumber MaxCoveringTombstoneSeqnum(const Slice& user_key,
+                                            SequenceNumber snapshot) const;
+
+  bool empty() const { return fragments_.empty(); }
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  // The user keys in [start_key, end_key) are covered by the tombstones with
+  // the sequence numbers seqs_[seq_begin, seq_end), newest first.
+  struct Fragment {
+    std::string start_key;
+    std::string end_key;
+    size_t seq_begin;
+    size_t seq_end;
+  };
+
+  const Comparator* ucmp_;
+  std::vector<Fragment> fragments_;
+  std::vector<SequenceNumber> seqs_;
+
+  // No copying allowed
+  FragmentedRangeTombstoneList(const FragmentedRangeTombstoneList&);
+  void operator=(const FragmentedRangeTombstoneList&);
+};
+
+}  // namespace rocksdb
@@ -292,6 +292,8 @@ class Repairer {
       ScopedArenaIterator iter(mem->NewIterator(ro, &arena));
       status = BuildTable(
           dbname_, env_, ioptions_, env_options_, table_cache_, iter.get(),
+          std::unique_ptr<InternalIterator>(
+              mem->NewRangeTombstoneIterator(ro)),
           &meta, icmp_, &int_tbl_prop_collector_factories_,
           TablePropertiesCollectorFactory::Context::kUnknownColumnFamily, {},
           kNoCompression, CompressionOptions(), false, nullptr);
@@ -373,6 +375,38 @@ class Repairer {
       }
       delete iter;
     }
+    if (status.ok()) {
+      // Range tombstones extend the key range of the table
+      std::unique_ptr<InternalIterator> range_del_iter(
+          table_cache_->NewRangeTombstoneIterator(ReadOptions(), icmp_,
+                                                  t->meta.fd));
+      if (range_del_iter != nullptr) {
+        for (range_del_iter->SeekToFirst(); range_del_iter->Valid();
+             range_del_iter->Next()) {
+          ParsedInternalKey parsed;
+          if (!ParseInternalKey(range_del_iter->key(), &parsed)) {
+            continue;
+          }
+          counter++;
+          InternalKey start(parsed.user_key, parsed.sequence,
+                            kTypeRangeDeletion);
+          InternalKey end(range_del_iter->value(), kMaxSequenceNumber,
+                          kTypeRangeDeletion);
+          if (t->meta.smallest.size() == 0 ||
+              icmp_.Compare(start, t->meta.smallest) < 0) {
+            t->meta.smallest = start;
+          }
+          if (t->meta.largest.size() == 0 ||
+              icmp_.Compare(end, t->meta.largest) > 0) {
+            t->meta.largest = end;
+          }
+          t->min_sequence = std::min(t->min_sequence, parsed.sequence);
+          t->max_sequence = std::max(t->max_sequence, parsed.sequence);
+          t->meta.has_range_deletions = true;
+        }
+        status = range_del_iter->status();
+      }
+    }
     Log(InfoLogLevel::INFO_LEVEL,
         options_.info_log, "Table #%" PRIu64 ": %d entries %s",
         t->meta.fd.GetNumber(), counter, status.ToString().c_str());
@@ -406,7 +440,8 @@ class Repairer {
       edit_->AddFile(0, t.meta.fd.GetNumber(), t.meta.fd.GetPathId(),
                      t.meta.fd.GetFileSize(), t.meta.smallest, t.meta.largest,
                      t.min_sequence, t.max_sequence,
-                     t.meta.marked_for_compaction);
+                     t.meta.marked_for_compaction, nullptr /* priv_meta */,
+                     t.meta.has_range_deletions);
     }
 
     //fprintf(stderr, "NewDescriptor:\n%s\n", edit_.DebugString().c_str());
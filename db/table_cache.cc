@@ -9,8 +9,13 @@
 
 #include "db/table_cache.h"
 
+#include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
 #include "db/dbformat.h"
 #include "db/filename.h"
+#include "db/range_del_aggregator.h"
 #include "db/version_edit.h"
 
 #include "rocksdb/statistics.h"
@@ -21,14 +26,78 @@
 #include "table/get_context.h"
 #include "util/coding.h"
 #include "util/file_reader_writer.h"
+#include "util/frequency_sketch.h"
+#include "util/hash.h"
 #include "util/perf_context_imp.h"
 #include "util/stop_watch.h"
 #include "util/sync_point.h"
 
 namespace rocksdb {
 
+// The bytes of the row cache charged to the rows of a column family, per
+// table file.
+struct RowCacheUsage {
+  RowCacheUsage() : total(0) {}
+
+  // Returns false if charging "charge" more bytes would exceed "budget".
+  bool TryCharge(uint64_t file_number, size_t charge, uint64_t budget) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (budget > 0 && total + charge > budget) {
+      return false;
+    }
+    total += charge;
+    per_file[file_number] += charge;
+    return true;
+  }
+
+  void Release(uint64_t file_number, size_t charge) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = per_file.find(file_number);
+    if (iter == per_file.end()) {
+      // The whole file was released already
+      return;
+    }
+    assert(iter->second >= charge && total >= charge);
+    total -= charge;
+    iter->second -= charge;
+    if (iter->second == 0) {
+      per_file.erase(iter);
+    }
+  }
+
+  void ReleaseFile(uint64_t file_number) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto iter = per_file.find(file_number);
+    if (iter != per_file.end()) {
+      total -= iter->second;
+      per_file.erase(iter);
+    }
+  }
+
+  std::mutex mutex;
+  uint64_t total;
+  std::unordered_map<uint64_t, uint64_t> per_file;
+};
+
 namespace {
 
+// The admission filter only inserts rows whose key was looked up at least
+// this many times recently, including the current lookup.
+const uint32_t kRowCacheAdmissionFrequency = 2;
+
+struct RowCacheEntry {
+  std::string replay_log;
+  std::shared_ptr<RowCacheUsage> usage;
+  uint64_t file_number;
+  size_t charge;
+};
+
+static void DeleteRowCacheEntry(const Slice& key, void* value) {
+  RowCacheEntry* entry = reinterpret_cast<RowCacheEntry*>(value);
+  entry->usage->Release(entry->file_number, entry->charge);
+  delete entry;
+}
+
 template <class T>
 static void DeleteEntry(const Slice& key, void* value) {
   T* typed_value = reinterpret_cast<T*>(value);
@@ -70,6 +139,17 @@ TableCache::TableCache(const ImmutableCFOptions& ioptions,
     // If the same cache is shared by multiple instances, we need to
     // disambiguate its entries.
     PutVarint64(&row_cache_id_, ioptions_.row_cache->NewId());
+    row_cache_usage_ = std::make_shared<RowCacheUsage>();
+    if (ioptions_.row_cache_admission_filter) {
+      uint64_t capacity = ioptions_.row_cache->GetCapacity();
+      if (ioptions_.row_cache_budget > 0) {
+        capacity = std::min(capacity, ioptions_.row_cache_budget);
+      }
+      // Size the sketch for rows of a few hundred bytes, but keep its memory
+      // bounded for huge caches.
+      row_cache_sketch_.reset(new FrequencySketch(
+          static_cast<size_t>(std::min<uint64_t>(capacity / 256, 1 << 20))));
+    }
   }
 }
 
@@ -87,15 +167,14 @@ void TableCache::ReleaseHandle(Cache::Handle* handle) {
 Status TableCache::GetTableReader(
     const EnvOptions& env_options,
     const InternalKeyComparator& internal_comparator, const FileDescriptor& fd,
-    bool sequential_mode, bool record_read_stats, HistogramImpl* file_read_hist,
-    unique_ptr<TableReader>* table_reader) {
+    bool sequential_mode, size_t readahead, bool record_read_stats,
+    HistogramImpl* file_read_hist, unique_ptr<TableReader>* table_reader) {
   std::string fname =
       TableFileName(ioptions_.db_paths, fd.GetNumber(), fd.GetPathId());
   unique_ptr<RandomAccessFile> file;
   Status s = ioptions_.env->NewRandomAccessFile(fname, &file, env_options);
-  if (sequential_mode && ioptions_.compaction_readahead_size > 0) {
-    file = NewReadaheadRandomAccessFile(std::move(file),
-                                        ioptions_.compaction_readahead_size);
+  if (s.ok() && readahead > 0) {
+    file = NewReadaheadRandomAccessFile(std::move(file), readahead);
   }
   RecordTick(ioptions_.statistics, NO_FILE_OPENS);
   if (s.ok()) {
@@ -134,8 +213,8 @@ Status TableCache::FindTable(const EnvOptions& env_options,
     }
     unique_ptr<TableReader> table_reader;
     s = GetTableReader(env_options, internal_comparator, fd,
-                       false /* sequential mode */, record_read_stats,
-                       file_read_hist, &table_reader);
+                       false /* sequential mode */, 0 /* readahead */,
+                       record_read_stats, file_read_hist, &table_reader);
     if (!s.ok()) {
       assert(table_reader == nullptr);
       RecordTick(ioptions_.statistics, NO_FILE_ERRORS);
@@ -162,13 +241,26 @@ InternalIterator* TableCache::NewIterator(
 
   TableReader* table_reader = nullptr;
   Cache::Handle* handle = nullptr;
-  bool create_new_table_reader =
-      (for_compaction && ioptions_.new_table_reader_for_compaction_inputs);
+  // Compaction inputs and iterators asking for readahead read the file
+  // through a private table reader, so that their readahead buffer does not
+  // get in the way of other readers.
+  size_t readahead = 0;
+  bool create_new_table_reader = false;
+  if (for_compaction) {
+    if (ioptions_.new_table_reader_for_compaction_inputs) {
+      readahead = ioptions_.compaction_readahead_size;
+      create_new_table_reader = true;
+    }
+  } else {
+    readahead = options.readahead_size;
+    create_new_table_reader = readahead > 0;
+  }
   if (create_new_table_reader) {
     unique_ptr<TableReader> table_reader_unique_ptr;
     Status s = GetTableReader(
-        env_options, icomparator, fd, /* sequential mode */ true,
-        /* record stats */ false, nullptr, &table_reader_unique_ptr);
+        env_options, icomparator, fd, /* sequential mode */ true, readahead,
+        /* record stats */ !for_compaction, file_read_hist,
+        &table_reader_unique_ptr);
     if (!s.ok()) {
       return NewErrorInternalIterator(s, arena);
     }
@@ -206,6 +298,30 @@ InternalIterator* TableCache::NewIterator(
   return result;
 }
 
+InternalIterator* TableCache::NewRangeTombstoneIterator(
+    const ReadOptions& options, const InternalKeyComparator& icomparator,
+    const FileDescriptor& fd) {
+  TableReader* table_reader = fd.table_reader;
+  Cache::Handle* handle = nullptr;
+  if (table_reader == nullptr) {
+    Status s = FindTable(env_options_, icomparator, fd, &handle,
+                         options.read_tier == kBlockCacheTier /* no_io */);
+    if (!s.ok()) {
+      return NewErrorInternalIterator(s);
+    }
+    table_reader = GetTableReaderFromHandle(handle);
+  }
+  InternalIterator* result = table_reader->NewRangeTombstoneIterator(options);
+  if (handle != nullptr) {
+    if (result != nullptr) {
+      result->RegisterCleanup(&UnrefEntry, cache_, handle);
+    } else {
+      ReleaseHandle(handle);
+    }
+  }
+  return result;
+}
+
 Status TableCache::Get(const ReadOptions& options,
                        const InternalKeyComparator& internal_comparator,
                        const FileDescriptor& fd, const Slice& k,
@@ -238,18 +354,35 @@ Status TableCache::Get(const ReadOptions& options,
     row_cache_key.TrimAppend(row_cache_key.Size(), user_key.data(),
                              user_key.size());
 
+    // Hits count as accesses too, so that the sketch knows the hot keys
+    // when their rows move to new files. A lookup is recorded once, however
+    // many files it searches.
+    uint32_t frequency = kRowCacheAdmissionFrequency;
+    if (row_cache_sketch_) {
+      if (get_context->row_cache_frequency() == 0) {
+        get_context->set_row_cache_frequency(
+            row_cache_sketch_->Record(GetSliceHash(user_key)));
+      }
+      frequency = get_context->row_cache_frequency();
+    }
+
     if (auto row_handle = ioptions_.row_cache->Lookup(row_cache_key.GetKey())) {
-      auto found_row_cache_entry = static_cast<const std::string*>(
+      auto found_row_cache_entry = static_cast<const RowCacheEntry*>(
           ioptions_.row_cache->Value(row_handle));
-      replayGetContextLog(*found_row_cache_entry, user_key, get_context);
+      replayGetContextLog(found_row_cache_entry->replay_log, user_key,
+                          get_context);
       ioptions_.row_cache->Release(row_handle);
       RecordTick(ioptions_.statistics, ROW_CACHE_HIT);
       return Status::OK();
     }
 
-    // Not found, setting up the replay log.
     RecordTick(ioptions_.statistics, ROW_CACHE_MISS);
-    row_cache_entry = &row_cache_entry_buffer;
+    if (frequency >= kRowCacheAdmissionFrequency) {
+      // Not found, setting up the replay log.
+      row_cache_entry = &row_cache_entry_buffer;
+    } else {
+      RecordTick(ioptions_.statistics, ROW_CACHE_REJECT);
+    }
   }
 #endif  // ROCKSDB_LITE
 
@@ -262,9 +395,20 @@ Status TableCache::Get(const ReadOptions& options,
     }
   }
   if (s.ok()) {
+    SequenceNumber covering_seq = 0;
+    auto* range_dels = t->GetFragmentedRangeTombstones();
+    if (range_dels != nullptr) {
+      covering_seq = range_dels->MaxCoveringTombstoneSeqnum(
+          ExtractUserKey(k), GetInternalKeySeqno(k));
+    }
+    get_context->SetMaxCoveringTombstoneSeq(covering_seq);
     get_context->SetReplayLog(row_cache_entry);  // nullptr if no cache.
     s = t->Get(options, k, get_context);
+    if (s.ok() && covering_seq > 0) {
+      get_context->MarkKeyDeletedByRangeTombstone();
+    }
     get_context->SetReplayLog(nullptr);
+    get_context->SetMaxCoveringTombstoneSeq(0);
     if (handle != nullptr) {
       ReleaseHandle(handle);
     }
@@ -278,11 +422,20 @@ Status TableCache::Get(const ReadOptions& options,
   // Put the replay log in row cache only if something was found.
   if (s.ok() && row_cache_entry && !row_cache_entry->empty()) {
     size_t charge =
-        row_cache_key.Size() + row_cache_entry->size() + sizeof(std::string);
-    void* row_ptr = new std::string(std::move(*row_cache_entry));
-    auto row_handle = ioptions_.row_cache->Insert(
-        row_cache_key.GetKey(), row_ptr, charge, &DeleteEntry<std::string>);
-    ioptions_.row_cache->Release(row_handle);
+        row_cache_key.Size() + row_cache_entry->size() + sizeof(RowCacheEntry);
+    if (row_cache_usage_->TryCharge(fd.GetNumber(), charge,
+                                    ioptions_.row_cache_budget)) {
+      RowCacheEntry* entry = new RowCacheEntry();
+      entry->replay_log = std::move(*row_cache_entry);
+      entry->usage = row_cache_usage_;
+      entry->file_number = fd.GetNumber();
+      entry->charge = charge;
+      auto row_handle = ioptions_.row_cache->Insert(
+          row_cache_key.GetKey(), entry, charge, &DeleteRowCacheEntry);
+      ioptions_.row_cache->Release(row_handle);
+    } else {
+      RecordTick(ioptions_.statistics, ROW_CACHE_REJECT);
+    }
   }
 #endif  // ROCKSDB_LITE
 
@@ -341,4 +494,18 @@ void TableCache::Evict(Cache* cache, uint64_t file_number) {
   cache->Erase(GetSliceForFileNumber(&file_number));
 }
 
+void TableCache::ReleaseRowCacheUsage(uint64_t file_number) {
+  if (row_cache_usage_) {
+    row_cache_usage_->ReleaseFile(file_number);
+  }
+}
+
+uint64_t TableCache::GetRowCacheUsage() const {
+  if (!row_cache_usage_) {
+    return 0;
+  }
+  std::lock_guard<std::mutex> lock(row_cache_usage_->mutex);
+  return row_cache_usage_->total;
+}
+
 }  // namespace rocksdb
@@ -10,6 +10,7 @@
 // Thread-safe (provides internal synchronization)
 
 #pragma once
+#include <memory>
 #include <string>
 #include <vector>
 #include <stdint.h>
@@ -27,9 +28,11 @@ namespace rocksdb {
 class Env;
 class Arena;
 struct FileDescriptor;
+class FrequencySketch;
 class GetContext;
 class HistogramImpl;
 class InternalIterator;
+struct RowCacheUsage;
 
 class TableCache {
  public:
@@ -51,6 +54,14 @@ class TableCache {
       HistogramImpl* file_read_hist = nullptr, bool for_compaction = false,
       Arena* arena = nullptr);
 
+  // Return an iterator over the range tombstones of the specified file, or
+  // nullptr if the file has none. On error, an iterator with a non-ok
+  // status is returned.
+  InternalIterator* NewRangeTombstoneIterator(
+      const ReadOptions& options,
+      const InternalKeyComparator& internal_comparator,
+      const FileDescriptor& file_fd);
+
   // If a seek to internal key "k" in specified file finds an entry,
   // call (*handle_result)(arg, found_key, found_value) repeatedly until
   // it returns false.
@@ -62,6 +73,15 @@ class TableCache {
   // Evict any entry for the specified file number
   static void Evict(Cache* cache, uint64_t file_number);
 
+  // Stops counting the rows of the specified file against the row cache
+  // budget. Called once the file is not part of any version anymore, so
+  // its rows can never be looked up again and just age out of the cache.
+  void ReleaseRowCacheUsage(uint64_t file_number);
+
+  // Returns the bytes of the row cache used by the rows of the files that
+  // were not released.
+  uint64_t GetRowCacheUsage() const;
+
   // Find table reader
   Status FindTable(const EnvOptions& toptions,
                    const InternalKeyComparator& internal_comparator,
@@ -95,17 +115,24 @@ class TableCache {
   void ReleaseHandle(Cache::Handle* handle);
 
  private:
-  // Build a table reader
+  // Build a table reader. If "readahead" is non-zero, the file is read in
+  // chunks of at least that many bytes.
   Status GetTableReader(const EnvOptions& env_options,
                         const InternalKeyComparator& internal_comparator,
                         const FileDescriptor& fd, bool sequential_mode,
-                        bool record_read_stats, HistogramImpl* file_read_hist,
+                        size_t readahead, bool record_read_stats,
+                        HistogramImpl* file_read_hist,
                         unique_ptr<TableReader>* table_reader);
 
   const ImmutableCFOptions& ioptions_;
   const EnvOptions& env_options_;
   Cache* const cache_;
   std::string row_cache_id_;
+  // Shared with the row cache entries, which may outlive the table cache.
+  std::shared_ptr<RowCacheUsage> row_cache_usage_;
+  // Estimates how often the user keys were looked up recently, if
+  // ioptions_.row_cache_admission_filter is set.
+  std::unique_ptr<FrequencySketch> row_cache_sketch_;
 };
 
 }  // namespace rocksdb
@@ -34,6 +34,8 @@ class IntTblPropCollector {
   virtual UserCollectedProperties GetReadableProperties() const = 0;
 
   virtual bool NeedCompact() const { return false; }
+
+  virtual uint64_t NewestEntryTime() const { return 0; }
 };
 
 // Factory for internal table properties collector.
@@ -106,6 +108,10 @@ class UserKeyTablePropertiesCollector : public IntTblPropCollector {
     return collector_->NeedCompact();
   }
 
+  virtual uint64_t NewestEntryTime() const override {
+    return collector_->NewestEntryTime();
+  }
+
  protected:
   std::unique_ptr<TablePropertiesCollector> collector_;
 };
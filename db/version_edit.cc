@@ -43,8 +43,10 @@ enum Tag {
 enum CustomTag {
   kTerminate = 1,  // The end of customized fields
   kNeedCompaction = 2,
+  kNewestEntryTime = 3,
   kPrivMeta = 10,
   kPathId = 65,
+  kRangeDeletions = 66,
 };
 // If this bit for the custom tag is set, opening DB should fail if
 // we don't know this field.
@@ -124,7 +126,8 @@ bool VersionEdit::EncodeTo(std::string* dst, Env* env) const {
       return false;
     }
     bool has_customized_fields = false;
-    if (f.marked_for_compaction || f.priv_meta != nullptr) {
+    if (f.marked_for_compaction || f.priv_meta != nullptr ||
+        f.has_range_deletions || f.newest_entry_time != 0) {
       PutVarint32(dst, kNewFile4);
       has_customized_fields = true;
     } else if (f.fd.GetPathId() == 0) {
@@ -171,7 +174,11 @@ bool VersionEdit::EncodeTo(std::string* dst, Env* env) const {
       //   tag kPathId: 1 byte as path_id
       //   tag kNeedCompaction:
       //        now only can take one char value 1 indicating need-compaction
+      //   tag kNewestEntryTime: varint64 time of the newest entry of the file
       //   tag kPrivMeta: Allow Env to store private metadata
+      //   tag kRangeDeletions:
+      //        now only can take one char value 1 indicating that the file
+      //        carries range tombstones
       //
       if (f.fd.GetPathId() != 0) {
         PutVarint32(dst, CustomTag::kPathId);
@@ -183,6 +190,17 @@ bool VersionEdit::EncodeTo(std::string* dst, Env* env) const {
         char p = static_cast<char>(1);
         PutLengthPrefixedSlice(dst, Slice(&p, 1));
       }
+      if (f.newest_entry_time != 0) {
+        PutVarint32(dst, CustomTag::kNewestEntryTime);
+        std::string varint_time;
+        PutVarint64(&varint_time, f.newest_entry_time);
+        PutLengthPrefixedSlice(dst, Slice(varint_time));
+      }
+      if (f.has_range_deletions) {
+        PutVarint32(dst, CustomTag::kRangeDeletions);
+        char p = static_cast<char>(1);
+        PutLengthPrefixedSlice(dst, Slice(&p, 1));
+      }
       if (f.priv_meta != nullptr) {
         PutVarint32(dst, CustomTag::kPrivMeta);
         // EncodePrivateMetadata returns a string formatted by the storage
@@ -281,6 +299,17 @@ const char* VersionEdit::DecodeNewFile4From(Slice* input) {
           }
           f.marked_for_compaction = (field[0] == 1);
           break;
+        case kNewestEntryTime:
+          if (!GetVarint64(&field, &f.newest_entry_time)) {
+            return "newest_entry_time field wrong size";
+          }
+          break;
+        case kRangeDeletions:
+          if (field.size() != 1) {
+            return "range_deletions field wrong size";
+          }
+          f.has_range_deletions = (field[0] == 1);
+          break;
         case kPrivMeta:
           if (field.size() < 1) {
             return "Env private metadata field wrong size";
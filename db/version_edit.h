@@ -93,6 +93,11 @@ struct FileMetaData {
 
   bool marked_for_compaction;  // True if client asked us nicely to compact this
                                // file.
+  bool has_range_deletions;    // True if the file has a range tombstone
+                               // meta block.
+  uint64_t newest_entry_time;  // Time at which the newest entry of the file
+                               // was written, 0 if unknown. See
+                               // ColumnFamilyOptions::expired_files_ttl.
 
   FileMetaData()
       : refs(0),
@@ -107,7 +112,9 @@ struct FileMetaData {
         raw_key_size(0),
         raw_value_size(0),
         init_stats_from_file(false),
-        marked_for_compaction(false) {}
+        marked_for_compaction(false),
+        has_range_deletions(false),
+        newest_entry_time(0) {}
 
   // REQUIRED: Keys must be given to the function in sorted order (it expects
   // the last key to be the largest).
@@ -152,15 +159,22 @@ struct FdWithKeyRange {
   FileDescriptor fd;
   Slice smallest_key;    // slice that contain smallest key
   Slice largest_key;     // slice that contain largest key
+  // copy of FileMetaData::newest_entry_time, 0 if an older file of the
+  // version overlaps this one
+  uint64_t newest_entry_time;
 
   FdWithKeyRange()
       : fd(),
         smallest_key(),
-        largest_key() {
+        largest_key(),
+        newest_entry_time(0) {
   }
 
   FdWithKeyRange(FileDescriptor _fd, Slice _smallest_key, Slice _largest_key)
-      : fd(_fd), smallest_key(_smallest_key), largest_key(_largest_key) {}
+      : fd(_fd),
+        smallest_key(_smallest_key),
+        largest_key(_largest_key),
+        newest_entry_time(0) {}
 };
 
 // Data structure to store an array of FdWithKeyRange in one level
@@ -213,7 +227,8 @@ class VersionEdit {
                uint64_t file_size, const InternalKey& smallest,
                const InternalKey& largest, const SequenceNumber& smallest_seqno,
                const SequenceNumber& largest_seqno, bool marked_for_compaction,
-               void* priv_meta = nullptr) {
+               void* priv_meta = nullptr, bool has_range_deletions = false,
+               uint64_t newest_entry_time = 0) {
     assert(smallest_seqno <= largest_seqno);
     FileMetaData f;
     f.fd = FileDescriptor(file, file_path_id, file_size);
@@ -223,6 +238,8 @@ class VersionEdit {
     f.largest_seqno = largest_seqno;
     f.SetPrivateMetadata(priv_meta);
     f.marked_for_compaction = marked_for_compaction;
+    f.has_range_deletions = has_range_deletions;
+    f.newest_entry_time = newest_entry_time;
     new_files_.emplace_back(level, f);
   }
 
@@ -59,6 +59,9 @@ TEST_F(VersionEditTest, EncodeDecodeNewFile4) {
   edit.AddFile(5, 302, 0, 100, InternalKey("foo", kBig + 502, kTypeValue),
                InternalKey("zoo", kBig + 602, kTypeDeletion), kBig + 502,
                kBig + 602, true);
+  edit.AddFile(5, 303, 0, 100, InternalKey("foo", kBig + 503, kTypeValue),
+               InternalKey("zoo", kBig + 603, kTypeDeletion), kBig + 503,
+               kBig + 603, false, nullptr, false, kBig + 700);
 
   edit.DeleteFile(4, 700);
 
@@ -77,6 +80,9 @@ TEST_F(VersionEditTest, EncodeDecodeNewFile4) {
   ASSERT_TRUE(new_files[0].second.marked_for_compaction);
   ASSERT_TRUE(!new_files[1].second.marked_for_compaction);
   ASSERT_TRUE(new_files[2].second.marked_for_compaction);
+  ASSERT_TRUE(!new_files[3].second.marked_for_compaction);
+  ASSERT_EQ(0U, new_files[2].second.newest_entry_time);
+  ASSERT_EQ(kBig + 700, new_files[3].second.newest_entry_time);
   ASSERT_EQ(3, new_files[0].second.fd.GetPathId());
   ASSERT_EQ(3, new_files[1].second.fd.GetPathId());
   ASSERT_EQ(0, new_files[2].second.fd.GetPathId());
@@ -29,6 +29,7 @@
 #include "db/log_writer.h"
 #include "db/memtable.h"
 #include "db/merge_context.h"
+#include "db/range_del_aggregator.h"
 #include "db/table_cache.h"
 #include "db/compaction.h"
 #include "db/version_builder.h"
@@ -37,6 +38,7 @@
 #include "rocksdb/merge_operator.h"
 #include "table/internal_iterator.h"
 #include "table/table_reader.h"
+#include "table/iterator_wrapper.h"
 #include "table/merger.h"
 #include "table/two_level_iterator.h"
 #include "table/format.h"
@@ -320,6 +322,7 @@ Version::~Version() {
           cfd_->table_cache()->ReleaseHandle(f->table_reader_handle);
           f->table_reader_handle = nullptr;
         }
+        cfd_->table_cache()->ReleaseRowCacheUsage(f->fd.GetNumber());
         vset_->obsolete_files_.push_back(f);
       }
     }
@@ -359,9 +362,19 @@ void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
     f.fd = files[i]->fd;
     f.smallest_key = Slice(mem, smallest_size);
     f.largest_key = Slice(mem + smallest_size, largest_size);
+    f.newest_entry_time = files[i]->newest_entry_time;
   }
 }
 
+uint64_t ExpiredFileThreshold(Env* env, uint64_t ttl) {
+  int64_t now;
+  if (ttl == 0 || !env->GetCurrentTime(&now).ok() || now <= 0 ||
+      static_cast<uint64_t>(now) <= ttl) {
+    return 0;
+  }
+  return static_cast<uint64_t>(now) - ttl;
+}
+
 static bool AfterFile(const Comparator* ucmp,
                       const Slice* user_key, const FdWithKeyRange* f) {
   // nullptr user_key occurs before all keys and is therefore never after *f
@@ -480,14 +493,16 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
                          const EnvOptions& env_options,
                          const InternalKeyComparator& icomparator,
                          HistogramImpl* file_read_hist, bool for_compaction,
-                         bool prefix_enabled)
+                         bool prefix_enabled,
+                         const std::set<uint64_t>* skip_files = nullptr)
       : TwoLevelIteratorState(prefix_enabled),
         table_cache_(table_cache),
         read_options_(read_options),
         env_options_(env_options),
         icomparator_(icomparator),
         file_read_hist_(file_read_hist),
-        for_compaction_(for_compaction) {}
+        for_compaction_(for_compaction),
+        skip_files_(skip_files) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& meta_handle) override {
     if (meta_handle.size() != sizeof(FileDescriptor)) {
@@ -496,6 +511,9 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
     } else {
       const FileDescriptor* fd =
           reinterpret_cast<const FileDescriptor*>(meta_handle.data());
+      if (skip_files_ != nullptr && skip_files_->count(fd->GetNumber()) > 0) {
+        return NewEmptyInternalIterator();
+      }
       return table_cache_->NewIterator(
           read_options_, env_options_, icomparator_, *fd,
           nullptr /* don't need reference to table*/, file_read_hist_,
@@ -514,6 +532,7 @@ class LevelFileIteratorState : public TwoLevelIteratorState {
   const InternalKeyComparator& icomparator_;
   HistogramImpl* file_read_hist_;
   bool for_compaction_;
+  const std::set<uint64_t>* skip_files_;
 };
 
 // A wrapper of version builder which references the current version in
@@ -736,7 +755,8 @@ uint64_t VersionStorageInfo::GetEstimatedActiveKeys() const {
 
 void Version::AddIterators(const ReadOptions& read_options,
                            const EnvOptions& soptions,
-                           MergeIteratorBuilder* merge_iter_builder) {
+                           MergeIteratorBuilder* merge_iter_builder,
+                           RangeDelAggregator* range_del_agg) {
   assert(storage_info_.finalized_);
 
   if (storage_info_.num_non_empty_levels() == 0) {
@@ -746,6 +766,24 @@ void Version::AddIterators(const ReadOptions& read_options,
 
   auto* arena = merge_iter_builder->GetArena();
 
+  if (range_del_agg != nullptr) {
+    for (int level = 0; level < storage_info_.num_non_empty_levels();
+         level++) {
+      for (const auto* file : storage_info_.LevelFiles(level)) {
+        if (!file->has_range_deletions) {
+          continue;
+        }
+        Status s = range_del_agg->AddTombstones(
+            std::unique_ptr<InternalIterator>(
+                cfd_->table_cache()->NewRangeTombstoneIterator(
+                    read_options, cfd_->internal_comparator(), file->fd)));
+        if (!s.ok()) {
+          merge_iter_builder->AddIterator(NewErrorInternalIterator(s, arena));
+        }
+      }
+    }
+  }
+
   // Merge all level zero files together since they may overlap
   for (size_t i = 0; i < storage_info_.LevelFilesBrief(0).num_files; i++) {
     const auto& file = storage_info_.LevelFilesBrief(0).files[i];
@@ -791,6 +829,7 @@ VersionStorageInfo::VersionStorageInfo(
       files_by_compaction_pri_(num_levels_),
       level0_non_overlapping_(false),
       next_file_to_compact_by_size_(num_levels_),
+      min_newest_entry_time_(0),
       compaction_score_(num_levels_),
       compaction_level_(num_levels_),
       l0_delay_trigger_count_(0),
@@ -857,8 +896,19 @@ void Version::Get(const ReadOptions& read_options,
       storage_info_.files_, user_key, ikey, &storage_info_.level_files_brief_,
       storage_info_.num_non_empty_levels_, &storage_info_.file_indexer_,
       user_comparator(), internal_comparator());
+  // Files whose newest entry expired only hold expired entries and are
+  // about to be dropped, see ColumnFamilyOptions::expired_files_ttl. The
+  // brief only has the time of the files that no older file overlaps.
+  const uint64_t expired_threshold =
+      ExpiredFileThreshold(env_, cfd_->ioptions()->expired_files_ttl);
+
   FdWithKeyRange* f = fp.GetNextFile();
   while (f != nullptr) {
+    if (f->newest_entry_time != 0 &&
+        f->newest_entry_time < expired_threshold) {
+      f = fp.GetNextFile();
+      continue;
+    }
     *status = table_cache_->Get(
         read_options, *internal_comparator(), f->fd, ikey, &get_context,
         cfd_->internal_stats()->GetFileReadHist(fp.GetHitFileLevel()));
@@ -921,6 +971,38 @@ void VersionStorageInfo::GenerateLevelFilesBrief() {
     DoGenerateLevelFilesBrief(
         &level_files_brief_[level], files_[level], &arena_);
   }
+
+  // An expired file hides the older versions of its keys. Unless no older
+  // file overlaps it, skipping or dropping it would bring them back.
+  const Comparator* ucmp = internal_comparator_->user_comparator();
+  for (int level = 0; level < num_non_empty_levels_; level++) {
+    auto& brief = level_files_brief_[level];
+    for (size_t i = 0; i < brief.num_files; i++) {
+      FdWithKeyRange& f = brief.files[i];
+      if (f.newest_entry_time == 0) {
+        continue;
+      }
+      const Slice smallest = ExtractUserKey(f.smallest_key);
+      const Slice largest = ExtractUserKey(f.largest_key);
+      bool overlap = false;
+      // Level 0 files are sorted from the newest to the oldest
+      for (size_t j = i + 1; level == 0 && j < brief.num_files; j++) {
+        const FdWithKeyRange& older = brief.files[j];
+        if (ucmp->Compare(smallest, ExtractUserKey(older.largest_key)) <= 0 &&
+            ucmp->Compare(largest, ExtractUserKey(older.smallest_key)) >= 0) {
+          overlap = true;
+          break;
+        }
+      }
+      for (int deeper = level + 1;
+           !overlap && deeper < num_non_empty_levels_; deeper++) {
+        overlap = OverlapInLevel(deeper, &smallest, &largest);
+      }
+      if (overlap) {
+        f.newest_entry_time = 0;
+      }
+    }
+  }
 }
 
 void Version::PrepareApply(
@@ -1193,6 +1275,7 @@ void VersionStorageInfo::ComputeCompactionScore(
     }
   }
   ComputeFilesMarkedForCompaction();
+  ComputeMinNewestEntryTime();
   EstimateCompactionBytesNeeded(mutable_cf_options);
 }
 
@@ -1219,6 +1302,20 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction() {
   }
 }
 
+void VersionStorageInfo::ComputeMinNewestEntryTime() {
+  min_newest_entry_time_ = 0;
+  for (int level = 0; level < num_levels(); level++) {
+    for (size_t i = 0; i < files_[level].size(); i++) {
+      const uint64_t newest_entry_time = ExpirableNewestEntryTime(level, i);
+      if (!files_[level][i]->being_compacted && newest_entry_time != 0 &&
+          (min_newest_entry_time_ == 0 ||
+           newest_entry_time < min_newest_entry_time_)) {
+        min_newest_entry_time_ = newest_entry_time;
+      }
+    }
+  }
+}
+
 namespace {
 
 // used to sort files by size
@@ -2521,7 +2618,8 @@ Status VersionSet::Recover(
       assert(builders_iter != builders.end());
       auto* builder = builders_iter->second->version_builder();
 
-      if (db_options_->max_open_files == -1) {
+      if (db_options_->max_open_files == -1 &&
+          !db_options_->open_files_lazily) {
         // unlimited table cache. Pre-load table handle now.
         // Need to do it out of the mutex.
         builder->LoadTableHandlers(cfd->internal_stats(),
@@ -2976,7 +3074,8 @@ Status VersionSet::WriteSnapshot(log::Writer* log) {
           edit.AddFile(level, f->fd.GetNumber(), f->fd.GetPathId(),
                        f->fd.GetFileSize(), f->smallest, f->largest,
                        f->smallest_seqno, f->largest_seqno,
-                       f->marked_for_compaction);
+                       f->marked_for_compaction, nullptr /* priv_meta */,
+                       f->has_range_deletions, f->newest_entry_time);
         }
       }
       edit.SetLogNumber(cfd->GetLogNumber());
@@ -3179,7 +3278,8 @@ void VersionSet::AddLiveFiles(std::vector<FileDescriptor>* live_list) {
   }
 }
 
-InternalIterator* VersionSet::MakeInputIterator(Compaction* c) {
+InternalIterator* VersionSet::MakeInputIterator(
+    Compaction* c, const std::set<uint64_t>* skip_files) {
   auto cfd = c->column_family_data();
   ReadOptions read_options;
   read_options.verify_checksums =
@@ -3202,6 +3302,10 @@ InternalIterator* VersionSet::MakeInputIterator(Compaction* c) {
       if (c->level(which) == 0) {
         const LevelFilesBrief* flevel = c->input_levels(which);
         for (size_t i = 0; i < flevel->num_files; i++) {
+          if (skip_files != nullptr &&
+              skip_files->count(flevel->files[i].fd.GetNumber()) > 0) {
+            continue;
+          }
           list[num++] = cfd->table_cache()->NewIterator(
               read_options, env_options_compactions_,
               cfd->internal_comparator(), flevel->files[i].fd, nullptr,
@@ -3215,7 +3319,8 @@ InternalIterator* VersionSet::MakeInputIterator(Compaction* c) {
                 cfd->table_cache(), read_options, env_options_,
                 cfd->internal_comparator(),
                 nullptr /* no per level latency histogram */,
-                true /* for_compaction */, false /* prefix enabled */),
+                true /* for_compaction */, false /* prefix enabled */,
+                skip_files),
             new LevelFileNumIterator(cfd->internal_comparator(),
                                      c->input_levels(which)));
       }
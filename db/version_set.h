@@ -60,6 +60,7 @@ class ColumnFamilyData;
 class ColumnFamilySet;
 class TableCache;
 class MergeIteratorBuilder;
+class RangeDelAggregator;
 
 // Return the smallest index i such that file_level.files[i]->largest >= key.
 // Return file_level.num_files if there is no such file.
@@ -87,6 +88,11 @@ extern void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
                                       const std::vector<FileMetaData*>& files,
                                       Arena* arena);
 
+// Returns the time below which the newest_entry_time of a file means that
+// all its entries were written more than "ttl" seconds ago, or 0 if "ttl" is
+// 0.
+extern uint64_t ExpiredFileThreshold(Env* env, uint64_t ttl);
+
 class VersionStorageInfo {
  public:
   VersionStorageInfo(const InternalKeyComparator* internal_comparator,
@@ -129,8 +135,21 @@ class VersionStorageInfo {
   // ComputeCompactionScore()
   void ComputeFilesMarkedForCompaction();
 
+  // This computes min_newest_entry_time_ and is called by
+  // ComputeCompactionScore()
+  void ComputeMinNewestEntryTime();
+
   // Generate level_files_brief_ from files_
   void GenerateLevelFilesBrief();
+  // Returns the newest_entry_time of the file at position "index" of
+  // "level" if it may be skipped or dropped once it expires, i.e. if no older
+  // file overlaps it, 0 otherwise.
+  // REQUIRES: level_files_brief_ has been generated
+  uint64_t ExpirableNewestEntryTime(int level, size_t index) const {
+    return level < static_cast<int>(level_files_brief_.size())
+               ? level_files_brief_[level].files[index].newest_entry_time
+               : 0;
+  }
   // Sort all files for this version based on their file size and
   // record results in files_by_compaction_pri_. The largest files are listed
   // first.
@@ -240,6 +259,15 @@ class VersionStorageInfo {
     return files_marked_for_compaction_;
   }
 
+  // The oldest ExpirableNewestEntryTime() of the files that are not being
+  // compacted, 0 if none of them has one.
+  // REQUIRES: This version has been saved (see VersionSet::SaveTo)
+  // REQUIRES: DB mutex held during access
+  uint64_t MinNewestEntryTime() const {
+    assert(finalized_);
+    return min_newest_entry_time_;
+  }
+
   int base_level() const { return base_level_; }
 
   // REQUIRES: lock is held
@@ -374,6 +402,11 @@ class VersionStorageInfo {
   // ComputeCompactionScore()
   autovector<std::pair<int, FileMetaData*>> files_marked_for_compaction_;
 
+  // The smallest ExpirableNewestEntryTime() of the files that are not
+  // being compacted, ignoring files without one. Calculated in
+  // ComputeCompactionScore()
+  uint64_t min_newest_entry_time_;
+
   // Level that should be compacted next and its compaction score.
   // Score < 1 means compaction is not strictly needed.  These fields
   // are initialized by Finalize().
@@ -416,9 +449,12 @@ class Version {
  public:
   // Append to *iters a sequence of iterators that will
   // yield the contents of this Version when merged together.
+  // If "range_del_agg" is not nullptr, the range tombstones of the files are
+  // added to it.
   // REQUIRES: This version has been saved (see VersionSet::SaveTo)
   void AddIterators(const ReadOptions&, const EnvOptions& soptions,
-                    MergeIteratorBuilder* merger_iter_builder);
+                    MergeIteratorBuilder* merger_iter_builder,
+                    RangeDelAggregator* range_del_agg = nullptr);
 
   // Lookup the value for key.  If found, store it in *val and
   // return OK.  Else return a non-OK status.
@@ -643,8 +679,11 @@ class VersionSet {
   }
 
   // Create an iterator that reads over the compaction inputs for "*c".
+  // Input files whose numbers are in "skip_files" are not read, e.g. because
+  // range tombstones have deleted their whole content.
   // The caller should delete the iterator when no longer needed.
-  InternalIterator* MakeInputIterator(Compaction* c);
+  InternalIterator* MakeInputIterator(
+      Compaction* c, const std::set<uint64_t>* skip_files = nullptr);
 
   // Add all files listed in any live version to *live.
   void AddLiveFiles(std::vector<FileDescriptor>* live_list);
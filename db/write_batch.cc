@@ -16,10 +16,12 @@
 //    kTypeDeletion varstring
 //    kTypeSingleDeletion varstring
 //    kTypeMerge varstring varstring
+//    kTypeRangeDeletion varstring varstring
 //    kTypeColumnFamilyValue varint32 varstring varstring
 //    kTypeColumnFamilyDeletion varint32 varstring varstring
 //    kTypeColumnFamilySingleDeletion varint32 varstring varstring
 //    kTypeColumnFamilyMerge varint32 varstring varstring
+//    kTypeColumnFamilyRangeDeletion varint32 varstring varstring
 // varstring :=
 //    len: varint32
 //    data: uint8[len]
@@ -36,6 +38,7 @@
 #include "db/snapshot_impl.h"
 #include "db/write_batch_internal.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/table.h"
 #include "util/coding.h"
 #include "util/perf_context_imp.h"
 #include "util/statistics.h"
@@ -134,6 +137,18 @@ Status ReadRecordFromWriteBatch(Slice* input, char* tag,
         return Status::Corruption("bad WriteBatch Merge");
       }
       break;
+    case kTypeColumnFamilyRangeDeletion:
+      if (!GetVarint32(input, column_family)) {
+        return Status::Corruption("bad WriteBatch DeleteRange");
+      }
+    // intentional fallthrough
+    case kTypeRangeDeletion:
+      // for range delete, "key" is begin_key, "value" is end_key
+      if (!GetLengthPrefixedSlice(input, key) ||
+          !GetLengthPrefixedSlice(input, value)) {
+        return Status::Corruption("bad WriteBatch DeleteRange");
+      }
+      break;
     case kTypeLogData:
       assert(blob != nullptr);
       if (!GetLengthPrefixedSlice(input, blob)) {
@@ -187,6 +202,11 @@ Status WriteBatch::Iterate(Handler* handler) const {
         s = handler->MergeCF(column_family, key, value);
         found++;
         break;
+      case kTypeColumnFamilyRangeDeletion:
+      case kTypeRangeDeletion:
+        s = handler->DeleteRangeCF(column_family, key, value);
+        found++;
+        break;
       case kTypeLogData:
         handler->LogData(blob);
         break;
@@ -325,6 +345,26 @@ void WriteBatch::SingleDelete(ColumnFamilyHandle* column_family,
   WriteBatchInternal::SingleDelete(this, GetColumnFamilyID(column_family), key);
 }
 
+void WriteBatchInternal::DeleteRange(WriteBatch* b, uint32_t column_family_id,
+                                     const Slice& begin_key,
+                                     const Slice& end_key) {
+  WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
+  if (column_family_id == 0) {
+    b->rep_.push_back(static_cast<char>(kTypeRangeDeletion));
+  } else {
+    b->rep_.push_back(static_cast<char>(kTypeColumnFamilyRangeDeletion));
+    PutVarint32(&b->rep_, column_family_id);
+  }
+  PutLengthPrefixedSlice(&b->rep_, begin_key);
+  PutLengthPrefixedSlice(&b->rep_, end_key);
+}
+
+void WriteBatch::DeleteRange(ColumnFamilyHandle* column_family,
+                             const Slice& begin_key, const Slice& end_key) {
+  WriteBatchInternal::DeleteRange(this, GetColumnFamilyID(column_family),
+                                  begin_key, end_key);
+}
+
 void WriteBatchInternal::Merge(WriteBatch* b, uint32_t column_family_id,
                                const Slice& key, const Slice& value) {
   WriteBatchInternal::SetCount(b, WriteBatchInternal::Count(b) + 1);
@@ -569,6 +609,36 @@ class MemTableInserter : public WriteBatch::Handler {
     return Status::OK();
   }
 
+  virtual Status DeleteRangeCF(uint32_t column_family_id,
+                               const Slice& begin_key,
+                               const Slice& end_key) override {
+    Status seek_status;
+    if (!SeekToColumnFamily(column_family_id, &seek_status)) {
+      ++sequence_;
+      return seek_status;
+    }
+    MemTable* mem = cf_mems_->GetMemTable();
+    auto* moptions = mem->GetMemTableOptions();
+    // Only block-based tables can store the tombstones once the memtable is
+    // flushed.
+    if (strcmp(moptions->table_factory->Name(), "BlockBasedTable") != 0) {
+      ++sequence_;
+      return Status::NotSupported(
+          "DeleteRange is only supported by BlockBasedTable");
+    }
+    if (moptions->inplace_update_support) {
+      // In-place updates keep the sequence number of the overwritten entry,
+      // which would let an older tombstone hide a newer value.
+      ++sequence_;
+      return Status::NotSupported(
+          "DeleteRange is not compatible with inplace_update_support");
+    }
+    mem->Add(sequence_, kTypeRangeDeletion, begin_key, end_key);
+    sequence_++;
+    cf_mems_->CheckMemtableFull();
+    return Status::OK();
+  }
+
   virtual Status MergeCF(uint32_t column_family_id, const Slice& key,
                          const Slice& value) override {
     Status seek_status;
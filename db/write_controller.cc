@@ -16,11 +16,13 @@ std::unique_ptr<WriteControllerToken> WriteController::GetStopToken() {
   return std::unique_ptr<WriteControllerToken>(new StopWriteToken(this));
 }
 
-std::unique_ptr<WriteControllerToken> WriteController::GetDelayToken() {
+std::unique_ptr<WriteControllerToken> WriteController::GetDelayToken(
+    uint64_t delayed_write_rate) {
   if (total_delayed_++ == 0) {
     last_refill_time_ = 0;
     bytes_left_ = 0;
   }
+  set_delayed_write_rate(delayed_write_rate);
   return std::unique_ptr<WriteControllerToken>(new DelayWriteToken(this));
 }
 
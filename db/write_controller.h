@@ -25,7 +25,7 @@ class WriteController {
         total_delayed_(0),
         bytes_left_(0),
         last_refill_time_(0) {
-    set_delayed_write_rate(delayed_write_rate);
+    set_max_delayed_write_rate(delayed_write_rate);
   }
   ~WriteController() = default;
 
@@ -33,10 +33,12 @@ class WriteController {
   // stopped until the stop token is released (deleted)
   std::unique_ptr<WriteControllerToken> GetStopToken();
   // When an actor (column family) requests a delay token, total delay for all
-  // writes to the DB will be controlled under the delayed write rate. Every
-  // write needs to call GetDelay() with number of bytes writing to the DB,
-  // which returns number of microseconds to sleep.
-  std::unique_ptr<WriteControllerToken> GetDelayToken();
+  // writes to the DB will be controlled under the delayed write rate, which
+  // is set to "delayed_write_rate" (capped by the maximum rate). Every write
+  // needs to call GetDelay() with number of bytes writing to the DB, which
+  // returns number of microseconds to sleep.
+  std::unique_ptr<WriteControllerToken> GetDelayToken(
+      uint64_t delayed_write_rate);
 
   // these two metods are querying the state of the WriteController
   bool IsStopped() const;
@@ -45,13 +47,31 @@ class WriteController {
   // num_bytes: how many number of bytes to put into the DB.
   // Prerequisite: DB mutex held.
   uint64_t GetDelay(Env* env, uint64_t num_bytes);
+  // The rate writes are currently limited to while delayed. Column families
+  // adjust it gradually, based on how their compaction debt evolves, between
+  // a small floor and max_delayed_write_rate().
   void set_delayed_write_rate(uint64_t delayed_write_rate) {
     delayed_write_rate_ = delayed_write_rate;
     if (delayed_write_rate_ == 0) {
       // avoid divide 0
       delayed_write_rate_ = 1U;
+    } else if (delayed_write_rate_ > max_delayed_write_rate_) {
+      delayed_write_rate_ = max_delayed_write_rate_;
     }
   }
+  uint64_t delayed_write_rate() const { return delayed_write_rate_; }
+
+  // The rate given by DBOptions::delayed_write_rate, which writes are never
+  // delayed to more than.
+  void set_max_delayed_write_rate(uint64_t max_delayed_write_rate) {
+    max_delayed_write_rate_ = max_delayed_write_rate;
+    if (max_delayed_write_rate_ == 0) {
+      // avoid divide 0
+      max_delayed_write_rate_ = 1U;
+    }
+    delayed_write_rate_ = max_delayed_write_rate_;
+  }
+  uint64_t max_delayed_write_rate() const { return max_delayed_write_rate_; }
 
  private:
   friend class WriteControllerToken;
@@ -63,6 +83,7 @@ class WriteController {
   uint64_t bytes_left_;
   uint64_t last_refill_time_;
   uint64_t delayed_write_rate_;
+  uint64_t max_delayed_write_rate_;
 };
 
 class WriteControllerToken {
@@ -32,12 +32,12 @@ TEST_F(WriteControllerTest, SanityTest) {
 
   TimeSetEnv env;
 
-  auto delay_token_1 = controller.GetDelayToken();
+  auto delay_token_1 = controller.GetDelayToken(10000000u);
   ASSERT_EQ(static_cast<uint64_t>(2000000),
             controller.GetDelay(&env, 20000000u));
 
   env.now_micros_ += 1999900u;  // sleep debt 1000
-  auto delay_token_2 = controller.GetDelayToken();
+  auto delay_token_2 = controller.GetDelayToken(10000000u);
   // One refill: 10240 bytes allowed, 1000 used, 9240 left
   ASSERT_EQ(static_cast<uint64_t>(1124), controller.GetDelay(&env, 1000u));
   env.now_micros_ += 1124u;  // sleep debt 0
@@ -94,6 +94,27 @@ TEST_F(WriteControllerTest, SanityTest) {
   ASSERT_FALSE(controller.IsStopped());
 }
 
+TEST_F(WriteControllerTest, DelayedWriteRate) {
+  WriteController controller(10000000u);
+  ASSERT_EQ(10000000u, controller.max_delayed_write_rate());
+  ASSERT_EQ(10000000u, controller.delayed_write_rate());
+
+  TimeSetEnv env;
+  auto delay_token_1 = controller.GetDelayToken(5000000u);
+  ASSERT_EQ(5000000u, controller.delayed_write_rate());
+  ASSERT_EQ(static_cast<uint64_t>(2000000),
+            controller.GetDelay(&env, 10000000u));
+
+  // The rate never exceeds the maximum.
+  auto delay_token_2 = controller.GetDelayToken(20000000u);
+  ASSERT_EQ(10000000u, controller.delayed_write_rate());
+  controller.set_delayed_write_rate(0);
+  ASSERT_EQ(1u, controller.delayed_write_rate());
+
+  controller.set_max_delayed_write_rate(2000000u);
+  ASSERT_EQ(2000000u, controller.delayed_write_rate());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -200,6 +200,22 @@ class DB {
     return SingleDelete(options, DefaultColumnFamily(), key);
   }
 
+  // Remove the database entries in the range ["begin_key", "end_key"), i.e.,
+  // including "begin_key" and excluding "end_key". Returns OK on success, and
+  // a non-OK status on error. It is not an error if no keys exist in the range.
+  // The whole range is recorded as a single tombstone, which is dropped
+  // together with the keys it covers during compaction.
+  // Range deletions are only supported by BlockBasedTable, are not compatible
+  // with inplace_update_support and are not visible to tailing iterators.
+  // Note: consider setting options.sync = true.
+  virtual Status DeleteRange(const WriteOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& begin_key, const Slice& end_key);
+  virtual Status DeleteRange(const WriteOptions& options,
+                             const Slice& begin_key, const Slice& end_key) {
+    return DeleteRange(options, DefaultColumnFamily(), begin_key, end_key);
+  }
+
   // Merge the database entry for "key" with "value".  Returns OK on success,
   // and a non-OK status on error. The semantics of this operation is
   // determined by the user provided merge_operator when opening DB.
@@ -350,6 +366,13 @@ class DB {
 //  "rocksdb.estimate-pending-compaction-bytes" - estimated total number of
 //      bytes compaction needs to rewrite the data to get all levels down
 //      to under target size. Not valid for other compactions than level-based.
+//  "rocksdb.actual-delayed-write-rate" - the rate, in bytes per second, writes
+//      to the DB are currently limited to. 0 if writes are not delayed.
+//  "rocksdb.is-write-stopped" - 1 if writes to the DB are stopped.
+//  "rocksdb.row-cache-usage" - bytes of DBOptions::row_cache used by the rows
+//      of the column family, see ColumnFamilyOptions::row_cache_budget.
+//  "rocksdb.table-readers-ready" - 0 while files are still being opened in
+//      the background after DB::Open(), see DBOptions::open_files_lazily.
 //  "rocksdb.aggregated-table-properties" - returns a string representation of
 //      the aggregated table properties of the target column family.
 //  "rocksdb.aggregated-table-properties-at-level<N>", same as the previous
@@ -383,6 +406,10 @@ class DB {
     static const std::string kEstimateLiveDataSize;
     static const std::string kTotalSstFilesSize;
     static const std::string kEstimatePendingCompactionBytes;
+    static const std::string kActualDelayedWriteRate;
+    static const std::string kIsWriteStopped;
+    static const std::string kRowCacheUsage;
+    static const std::string kTableReadersReady;
     static const std::string kAggregatedTableProperties;
     static const std::string kAggregatedTablePropertiesAtLevel;
   };
@@ -418,6 +445,10 @@ class DB {
   //  "rocksdb.total-sst-files-size"
   //  "rocksdb.base-level"
   //  "rocksdb.estimate-pending-compaction-bytes"
+  //  "rocksdb.actual-delayed-write-rate"
+  //  "rocksdb.is-write-stopped"
+  //  "rocksdb.row-cache-usage"
+  //  "rocksdb.table-readers-ready"
   virtual bool GetIntProperty(ColumnFamilyHandle* column_family,
                               const Slice& property, uint64_t* value) = 0;
   virtual bool GetIntProperty(const Slice& property, uint64_t* value) {
@@ -453,6 +453,13 @@ class RandomAccessFile {
   virtual Status Read(uint64_t offset, size_t n, Slice* result,
                       char* scratch) const = 0;
 
+  // Asks for "n" bytes of the file starting at "offset" to be read into the
+  // OS cache in the background, so that a later Read() of the range does not
+  // have to wait for the device. Does not block.
+  virtual Status Prefetch(uint64_t offset, size_t n) {
+    return Status::NotSupported("Prefetch not supported.");
+  }
+
   // Used by the file_reader_writer to decide if the ReadAhead wrapper
   // should simply forward the call and do not enact buffering or locking.
   virtual bool ShouldForwardRawRequest() const {
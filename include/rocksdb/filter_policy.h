@@ -114,6 +114,12 @@ class FilterPolicy {
 // is 10, which yields a filter with ~ 1% false positive rate.
 // use_block_based_builder: use block based filter rather than full fiter.
 // If you want to builder full filter, it needs to be set to false.
+// use_blocked_full_filter: only used for full filter. Write filters in the
+// cache-line-blocked format, which confines all probes of a key to one
+// 64-byte line and tests them with SIMD instructions where available.
+// Filters written in either full filter format can be read regardless of
+// this setting, but readers older than RocksDB 4.2 treat blocked filters as
+// always matching.
 //
 // Callers must delete the result after any database that is using the
 // result has been closed.
@@ -126,7 +132,7 @@ class FilterPolicy {
 // FilterPolicy (like NewBloomFilterPolicy) that does not ignore
 // trailing spaces in keys.
 extern const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-    bool use_block_based_builder = true);
+    bool use_block_based_builder = true, bool use_blocked_full_filter = false);
 }
 
 #endif  // STORAGE_ROCKSDB_INCLUDE_FILTER_POLICY_H_
@@ -58,6 +58,8 @@ struct ImmutableCFOptions {
 
   std::vector<DbPath> db_paths;
 
+  std::vector<uint32_t> level_path_ids;
+
   MemTableRepFactory* memtable_factory;
 
   TableFactory* table_factory;
@@ -102,6 +104,14 @@ struct ImmutableCFOptions {
   std::vector<std::shared_ptr<EventListener>> listeners;
 
   std::shared_ptr<Cache> row_cache;
+
+  bool row_cache_admission_filter;
+
+  uint64_t row_cache_budget;
+
+  bool compaction_warm_block_cache;
+
+  uint64_t expired_files_ttl;
 };
 
 }  // namespace rocksdb
@@ -19,6 +19,7 @@
 #ifndef STORAGE_ROCKSDB_INCLUDE_ITERATOR_H_
 #define STORAGE_ROCKSDB_INCLUDE_ITERATOR_H_
 
+#include <string>
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 
@@ -95,6 +96,15 @@ class Iterator : public Cleanable {
   // satisfied without doing some IO, then this returns Status::Incomplete().
   virtual Status status() const = 0;
 
+  // Property "rocksdb.iterator.is-key-pinned":
+  //   If returning "1", this means that the Slice returned by key() is valid
+  //   as long as the iterator is not deleted. It can only be "1" for
+  //   iterators created with ReadOptions::pin_data = true.
+  // Property "rocksdb.iterator.pinned-memory-usage":
+  //   Approximate number of bytes of data blocks kept in memory because the
+  //   iterator was created with ReadOptions::pin_data = true.
+  virtual Status GetProperty(std::string prop_name, std::string* prop);
+
  private:
   // No copying allowed
   Iterator(const Iterator&);
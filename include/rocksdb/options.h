@@ -123,9 +123,24 @@ struct CompressionOptions {
   int window_bits;
   int level;
   int strategy;
-  CompressionOptions() : window_bits(-14), level(-1), strategy(0) {}
-  CompressionOptions(int wbits, int _lev, int _strategy)
-      : window_bits(wbits), level(_lev), strategy(_strategy) {}
+  // Maximum size of the dictionary used to prime the compression library.
+  // When non-zero, compactions into the bottommost level sample the data of
+  // their first output file and use the samples as a dictionary when
+  // compressing the data blocks of the following output files. The
+  // dictionary is stored in the file and kept in memory by the table reader.
+  // Only Zlib, LZ4 and ZSTD (>= 0.5) make use of the dictionary; it helps
+  // most with small blocks whose contents look alike.
+  //
+  // Default: 0 (disabled)
+  uint32_t max_dict_bytes;
+  CompressionOptions()
+      : window_bits(-14), level(-1), strategy(0), max_dict_bytes(0) {}
+  CompressionOptions(int wbits, int _lev, int _strategy,
+                     uint32_t _max_dict_bytes = 0)
+      : window_bits(wbits),
+        level(_lev),
+        strategy(_strategy),
+        max_dict_bytes(_max_dict_bytes) {}
 };
 
 enum UpdateStatus {    // Return status For inplace update callback
@@ -474,6 +489,24 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   std::vector<int> max_bytes_for_level_multiplier_additional;
 
+  // Maps levels onto DBOptions::db_paths, e.g. to keep the hot levels on
+  // fast storage and the cold ones on slow storage. Files of level i are
+  // written to db_paths[level_path_ids[i]]; levels past the end of the
+  // vector use its last entry. For example, with db_paths
+  //   [{"/flash_path", 10GB}, {"/hard_drive", 2TB}]
+  // level_path_ids = {0, 0, 1} places L0 and L1 on flash and L2 and higher
+  // on the hard drive. Data moves to the cold path as compactions push it
+  // down the levels, and files that are not on the path of their level,
+  // e.g. after this option changed, are rewritten into it in the
+  // background. Target sizes of db_paths and
+  // CompactRangeOptions::target_path_id are ignored.
+  //
+  // Only supported by level compaction. Out-of-range path IDs are clipped
+  // to the last path.
+  //
+  // Default: empty, files are placed by the target sizes of db_paths
+  std::vector<uint32_t> level_path_ids;
+
   // Maximum number of bytes in all compacted files.  We avoid expanding
   // the lower level file set of a compaction if it would make the
   // total compaction cover more than
@@ -499,8 +532,9 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   int max_grandparent_overlap_factor;
 
-  // Puts are delayed to options.delayed_write_rate when any level has a
-  // compaction score that exceeds soft_rate_limit. This is ignored when == 0.0.
+  // Puts are delayed when any level has a compaction score that exceeds
+  // soft_rate_limit. See delayed_write_rate for how fast delayed writes go.
+  // This is ignored when == 0.0.
   //
   // Default: 0 (disabled)
   //
@@ -510,6 +544,15 @@ struct ColumnFamilyOptions {
   // DEPRECATED -- this options is no longer usde
   double hard_rate_limit;
 
+  // All writes are delayed if estimated bytes needed to be compaction exceed
+  // this threshold. The closer the estimate gets to
+  // hard_pending_compaction_bytes_limit, the slower writes are allowed to go.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint64_t soft_pending_compaction_bytes_limit;
+
   // All writes are stopped if estimated bytes needed to be compaction exceed
   // this threshold.
   //
@@ -681,8 +724,8 @@ struct ColumnFamilyOptions {
                                    Slice delta_value,
                                    std::string* merged_value);
 
-  // if prefix_extractor is set and bloom_bits is not 0, create prefix bloom
-  // for memtable
+  // if prefix_extractor is set or memtable_whole_key_filtering is true, and
+  // bloom_bits is not 0, create a bloom filter for the memtable
   //
   // Dynamically changeable through SetOptions() API
   uint32_t memtable_prefix_bloom_bits;
@@ -701,6 +744,17 @@ struct ColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   size_t memtable_prefix_bloom_huge_page_tlb_size;
 
+  // If true and memtable_prefix_bloom_bits is not 0, the memtable bloom
+  // filter also holds the whole user keys, so that Get() can skip the
+  // memtable without searching it when the key is not there. Does not need
+  // a prefix_extractor. The bloom filter is allocated from the memtable
+  // arena and counted in its memory usage.
+  //
+  // Default: false
+  //
+  // Dynamically changeable through SetOptions() API
+  bool memtable_whole_key_filtering;
+
   // Control locality of bloom filter probes to improve cache miss rate.
   // This option only applies to memtable prefix bloom and plaintable
   // prefix bloom. It essentially limits every bloom checking to one cache line.
@@ -755,6 +809,43 @@ struct ColumnFamilyOptions {
   // Default: false
   bool compaction_measure_io_stats;
 
+  // If non-zero, the rows of this column family may use at most this many
+  // bytes of DBOptions::row_cache; rows that would exceed it are not cached
+  // and counted by the ROW_CACHE_REJECT ticker. Rows of table files that
+  // were deleted stop counting against it. The current usage is reported by
+  // the "rocksdb.row-cache-usage" property.
+  //
+  // Default: 0 (no limit)
+  uint64_t row_cache_budget;
+
+  // If true, compactions keep the block cache warm for the key ranges that
+  // were being read. Before a compaction runs, the data blocks of its input
+  // files that are in the block cache mark the hot key ranges; the blocks of
+  // the output files that overlap them, along with the index and filter
+  // blocks if cache_index_and_filter_blocks is set, are loaded into the block
+  // cache as soon as each output file is written. Once the compaction is
+  // done, the blocks of its input files are erased from the block cache
+  // instead of waiting for the LRU to evict them.
+  //
+  // Only applies to block based tables with a block cache.
+  //
+  // Default: false
+  bool compaction_warm_block_cache;
+
+  // If non-zero, table files whose newest entry was written more than this
+  // many seconds ago are dropped by background compactions without being
+  // read or rewritten, and point lookups skip them. The time of the newest
+  // entry of a file comes from TablePropertiesCollector::NewestEntryTime(),
+  // so this only applies to files built with a collector that reports it,
+  // like the one DBWithTTL installs. Files with range tombstones are never
+  // dropped this way, nor are files that overlap older files, since the
+  // older versions of their keys would come back.
+  //
+  // Files are only dropped with level style compaction.
+  //
+  // Default: 0 (disabled)
+  uint64_t expired_files_ttl;
+
   // Create ColumnFamilyOptions with default values for all fields
   ColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -834,6 +925,16 @@ struct DBOptions {
   // Default: 1
   int max_file_opening_threads;
 
+  // If true and max_open_files is -1, DB::Open() does not open the files
+  // before it returns. Each file is opened on its first access, and
+  // max_file_opening_threads background threads open all of them, level by
+  // level starting with L0, after DB::Open() returns. Lowers the time it
+  // takes to open DBs with many files. The DB property
+  // "rocksdb.table-readers-ready" tells when all the files are open.
+  //
+  // Default: false
+  bool open_files_lazily;
+
   // Once write-ahead logs exceed this size, we will start forcing the flush of
   // column families whose memtables are backed by the oldest live WAL file
   // (i.e. the ones that are causing all the space amplification). If set to 0
@@ -1106,9 +1207,16 @@ struct DBOptions {
   // Default: false
   bool enable_thread_tracking;
 
-  // The limited write rate to DB if soft_rate_limit or
-  // level0_slowdown_writes_trigger is triggered. It is calculated using
+  // The maximum write rate to DB while writes are delayed, i.e. when
+  // soft_rate_limit, soft_pending_compaction_bytes_limit or
+  // level0_slowdown_writes_trigger is triggered, or when only one more
+  // immutable memtable is allowed before writes stop. It is calculated using
   // size of user write requests before compression.
+  // While delayed, the actual rate is lowered step by step as long as the
+  // compaction debt keeps growing, and further as L0 files or pending
+  // compaction bytes get close to their stop triggers. It is raised back step
+  // by step as the debt is paid off. The current rate is reported by the
+  // "rocksdb.actual-delayed-write-rate" property.
   // Unit: byte per second.
   //
   // Default: 1MB/s
@@ -1130,6 +1238,15 @@ struct DBOptions {
   // Default: nullptr (disabled)
   // Not supported in ROCKSDB_LITE mode!
   std::shared_ptr<Cache> row_cache;
+
+  // If true, a row that is not in row_cache is only inserted into it when it
+  // was looked up at least twice recently, as estimated by a TinyLFU
+  // frequency sketch of the looked up keys. This keeps one-off reads from
+  // evicting the frequently read rows. The rows that are not inserted are
+  // counted by the ROW_CACHE_REJECT ticker.
+  //
+  // Default: false
+  bool row_cache_admission_filter;
 };
 
 // Options to control the behavior of a database (passed to DB::Open)
@@ -1248,6 +1365,28 @@ struct ReadOptions {
   // this option.
   bool total_order_seek;
 
+  // If non-zero, NewIterator will create a new table reader for each table
+  // file it reads, which performs reads of the given size. Using a large
+  // size (> 2MB) can improve the performance of forward iteration on
+  // spinning disks.
+  // If zero, iterators prefetch data blocks on their own once they see
+  // blocks being read one after another, starting with 8KB and doubling the
+  // prefetched range up to 256KB.
+  // Default: 0
+  size_t readahead_size;
+
+  // If true, the data blocks read by the iterator are kept referenced until
+  // the iterator is deleted, so that key() and value() can return Slices
+  // that point into block memory instead of copies. Keys stay valid after
+  // the iterator moves, for as long as the iterator is alive, whenever the
+  // "rocksdb.iterator.is-key-pinned" property of the iterator is "1". This
+  // is the case for block based tables written with use_delta_encoding set
+  // to false and for keys in memtables. The memory held by the pinned blocks
+  // is reported by the "rocksdb.iterator.pinned-memory-usage" property.
+  // Ignored by tailing iterators.
+  // Default: false
+  bool pin_data;
+
   ReadOptions();
   ReadOptions(bool cksum, bool cache);
 };
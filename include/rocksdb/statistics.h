@@ -165,6 +165,13 @@ enum Tickers : uint32_t {
   // Row cache.
   ROW_CACHE_HIT,
   ROW_CACHE_MISS,
+  // Rows that were not inserted into the row cache after a miss, because
+  // of the admission filter or the column family's budget.
+  ROW_CACHE_REJECT,
+
+  // Number of times an iterator asked the file to prefetch data blocks after
+  // detecting a sequential scan.
+  NUMBER_BLOCK_PREFETCHES,
 
   TICKER_ENUM_MAX
 };
@@ -244,6 +251,8 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {FILTER_OPERATION_TOTAL_TIME, "rocksdb.filter.operation.time.nanos"},
     {ROW_CACHE_HIT, "rocksdb.row.cache.hit"},
     {ROW_CACHE_MISS, "rocksdb.row.cache.miss"},
+    {ROW_CACHE_REJECT, "rocksdb.row.cache.reject"},
+    {NUMBER_BLOCK_PREFETCHES, "rocksdb.number.block.prefetches"},
 };
 
 /**
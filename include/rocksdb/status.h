@@ -58,6 +58,7 @@ class Status {
     kMutexTimeout = 1,
     kLockTimeout = 2,
     kLockLimit = 3,
+    kDeadlock = 4,
     kMaxSubCode
   };
 
@@ -119,6 +119,25 @@ struct BlockBasedTableOptions {
   // leave this parameter alone.
   int block_restart_interval = 16;
 
+  // Use delta encoding to compress keys in data blocks. Without it every key
+  // is stored in full, which takes more space but lets iterators opened with
+  // ReadOptions::pin_data return keys that point into the block instead of
+  // copies.
+  bool use_delta_encoding = true;
+
+  // If true, append to each data block a small hash table that maps a user
+  // key to its restart interval, so point lookups can skip the binary search
+  // over the restart array. Blocks with more than 253 restart points are
+  // written without it. Requires BytewiseComparator() or
+  // ReverseBytewiseComparator(); opening a DB with another comparator fails.
+  // Tables written with this option cannot be read by RocksDB versions that
+  // predate it.
+  bool data_block_hash_index = false;
+
+  // Number of distinct user keys per hash bucket when data_block_hash_index
+  // is enabled. Lower values use more space and collide less.
+  double data_block_hash_table_util_ratio = 0.75;
+
   // If non-nullptr, use the specified filter policy to reduce disk reads.
   // Many applications will benefit from passing the result of
   // NewBloomFilterPolicy() here.
@@ -143,6 +162,17 @@ struct BlockBasedTableOptions {
   // This option only affects newly written tables. When reading exising tables,
   // the information about version is read from the footer.
   uint32_t format_version = 0;
+
+  // If greater than 1, table builders hand their filled data blocks to a pool
+  // of this many background threads, which compress and checksum them while
+  // the builders keep consuming keys. The pool is shared by all the builders
+  // of the table factory, so concurrent flushes and compactions do not add
+  // threads. Blocks are still written in order, so the output is identical
+  // to the single threaded one. Useful when a slow compression algorithm
+  // limits how fast one flush or compaction can write.
+  // Only takes effect with compression enabled, the kBinarySearch index and
+  // either a full filter or no filter; otherwise blocks are compressed inline.
+  uint32_t parallel_compression_threads = 1;
 };
 
 // Table Properties that are specific to block-based table properties.
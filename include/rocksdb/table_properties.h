@@ -45,6 +45,8 @@ struct TableProperties {
   uint64_t num_data_blocks = 0;
   // the number of entries in this table
   uint64_t num_entries = 0;
+  // the number of range deletion tombstones in this table
+  uint64_t num_range_deletions = 0;
   // format version, reserved for backward compatibility
   uint64_t format_version = 0;
   // If 0, key is variable length. Otherwise number of bytes for each key.
@@ -77,6 +79,7 @@ struct TablePropertiesNames {
   static const std::string kRawValueSize;
   static const std::string kNumDataBlocks;
   static const std::string kNumEntries;
+  static const std::string kNumRangeDeletions;
   static const std::string kFormatVersion;
   static const std::string kFixedKeyLen;
   static const std::string kFilterPolicy;
@@ -139,6 +142,13 @@ class TablePropertiesCollector {
 
   // EXPERIMENTAL Return whether the output file should be further compacted
   virtual bool NeedCompact() const { return false; }
+
+  // EXPERIMENTAL Return the time, in seconds since the epoch, at which the
+  // newest entry of the file was written, or 0 if it is unknown. Files
+  // whose newest entry is older than ColumnFamilyOptions::expired_files_ttl
+  // are dropped without being compacted, so only return a time if none of
+  // the entries of the file may still be needed once it has passed.
+  virtual uint64_t NewestEntryTime() const { return 0; }
 };
 
 // Constructs TablePropertiesCollector. Internals create a new
@@ -89,7 +89,9 @@ struct BackupableDBOptions {
   bool share_files_with_checksum;
 
   // Up to this many background threads will copy files for CreateNewBackup()
-  // and RestoreDBFromBackup()
+  // and RestoreDBFromBackup(), and calculate the checksums of the table files
+  // with share_files_with_checksum. Each copy reads its source on one more
+  // thread, so that reading overlaps with checksumming and writing.
   // Default: 1
   int max_background_operations;
 
@@ -0,0 +1,86 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <string>
+
+#include "rocksdb/db.h"
+#include "rocksdb/utilities/stackable_db.h"
+
+namespace rocksdb {
+
+struct BlobDBOptions {
+  // Name of the directory the value log files are stored in. A relative path
+  // is relative to the DB directory.
+  //
+  // Default: "blob"
+  std::string blob_dir = "blob";
+
+  // Values of at least this many bytes are written to the value log, smaller
+  // values are stored in the LSM tree as usual.
+  //
+  // Default: 4KB
+  uint64_t min_blob_size = 4 << 10;
+
+  // A new value log file is started once the current one reaches this size.
+  //
+  // Default: 256MB
+  uint64_t blob_file_size = 256 << 20;
+
+  // A full value log file is garbage collected once at least this fraction
+  // of its bytes belongs to values that were overwritten or deleted. Its
+  // live values are appended to the current value log file and the file is
+  // deleted. Set it above 1 to only collect garbage on GarbageCollect().
+  //
+  // Default: 0.5
+  double garbage_collection_ratio = 0.5;
+
+  // Iterators read ahead up to this many bytes of a value log file when
+  // consecutive keys point at consecutive values, which is the common case
+  // for data that was written in key order. 0 disables the read ahead.
+  //
+  // Default: 256KB
+  size_t scan_readahead_size = 256 << 10;
+};
+
+// A DB that separates large values from the keys: values of at least
+// BlobDBOptions::min_blob_size bytes are appended once to a value log and the
+// LSM tree only stores (file, offset, size) pointers to them, so that
+// compactions do not rewrite them. Get() and iterators resolve the pointers
+// transparently.
+//
+// Overwriting or deleting a key accounts the size of its old value to the
+// garbage of the value log file holding it, which costs a lookup of the old
+// value's pointer per write. Files whose garbage ratio reaches
+// BlobDBOptions::garbage_collection_ratio are collected in the background.
+//
+// LIMITATIONS:
+// Only the default column family is supported and Merge() is not supported.
+// Writes are serialized. Value log files that were collected are only
+// deleted when the DB holds no snapshots.
+//
+// !!!WARNING!!!:
+// The values stored in the LSM tree are encoded, so a DB created by this API
+// has to be opened with this API.
+class BlobDB : public StackableDB {
+ public:
+  static Status Open(const Options& options,
+                     const BlobDBOptions& blob_db_options,
+                     const std::string& dbname, BlobDB** blob_db);
+
+  // Collects all the full value log files that contain garbage, whatever
+  // their garbage ratio.
+  virtual Status GarbageCollect() = 0;
+
+  virtual BlobDBOptions GetBlobDBOptions() const = 0;
+
+ protected:
+  explicit BlobDB(DB* db) : StackableDB(db) {}
+};
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -28,11 +28,16 @@ namespace rocksdb {
 // (int32_t)Timestamp(creation) is suffixed to values in Put internally
 // Expired TTL values deleted in compaction only:(Timestamp+ttl<time_now)
 // Get/Iterator may return expired entries(compaction not run on them yet)
+// Table files that only hold Puts record their oldest and newest timestamps
+//  in their table properties. Once the newest one expired, the whole file is
+//  dropped by compaction without being rewritten and Get skips it (see
+//  ColumnFamilyOptions::expired_files_ttl, which is set to the ttl)
 // Different TTL may be used during different Opens
 // Example: Open1 at t=0 with ttl=4 and insert k1,k2, close at t=2
 //          Open2 at t=3 with ttl=5. Now k1,k2 should be deleted at t>=5
 // read_only=true opens in the usual read-only mode. Compactions will not be
 //  triggered(neither manual nor automatic), so no expired entries removed
+//  and no expired files skipped
 //
 // CONSTRAINTS:
 // Not specifying/passing or non-positive TTL behaves like TTL = infinity
@@ -51,6 +51,10 @@ class Cursor {
 
 struct DocumentDBOptions {
   int background_threads = 4;
+  // Number of threads CreateIndex() uses to scan the documents. The primary
+  // key range is split at SST file boundaries into ranges that the threads
+  // index independently.
+  int index_build_threads = 4;
   uint64_t memtable_size = 128 * 1024 * 1024;    // 128 MB
   uint64_t cache_size = 1 * 1024 * 1024 * 1024;  // 1 GB
 };
@@ -80,9 +84,11 @@ class DocumentDB : public StackableDB {
 
   explicit DocumentDB(DB* db) : StackableDB(db) {}
 
-  // Create a new index. It will stop all writes for the duration of the call.
-  // All current documents in the DB are scanned and corresponding index entries
-  // are created
+  // Create a new index. All current documents in the DB are scanned and
+  // corresponding index entries are created. Writes are not stopped while the
+  // documents are scanned: they maintain the new index from the start of the
+  // call, and the scan skips the documents they modified. Until the call
+  // returns, queries can not use the index and it can not be dropped.
   virtual Status CreateIndex(const WriteOptions& write_options,
                              const IndexDescriptor& index) = 0;
 
@@ -79,6 +79,16 @@ class GeoDB : public StackableDB {
   // object being inserted here.
   virtual Status Insert(const GeoObject& object) = 0;
 
+  // Insert many objects at once, as if Insert() was called for each of
+  // them. If several objects have the same id, the last one wins.
+  //
+  // The objects are sorted by quadkey. As long as the db holds neither
+  // writes nor table files, they are written to a table file that is added to
+  // the db with AddFile(), bypassing the memtable and the WAL, which is the
+  // fast way to load an initial data set. Otherwise they are inserted in
+  // quadkey order with large write batches.
+  virtual Status BulkInsert(const std::vector<GeoObject>& objects) = 0;
+
   // Retrieve the value of the object located at the specified GPS
   // location and is identified by the 'id'.
   virtual Status GetByPosition(const GeoPosition& pos,
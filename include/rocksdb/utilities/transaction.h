@@ -165,9 +165,15 @@ class Transaction {
   // could cause commit() to fail.  Otherwise, it could return any error
   // that could be returned by DB::Get().
   //
+  // If exclusive is false, the key is locked in shared mode: other
+  // transactions can lock it in shared mode as well, but nobody can write it
+  // until all of them released it.  A shared lock is upgraded to an exclusive
+  // one when this transaction writes the key.  Optimistic transactions ignore
+  // exclusive.
+  //
   // If this transaction was created by a TransactionDB, it can return
   // Status::OK() on success,
-  // Status::Busy() if there is a write conflict,
+  // Status::Busy() if there is a write conflict or a deadlock was detected,
   // Status::TimedOut() if a lock could not be acquired,
   // Status::TryAgain() if the memtable history size is not large enough
   //  (See max_write_buffer_number_to_maintain)
@@ -175,10 +181,11 @@ class Transaction {
   // or other errors if this key could not be read.
   virtual Status GetForUpdate(const ReadOptions& options,
                               ColumnFamilyHandle* column_family,
-                              const Slice& key, std::string* value) = 0;
+                              const Slice& key, std::string* value,
+                              bool exclusive = true) = 0;
 
   virtual Status GetForUpdate(const ReadOptions& options, const Slice& key,
-                              std::string* value) = 0;
+                              std::string* value, bool exclusive = true) = 0;
 
   virtual std::vector<Status> MultiGetForUpdate(
       const ReadOptions& options,
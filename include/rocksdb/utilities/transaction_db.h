@@ -42,9 +42,8 @@ struct TransactionDBOptions {
   //
   // If 0, no waiting is done if a lock cannot instantly be acquired.
   // If negative, there is no timeout.  Not using a timeout is not recommended
-  // as it can lead to deadlocks.  Currently, there is no deadlock-detection to
-  // recover
-  // from a deadlock.
+  // as it can lead to deadlocks, unless all transactions set
+  // TransactionOptions::deadlock_detect.
   int64_t transaction_lock_timeout = 1000;  // 1 second
 
   // If positive, specifies the wait timeout in milliseconds when writing a key
@@ -54,8 +53,8 @@ struct TransactionDBOptions {
   // If negative, there is no timeout and will block indefinitely when acquiring
   // a lock.
   //
-  // Not using a a timeout can lead to deadlocks.  Currently, there
-  // is no deadlock-detection to recover from a deadlock.  While DB writes
+  // Not using a a timeout can lead to deadlocks.  DB writes do not take part
+  // in deadlock detection.  While DB writes
   // cannot deadlock with other DB writes, they can deadlock with a transaction.
   // A negative timeout should only be used if all transactions have an small
   // expiration set.
@@ -95,6 +94,18 @@ struct TransactionOptions {
   //
   // TODO(agiardullo):  Improve performance of checking expiration time.
   int64_t expiration = -1;
+
+  // If true, before waiting for a lock held by other transactions, this
+  // transaction follows the chain of transactions they are waiting for.  If it
+  // leads back to this transaction, the lock request fails immediately with
+  // Status::Busy() and subcode kDeadlock instead of waiting for the lock
+  // timeout.  Only waits of transactions that set deadlock_detect are
+  // considered.
+  bool deadlock_detect = false;
+
+  // The number of transactions deadlock detection follows before it gives up
+  // and reports a deadlock.
+  int64_t deadlock_detect_depth = 50;
 };
 
 class TransactionDB : public StackableDB {
@@ -13,6 +13,7 @@
 #ifndef ROCKSDB_LITE
 
 #include <string>
+#include <vector>
 
 #include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
@@ -177,6 +178,22 @@ class WriteBatchWithIndex : public WriteBatchBase {
                            ColumnFamilyHandle* column_family, const Slice& key,
                            std::string* value);
 
+  // Similar to DB::MultiGet() but will also read writes from this batch,
+  // like GetFromBatchAndDB() does for every key. The keys that cannot be
+  // resolved from the batch alone are read from the DB with a single
+  // DB::MultiGet() call.
+  //
+  // (*values) will be resized to the number of keys, and so will be the
+  // returned statuses. column_families must have one entry per key.
+  std::vector<Status> MultiGetFromBatchAndDB(
+      DB* db, const ReadOptions& read_options,
+      const std::vector<ColumnFamilyHandle*>& column_families,
+      const std::vector<Slice>& keys, std::vector<std::string>* values);
+  // default column family
+  std::vector<Status> MultiGetFromBatchAndDB(
+      DB* db, const ReadOptions& read_options, const std::vector<Slice>& keys,
+      std::vector<std::string>* values);
+
   // Records the state of the batch for future calls to RollbackToSavePoint().
   // May be called multiple times to set multiple save points.
   void SetSavePoint() override;
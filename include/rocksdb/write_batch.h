@@ -84,6 +84,15 @@ class WriteBatch : public WriteBatchBase {
     SingleDelete(nullptr, key);
   }
 
+  // Remove the database entries in the range ["begin_key", "end_key"), i.e.,
+  // including "begin_key" and excluding "end_key". The range tombstone is
+  // recorded as a single entry and consumes one sequence number.
+  void DeleteRange(ColumnFamilyHandle* column_family, const Slice& begin_key,
+                   const Slice& end_key);
+  void DeleteRange(const Slice& begin_key, const Slice& end_key) {
+    DeleteRange(nullptr, begin_key, end_key);
+  }
+
   using WriteBatchBase::Merge;
   // Merge "value" with the existing value of "key" in the database.
   // "key->merge(existing, value)"
@@ -169,6 +178,17 @@ class WriteBatch : public WriteBatchBase {
     }
     virtual void SingleDelete(const Slice& key) {}
 
+    virtual Status DeleteRangeCF(uint32_t column_family_id,
+                                 const Slice& begin_key, const Slice& end_key) {
+      if (column_family_id == 0) {
+        DeleteRange(begin_key, end_key);
+        return Status::OK();
+      }
+      return Status::InvalidArgument(
+          "non-default column family and DeleteRangeCF not implemented");
+    }
+    virtual void DeleteRange(const Slice& begin_key, const Slice& end_key) {}
+
     // Merge and LogData are not pure virtual. Otherwise, we would break
     // existing clients of Handler on a source code level. The default
     // implementation of Merge does nothing.
@@ -8,6 +8,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <jni.h>
 
 #include "include/org_rocksdb_RocksIterator.h"
@@ -142,3 +143,55 @@ jbyteArray Java_org_rocksdb_RocksIterator_value0(
                           reinterpret_cast<const jbyte*>(value_slice.data()));
   return jkeyValue;
 }
+
+/*
+ * Class:     org_rocksdb_RocksIterator
+ * Method:    nextBatch0
+ * Signature: (JLjava/nio/ByteBuffer;II)J
+ */
+jlong Java_org_rocksdb_RocksIterator_nextBatch0(
+    JNIEnv* env, jobject jobj, jlong handle,
+    jobject jbuffer, jint jbuffer_off, jint jbuffer_len) {
+  auto it = reinterpret_cast<rocksdb::Iterator*>(handle);
+  char* buffer = reinterpret_cast<char*>(env->GetDirectBufferAddress(jbuffer));
+  if (buffer == nullptr || jbuffer_off < 0 || jbuffer_len < 0 ||
+      env->GetDirectBufferCapacity(jbuffer) <
+          static_cast<jlong>(jbuffer_off) + jbuffer_len) {
+    rocksdb::RocksDBExceptionJni::ThrowNew(env,
+        rocksdb::Status::InvalidArgument("Invalid direct ByteBuffer."));
+    return 0;
+  }
+  buffer += jbuffer_off;
+
+  // Every entry is written as key length, key, value length, value, with
+  // the lengths as big-endian 32 bit integers, which is what
+  // ByteBuffer.getInt() reads by default.
+  auto put_length = [](char* dst, size_t len) {
+    dst[0] = static_cast<char>((len >> 24) & 0xff);
+    dst[1] = static_cast<char>((len >> 16) & 0xff);
+    dst[2] = static_cast<char>((len >> 8) & 0xff);
+    dst[3] = static_cast<char>(len & 0xff);
+  };
+  const size_t capacity = static_cast<size_t>(jbuffer_len);
+  size_t written = 0;
+  jlong entries = 0;
+  for (; it->Valid(); it->Next()) {
+    rocksdb::Slice key = it->key();
+    rocksdb::Slice value = it->value();
+    const size_t entry_size = 8 + key.size() + value.size();
+    if (entry_size > capacity - written) {
+      break;
+    }
+    char* dst = buffer + written;
+    put_length(dst, key.size());
+    memcpy(dst + 4, key.data(), key.size());
+    dst += 4 + key.size();
+    put_length(dst, value.size());
+    memcpy(dst + 4, value.data(), value.size());
+    written += entry_size;
+    entries++;
+  }
+  // the number of entries goes in the upper half and the number of bytes
+  // written in the lower half
+  return (entries << 32) | static_cast<jlong>(written);
+}
@@ -9,6 +9,8 @@
 #include <jni.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
+#include <algorithm>
 #include <memory>
 #include <string>
 #include <vector>
@@ -388,6 +390,65 @@ void Java_org_rocksdb_RocksDB_put__JJ_3BI_3BIJ(
   }
 }
 
+//////////////////////////////////////////////////////////////////////////////
+// rocksdb::DB::Put with direct ByteBuffers
+
+// Returns the address of the jlen bytes at joffset of the direct ByteBuffer
+// jbuffer, or throws a RocksDBException and returns nullptr if they are not
+// accessible.
+char* rocksdb_direct_buffer_helper(
+    JNIEnv* env, jobject jbuffer, jint joffset, jint jlen) {
+  char* data = nullptr;
+  if (jbuffer != nullptr) {
+    data = reinterpret_cast<char*>(env->GetDirectBufferAddress(jbuffer));
+  }
+  if (data == nullptr || joffset < 0 || jlen < 0 ||
+      env->GetDirectBufferCapacity(jbuffer) <
+          static_cast<jlong>(joffset) + jlen) {
+    rocksdb::RocksDBExceptionJni::ThrowNew(env,
+        rocksdb::Status::InvalidArgument("Invalid direct ByteBuffer."));
+    return nullptr;
+  }
+  return data + joffset;
+}
+
+/*
+ * Class:     org_rocksdb_RocksDB
+ * Method:    putDirect
+ * Signature: (JJLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;IIJ)V
+ */
+void Java_org_rocksdb_RocksDB_putDirect(
+    JNIEnv* env, jobject jdb, jlong jdb_handle, jlong jwrite_options_handle,
+    jobject jkey, jint jkey_off, jint jkey_len,
+    jobject jentry_value, jint jentry_value_off, jint jentry_value_len,
+    jlong jcf_handle) {
+  auto db = reinterpret_cast<rocksdb::DB*>(jdb_handle);
+  static const rocksdb::WriteOptions default_write_options =
+      rocksdb::WriteOptions();
+  const auto& write_options = jwrite_options_handle == 0 ?
+      default_write_options :
+      *reinterpret_cast<rocksdb::WriteOptions*>(jwrite_options_handle);
+  auto cf_handle = jcf_handle == 0 ? db->DefaultColumnFamily() :
+      reinterpret_cast<rocksdb::ColumnFamilyHandle*>(jcf_handle);
+
+  char* key = rocksdb_direct_buffer_helper(env, jkey, jkey_off, jkey_len);
+  if (key == nullptr) {
+    return;
+  }
+  char* value = rocksdb_direct_buffer_helper(
+      env, jentry_value, jentry_value_off, jentry_value_len);
+  if (value == nullptr) {
+    return;
+  }
+
+  // the slices point straight at the native memory of the buffers
+  rocksdb::Status s = db->Put(write_options, cf_handle,
+      rocksdb::Slice(key, jkey_len), rocksdb::Slice(value, jentry_value_len));
+  if (!s.ok()) {
+    rocksdb::RocksDBExceptionJni::ThrowNew(env, s);
+  }
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // rocksdb::DB::Write
 /*
@@ -908,6 +969,141 @@ jint Java_org_rocksdb_RocksDB_get__JJ_3BI_3BIJ(
     return 0;
   }
 }
+//////////////////////////////////////////////////////////////////////////////
+// rocksdb::DB::Get and rocksdb::DB::MultiGet with direct ByteBuffers
+
+/*
+ * Class:     org_rocksdb_RocksDB
+ * Method:    getDirect
+ * Signature: (JJLjava/nio/ByteBuffer;IILjava/nio/ByteBuffer;IIJ)I
+ */
+jint Java_org_rocksdb_RocksDB_getDirect(
+    JNIEnv* env, jobject jdb, jlong jdb_handle, jlong jropt_handle,
+    jobject jkey, jint jkey_off, jint jkey_len,
+    jobject jentry_value, jint jentry_value_off, jint jentry_value_len,
+    jlong jcf_handle) {
+  static const int kNotFound = -1;
+  static const int kStatusError = -2;
+
+  auto db = reinterpret_cast<rocksdb::DB*>(jdb_handle);
+  const auto& read_options = jropt_handle == 0 ? rocksdb::ReadOptions() :
+      *reinterpret_cast<rocksdb::ReadOptions*>(jropt_handle);
+  auto cf_handle = jcf_handle == 0 ? db->DefaultColumnFamily() :
+      reinterpret_cast<rocksdb::ColumnFamilyHandle*>(jcf_handle);
+
+  char* key = rocksdb_direct_buffer_helper(env, jkey, jkey_off, jkey_len);
+  if (key == nullptr) {
+    return kStatusError;
+  }
+  char* value = rocksdb_direct_buffer_helper(
+      env, jentry_value, jentry_value_off, jentry_value_len);
+  if (value == nullptr) {
+    return kStatusError;
+  }
+
+  std::string cvalue;
+  rocksdb::Status s = db->Get(read_options, cf_handle,
+      rocksdb::Slice(key, jkey_len), &cvalue);
+  if (s.IsNotFound()) {
+    return kNotFound;
+  } else if (!s.ok()) {
+    rocksdb::RocksDBExceptionJni::ThrowNew(env, s);
+    return kStatusError;
+  }
+
+  // the value is copied once, straight into the native memory of the buffer
+  int cvalue_len = static_cast<int>(cvalue.size());
+  memcpy(value, cvalue.data(), std::min(jentry_value_len, cvalue_len));
+  return cvalue_len;
+}
+
+/*
+ * Class:     org_rocksdb_RocksDB
+ * Method:    multiGetDirect
+ * Signature: (JJ[J[Ljava/nio/ByteBuffer;[I[I[Ljava/nio/ByteBuffer;[I[I)[I
+ */
+jintArray Java_org_rocksdb_RocksDB_multiGetDirect(
+    JNIEnv* env, jobject jdb, jlong jdb_handle, jlong jropt_handle,
+    jlongArray jcf_handles, jobjectArray jkeys, jintArray jkey_offs,
+    jintArray jkey_lens, jobjectArray jvalues, jintArray jvalue_offs,
+    jintArray jvalue_lens) {
+  static const int kNotFound = -1;
+
+  auto db = reinterpret_cast<rocksdb::DB*>(jdb_handle);
+  const auto& read_options = jropt_handle == 0 ? rocksdb::ReadOptions() :
+      *reinterpret_cast<rocksdb::ReadOptions*>(jropt_handle);
+
+  const jsize num_keys = env->GetArrayLength(jkeys);
+  std::vector<jint> key_offs(num_keys);
+  std::vector<jint> key_lens(num_keys);
+  std::vector<jint> value_offs(num_keys);
+  std::vector<jint> value_lens(num_keys);
+  env->GetIntArrayRegion(jkey_offs, 0, num_keys, key_offs.data());
+  env->GetIntArrayRegion(jkey_lens, 0, num_keys, key_lens.data());
+  env->GetIntArrayRegion(jvalue_offs, 0, num_keys, value_offs.data());
+  env->GetIntArrayRegion(jvalue_lens, 0, num_keys, value_lens.data());
+
+  std::vector<rocksdb::ColumnFamilyHandle*> cf_handles(
+      num_keys, db->DefaultColumnFamily());
+  if (jcf_handles != nullptr) {
+    std::vector<jlong> handles(num_keys);
+    env->GetLongArrayRegion(jcf_handles, 0, num_keys, handles.data());
+    for (jsize i = 0; i < num_keys; i++) {
+      cf_handles[i] =
+          reinterpret_cast<rocksdb::ColumnFamilyHandle*>(handles[i]);
+    }
+  }
+
+  // the keys are not copied, the slices point at the buffers
+  std::vector<rocksdb::Slice> keys;
+  std::vector<char*> values;
+  keys.reserve(num_keys);
+  values.reserve(num_keys);
+  for (jsize i = 0; i < num_keys; i++) {
+    jobject jkey = env->GetObjectArrayElement(jkeys, i);
+    char* key = rocksdb_direct_buffer_helper(env, jkey, key_offs[i],
+                                             key_lens[i]);
+    env->DeleteLocalRef(jkey);
+    if (key == nullptr) {
+      return nullptr;
+    }
+    keys.emplace_back(key, key_lens[i]);
+
+    jobject jvalue = env->GetObjectArrayElement(jvalues, i);
+    char* value = rocksdb_direct_buffer_helper(env, jvalue, value_offs[i],
+                                               value_lens[i]);
+    env->DeleteLocalRef(jvalue);
+    if (value == nullptr) {
+      return nullptr;
+    }
+    values.push_back(value);
+  }
+
+  std::vector<std::string> cvalues;
+  std::vector<rocksdb::Status> s =
+      db->MultiGet(read_options, cf_handles, keys, &cvalues);
+
+  std::vector<jint> value_sizes(num_keys);
+  for (jsize i = 0; i < num_keys; i++) {
+    if (s[i].IsNotFound()) {
+      value_sizes[i] = kNotFound;
+    } else if (!s[i].ok()) {
+      rocksdb::RocksDBExceptionJni::ThrowNew(env, s[i]);
+      return nullptr;
+    } else {
+      int cvalue_len = static_cast<int>(cvalues[i].size());
+      memcpy(values[i], cvalues[i].data(),
+             std::min(value_lens[i], cvalue_len));
+      value_sizes[i] = cvalue_len;
+    }
+  }
+
+  // a single Java array is returned for all the keys
+  jintArray jvalue_sizes = env->NewIntArray(num_keys);
+  env->SetIntArrayRegion(jvalue_sizes, 0, num_keys, value_sizes.data());
+  return jvalue_sizes;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // rocksdb::DB::Delete()
 void rocksdb_remove_helper(
@@ -7,6 +7,7 @@ package org.rocksdb;
 
 import java.util.*;
 import java.io.IOException;
+import java.nio.ByteBuffer;
 import org.rocksdb.util.Environment;
 
 /**
@@ -456,6 +457,107 @@ public class RocksDB extends RocksObject {
         columnFamilyHandle.nativeHandle_);
   }
 
+  /**
+   * Set the database entry for "key" to "value", reading both from the
+   * native memory of direct buffers instead of copying them to the native
+   * heap first.
+   *
+   * <p>The key and the value are the bytes between the position and the
+   * limit of the buffers. The positions of both buffers are set to their
+   * limits.</p>
+   *
+   * @param key the direct buffer holding the key to be inserted.
+   * @param value the direct buffer holding the value associated with the
+   *     specified key.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   */
+  public void put(final ByteBuffer key, final ByteBuffer value)
+      throws RocksDBException {
+    putDirect(0, key, value, 0);
+  }
+
+  /**
+   * Set the database entry for "key" to "value" in the specified
+   * column family, reading both from direct buffers.
+   *
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance
+   * @param key the direct buffer holding the key to be inserted.
+   * @param value the direct buffer holding the value associated with the
+   *     specified key.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #put(ByteBuffer, ByteBuffer)
+   */
+  public void put(final ColumnFamilyHandle columnFamilyHandle,
+      final ByteBuffer key, final ByteBuffer value) throws RocksDBException {
+    putDirect(0, key, value, columnFamilyHandle.nativeHandle_);
+  }
+
+  /**
+   * Set the database entry for "key" to "value", reading both from direct
+   * buffers.
+   *
+   * @param writeOpts {@link org.rocksdb.WriteOptions} instance.
+   * @param key the direct buffer holding the key to be inserted.
+   * @param value the direct buffer holding the value associated with the
+   *     specified key.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #put(ByteBuffer, ByteBuffer)
+   */
+  public void put(final WriteOptions writeOpts, final ByteBuffer key,
+      final ByteBuffer value) throws RocksDBException {
+    putDirect(writeOpts.nativeHandle_, key, value, 0);
+  }
+
+  /**
+   * Set the database entry for "key" to "value" for the specified
+   * column family, reading both from direct buffers.
+   *
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance
+   * @param writeOpts {@link org.rocksdb.WriteOptions} instance.
+   * @param key the direct buffer holding the key to be inserted.
+   * @param value the direct buffer holding the value associated with the
+   *     specified key.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #put(ByteBuffer, ByteBuffer)
+   */
+  public void put(final ColumnFamilyHandle columnFamilyHandle,
+      final WriteOptions writeOpts, final ByteBuffer key,
+      final ByteBuffer value) throws RocksDBException {
+    putDirect(writeOpts.nativeHandle_, key, value,
+        columnFamilyHandle.nativeHandle_);
+  }
+
+  private void putDirect(final long writeOptHandle, final ByteBuffer key,
+      final ByteBuffer value, final long cfHandle) throws RocksDBException {
+    checkDirect(key);
+    checkDirect(value);
+    putDirect(nativeHandle_, writeOptHandle,
+        key, key.position(), key.remaining(),
+        value, value.position(), value.remaining(), cfHandle);
+    key.position(key.limit());
+    value.position(value.limit());
+  }
+
+  private static void checkDirect(final ByteBuffer buffer) {
+    if (!buffer.isDirect()) {
+      throw new IllegalArgumentException("The ByteBuffer must be direct.");
+    }
+  }
+
   /**
    * If the key definitely does not exist in the database, then this method
    * returns false, else true.
@@ -715,6 +817,109 @@ public class RocksDB extends RocksObject {
         value.length, columnFamilyHandle.nativeHandle_);
   }
 
+  /**
+   * Get the value associated with the specified key, reading the key from
+   * and writing the value to the native memory of direct buffers. No Java
+   * array is allocated and the value is only copied once.
+   *
+   * <p>The key is the bytes between the position and the limit of
+   * {@code key}, whose position is set to its limit. The value is written
+   * at the position of {@code value}, whose limit is then set to the end of
+   * the value, so that it is ready to be read.</p>
+   *
+   * @param key the direct buffer holding the key to retrieve the value.
+   * @param value the direct buffer to receive the retrieved value.
+   * @return The size of the actual value that matches the specified
+   *     {@code key} in byte.  If the return value is greater than the
+   *     remaining bytes of {@code value}, then it indicates that the size
+   *     of the buffer {@code value} is insufficient and partial result will
+   *     be returned.  RocksDB.NOT_FOUND will be returned if the value not
+   *     found.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   */
+  public int get(final ByteBuffer key, final ByteBuffer value)
+      throws RocksDBException {
+    return getDirect(0, key, value, 0);
+  }
+
+  /**
+   * Get the value associated with the specified key within column family,
+   * using direct buffers.
+   *
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance
+   * @param key the direct buffer holding the key to retrieve the value.
+   * @param value the direct buffer to receive the retrieved value.
+   * @return The size of the actual value, or RocksDB.NOT_FOUND.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #get(ByteBuffer, ByteBuffer)
+   */
+  public int get(final ColumnFamilyHandle columnFamilyHandle,
+      final ByteBuffer key, final ByteBuffer value) throws RocksDBException {
+    return getDirect(0, key, value, columnFamilyHandle.nativeHandle_);
+  }
+
+  /**
+   * Get the value associated with the specified key, using direct buffers.
+   *
+   * @param opt {@link org.rocksdb.ReadOptions} instance.
+   * @param key the direct buffer holding the key to retrieve the value.
+   * @param value the direct buffer to receive the retrieved value.
+   * @return The size of the actual value, or RocksDB.NOT_FOUND.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #get(ByteBuffer, ByteBuffer)
+   */
+  public int get(final ReadOptions opt, final ByteBuffer key,
+      final ByteBuffer value) throws RocksDBException {
+    return getDirect(opt.nativeHandle_, key, value, 0);
+  }
+
+  /**
+   * Get the value associated with the specified key within column family,
+   * using direct buffers.
+   *
+   * @param columnFamilyHandle {@link org.rocksdb.ColumnFamilyHandle}
+   *     instance
+   * @param opt {@link org.rocksdb.ReadOptions} instance.
+   * @param key the direct buffer holding the key to retrieve the value.
+   * @param value the direct buffer to receive the retrieved value.
+   * @return The size of the actual value, or RocksDB.NOT_FOUND.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if one of the buffers is not direct.
+   * @see #get(ByteBuffer, ByteBuffer)
+   */
+  public int get(final ColumnFamilyHandle columnFamilyHandle,
+      final ReadOptions opt, final ByteBuffer key, final ByteBuffer value)
+      throws RocksDBException {
+    return getDirect(opt.nativeHandle_, key, value,
+        columnFamilyHandle.nativeHandle_);
+  }
+
+  private int getDirect(final long readOptHandle, final ByteBuffer key,
+      final ByteBuffer value, final long cfHandle) throws RocksDBException {
+    checkDirect(key);
+    checkDirect(value);
+    final int size = getDirect(nativeHandle_, readOptHandle,
+        key, key.position(), key.remaining(),
+        value, value.position(), value.remaining(), cfHandle);
+    key.position(key.limit());
+    if (size != NOT_FOUND) {
+      value.limit(value.position() + Math.min(size, value.remaining()));
+    }
+    return size;
+  }
+
   /**
    * The simplified version of get which returns a new byte array storing
    * the value associated with the specified input key if any.  null will be
@@ -932,6 +1137,126 @@ public class RocksDB extends RocksObject {
     return keyValueMap;
   }
 
+  /**
+   * Looks up the values of a list of keys in a single call, reading the keys
+   * from and writing the values to the native memory of direct buffers.
+   * Unlike the other {@code multiGet()} methods it allocates no Java array
+   * per key and no map.
+   *
+   * <p>Every key and value buffer follows the conventions of
+   * {@link #get(ByteBuffer, ByteBuffer)}: the positions of the keys are set
+   * to their limits and the limits of the values found are set to the end
+   * of the value written.</p>
+   *
+   * @param keys direct buffers holding the keys for which values need to be
+   *     retrieved.
+   * @param values direct buffers to receive the values, one per key.
+   * @return the size of the value of every key, or RocksDB.NOT_FOUND. A size
+   *     greater than the remaining bytes of the corresponding value buffer
+   *     indicates a partial result.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if a buffer is not direct or if the
+   *    number of keys and values differ.
+   */
+  public int[] multiGet(final ByteBuffer[] keys, final ByteBuffer[] values)
+      throws RocksDBException {
+    return multiGetDirect(0, null, keys, values);
+  }
+
+  /**
+   * Looks up the values of a list of keys in a single call, using direct
+   * buffers.
+   *
+   * @param opt Read options.
+   * @param keys direct buffers holding the keys for which values need to be
+   *     retrieved.
+   * @param values direct buffers to receive the values, one per key.
+   * @return the size of the value of every key, or RocksDB.NOT_FOUND.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if a buffer is not direct or if the
+   *    number of keys and values differ.
+   * @see #multiGet(ByteBuffer[], ByteBuffer[])
+   */
+  public int[] multiGet(final ReadOptions opt, final ByteBuffer[] keys,
+      final ByteBuffer[] values) throws RocksDBException {
+    return multiGetDirect(opt.nativeHandle_, null, keys, values);
+  }
+
+  /**
+   * Looks up the values of a list of keys in a single call, using direct
+   * buffers.
+   * <p>
+   * Note: Every key needs to have a related column family name in
+   * {@code columnFamilyHandleList}.
+   * </p>
+   *
+   * @param opt Read options.
+   * @param columnFamilyHandleList {@link java.util.List} containing
+   *     {@link org.rocksdb.ColumnFamilyHandle} instances.
+   * @param keys direct buffers holding the keys for which values need to be
+   *     retrieved.
+   * @param values direct buffers to receive the values, one per key.
+   * @return the size of the value of every key, or RocksDB.NOT_FOUND.
+   *
+   * @throws RocksDBException thrown if error happens in underlying
+   *    native library.
+   * @throws IllegalArgumentException if a buffer is not direct or if the
+   *    number of keys, values and column family handles differ.
+   * @see #multiGet(ByteBuffer[], ByteBuffer[])
+   */
+  public int[] multiGet(final ReadOptions opt,
+      final List<ColumnFamilyHandle> columnFamilyHandleList,
+      final ByteBuffer[] keys, final ByteBuffer[] values)
+      throws RocksDBException {
+    if (keys.length != columnFamilyHandleList.size()) {
+      throw new IllegalArgumentException(
+          "For each key there must be a ColumnFamilyHandle.");
+    }
+    final long[] cfHandles = new long[keys.length];
+    for (int i = 0; i < cfHandles.length; i++) {
+      cfHandles[i] = columnFamilyHandleList.get(i).nativeHandle_;
+    }
+    return multiGetDirect(opt.nativeHandle_, cfHandles, keys, values);
+  }
+
+  private int[] multiGetDirect(final long readOptHandle,
+      final long[] cfHandles, final ByteBuffer[] keys,
+      final ByteBuffer[] values) throws RocksDBException {
+    if (keys.length != values.length) {
+      throw new IllegalArgumentException(
+          "For each key there must be a value buffer.");
+    }
+    final int count = keys.length;
+    final int[] keyOffsets = new int[count];
+    final int[] keyLengths = new int[count];
+    final int[] valueOffsets = new int[count];
+    final int[] valueLengths = new int[count];
+    for (int i = 0; i < count; i++) {
+      checkDirect(keys[i]);
+      checkDirect(values[i]);
+      keyOffsets[i] = keys[i].position();
+      keyLengths[i] = keys[i].remaining();
+      valueOffsets[i] = values[i].position();
+      valueLengths[i] = values[i].remaining();
+    }
+
+    final int[] sizes = multiGetDirect(nativeHandle_, readOptHandle,
+        cfHandles, keys, keyOffsets, keyLengths,
+        values, valueOffsets, valueLengths);
+    for (int i = 0; i < count; i++) {
+      keys[i].position(keys[i].limit());
+      if (sizes[i] != NOT_FOUND) {
+        values[i].limit(
+            valueOffsets[i] + Math.min(sizes[i], valueLengths[i]));
+      }
+    }
+    return sizes;
+  }
+
   /**
    * Remove the database entry (if any) for "key".  Returns OK on
    * success, and a non-OK status on error.  It is not an error if "key"
@@ -1706,6 +2031,11 @@ public class RocksDB extends RocksObject {
       long handle, long writeOptHandle,
       byte[] key, int keyLen,
       byte[] value, int valueLen, long cfHandle) throws RocksDBException;
+  protected native void putDirect(
+      long handle, long writeOptHandle,
+      ByteBuffer key, int keyOffset, int keyLen,
+      ByteBuffer value, int valueOffset, int valueLen,
+      long cfHandle) throws RocksDBException;
   protected native void write0(
       long writeOptHandle, long wbHandle) throws RocksDBException;
   protected native void write1(
@@ -1754,6 +2084,16 @@ public class RocksDB extends RocksObject {
   protected native List<byte[]> multiGet(
       long dbHandle, long rOptHandle, List<byte[]> keys, int keysCount,
       List<ColumnFamilyHandle> cfHandles);
+  protected native int getDirect(
+      long handle, long readOptHandle,
+      ByteBuffer key, int keyOffset, int keyLen,
+      ByteBuffer value, int valueOffset, int valueLen,
+      long cfHandle) throws RocksDBException;
+  protected native int[] multiGetDirect(
+      long handle, long readOptHandle, long[] cfHandles,
+      ByteBuffer[] keys, int[] keyOffsets, int[] keyLengths,
+      ByteBuffer[] values, int[] valueOffsets, int[] valueLengths)
+      throws RocksDBException;
   protected native byte[] get(
       long handle, byte[] key, int keyLen) throws RocksDBException;
   protected native byte[] get(
@@ -5,6 +5,8 @@
 
 package org.rocksdb;
 
+import java.nio.ByteBuffer;
+
 /**
  * <p>An iterator that yields a sequence of key/value pairs from a source.
  * Multiple implementations are provided by this library.
@@ -50,6 +52,39 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
     return value0(nativeHandle_);
   }
 
+  /**
+   * <p>Copies the entries starting at the current one into a direct buffer
+   * with a single native call, moving the iterator past them. It stops at
+   * the first entry that does not fit into the remaining bytes of
+   * {@code buffer} and leaves the iterator on it, or when the iterator
+   * becomes invalid.</p>
+   *
+   * <p>Every entry is written at the position of the buffer as the length
+   * of the key, the key, the length of the value and the value, the lengths
+   * being big-endian ints. The limit of the buffer is set to the end of the
+   * last entry, so that the entries can be read with
+   * {@link ByteBuffer#getInt()} and {@link ByteBuffer#get(byte[])} while the
+   * buffer has remaining bytes.</p>
+   *
+   * @param buffer the direct buffer to receive the entries.
+   * @return the number of entries copied. 0 if the iterator is not valid,
+   *     or if the current entry alone is larger than the remaining bytes of
+   *     {@code buffer}.
+   *
+   * @throws RocksDBException if the buffer cannot be accessed.
+   * @throws IllegalArgumentException if the buffer is not direct.
+   */
+  public int nextBatch(final ByteBuffer buffer) throws RocksDBException {
+    assert(isInitialized());
+    if (!buffer.isDirect()) {
+      throw new IllegalArgumentException("The ByteBuffer must be direct.");
+    }
+    final long result = nextBatch0(nativeHandle_, buffer, buffer.position(),
+        buffer.remaining());
+    buffer.limit(buffer.position() + (int) result);
+    return (int) (result >>> 32);
+  }
+
   @Override final native void disposeInternal(long handle);
   @Override final native boolean isValid0(long handle);
   @Override final native void seekToFirst0(long handle);
@@ -61,4 +96,6 @@ public class RocksIterator extends AbstractRocksIterator<RocksDB> {
 
   private native byte[] key0(long handle);
   private native byte[] value0(long handle);
+  private native long nextBatch0(long handle, ByteBuffer buffer, int offset,
+      int length) throws RocksDBException;
 }
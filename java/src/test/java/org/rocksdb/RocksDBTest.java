@@ -9,6 +9,7 @@ import org.junit.Rule;
 import org.junit.Test;
 import org.junit.rules.TemporaryFolder;
 
+import java.nio.ByteBuffer;
 import java.util.ArrayList;
 import java.util.List;
 import java.util.Map;
@@ -223,6 +224,103 @@ public class RocksDBTest {
     }
   }
 
+  private static ByteBuffer directBuffer(final String s) {
+    final byte[] bytes = s.getBytes();
+    final ByteBuffer buffer = ByteBuffer.allocateDirect(bytes.length);
+    buffer.put(bytes);
+    buffer.flip();
+    return buffer;
+  }
+
+  private static byte[] remainingBytes(final ByteBuffer buffer) {
+    final byte[] bytes = new byte[buffer.remaining()];
+    buffer.get(bytes);
+    return bytes;
+  }
+
+  @Test
+  public void putGetDirectBuffers() throws RocksDBException {
+    RocksDB db = null;
+    WriteOptions wOpt = null;
+    ReadOptions rOpt = null;
+    try {
+      db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
+      wOpt = new WriteOptions();
+      rOpt = new ReadOptions();
+      final ByteBuffer key = directBuffer("key1");
+      db.put(key, directBuffer("value"));
+      assertThat(key.remaining()).isEqualTo(0);
+      db.put(wOpt, directBuffer("key2"), directBuffer("12345678"));
+      assertThat(db.get("key1".getBytes())).isEqualTo("value".getBytes());
+
+      ByteBuffer value = ByteBuffer.allocateDirect(16);
+      assertThat(db.get(directBuffer("key2"), value)).isEqualTo(8);
+      assertThat(remainingBytes(value)).isEqualTo("12345678".getBytes());
+
+      // a buffer that is too small receives a partial value
+      value = ByteBuffer.allocateDirect(4);
+      assertThat(db.get(rOpt, directBuffer("key2"), value)).isEqualTo(8);
+      assertThat(remainingBytes(value)).isEqualTo("1234".getBytes());
+
+      value = ByteBuffer.allocateDirect(16);
+      assertThat(db.get(directBuffer("key3"), value)).
+          isEqualTo(RocksDB.NOT_FOUND);
+      assertThat(value.remaining()).isEqualTo(16);
+    } finally {
+      if (db != null) {
+        db.close();
+      }
+      if (wOpt != null) {
+        wOpt.dispose();
+      }
+      if (rOpt != null) {
+        rOpt.dispose();
+      }
+    }
+  }
+
+  @Test(expected = IllegalArgumentException.class)
+  public void putHeapBuffer() throws RocksDBException {
+    RocksDB db = null;
+    try {
+      db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
+      db.put(ByteBuffer.wrap("key1".getBytes()), directBuffer("value"));
+    } finally {
+      if (db != null) {
+        db.close();
+      }
+    }
+  }
+
+  @Test
+  public void multiGetDirectBuffers() throws RocksDBException {
+    RocksDB db = null;
+    ReadOptions rOpt = null;
+    try {
+      db = RocksDB.open(dbFolder.getRoot().getAbsolutePath());
+      rOpt = new ReadOptions();
+      db.put("key1".getBytes(), "value".getBytes());
+      db.put("key2".getBytes(), "12345678".getBytes());
+      final ByteBuffer[] keys = {
+          directBuffer("key1"), directBuffer("key3"), directBuffer("key2")};
+      final ByteBuffer[] values = {
+          ByteBuffer.allocateDirect(16), ByteBuffer.allocateDirect(16),
+          ByteBuffer.allocateDirect(16)};
+      assertThat(db.multiGet(rOpt, keys, values)).
+          isEqualTo(new int[] {5, RocksDB.NOT_FOUND, 8});
+      assertThat(remainingBytes(values[0])).isEqualTo("value".getBytes());
+      assertThat(values[1].remaining()).isEqualTo(16);
+      assertThat(remainingBytes(values[2])).isEqualTo("12345678".getBytes());
+    } finally {
+      if (db != null) {
+        db.close();
+      }
+      if (rOpt != null) {
+        rOpt.dispose();
+      }
+    }
+  }
+
   @Test
   public void merge() throws RocksDBException {
     RocksDB db = null;
@@ -9,6 +9,8 @@ import org.junit.Rule;
 import org.junit.Test;
 import org.junit.rules.TemporaryFolder;
 
+import java.nio.ByteBuffer;
+
 import static org.assertj.core.api.Assertions.assertThat;
 
 public class RocksIteratorTest {
@@ -69,4 +71,54 @@ public class RocksIteratorTest {
       }
     }
   }
+
+  @Test
+  public void nextBatch() throws RocksDBException {
+    RocksDB db = null;
+    Options options = null;
+    RocksIterator iterator = null;
+    try {
+      options = new Options();
+      options.setCreateIfMissing(true);
+      db = RocksDB.open(options,
+          dbFolder.getRoot().getAbsolutePath());
+      db.put("key1".getBytes(), "value1".getBytes());
+      db.put("key2".getBytes(), "value2".getBytes());
+      db.put("key3".getBytes(), "value3".getBytes());
+
+      iterator = db.newIterator();
+      iterator.seekToFirst();
+      // room for two entries of 4 + 4 + 4 + 6 bytes
+      final ByteBuffer buffer = ByteBuffer.allocateDirect(40);
+      assertThat(iterator.nextBatch(buffer)).isEqualTo(2);
+      for (int i = 1; i <= 2; i++) {
+        final byte[] key = new byte[buffer.getInt()];
+        buffer.get(key);
+        final byte[] value = new byte[buffer.getInt()];
+        buffer.get(value);
+        assertThat(key).isEqualTo(("key" + i).getBytes());
+        assertThat(value).isEqualTo(("value" + i).getBytes());
+      }
+      assertThat(buffer.hasRemaining()).isFalse();
+      assertThat(iterator.isValid()).isTrue();
+      assertThat(iterator.key()).isEqualTo("key3".getBytes());
+
+      buffer.clear();
+      assertThat(iterator.nextBatch(buffer)).isEqualTo(1);
+      assertThat(buffer.remaining()).isEqualTo(18);
+      assertThat(iterator.isValid()).isFalse();
+      buffer.clear();
+      assertThat(iterator.nextBatch(buffer)).isEqualTo(0);
+    } finally {
+      if (iterator != null) {
+        iterator.dispose();
+      }
+      if (db != null) {
+        db.close();
+      }
+      if (options != null) {
+        options.dispose();
+      }
+    }
+  }
 }
@@ -31,6 +31,7 @@ LIB_SOURCES =                                                   \
   db/memtable.cc                                                \
   db/memtable_list.cc                                           \
   db/merge_helper.cc                                            \
+  db/range_del_aggregator.cc                                    \
   db/merge_operator.cc                                          \
   db/repair.cc                                                  \
   db/slice.cc                                                   \
@@ -59,6 +60,7 @@ LIB_SOURCES =                                                   \
   table/block_hash_index.cc                                     \
   table/block_prefix_index.cc                                   \
   table/bloom_block.cc                                          \
+  table/data_block_hash_index.cc                                \
   table/cuckoo_table_builder.cc                                 \
   table/cuckoo_table_factory.cc                                 \
   table/cuckoo_table_reader.cc                                  \
@@ -101,6 +103,7 @@ LIB_SOURCES =                                                   \
   util/file_util.cc                                             \
   util/file_reader_writer.cc                                    \
   util/filter_policy.cc                                         \
+  util/frequency_sketch.cc                                      \
   util/hash.cc                                                  \
   util/hash_cuckoo_rep.cc                                       \
   util/hash_linklist_rep.cc                                     \
@@ -109,6 +112,7 @@ LIB_SOURCES =                                                   \
   util/instrumented_mutex.cc                                    \
   util/iostats_context.cc                                       \
   utilities/backupable/backupable_db.cc                         \
+  utilities/blob_db/blob_db_impl.cc                             \
   utilities/convenience/info_log_finder.cc                      \
   utilities/checkpoint/checkpoint.cc                            \
   utilities/compaction_filters/remove_emptyvalue_compactionfilter.cc    \
@@ -194,6 +198,7 @@ TEST_BENCH_SOURCES =                                                    \
   db/db_dynamic_level_test.cc                                           \
   db/db_inplace_update_test.cc                                          \
   db/db_log_iter_test.cc                                                \
+  db/db_range_del_test.cc                                               \
   db/db_universal_compaction_test.cc                                    \
   db/db_tailing_iter_test.cc                                            \
   db/db_wal_test.cc                                                     \
@@ -247,10 +252,12 @@ TEST_BENCH_SOURCES =                                                    \
   util/coding_test.cc                                                   \
   util/crc32c_test.cc                                                   \
   util/dynamic_bloom_test.cc                                            \
+  util/frequency_sketch_test.cc                                         \
   util/env_test.cc                                                      \
   util/filelock_test.cc                                                 \
   util/histogram_test.cc                                                \
   utilities/backupable/backupable_db_test.cc                            \
+  utilities/blob_db/blob_db_test.cc                                     \
   utilities/checkpoint/checkpoint_test.cc                               \
   utilities/document/document_db_test.cc                                \
   utilities/document/json_document_test.cc                              \
@@ -109,6 +109,42 @@ void BlockIter::Seek(const Slice& target) {
   }
 }
 
+void BlockIter::SeekForGet(const Slice& target) {
+  if (data_block_hash_index_ == nullptr) {
+    Seek(target);
+    return;
+  }
+  PERF_TIMER_GUARD(block_seek_nanos);
+  uint8_t entry = data_block_hash_index_->Lookup(
+      data_, data_block_hash_index_offset_, ExtractUserKey(target));
+  if (entry == kCollision) {
+    // The bucket is shared by keys from different restart intervals
+    Seek(target);
+    return;
+  }
+
+  uint32_t index;
+  if (entry == kNoEntry) {
+    // The user key is not in this block. Scanning the last restart interval
+    // either stops at a larger key, ending the lookup, or runs off the end
+    // of the block when target may still be in the next block.
+    index = num_restarts_ - 1;
+  } else {
+    index = entry;
+    if (index >= num_restarts_) {
+      CorruptionError();
+      return;
+    }
+  }
+  SeekToRestartPoint(index);
+  // Linear search (within restart block) for first key >= target
+  while (true) {
+    if (!ParseNextKey() || Compare(key_.GetKey(), target) >= 0) {
+      return;
+    }
+  }
+}
+
 void BlockIter::SeekToFirst() {
   if (data_ == nullptr) {  // Not init yet
     return;
@@ -153,7 +189,13 @@ bool BlockIter::ParseNextKey() {
       CorruptionError();
       return false;
     } else {
-      key_.TrimAppend(shared, p, non_shared);
+      if (shared == 0) {
+        // The key does not share bytes with the previous one, so it can be
+        // referenced in the block directly instead of being copied.
+        key_.SetKey(Slice(p, non_shared), false /* copy */);
+      } else {
+        key_.TrimAppend(shared, p, non_shared);
+      }
       value_ = Slice(p + non_shared, value_length);
       while (restart_index_ + 1 < num_restarts_ &&
              GetRestartPoint(restart_index_ + 1) < current_) {
@@ -294,21 +336,30 @@ bool BlockIter::PrefixSeek(const Slice& target, uint32_t* index) {
   }
 }
 
-uint32_t Block::NumRestarts() const {
-  assert(size_ >= 2*sizeof(uint32_t));
-  return DecodeFixed32(data_ + size_ - sizeof(uint32_t));
-}
-
 Block::Block(BlockContents&& contents)
     : contents_(std::move(contents)),
       data_(contents_.data.data()),
-      size_(contents_.data.size()) {
+      size_(contents_.data.size()),
+      restart_offset_(0),
+      num_restarts_(0),
+      data_block_hash_index_offset_(0) {
   if (size_ < sizeof(uint32_t)) {
     size_ = 0;  // Error marker
   } else {
-    restart_offset_ =
-        static_cast<uint32_t>(size_) - (1 + NumRestarts()) * sizeof(uint32_t);
-    if (restart_offset_ > size_ - sizeof(uint32_t)) {
+    bool has_hash_index;
+    UnPackDataBlockFooter(DecodeFixed32(data_ + size_ - sizeof(uint32_t)),
+                          &has_hash_index, &num_restarts_);
+    uint32_t restarts_end = static_cast<uint32_t>(size_) - sizeof(uint32_t);
+    if (has_hash_index) {
+      if (!data_block_hash_index_.Initialize(data_, restarts_end,
+                                             &data_block_hash_index_offset_)) {
+        size_ = 0;
+        return;
+      }
+      restarts_end = data_block_hash_index_offset_;
+    }
+    restart_offset_ = restarts_end - num_restarts_ * sizeof(uint32_t);
+    if (num_restarts_ > restarts_end / sizeof(uint32_t)) {
       // The size is too small for NumRestarts() and therefore
       // restart_offset_ wrapped around.
       size_ = 0;
@@ -340,12 +391,18 @@ InternalIterator* Block::NewIterator(const Comparator* cmp, BlockIter* iter,
     BlockPrefixIndex* prefix_index_ptr =
         total_order_seek ? nullptr : prefix_index_.get();
 
+    const DataBlockHashIndex* data_block_hash_index_ptr =
+        data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr;
+
     if (iter != nullptr) {
       iter->Initialize(cmp, data_, restart_offset_, num_restarts,
-                    hash_index_ptr, prefix_index_ptr);
+                    hash_index_ptr, prefix_index_ptr,
+                    data_block_hash_index_ptr, data_block_hash_index_offset_);
     } else {
       iter = new BlockIter(cmp, data_, restart_offset_, num_restarts,
-                           hash_index_ptr, prefix_index_ptr);
+                           hash_index_ptr, prefix_index_ptr,
+                           data_block_hash_index_ptr,
+                           data_block_hash_index_offset_);
     }
   }
 
@@ -19,6 +19,7 @@
 #include "db/dbformat.h"
 #include "table/block_prefix_index.h"
 #include "table/block_hash_index.h"
+#include "table/data_block_hash_index.h"
 #include "table/internal_iterator.h"
 
 #include "format.h"
@@ -49,7 +50,7 @@ class Block {
 #endif  // ROCKSDB_MALLOC_USABLE_SIZE
     return size_;
   }
-  uint32_t NumRestarts() const;
+  uint32_t NumRestarts() const { return num_restarts_; }
   CompressionType compression_type() const {
     return contents_.compression_type;
   }
@@ -81,6 +82,9 @@ class Block {
   const char* data_;            // contents_.data.data()
   size_t size_;                 // contents_.data.size()
   uint32_t restart_offset_;     // Offset in data_ of restart array
+  uint32_t num_restarts_;
+  DataBlockHashIndex data_block_hash_index_;
+  uint32_t data_block_hash_index_offset_;  // Offset in data_ of the buckets
   std::unique_ptr<BlockHashIndex> hash_index_;
   std::unique_ptr<BlockPrefixIndex> prefix_index_;
 
@@ -100,19 +104,26 @@ class BlockIter : public InternalIterator {
         restart_index_(0),
         status_(Status::OK()),
         hash_index_(nullptr),
-        prefix_index_(nullptr) {}
+        prefix_index_(nullptr),
+        data_block_hash_index_(nullptr),
+        data_block_hash_index_offset_(0) {}
 
   BlockIter(const Comparator* comparator, const char* data, uint32_t restarts,
        uint32_t num_restarts, BlockHashIndex* hash_index,
-       BlockPrefixIndex* prefix_index)
+       BlockPrefixIndex* prefix_index,
+       const DataBlockHashIndex* data_block_hash_index = nullptr,
+       uint32_t data_block_hash_index_offset = 0)
       : BlockIter() {
     Initialize(comparator, data, restarts, num_restarts,
-        hash_index, prefix_index);
+        hash_index, prefix_index, data_block_hash_index,
+        data_block_hash_index_offset);
   }
 
   void Initialize(const Comparator* comparator, const char* data,
       uint32_t restarts, uint32_t num_restarts, BlockHashIndex* hash_index,
-      BlockPrefixIndex* prefix_index) {
+      BlockPrefixIndex* prefix_index,
+      const DataBlockHashIndex* data_block_hash_index = nullptr,
+      uint32_t data_block_hash_index_offset = 0) {
     assert(data_ == nullptr);           // Ensure it is called only once
     assert(num_restarts > 0);           // Ensure the param is valid
 
@@ -124,6 +135,8 @@ class BlockIter : public InternalIterator {
     restart_index_ = num_restarts_;
     hash_index_ = hash_index;
     prefix_index_ = prefix_index;
+    data_block_hash_index_ = data_block_hash_index;
+    data_block_hash_index_offset_ = data_block_hash_index_offset;
   }
 
   void SetStatus(Status s) {
@@ -141,12 +154,30 @@ class BlockIter : public InternalIterator {
     return value_;
   }
 
+  // Keys that share no prefix with the previous key, and all values, are
+  // referenced in the block directly.
+  virtual bool IsKeyPinned() const override { return key_.IsKeyPinned(); }
+
+  virtual bool IsValuePinned() const override { return true; }
+
+  virtual size_t ApproximateMemoryUsage() const override {
+    return data_ == nullptr ? 0 : restarts_ + num_restarts_ * sizeof(uint32_t);
+  }
+
   virtual void Next() override;
 
   virtual void Prev() override;
 
   virtual void Seek(const Slice& target) override;
 
+  // Position the iterator for a point lookup of the internal key target.
+  // Without a data block hash index this is the same as Seek(). With one,
+  // the iterator may instead stop at an entry of a different user key that
+  // is > target, which is enough for a point lookup to conclude the key is
+  // not in this block; it becomes invalid only if target may continue in
+  // the next block.
+  void SeekForGet(const Slice& target);
+
   virtual void SeekToFirst() override;
 
   virtual void SeekToLast() override;
@@ -165,6 +196,8 @@ class BlockIter : public InternalIterator {
   Status status_;
   BlockHashIndex* hash_index_;
   BlockPrefixIndex* prefix_index_;
+  const DataBlockHashIndex* data_block_hash_index_;
+  uint32_t data_block_hash_index_offset_;
 
   inline int Compare(const Slice& a, const Slice& b) const {
     return comparator_->Compare(a, b);
@@ -13,11 +13,16 @@
 #include <inttypes.h>
 #include <stdio.h>
 
+#include <algorithm>
+#include <deque>
+#include <limits>
 #include <map>
 #include <memory>
 #include <string>
+#include <thread>
 #include <unordered_map>
 #include <utility>
+#include <vector>
 
 #include "db/dbformat.h"
 
@@ -43,6 +48,7 @@
 #include "util/coding.h"
 #include "util/compression.h"
 #include "util/crc32c.h"
+#include "util/mutexlock.h"
 #include "util/stop_watch.h"
 #include "util/xxhash.h"
 
@@ -309,6 +315,7 @@ bool GoodCompressionRatio(size_t compressed_size, size_t raw_size) {
 Slice CompressBlock(const Slice& raw,
                     const CompressionOptions& compression_options,
                     CompressionType* type, uint32_t format_version,
+                    const Slice& compression_dict,
                     std::string* compressed_output) {
   if (*type == kNoCompression) {
     return raw;
@@ -328,7 +335,7 @@ Slice CompressBlock(const Slice& raw,
       if (Zlib_Compress(
               compression_options,
               GetCompressFormatForVersion(kZlibCompression, format_version),
-              raw.data(), raw.size(), compressed_output) &&
+              raw.data(), raw.size(), compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -346,7 +353,7 @@ Slice CompressBlock(const Slice& raw,
       if (LZ4_Compress(
               compression_options,
               GetCompressFormatForVersion(kLZ4Compression, format_version),
-              raw.data(), raw.size(), compressed_output) &&
+              raw.data(), raw.size(), compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -355,14 +362,14 @@ Slice CompressBlock(const Slice& raw,
       if (LZ4HC_Compress(
               compression_options,
               GetCompressFormatForVersion(kLZ4HCCompression, format_version),
-              raw.data(), raw.size(), compressed_output) &&
+              raw.data(), raw.size(), compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
       break;     // fall back to no compression.
     case kZSTDNotFinalCompression:
       if (ZSTD_Compress(compression_options, raw.data(), raw.size(),
-                        compressed_output) &&
+                        compressed_output, compression_dict) &&
           GoodCompressionRatio(compressed_output->size(), raw.size())) {
         return *compressed_output;
       }
@@ -376,6 +383,54 @@ Slice CompressBlock(const Slice& raw,
   return raw;
 }
 
+// Some compression libraries fail when the raw size is bigger than int. If
+// uncompressed size is bigger than kCompressionSizeLimit, don't compress it
+const uint64_t kCompressionSizeLimit = std::numeric_limits<int>::max();
+
+// Compresses a data or index block unless it is too big for the compression
+// libraries.
+Slice CompressBlockForWrite(const Slice& raw,
+                            const CompressionOptions& compression_options,
+                            CompressionType* type, uint32_t format_version,
+                            const Slice& compression_dict,
+                            Statistics* statistics,
+                            std::string* compressed_output) {
+  if (raw.size() < kCompressionSizeLimit) {
+    return CompressBlock(raw, compression_options, type, format_version,
+                         compression_dict, compressed_output);
+  }
+  RecordTick(statistics, NUMBER_BLOCK_NOT_COMPRESSED);
+  *type = kNoCompression;
+  return raw;
+}
+
+// Fills "trailer" with the block type and the checksum of the block.
+void ComputeBlockTrailer(ChecksumType checksum_type, const Slice& contents,
+                         CompressionType type, char* trailer) {
+  trailer[0] = type;
+  char* trailer_without_type = trailer + 1;
+  switch (checksum_type) {
+    case kNoChecksum:
+      // we don't support no checksum yet
+      assert(false);
+      // intentional fallthrough in release binary
+    case kCRC32c: {
+      auto crc = crc32c::Value(contents.data(), contents.size());
+      crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
+      EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
+      break;
+    }
+    case kxxHash: {
+      void* xxh = XXH32_init(0);
+      XXH32_update(xxh, contents.data(),
+                   static_cast<uint32_t>(contents.size()));
+      XXH32_update(xxh, trailer, 1);  // Extend  to cover block type
+      EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
+      break;
+    }
+  }
+}
+
 }  // namespace
 
 // kBlockBasedTableMagicNumber was picked by running
@@ -440,6 +495,174 @@ class BlockBasedTableBuilder::BlockBasedTablePropertiesCollector
   bool prefix_filtering_;
 };
 
+BlockCompressionPool::BlockCompressionPool(uint32_t num_threads)
+    : num_threads_(num_threads), work_cv_(&mu_), shutdown_(false) {}
+
+BlockCompressionPool::~BlockCompressionPool() {
+  {
+    MutexLock l(&mu_);
+    shutdown_ = true;
+    work_cv_.SignalAll();
+  }
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void BlockCompressionPool::Schedule(std::function<void()> work) {
+  MutexLock l(&mu_);
+  if (threads_.empty()) {
+    for (uint32_t i = 0; i < num_threads_; i++) {
+      threads_.emplace_back(&BlockCompressionPool::BGWork, this);
+    }
+  }
+  queue_.push_back(std::move(work));
+  work_cv_.Signal();
+}
+
+void BlockCompressionPool::BGWork() {
+  MutexLock l(&mu_);
+  while (true) {
+    while (!shutdown_ && queue_.empty()) {
+      work_cv_.Wait();
+    }
+    if (shutdown_) {
+      // Builders wait for their blocks before they go away, so no work is
+      // left at this point.
+      assert(queue_.empty());
+      return;
+    }
+    std::function<void()> work = std::move(queue_.front());
+    queue_.pop_front();
+    mu_.Unlock();
+    work();
+    mu_.Lock();
+  }
+}
+
+// Data blocks are compressed and checksummed on a BlockCompressionPool. The
+// builder thread queues each finished block, and writes the blocks to the
+// file, together with their index entries, strictly in the order they were
+// queued once their compression is done. The index entry of a block needs the
+// first key of the next block, so a block is only written after its successor
+// has been started.
+struct BlockBasedTableBuilder::ParallelCompressionRep {
+  struct BlockRep {
+    std::string raw;
+    std::string compressed_output;
+    Slice contents;
+    CompressionType type;
+    char trailer[kBlockTrailerSize];
+    // Index entry: the last key of this block and the first of the next one.
+    std::string last_key;
+    std::string next_key;
+    bool has_next_key = false;
+    // Protected by ParallelCompressionRep::mu.
+    bool compressed = false;
+  };
+
+  ParallelCompressionRep(BlockCompressionPool* _pool, CompressionType _type,
+                         const CompressionOptions& _compression_opts,
+                         const Slice& _compression_dict,
+                         uint32_t _format_version, ChecksumType _checksum,
+                         Statistics* _statistics)
+      : pool(_pool),
+        compression_type(_type),
+        compression_opts(_compression_opts),
+        compression_dict(_compression_dict),
+        format_version(_format_version),
+        checksum(_checksum),
+        statistics(_statistics),
+        max_queued_blocks(2 * _pool->num_threads()),
+        compressed_cv(&mu),
+        num_scheduled(0),
+        abandoned(false) {}
+
+  ~ParallelCompressionRep() { StopWorkers(); }
+
+  // Queues a block for compression. Called by the builder thread only.
+  void Queue(std::unique_ptr<BlockRep> block) {
+    raw_bytes_queued += block->raw.size();
+    BlockRep* raw_block = block.get();
+    blocks.push_back(std::move(block));
+    {
+      MutexLock l(&mu);
+      ++num_scheduled;
+    }
+    pool->Schedule([this, raw_block]() { Compress(raw_block); });
+  }
+
+  // Waits until "block" is compressed. Returns false without waiting if it is
+  // not compressed yet and "wait" is false.
+  bool WaitForCompression(BlockRep* block, bool wait) {
+    MutexLock l(&mu);
+    while (!block->compressed) {
+      if (!wait) {
+        return false;
+      }
+      compressed_cv.Wait();
+    }
+    return true;
+  }
+
+  // Waits until the pool is done with the blocks of this builder. The
+  // blocks not compressed yet are skipped, since they are not needed anymore
+  // after an error or Abandon().
+  void StopWorkers() {
+    MutexLock l(&mu);
+    abandoned = true;
+    while (num_scheduled > 0) {
+      compressed_cv.Wait();
+    }
+  }
+
+  // Runs on the pool.
+  void Compress(BlockRep* block) {
+    bool skip;
+    {
+      MutexLock l(&mu);
+      skip = abandoned;
+    }
+    if (!skip) {
+      block->type = compression_type;
+      block->contents = CompressBlockForWrite(
+          block->raw, compression_opts, &block->type, format_version,
+          compression_dict, statistics, &block->compressed_output);
+      ComputeBlockTrailer(checksum, block->contents, block->type,
+                          block->trailer);
+    }
+    MutexLock l(&mu);
+    block->compressed = true;
+    --num_scheduled;
+    compressed_cv.SignalAll();
+  }
+
+  BlockCompressionPool* const pool;
+  const CompressionType compression_type;
+  const CompressionOptions compression_opts;
+  // Points into BlockBasedTableBuilder::Rep::compression_dict.
+  const Slice compression_dict;
+  const uint32_t format_version;
+  const ChecksumType checksum;
+  Statistics* const statistics;
+  // Blocks the builder may have in flight before it waits for the oldest.
+  const size_t max_queued_blocks;
+
+  // Blocks not written yet, in table order. Only the builder thread adds or
+  // removes blocks.
+  std::deque<std::unique_ptr<BlockRep>> blocks;
+  // Used to estimate the final file size while blocks are in flight.
+  uint64_t raw_bytes_queued = 0;
+  uint64_t raw_bytes_written = 0;
+  uint64_t bytes_written = 0;
+
+  port::Mutex mu;
+  port::CondVar compressed_cv;
+  // Blocks handed to the pool and not compressed yet.
+  size_t num_scheduled;
+  bool abandoned;
+};
+
 struct BlockBasedTableBuilder::Rep {
   const ImmutableCFOptions ioptions;
   const BlockBasedTableOptions table_options;
@@ -448,6 +671,9 @@ struct BlockBasedTableBuilder::Rep {
   uint64_t offset = 0;
   Status status;
   BlockBuilder data_block;
+  // Range tombstones do not interleave with the point entries; they are kept
+  // sorted in their own meta block.
+  BlockBuilder range_del_block;
 
   InternalKeySliceTransform internal_prefix_transform;
   std::unique_ptr<IndexBuilder> index_builder;
@@ -455,6 +681,9 @@ struct BlockBasedTableBuilder::Rep {
   std::string last_key;
   const CompressionType compression_type;
   const CompressionOptions compression_opts;
+  // Dictionary the data blocks are compressed with; empty if there is none.
+  // Written to the file as a meta block so that readers can decompress.
+  std::string compression_dict;
   TableProperties props;
 
   bool closed = false;  // Either Finish() or Abandon() has been called.
@@ -469,6 +698,8 @@ struct BlockBasedTableBuilder::Rep {
 
   std::vector<std::unique_ptr<IntTblPropCollector>> table_properties_collectors;
 
+  std::unique_ptr<ParallelCompressionRep> pc_rep;
+
   Rep(const ImmutableCFOptions& _ioptions,
       const BlockBasedTableOptions& table_opt,
       const InternalKeyComparator& icomparator,
@@ -476,12 +707,18 @@ struct BlockBasedTableBuilder::Rep {
           int_tbl_prop_collector_factories,
       uint32_t column_family_id, WritableFileWriter* f,
       const CompressionType _compression_type,
-      const CompressionOptions& _compression_opts, const bool skip_filters)
+      const CompressionOptions& _compression_opts,
+      const std::string* _compression_dict, const bool skip_filters,
+      BlockCompressionPool* compression_pool)
       : ioptions(_ioptions),
         table_options(table_opt),
         internal_comparator(icomparator),
         file(f),
-        data_block(table_options.block_restart_interval),
+        data_block(table_options.block_restart_interval,
+                   table_options.data_block_hash_index,
+                   table_options.data_block_hash_table_util_ratio,
+                   table_options.use_delta_encoding),
+        range_del_block(1 /* block_restart_interval */),
         internal_prefix_transform(_ioptions.prefix_extractor),
         index_builder(CreateIndexBuilder(table_options.index_type,
                                          &internal_comparator,
@@ -493,6 +730,13 @@ struct BlockBasedTableBuilder::Rep {
         flush_block_policy(
             table_options.flush_block_policy_factory->NewFlushBlockPolicy(
                 table_options, data_block)) {
+    if (_compression_dict != nullptr &&
+        (compression_type == kZlibCompression ||
+         compression_type == kLZ4Compression ||
+         compression_type == kLZ4HCCompression ||
+         compression_type == kZSTDNotFinalCompression)) {
+      compression_dict = *_compression_dict;
+    }
     for (auto& collector_factories : *int_tbl_prop_collector_factories) {
       table_properties_collectors.emplace_back(
           collector_factories->CreateIntTblPropCollector(column_family_id));
@@ -501,6 +745,17 @@ struct BlockBasedTableBuilder::Rep {
         new BlockBasedTablePropertiesCollector(
             table_options.index_type, table_options.whole_key_filtering,
             _ioptions.prefix_extractor != nullptr));
+    // Block based filters and the hash index need to know the file offset or
+    // the number of each data block as soon as it is cut.
+    if (compression_pool != nullptr &&
+        compression_type != kNoCompression &&
+        table_options.index_type == BlockBasedTableOptions::kBinarySearch &&
+        (filter_block == nullptr || !filter_block->IsBlockBased())) {
+      pc_rep.reset(new ParallelCompressionRep(
+          compression_pool, compression_type,
+          compression_opts, compression_dict, table_options.format_version,
+          table_options.checksum, ioptions.statistics));
+    }
   }
 };
 
@@ -512,7 +767,9 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
         int_tbl_prop_collector_factories,
     uint32_t column_family_id, WritableFileWriter* file,
     const CompressionType compression_type,
-    const CompressionOptions& compression_opts, const bool skip_filters) {
+    const CompressionOptions& compression_opts,
+    const std::string* compression_dict, const bool skip_filters,
+    BlockCompressionPool* compression_pool) {
   BlockBasedTableOptions sanitized_table_options(table_options);
   if (sanitized_table_options.format_version == 0 &&
       sanitized_table_options.checksum != kCRC32c) {
@@ -526,7 +783,8 @@ BlockBasedTableBuilder::BlockBasedTableBuilder(
 
   rep_ = new Rep(ioptions, sanitized_table_options, internal_comparator,
                  int_tbl_prop_collector_factories, column_family_id, file,
-                 compression_type, compression_opts, skip_filters);
+                 compression_type, compression_opts, compression_dict,
+                 skip_filters, compression_pool);
 
   if (rep_->filter_block != nullptr) {
     rep_->filter_block->StartBlock(0);
@@ -565,7 +823,14 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     // "the r" as the key for the index block entry since it is >= all
     // entries in the first block and < all entries in subsequent
     // blocks.
-    if (ok()) {
+    if (r->pc_rep != nullptr) {
+      if (ok()) {
+        auto* block = r->pc_rep->blocks.back().get();
+        block->next_key.assign(key.data(), key.size());
+        block->has_next_key = true;
+        WriteCompressedBlocks(false /* wait */);
+      }
+    } else if (ok()) {
       r->index_builder->AddIndexEntry(&r->last_key, &key, r->pending_handle);
     }
   }
@@ -586,12 +851,37 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
                                     r->ioptions.info_log);
 }
 
+Status BlockBasedTableBuilder::AddRangeTombstone(const Slice& key,
+                                                 const Slice& value) {
+  Rep* r = rep_;
+  assert(!r->closed);
+  assert(ExtractValueType(key) == kTypeRangeDeletion);
+  if (!ok()) return status();
+  r->range_del_block.Add(key, value);
+  ++r->props.num_range_deletions;
+  return Status::OK();
+}
+
 void BlockBasedTableBuilder::Flush() {
   Rep* r = rep_;
   assert(!r->closed);
   if (!ok()) return;
   if (r->data_block.empty()) return;
-  WriteBlock(&r->data_block, &r->pending_handle);
+  if (r->pc_rep != nullptr) {
+    std::unique_ptr<ParallelCompressionRep::BlockRep> block(
+        new ParallelCompressionRep::BlockRep());
+    block->raw = r->data_block.Finish().ToString();
+    block->last_key = r->last_key;
+    r->data_block.Reset();
+    r->pc_rep->Queue(std::move(block));
+    // Full filters ignore block boundaries.
+    if (r->filter_block != nullptr) {
+      r->filter_block->StartBlock(r->offset);
+    }
+    ++r->props.num_data_blocks;
+    return;
+  }
+  WriteBlock(&r->data_block, &r->pending_handle, true /* is_data_block */);
   if (ok()) {
     r->status = r->file->Flush();
   }
@@ -602,14 +892,48 @@ void BlockBasedTableBuilder::Flush() {
   ++r->props.num_data_blocks;
 }
 
+void BlockBasedTableBuilder::WriteCompressedBlocks(bool wait) {
+  Rep* r = rep_;
+  ParallelCompressionRep* pc = r->pc_rep.get();
+  while (ok() && !pc->blocks.empty()) {
+    auto* block = pc->blocks.front().get();
+    if (!block->has_next_key && !wait) {
+      break;
+    }
+    // Bound the memory held by blocks in flight.
+    bool must_wait = wait || pc->blocks.size() > pc->max_queued_blocks;
+    if (!pc->WaitForCompression(block, must_wait)) {
+      break;
+    }
+    BlockHandle handle;
+    WriteRawBlock(block->contents, block->type, block->trailer, &handle);
+    if (ok()) {
+      r->status = r->file->Flush();
+    }
+    if (ok()) {
+      Slice next_key(block->next_key);
+      r->index_builder->AddIndexEntry(
+          &block->last_key, block->has_next_key ? &next_key : nullptr,
+          handle);
+      r->props.data_size = r->offset;
+    }
+    pc->raw_bytes_queued -= block->raw.size();
+    pc->raw_bytes_written += block->raw.size();
+    pc->bytes_written += block->contents.size() + kBlockTrailerSize;
+    pc->blocks.pop_front();
+  }
+}
+
 void BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
-                                        BlockHandle* handle) {
-  WriteBlock(block->Finish(), handle);
+                                        BlockHandle* handle,
+                                        bool is_data_block) {
+  WriteBlock(block->Finish(), handle, is_data_block);
   block->Reset();
 }
 
 void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
-                                        BlockHandle* handle) {
+                                        BlockHandle* handle,
+                                        bool is_data_block) {
   // File format contains a sequence of blocks where each block has:
   //    block_data: uint8[n]
   //    type: uint8
@@ -618,16 +942,11 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
   Rep* r = rep_;
 
   auto type = r->compression_type;
-  Slice block_contents;
-  if (raw_block_contents.size() < kCompressionSizeLimit) {
-    block_contents =
-        CompressBlock(raw_block_contents, r->compression_opts, &type,
-                      r->table_options.format_version, &r->compressed_output);
-  } else {
-    RecordTick(r->ioptions.statistics, NUMBER_BLOCK_NOT_COMPRESSED);
-    type = kNoCompression;
-    block_contents = raw_block_contents;
-  }
+  Slice block_contents = CompressBlockForWrite(
+      raw_block_contents, r->compression_opts, &type,
+      r->table_options.format_version,
+      is_data_block ? Slice(r->compression_dict) : Slice(),
+      r->ioptions.statistics, &r->compressed_output);
   WriteRawBlock(block_contents, type, handle);
   r->compressed_output.clear();
 }
@@ -635,36 +954,22 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& raw_block_contents,
 void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
                                            CompressionType type,
                                            BlockHandle* handle) {
+  char trailer[kBlockTrailerSize];
+  ComputeBlockTrailer(rep_->table_options.checksum, block_contents, type,
+                      trailer);
+  WriteRawBlock(block_contents, type, trailer, handle);
+}
+
+void BlockBasedTableBuilder::WriteRawBlock(const Slice& block_contents,
+                                           CompressionType type,
+                                           const char* trailer,
+                                           BlockHandle* handle) {
   Rep* r = rep_;
   StopWatch sw(r->ioptions.env, r->ioptions.statistics, WRITE_RAW_BLOCK_MICROS);
   handle->set_offset(r->offset);
   handle->set_size(block_contents.size());
   r->status = r->file->Append(block_contents);
   if (r->status.ok()) {
-    char trailer[kBlockTrailerSize];
-    trailer[0] = type;
-    char* trailer_without_type = trailer + 1;
-    switch (r->table_options.checksum) {
-      case kNoChecksum:
-        // we don't support no checksum yet
-        assert(false);
-        // intentional fallthrough in release binary
-      case kCRC32c: {
-        auto crc = crc32c::Value(block_contents.data(), block_contents.size());
-        crc = crc32c::Extend(crc, trailer, 1);  // Extend to cover block type
-        EncodeFixed32(trailer_without_type, crc32c::Mask(crc));
-        break;
-      }
-      case kxxHash: {
-        void* xxh = XXH32_init(0);
-        XXH32_update(xxh, block_contents.data(),
-                     static_cast<uint32_t>(block_contents.size()));
-        XXH32_update(xxh, trailer, 1);  // Extend  to cover block type
-        EncodeFixed32(trailer_without_type, XXH32_digest(xxh));
-        break;
-      }
-    }
-
     r->status = r->file->Append(Slice(trailer, kBlockTrailerSize));
     if (r->status.ok()) {
       r->status = InsertBlockInCache(block_contents, type, handle);
@@ -731,6 +1036,11 @@ Status BlockBasedTableBuilder::Finish() {
   Flush();
   assert(!r->closed);
   r->closed = true;
+  if (r->pc_rep != nullptr) {
+    // The last block is written with its index entry here.
+    WriteCompressedBlocks(true /* wait */);
+    r->pc_rep->StopWorkers();
+  }
 
   BlockHandle filter_block_handle, metaindex_block_handle, index_block_handle;
   // Write filter block
@@ -743,7 +1053,7 @@ Status BlockBasedTableBuilder::Finish() {
   // To make sure properties block is able to keep the accurate size of index
   // block, we will finish writing all index entries here and flush them
   // to storage after metaindex block is written.
-  if (ok() && !empty_data_block) {
+  if (ok() && !empty_data_block && r->pc_rep == nullptr) {
     r->index_builder->AddIndexEntry(
         &r->last_key, nullptr /* no next data block */, r->pending_handle);
   }
@@ -763,7 +1073,7 @@ Status BlockBasedTableBuilder::Finish() {
   MetaIndexBuilder meta_index_builder;
   for (const auto& item : index_blocks.meta_blocks) {
     BlockHandle block_handle;
-    WriteBlock(item.second, &block_handle);
+    WriteBlock(item.second, &block_handle, false /* is_data_block */);
     meta_index_builder.Add(item.first, block_handle);
   }
 
@@ -781,6 +1091,22 @@ Status BlockBasedTableBuilder::Finish() {
       meta_index_builder.Add(key, filter_block_handle);
     }
 
+    if (!r->range_del_block.empty()) {
+      BlockHandle range_del_block_handle;
+      WriteRawBlock(r->range_del_block.Finish(), kNoCompression,
+                    &range_del_block_handle);
+      meta_index_builder.Add(BlockBasedTable::kRangeDelBlock,
+                             range_del_block_handle);
+    }
+
+    if (ok() && !r->compression_dict.empty()) {
+      BlockHandle compression_dict_block_handle;
+      WriteRawBlock(r->compression_dict, kNoCompression,
+                    &compression_dict_block_handle);
+      meta_index_builder.Add(BlockBasedTable::kCompressionDictBlock,
+                             compression_dict_block_handle);
+    }
+
     // Write properties block.
     {
       PropertyBlockBuilder property_block_builder;
@@ -813,7 +1139,8 @@ Status BlockBasedTableBuilder::Finish() {
     // flush the meta index block
     WriteRawBlock(meta_index_builder.Finish(), kNoCompression,
                   &metaindex_block_handle);
-    WriteBlock(index_blocks.index_block_contents, &index_block_handle);
+    WriteBlock(index_blocks.index_block_contents, &index_block_handle,
+               false /* is_data_block */);
   }
 
   // Write footer
@@ -850,14 +1177,29 @@ void BlockBasedTableBuilder::Abandon() {
   Rep* r = rep_;
   assert(!r->closed);
   r->closed = true;
+  if (r->pc_rep != nullptr) {
+    r->pc_rep->StopWorkers();
+  }
 }
 
 uint64_t BlockBasedTableBuilder::NumEntries() const {
-  return rep_->props.num_entries;
+  return rep_->props.num_entries + rep_->props.num_range_deletions;
 }
 
 uint64_t BlockBasedTableBuilder::FileSize() const {
-  return rep_->offset;
+  const ParallelCompressionRep* pc = rep_->pc_rep.get();
+  if (pc == nullptr || pc->raw_bytes_queued == 0) {
+    return rep_->offset;
+  }
+  // Estimate the size of the blocks in flight with the compression ratio
+  // achieved so far.
+  double ratio = pc->raw_bytes_written > 0
+                     ? static_cast<double>(pc->bytes_written) /
+                           static_cast<double>(pc->raw_bytes_written)
+                     : 1.0;
+  return rep_->offset +
+         static_cast<uint64_t>(ratio * static_cast<double>(
+                                           pc->raw_bytes_queued));
 }
 
 bool BlockBasedTableBuilder::NeedCompact() const {
@@ -869,6 +1211,15 @@ bool BlockBasedTableBuilder::NeedCompact() const {
   return false;
 }
 
+uint64_t BlockBasedTableBuilder::NewestEntryTime() const {
+  uint64_t newest_entry_time = 0;
+  for (const auto& collector : rep_->table_properties_collectors) {
+    newest_entry_time =
+        std::max(newest_entry_time, collector->NewestEntryTime());
+  }
+  return newest_entry_time;
+}
+
 TableProperties BlockBasedTableBuilder::GetTableProperties() const {
   TableProperties ret = rep_->props;
   for (const auto& collector : rep_->table_properties_collectors) {
@@ -882,4 +1233,7 @@ TableProperties BlockBasedTableBuilder::GetTableProperties() const {
 
 const std::string BlockBasedTable::kFilterBlockPrefix = "filter.";
 const std::string BlockBasedTable::kFullFilterBlockPrefix = "fullfilter.";
+const std::string BlockBasedTable::kRangeDelBlock = "rocksdb.range_del";
+const std::string BlockBasedTable::kCompressionDictBlock =
+    "rocksdb.compression_dict";
 }  // namespace rocksdb
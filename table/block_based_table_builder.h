@@ -9,11 +9,15 @@
 
 #pragma once
 #include <stdint.h>
+#include <deque>
+#include <functional>
 #include <limits>
 #include <string>
+#include <thread>
 #include <utility>
 #include <vector>
 
+#include "port/port.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
@@ -29,11 +33,41 @@ struct BlockBasedTableOptions;
 extern const uint64_t kBlockBasedTableMagicNumber;
 extern const uint64_t kLegacyBlockBasedTableMagicNumber;
 
+// Threads that compress data blocks for all the table builders of a
+// BlockBasedTableFactory, so that concurrent flushes and compactions share
+// BlockBasedTableOptions::parallel_compression_threads threads. The threads
+// are started by the first Schedule() call and joined on destruction.
+class BlockCompressionPool {
+ public:
+  explicit BlockCompressionPool(uint32_t num_threads);
+  ~BlockCompressionPool();
+
+  // Runs "work" on one of the threads. The work must not block.
+  void Schedule(std::function<void()> work);
+
+  uint32_t num_threads() const { return num_threads_; }
+
+ private:
+  void BGWork();
+
+  const uint32_t num_threads_;
+  port::Mutex mu_;
+  port::CondVar work_cv_;
+  std::deque<std::function<void()>> queue_;
+  bool shutdown_;
+  std::vector<std::thread> threads_;
+
+  // No copying allowed
+  BlockCompressionPool(const BlockCompressionPool&) = delete;
+  void operator=(const BlockCompressionPool&) = delete;
+};
+
 class BlockBasedTableBuilder : public TableBuilder {
  public:
   // Create a builder that will store the contents of the table it is
   // building in *file.  Does not close the file.  It is up to the
-  // caller to close the file after calling Finish().
+  // caller to close the file after calling Finish(). Data blocks are
+  // compressed on "compression_pool" if it is not nullptr.
   BlockBasedTableBuilder(
       const ImmutableCFOptions& ioptions,
       const BlockBasedTableOptions& table_options,
@@ -42,7 +76,9 @@ class BlockBasedTableBuilder : public TableBuilder {
           int_tbl_prop_collector_factories,
       uint32_t column_family_id, WritableFileWriter* file,
       const CompressionType compression_type,
-      const CompressionOptions& compression_opts, const bool skip_filters);
+      const CompressionOptions& compression_opts,
+      const std::string* compression_dict, const bool skip_filters,
+      BlockCompressionPool* compression_pool = nullptr);
 
   // REQUIRES: Either Finish() or Abandon() has been called.
   ~BlockBasedTableBuilder();
@@ -52,6 +88,9 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Add(const Slice& key, const Slice& value) override;
 
+  // Add a range tombstone to the range deletion meta block.
+  Status AddRangeTombstone(const Slice& key, const Slice& value) override;
+
   // Return non-ok iff some error has been detected.
   Status status() const override;
 
@@ -76,6 +115,8 @@ class BlockBasedTableBuilder : public TableBuilder {
 
   bool NeedCompact() const override;
 
+  uint64_t NewestEntryTime() const override;
+
   // Get table properties
   TableProperties GetTableProperties() const override;
 
@@ -83,14 +124,20 @@ class BlockBasedTableBuilder : public TableBuilder {
   bool ok() const { return status().ok(); }
   // Call block's Finish() method and then write the finalize block contents to
   // file.
-  void WriteBlock(BlockBuilder* block, BlockHandle* handle);
-  // Directly write block content to the file.
-  void WriteBlock(const Slice& block_contents, BlockHandle* handle);
+  void WriteBlock(BlockBuilder* block, BlockHandle* handle, bool is_data_block);
+  // Directly write block content to the file. Only data blocks are
+  // compressed with the compression dictionary.
+  void WriteBlock(const Slice& block_contents, BlockHandle* handle,
+                  bool is_data_block);
   void WriteRawBlock(const Slice& data, CompressionType, BlockHandle* handle);
+  // Write block content whose trailer has already been computed.
+  void WriteRawBlock(const Slice& data, CompressionType type,
+                     const char* trailer, BlockHandle* handle);
   Status InsertBlockInCache(const Slice& block_contents,
                             const CompressionType type,
                             const BlockHandle* handle);
   struct Rep;
+  struct ParallelCompressionRep;
   class BlockBasedTablePropertiesCollectorFactory;
   class BlockBasedTablePropertiesCollector;
   Rep* rep_;
@@ -101,9 +148,10 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Flush();
 
-  // Some compression libraries fail when the raw size is bigger than int. If
-  // uncompressed size is bigger than kCompressionSizeLimit, don't compress it
-  const uint64_t kCompressionSizeLimit = std::numeric_limits<int>::max();
+  // With parallel compression, write the blocks at the head of the pipeline
+  // that are compressed and whose successor is known. If "wait" is true,
+  // wait for every remaining block and write it.
+  void WriteCompressedBlocks(bool wait);
 
   // No copying allowed
   BlockBasedTableBuilder(const BlockBasedTableBuilder&) = delete;
@@ -13,8 +13,10 @@
 #include <memory>
 #include <string>
 #include <stdint.h>
+#include <string.h>
 
 #include "port/port.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/cache.h"
 #include "table/block_based_table_builder.h"
@@ -39,8 +41,14 @@ BlockBasedTableFactory::BlockBasedTableFactory(
       table_options_.block_size_deviation > 100) {
     table_options_.block_size_deviation = 0;
   }
+  if (table_options_.parallel_compression_threads > 1) {
+    compression_pool_.reset(
+        new BlockCompressionPool(table_options_.parallel_compression_threads));
+  }
 }
 
+BlockBasedTableFactory::~BlockBasedTableFactory() {}
+
 Status BlockBasedTableFactory::NewTableReader(
     const TableReaderOptions& table_reader_options,
     unique_ptr<RandomAccessFileReader>&& file, uint64_t file_size,
@@ -69,7 +77,8 @@ TableBuilder* BlockBasedTableFactory::NewTableBuilder(
       table_builder_options.int_tbl_prop_collector_factories, column_family_id,
       file, table_builder_options.compression_type,
       table_builder_options.compression_opts,
-      table_builder_options.skip_filters);
+      table_builder_options.compression_dict,
+      table_builder_options.skip_filters, compression_pool_.get());
 
   return table_builder;
 }
@@ -87,6 +96,13 @@ Status BlockBasedTableFactory::SanitizeOptions(
     return Status::InvalidArgument("Enable cache_index_and_filter_blocks, "
         ", but block cache is disabled");
   }
+  if (table_options_.data_block_hash_index &&
+      strcmp(cf_opts.comparator->Name(), BytewiseComparator()->Name()) != 0 &&
+      strcmp(cf_opts.comparator->Name(),
+             ReverseBytewiseComparator()->Name()) != 0) {
+    return Status::InvalidArgument(
+        "data_block_hash_index requires a bytewise comparator");
+  }
   if (!BlockBasedTableSupportedVersion(table_options_.format_version)) {
     return Status::InvalidArgument(
         "Unsupported BlockBasedTable format_version. Please check "
@@ -146,6 +162,15 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  block_restart_interval: %d\n",
            table_options_.block_restart_interval);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  use_delta_encoding: %d\n",
+           table_options_.use_delta_encoding);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_hash_index: %d\n",
+           table_options_.data_block_hash_index);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
+           table_options_.data_block_hash_table_util_ratio);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  filter_policy: %s\n",
            table_options_.filter_policy == nullptr ?
              "nullptr" : table_options_.filter_policy->Name());
@@ -155,6 +180,9 @@ std::string BlockBasedTableFactory::GetPrintableTableOptions() const {
   snprintf(buffer, kBufferSize, "  format_version: %d\n",
            table_options_.format_version);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  parallel_compression_threads: %u\n",
+           table_options_.parallel_compression_threads);
+  ret.append(buffer);
   return ret;
 }
 
@@ -23,13 +23,14 @@ struct EnvOptions;
 
 using std::unique_ptr;
 class BlockBasedTableBuilder;
+class BlockCompressionPool;
 
 class BlockBasedTableFactory : public TableFactory {
  public:
   explicit BlockBasedTableFactory(
       const BlockBasedTableOptions& table_options = BlockBasedTableOptions());
 
-  ~BlockBasedTableFactory() {}
+  ~BlockBasedTableFactory();
 
   const char* Name() const override { return "BlockBasedTable"; }
 
@@ -60,6 +61,9 @@ class BlockBasedTableFactory : public TableFactory {
 
  private:
   BlockBasedTableOptions table_options_;
+  // Shared by all the builders, nullptr unless parallel_compression_threads
+  // is greater than 1.
+  std::unique_ptr<BlockCompressionPool> compression_pool_;
 };
 
 extern const std::string kHashIndexPrefixesBlock;
@@ -13,6 +13,7 @@
 #include <utility>
 
 #include "db/dbformat.h"
+#include "db/range_del_aggregator.h"
 
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
@@ -60,6 +61,13 @@ namespace {
 const size_t kMaxCacheKeyPrefixSize __attribute__((unused)) =
     kMaxVarint64Length * 3 + 1;
 
+// Sequential scans start prefetching data blocks after this many blocks were
+// read one after another, with a range that grows from the initial to the
+// maximum size.
+const int kMinSequentialReadsForReadahead = 2;
+const size_t kInitAutoReadaheadSize = 8 * 1024;
+const size_t kMaxAutoReadaheadSize = 256 * 1024;
+
 // Read the block identified by "handle" from "file".
 // The only relevant option is options.verify_checksums for now.
 // On failure return non-OK.
@@ -67,10 +75,11 @@ const size_t kMaxCacheKeyPrefixSize __attribute__((unused)) =
 Status ReadBlockFromFile(RandomAccessFileReader* file, const Footer& footer,
                          const ReadOptions& options, const BlockHandle& handle,
                          std::unique_ptr<Block>* result, Env* env,
-                         bool do_uncompress = true) {
+                         bool do_uncompress = true,
+                         const Slice& compression_dict = Slice()) {
   BlockContents contents;
   Status s = ReadBlockContents(file, footer, options, handle, &contents, env,
-                               do_uncompress);
+                               do_uncompress, compression_dict);
   if (s.ok()) {
     result->reset(new Block(std::move(contents)));
   }
@@ -367,6 +376,14 @@ struct BlockBasedTable::Rep {
   // the block cache.
   unique_ptr<IndexReader> index_reader;
   unique_ptr<FilterBlockReader> filter;
+  // Range tombstones are consulted by every lookup, so the block is pinned
+  // for the lifetime of the table, along with its fragmented copy for point
+  // lookups. nullptr if the table has none.
+  unique_ptr<Block> range_del_block;
+  unique_ptr<FragmentedRangeTombstoneList> fragmented_range_dels;
+  // Dictionary the data blocks were compressed with, kept for the lifetime of
+  // the table. Empty if the table has none.
+  std::string compression_dict;
 
   enum class FilterType {
     kNoFilter,
@@ -564,6 +581,41 @@ Status BlockBasedTable::Open(const ImmutableCFOptions& ioptions,
         "Cannot find Properties block from file.");
   }
 
+  // Read the range tombstones
+  BlockHandle range_del_handle;
+  if (FindMetaBlock(meta_iter.get(), kRangeDelBlock, &range_del_handle).ok()) {
+    s = ReadBlockFromFile(rep->file.get(), rep->footer, ReadOptions(),
+                          range_del_handle, &rep->range_del_block,
+                          rep->ioptions.env);
+    if (!s.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, rep->ioptions.info_log,
+          "Encountered error while reading range deletion block: %s",
+          s.ToString().c_str());
+      return s;
+    }
+    std::unique_ptr<InternalIterator> range_del_iter(
+        rep->range_del_block->NewIterator(&rep->internal_comparator));
+    rep->fragmented_range_dels.reset(new FragmentedRangeTombstoneList(
+        range_del_iter.get(), rep->internal_comparator.user_comparator()));
+  }
+
+  // Read the compression dictionary
+  BlockHandle compression_dict_handle;
+  if (FindMetaBlock(meta_iter.get(), kCompressionDictBlock,
+                    &compression_dict_handle).ok()) {
+    BlockContents compression_dict_block;
+    s = ReadBlockContents(rep->file.get(), rep->footer, ReadOptions(),
+                          compression_dict_handle, &compression_dict_block,
+                          rep->ioptions.env, false /* do_uncompress */);
+    if (!s.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, rep->ioptions.info_log,
+          "Encountered error while reading compression dictionary block: %s",
+          s.ToString().c_str());
+      return s;
+    }
+    rep->compression_dict = compression_dict_block.data.ToString();
+  }
+
   // Determine whether whole key filtering is supported.
   if (rep->table_properties) {
     rep->whole_key_filtering &=
@@ -650,6 +702,10 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->index_reader) {
     usage += rep_->index_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_del_block) {
+    usage += rep_->range_del_block->ApproximateMemoryUsage();
+    usage += rep_->fragmented_range_dels->ApproximateMemoryUsage();
+  }
   return usage;
 }
 
@@ -687,7 +743,8 @@ Status BlockBasedTable::GetDataBlockFromCache(
     const Slice& block_cache_key, const Slice& compressed_block_cache_key,
     Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
     const ReadOptions& read_options,
-    BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version) {
+    BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
+    const Slice& compression_dict) {
   Status s;
   Block* compressed_block = nullptr;
   Cache::Handle* block_cache_compressed_handle = nullptr;
@@ -731,7 +788,7 @@ Status BlockBasedTable::GetDataBlockFromCache(
   BlockContents contents;
   s = UncompressBlockContents(compressed_block->data(),
                               compressed_block->size(), &contents,
-                              format_version);
+                              format_version, compression_dict);
 
   // Insert uncompressed block into block cache
   if (s.ok()) {
@@ -756,7 +813,8 @@ Status BlockBasedTable::PutDataBlockToCache(
     const Slice& block_cache_key, const Slice& compressed_block_cache_key,
     Cache* block_cache, Cache* block_cache_compressed,
     const ReadOptions& read_options, Statistics* statistics,
-    CachableEntry<Block>* block, Block* raw_block, uint32_t format_version) {
+    CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
+    const Slice& compression_dict) {
   assert(raw_block->compression_type() == kNoCompression ||
          block_cache_compressed != nullptr);
 
@@ -765,7 +823,7 @@ Status BlockBasedTable::PutDataBlockToCache(
   BlockContents contents;
   if (raw_block->compression_type() != kNoCompression) {
     s = UncompressBlockContents(raw_block->data(), raw_block->size(), &contents,
-                                format_version);
+                                format_version, compression_dict);
   }
   if (!s.ok()) {
     delete raw_block;
@@ -1015,7 +1073,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
 
     s = GetDataBlockFromCache(key, ckey, block_cache, block_cache_compressed,
                               statistics, ro, &block,
-                              rep->table_options.format_version);
+                              rep->table_options.format_version,
+                              rep->compression_dict);
 
     if (block.value == nullptr && !no_io && ro.fill_cache) {
       std::unique_ptr<Block> raw_block;
@@ -1023,13 +1082,15 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
         StopWatch sw(rep->ioptions.env, statistics, READ_BLOCK_GET_MICROS);
         s = ReadBlockFromFile(rep->file.get(), rep->footer, ro, handle,
                               &raw_block, rep->ioptions.env,
-                              block_cache_compressed == nullptr);
+                              block_cache_compressed == nullptr,
+                              rep->compression_dict);
       }
 
       if (s.ok()) {
         s = PutDataBlockToCache(key, ckey, block_cache, block_cache_compressed,
                                 ro, statistics, &block, raw_block.release(),
-                                rep->table_options.format_version);
+                                rep->table_options.format_version,
+                                rep->compression_dict);
       }
     }
   }
@@ -1047,7 +1108,8 @@ InternalIterator* BlockBasedTable::NewDataBlockIterator(
     }
     std::unique_ptr<Block> block_value;
     s = ReadBlockFromFile(rep->file.get(), rep->footer, ro, handle,
-                          &block_value, rep->ioptions.env);
+                          &block_value, rep->ioptions.env,
+                          true /* do_uncompress */, rep->compression_dict);
     if (s.ok()) {
       block.value = block_value.release();
     }
@@ -1080,9 +1142,18 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
       : TwoLevelIteratorState(
           table->rep_->ioptions.prefix_extractor != nullptr),
         table_(table),
-        read_options_(read_options) {}
+        read_options_(read_options),
+        auto_readahead_(read_options.readahead_size == 0 &&
+                        !table->rep_->ioptions.allow_mmap_reads),
+        next_block_offset_(0),
+        num_sequential_reads_(0),
+        readahead_size_(kInitAutoReadaheadSize),
+        readahead_limit_(0) {}
 
   InternalIterator* NewSecondaryIterator(const Slice& index_value) override {
+    if (auto_readahead_) {
+      MaybeReadahead(index_value);
+    }
     return NewDataBlockIterator(table_->rep_, read_options_, index_value);
   }
 
@@ -1094,9 +1165,43 @@ class BlockBasedTable::BlockEntryIteratorState : public TwoLevelIteratorState {
   }
 
  private:
+  // Once a few data blocks have been read one right after the other, asks
+  // the file to prefetch the blocks that follow in the background. The
+  // prefetched range doubles every time the scan runs past it, and goes back
+  // to its initial size as soon as the scan jumps elsewhere.
+  void MaybeReadahead(const Slice& index_value) {
+    BlockHandle handle;
+    Slice input = index_value;
+    if (!handle.DecodeFrom(&input).ok()) {
+      return;
+    }
+    if (handle.offset() == next_block_offset_) {
+      num_sequential_reads_++;
+    } else {
+      num_sequential_reads_ = 1;
+      readahead_size_ = kInitAutoReadaheadSize;
+      readahead_limit_ = 0;
+    }
+    next_block_offset_ = handle.offset() + handle.size() + kBlockTrailerSize;
+    if (num_sequential_reads_ > kMinSequentialReadsForReadahead &&
+        next_block_offset_ > readahead_limit_) {
+      table_->rep_->file->Prefetch(handle.offset(), readahead_size_);
+      RecordTick(table_->rep_->ioptions.statistics, NUMBER_BLOCK_PREFETCHES);
+      readahead_limit_ = handle.offset() + readahead_size_;
+      readahead_size_ = std::min(kMaxAutoReadaheadSize, readahead_size_ * 2);
+    }
+  }
+
   // Don't own table_
   BlockBasedTable* table_;
   const ReadOptions read_options_;
+  // Explicit readahead already reads the file in large chunks, and mmapped
+  // files are paged in by the OS.
+  const bool auto_readahead_;
+  uint64_t next_block_offset_;
+  int num_sequential_reads_;
+  size_t readahead_size_;
+  uint64_t readahead_limit_;
 };
 
 // This will be broken if the user specifies an unusual implementation
@@ -1192,6 +1297,19 @@ InternalIterator* BlockBasedTable::NewIterator(const ReadOptions& read_options,
                              NewIndexIterator(read_options), arena);
 }
 
+InternalIterator* BlockBasedTable::NewRangeTombstoneIterator(
+    const ReadOptions& read_options) {
+  if (rep_->range_del_block == nullptr) {
+    return nullptr;
+  }
+  return rep_->range_del_block->NewIterator(&rep_->internal_comparator);
+}
+
+const FragmentedRangeTombstoneList*
+BlockBasedTable::GetFragmentedRangeTombstones() const {
+  return rep_->fragmented_range_dels.get();
+}
+
 bool BlockBasedTable::FullFilterKeyMayMatch(FilterBlockReader* filter,
                                             const Slice& internal_key) const {
   if (filter == nullptr || filter->IsBlockBased()) {
@@ -1257,7 +1375,7 @@ Status BlockBasedTable::Get(
         }
 
         // Call the *saver function on each entry/block until it returns false
-        for (biter.Seek(key); biter.Valid(); biter.Next()) {
+        for (biter.SeekForGet(key); biter.Valid(); biter.Next()) {
           ParsedInternalKey parsed_key;
           if (!ParseInternalKey(biter.key(), &parsed_key)) {
             s = Status::Corruption(Slice());
@@ -1288,6 +1406,13 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
     return Status::InvalidArgument(*begin, *end);
   }
 
+  // The filter covers the whole table, load it along with the data blocks
+  // if it lives in the block cache
+  if (rep_->table_options.cache_index_and_filter_blocks) {
+    auto filter_entry = GetFilter();
+    filter_entry.Release(rep_->table_options.block_cache.get());
+  }
+
   BlockIter iiter;
   NewIndexIterator(ReadOptions(), &iiter);
 
@@ -1326,6 +1451,91 @@ Status BlockBasedTable::Prefetch(const Slice* const begin,
   return Status::OK();
 }
 
+void BlockBasedTable::GetCachedRanges(
+    std::vector<std::pair<std::string, std::string>>* ranges) {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr) {
+    return;
+  }
+
+  BlockIter iiter;
+  NewIndexIterator(ReadOptions(), &iiter);
+  if (!iiter.status().ok()) {
+    return;
+  }
+
+  // A data block holds the keys after the index key of the previous block,
+  // up to its own index key
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  std::string prev_index_key;
+  bool prev_cached = false;
+  for (iiter.SeekToFirst(); iiter.Valid(); iiter.Next()) {
+    BlockHandle handle;
+    Slice input = iiter.value();
+    if (!handle.DecodeFrom(&input).ok()) {
+      break;
+    }
+    Cache::Handle* cache_handle = block_cache->Lookup(
+        GetCacheKey(rep_->cache_key_prefix, rep_->cache_key_prefix_size,
+                    handle, cache_key));
+    bool cached = cache_handle != nullptr;
+    if (cached) {
+      block_cache->Release(cache_handle);
+      if (prev_cached) {
+        ranges->back().second = iiter.key().ToString();
+      } else {
+        ranges->emplace_back(prev_index_key, iiter.key().ToString());
+      }
+    }
+    prev_cached = cached;
+    prev_index_key.assign(iiter.key().data(), iiter.key().size());
+  }
+}
+
+void BlockBasedTable::EraseFromBlockCache() {
+  Cache* block_cache = rep_->table_options.block_cache.get();
+  Cache* block_cache_compressed =
+      rep_->table_options.block_cache_compressed.get();
+  if (block_cache == nullptr && block_cache_compressed == nullptr) {
+    return;
+  }
+
+  char cache_key[kMaxCacheKeyPrefixSize + kMaxVarint64Length];
+  BlockIter iiter;
+  NewIndexIterator(ReadOptions(), &iiter);
+  for (iiter.SeekToFirst(); iiter.Valid(); iiter.Next()) {
+    BlockHandle handle;
+    Slice input = iiter.value();
+    if (!handle.DecodeFrom(&input).ok()) {
+      break;
+    }
+    if (block_cache != nullptr) {
+      block_cache->Erase(GetCacheKey(rep_->cache_key_prefix,
+                                     rep_->cache_key_prefix_size, handle,
+                                     cache_key));
+    }
+    if (block_cache_compressed != nullptr) {
+      block_cache_compressed->Erase(
+          GetCacheKey(rep_->compressed_cache_key_prefix,
+                      rep_->compressed_cache_key_prefix_size, handle,
+                      cache_key));
+    }
+  }
+  // With cache_index_and_filter_blocks, the index and the filter are cached
+  // as well, under the handles of the index and the metaindex block. Erased
+  // entries that are still referenced, like the index held by iiter, are
+  // freed once released.
+  if (block_cache != nullptr &&
+      rep_->table_options.cache_index_and_filter_blocks) {
+    block_cache->Erase(GetCacheKey(rep_->cache_key_prefix,
+                                   rep_->cache_key_prefix_size,
+                                   rep_->footer.index_handle(), cache_key));
+    block_cache->Erase(GetCacheKey(rep_->cache_key_prefix,
+                                   rep_->cache_key_prefix_size,
+                                   rep_->footer.metaindex_handle(), cache_key));
+  }
+}
+
 bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
                                       const Slice& key) {
   std::unique_ptr<InternalIterator> iiter(NewIndexIterator(options));
@@ -1348,7 +1558,8 @@ bool BlockBasedTable::TEST_KeyInCache(const ReadOptions& options,
 
   s = GetDataBlockFromCache(cache_key, ckey, block_cache, nullptr, nullptr,
                             options, &block,
-                            rep_->table_options.format_version);
+                            rep_->table_options.format_version,
+                            rep_->compression_dict);
   assert(s.ok());
   bool in_cache = block.value != nullptr;
   if (in_cache) {
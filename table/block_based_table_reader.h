@@ -13,6 +13,7 @@
 #include <memory>
 #include <utility>
 #include <string>
+#include <vector>
 
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
@@ -54,6 +55,8 @@ class BlockBasedTable : public TableReader {
  public:
   static const std::string kFilterBlockPrefix;
   static const std::string kFullFilterBlockPrefix;
+  static const std::string kRangeDelBlock;
+  static const std::string kCompressionDictBlock;
 
   // Attempt to open the table that is stored in bytes [0..file_size)
   // of "file", and read the metadata entries necessary to allow
@@ -83,6 +86,12 @@ class BlockBasedTable : public TableReader {
   InternalIterator* NewIterator(const ReadOptions&,
                                 Arena* arena = nullptr) override;
 
+  InternalIterator* NewRangeTombstoneIterator(
+      const ReadOptions& read_options) override;
+
+  const FragmentedRangeTombstoneList* GetFragmentedRangeTombstones()
+      const override;
+
   Status Get(const ReadOptions& readOptions, const Slice& key,
              GetContext* get_context) override;
 
@@ -91,6 +100,11 @@ class BlockBasedTable : public TableReader {
   // IO or iteration error.
   Status Prefetch(const Slice* begin, const Slice* end) override;
 
+  void GetCachedRanges(
+      std::vector<std::pair<std::string, std::string>>* ranges) override;
+
+  void EraseFromBlockCache() override;
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -161,7 +175,8 @@ class BlockBasedTable : public TableReader {
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed, Statistics* statistics,
       const ReadOptions& read_options,
-      BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version);
+      BlockBasedTable::CachableEntry<Block>* block, uint32_t format_version,
+      const Slice& compression_dict);
   // Put a raw block (maybe compressed) to the corresponding block caches.
   // This method will perform decompression against raw_block if needed and then
   // populate the block caches.
@@ -174,7 +189,8 @@ class BlockBasedTable : public TableReader {
       const Slice& block_cache_key, const Slice& compressed_block_cache_key,
       Cache* block_cache, Cache* block_cache_compressed,
       const ReadOptions& read_options, Statistics* statistics,
-      CachableEntry<Block>* block, Block* raw_block, uint32_t format_version);
+      CachableEntry<Block>* block, Block* raw_block, uint32_t format_version,
+      const Slice& compression_dict);
 
   // Calls (*handle_result)(arg, ...) repeatedly, starting with the entry found
   // after a call to Seek(key), until handle_result returns false.
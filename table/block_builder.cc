@@ -30,6 +30,9 @@
 //     restarts: uint32[num_restarts]
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+//
+// Data blocks may carry a hash index between the restart array and
+// num_restarts; see table/data_block_hash_index.h.
 
 #include "table/block_builder.h"
 
@@ -41,13 +44,21 @@
 
 namespace rocksdb {
 
-BlockBuilder::BlockBuilder(int block_restart_interval)
+BlockBuilder::BlockBuilder(int block_restart_interval,
+                           bool use_data_block_hash_index,
+                           double data_block_hash_table_util_ratio,
+                           bool use_delta_encoding)
     : block_restart_interval_(block_restart_interval),
+      use_delta_encoding_(use_delta_encoding),
       restarts_(),
       counter_(0),
       finished_(false) {
   assert(block_restart_interval_ >= 1);
   restarts_.push_back(0);       // First restart point is at offset 0
+  if (use_data_block_hash_index) {
+    data_block_hash_index_builder_.Initialize(
+        data_block_hash_table_util_ratio);
+  }
 }
 
 void BlockBuilder::Reset() {
@@ -57,11 +68,13 @@ void BlockBuilder::Reset() {
   counter_ = 0;
   finished_ = false;
   last_key_.clear();
+  data_block_hash_index_builder_.Reset();
 }
 
 size_t BlockBuilder::CurrentSizeEstimate() const {
   return (buffer_.size() +                        // Raw data buffer
           restarts_.size() * sizeof(uint32_t) +   // Restart array
+          data_block_hash_index_builder_.EstimateSize() +  // Hash index
           sizeof(uint32_t));                      // Restart array length
 }
 
@@ -85,7 +98,15 @@ Slice BlockBuilder::Finish() {
   for (size_t i = 0; i < restarts_.size(); i++) {
     PutFixed32(&buffer_, restarts_[i]);
   }
-  PutFixed32(&buffer_, static_cast<uint32_t>(restarts_.size()));
+  bool has_hash_index =
+      data_block_hash_index_builder_.Valid() &&
+      restarts_.size() <= kMaxRestartSupportedByHashIndex;
+  if (has_hash_index) {
+    data_block_hash_index_builder_.Finish(&buffer_);
+  }
+  PutFixed32(&buffer_,
+             PackDataBlockFooter(has_hash_index,
+                                 static_cast<uint32_t>(restarts_.size())));
   finished_ = true;
   return Slice(buffer_);
 }
@@ -96,10 +117,12 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   assert(counter_ <= block_restart_interval_);
   size_t shared = 0;
   if (counter_ < block_restart_interval_) {
-    // See how much sharing to do with previous string
-    const size_t min_length = std::min(last_key_piece.size(), key.size());
-    while ((shared < min_length) && (last_key_piece[shared] == key[shared])) {
-      shared++;
+    if (use_delta_encoding_) {
+      // See how much sharing to do with previous string
+      const size_t min_length = std::min(last_key_piece.size(), key.size());
+      while ((shared < min_length) && (last_key_piece[shared] == key[shared])) {
+        shared++;
+      }
     }
   } else {
     // Restart compression
@@ -122,6 +145,11 @@ void BlockBuilder::Add(const Slice& key, const Slice& value) {
   last_key_.append(key.data() + shared, non_shared);
   assert(Slice(last_key_) == key);
   counter_++;
+
+  if (data_block_hash_index_builder_.Initialized()) {
+    data_block_hash_index_builder_.Add(ExtractUserKey(key),
+                                       restarts_.size() - 1);
+  }
 }
 
 }  // namespace rocksdb
@@ -12,6 +12,7 @@
 
 #include <stdint.h>
 #include "rocksdb/slice.h"
+#include "table/data_block_hash_index.h"
 
 namespace rocksdb {
 
@@ -20,7 +21,14 @@ class BlockBuilder {
   BlockBuilder(const BlockBuilder&) = delete;
   void operator=(const BlockBuilder&) = delete;
 
-  explicit BlockBuilder(int block_restart_interval);
+  // If use_data_block_hash_index is true, keys must be internal keys and a
+  // DataBlockHashIndex over their user keys is appended to the block.
+  // If use_delta_encoding is false, every key is stored in full so that
+  // readers can reference keys in the block without decoding them.
+  explicit BlockBuilder(int block_restart_interval,
+                        bool use_data_block_hash_index = false,
+                        double data_block_hash_table_util_ratio = 0.75,
+                        bool use_delta_encoding = true);
 
   // Reset the contents as if the BlockBuilder was just constructed.
   void Reset();
@@ -48,12 +56,14 @@ class BlockBuilder {
 
  private:
   const int          block_restart_interval_;
+  const bool         use_delta_encoding_;
 
   std::string           buffer_;    // Destination buffer
   std::vector<uint32_t> restarts_;  // Restart points
   int                   counter_;   // Number of entries emitted since restart
   bool                  finished_;  // Has Finish() been called?
   std::string           last_key_;
+  DataBlockHashIndexBuilder data_block_hash_index_builder_;
 };
 
 }  // namespace rocksdb
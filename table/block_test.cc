@@ -234,6 +234,77 @@ TEST_F(BlockTest, IndexHashWithSharedPrefix) {
   CheckBlockContents(std::move(contents), kMaxKey, keys, values);
 }
 
+// data block hash index test
+TEST_F(BlockTest, DataBlockHashIndex) {
+  InternalKeyComparator icmp(BytewiseComparator());
+  std::vector<std::string> user_keys;
+  std::vector<std::string> values;
+  GenerateRandomKVs(&user_keys, &values, 0, 200, 2 /* step */);
+
+  for (bool use_hash_index : {false, true}) {
+    BlockBuilder builder(16, use_hash_index);
+    std::vector<std::string> keys;
+    for (size_t i = 0; i < user_keys.size(); i++) {
+      // Give every third key a second, older version
+      keys.push_back(
+          InternalKey(user_keys[i], 100, kTypeValue).Encode().ToString());
+      builder.Add(keys.back(), values[i]);
+      if (i % 3 == 0) {
+        builder.Add(InternalKey(user_keys[i], 50, kTypeValue).Encode(),
+                    "old");
+      }
+    }
+
+    Slice rawblock = builder.Finish();
+    BlockContents contents;
+    contents.data = rawblock;
+    contents.cachable = false;
+    Block reader(std::move(contents));
+
+    // Iteration is unaffected by the index
+    std::unique_ptr<InternalIterator> iter(reader.NewIterator(&icmp));
+    size_t count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      count++;
+    }
+    ASSERT_EQ(user_keys.size() + (user_keys.size() + 2) / 3, count);
+
+    BlockIter biter;
+    reader.NewIterator(&icmp, &biter);
+    for (size_t i = 0; i < user_keys.size(); i++) {
+      // Present keys are found at the newest visible version
+      biter.SeekForGet(
+          InternalKey(user_keys[i], kMaxSequenceNumber, kTypeValue).Encode());
+      ASSERT_TRUE(biter.Valid());
+      ASSERT_EQ(keys[i], biter.key().ToString());
+      ASSERT_EQ(values[i], biter.value().ToString());
+
+      if (i % 3 == 0) {
+        biter.SeekForGet(InternalKey(user_keys[i], 60, kTypeValue).Encode());
+        ASSERT_TRUE(biter.Valid());
+        ASSERT_EQ("old", biter.value().ToString());
+      }
+
+      // Absent keys never land on an entry of the same user key
+      std::string absent = GenerateKey(static_cast<int>(i) * 2 + 1, 0, 0,
+                                       nullptr);
+      biter.SeekForGet(
+          InternalKey(absent, kMaxSequenceNumber, kTypeValue).Encode());
+      if (biter.Valid()) {
+        ASSERT_GT(icmp.user_comparator()->Compare(ExtractUserKey(biter.key()),
+                                                  absent),
+                  0);
+      }
+    }
+
+    // A key past the end of the block invalidates the iterator so that the
+    // lookup can continue in the next block
+    biter.SeekForGet(InternalKey("zzzzzz", kMaxSequenceNumber, kTypeValue)
+                         .Encode());
+    ASSERT_TRUE(!biter.Valid());
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char **argv) {
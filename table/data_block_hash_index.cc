@@ -0,0 +1,96 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "table/data_block_hash_index.h"
+
+#include <assert.h>
+#include <algorithm>
+
+#include "util/coding.h"
+#include "util/hash.h"
+
+namespace rocksdb {
+
+namespace {
+const uint32_t kDataBlockHashSeed = 0x4c7e3a9b;
+
+inline uint32_t DataBlockHash(const Slice& user_key) {
+  return Hash(user_key.data(), user_key.size(), kDataBlockHashSeed);
+}
+}  // namespace
+
+void DataBlockHashIndexBuilder::Add(const Slice& user_key,
+                                    size_t restart_index) {
+  assert(initialized_);
+  if (restart_index >= kMaxRestartSupportedByHashIndex) {
+    // Too many restart points; Finish() won't be called for this block.
+    return;
+  }
+  uint32_t hash = DataBlockHash(user_key);
+  if (!hash_and_restart_pairs_.empty() &&
+      hash_and_restart_pairs_.back().first == hash &&
+      hash_and_restart_pairs_.back().second == restart_index) {
+    // Another version of the previous key.
+    return;
+  }
+  hash_and_restart_pairs_.emplace_back(hash,
+                                       static_cast<uint8_t>(restart_index));
+}
+
+uint16_t DataBlockHashIndexBuilder::NumBuckets() const {
+  uint32_t num_buckets = static_cast<uint32_t>(
+      static_cast<double>(hash_and_restart_pairs_.size()) / util_ratio_);
+  // An odd bucket count spreads hashes better under modulo.
+  num_buckets |= 1;
+  return static_cast<uint16_t>(std::min<uint32_t>(num_buckets, 0xffff));
+}
+
+size_t DataBlockHashIndexBuilder::EstimateSize() const {
+  if (!Valid()) {
+    return 0;
+  }
+  return NumBuckets() * sizeof(uint8_t) + sizeof(uint16_t);
+}
+
+void DataBlockHashIndexBuilder::Finish(std::string* buffer) {
+  assert(Valid());
+  uint16_t num_buckets = NumBuckets();
+  std::vector<uint8_t> buckets(num_buckets, kNoEntry);
+  for (const auto& entry : hash_and_restart_pairs_) {
+    uint8_t& bucket = buckets[entry.first % num_buckets];
+    if (bucket == kNoEntry) {
+      bucket = entry.second;
+    } else if (bucket != entry.second) {
+      bucket = kCollision;
+    }
+  }
+  buffer->append(reinterpret_cast<const char*>(buckets.data()), num_buckets);
+  PutFixed16(buffer, num_buckets);
+}
+
+void DataBlockHashIndexBuilder::Reset() { hash_and_restart_pairs_.clear(); }
+
+bool DataBlockHashIndex::Initialize(const char* data, uint32_t size,
+                                    uint32_t* map_offset) {
+  if (size < sizeof(uint16_t)) {
+    return false;
+  }
+  num_buckets_ = DecodeFixed16(data + size - sizeof(uint16_t));
+  if (num_buckets_ == 0 || num_buckets_ > size - sizeof(uint16_t)) {
+    num_buckets_ = 0;
+    return false;
+  }
+  *map_offset = size - sizeof(uint16_t) - num_buckets_;
+  return true;
+}
+
+uint8_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
+                                   const Slice& user_key) const {
+  assert(Valid());
+  uint32_t idx = DataBlockHash(user_key) % num_buckets_;
+  return static_cast<uint8_t>(data[map_offset + idx]);
+}
+
+}  // namespace rocksdb
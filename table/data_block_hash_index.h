@@ -0,0 +1,114 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+#pragma once
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/slice.h"
+
+namespace rocksdb {
+
+// DataBlockHashIndex is an optional hash table appended to a data block. It
+// maps the hash of a user key to the index of the restart interval that holds
+// all entries of that key, so a point lookup can jump straight to the right
+// restart point instead of binary searching the restart array.
+//
+// Each bucket is one byte: a restart index, kNoEntry if no key hashes to the
+// bucket, or kCollision if keys from different restart intervals do. Only
+// blocks with at most kMaxRestartSupportedByHashIndex restart points get an
+// index.
+//
+// Layout of a data block carrying the index:
+//     entries ...
+//     restarts: uint32[num_restarts]
+//     buckets: uint8[num_buckets]
+//     num_buckets: uint16
+//     num_restarts | kDataBlockHashIndexFlag: uint32
+//
+// Blocks written without the index keep the original trailer. The flag bit
+// can never be set by a legacy block since restart offsets are at most 2GB.
+
+const uint32_t kDataBlockHashIndexFlag = 1u << 31;
+const uint8_t kNoEntry = 255;
+const uint8_t kCollision = 254;
+const uint8_t kMaxRestartSupportedByHashIndex = 253;
+
+// Encode/decode the last uint32 of a block.
+inline uint32_t PackDataBlockFooter(bool has_hash_index, uint32_t num_restarts) {
+  return has_hash_index ? (num_restarts | kDataBlockHashIndexFlag)
+                        : num_restarts;
+}
+
+inline void UnPackDataBlockFooter(uint32_t footer, bool* has_hash_index,
+                                  uint32_t* num_restarts) {
+  *has_hash_index = (footer & kDataBlockHashIndexFlag) != 0;
+  *num_restarts = footer & ~kDataBlockHashIndexFlag;
+}
+
+class DataBlockHashIndexBuilder {
+ public:
+  DataBlockHashIndexBuilder() : util_ratio_(0), initialized_(false) {}
+
+  // util_ratio is the expected number of distinct user keys per bucket.
+  // A builder that was never initialized produces no index.
+  void Initialize(double util_ratio) {
+    if (util_ratio <= 0) {
+      util_ratio = 0.75;  // sanity check
+    }
+    util_ratio_ = util_ratio;
+    initialized_ = true;
+  }
+
+  bool Initialized() const { return initialized_; }
+
+  // True if there is an index to write for the keys added so far.
+  bool Valid() const {
+    return initialized_ && !hash_and_restart_pairs_.empty();
+  }
+
+  // REQUIRES: user keys of the same restart interval are added in a row
+  void Add(const Slice& user_key, size_t restart_index);
+
+  // Approximate number of bytes Finish() would append.
+  size_t EstimateSize() const;
+
+  // Append the buckets and num_buckets to buffer. Only call if Valid() and
+  // the block has at most kMaxRestartSupportedByHashIndex restart points.
+  void Finish(std::string* buffer);
+
+  void Reset();
+
+ private:
+  uint16_t NumBuckets() const;
+
+  double util_ratio_;
+  bool initialized_;
+  std::vector<std::pair<uint32_t, uint8_t>> hash_and_restart_pairs_;
+};
+
+// Reader side. Holds no data of its own; the buckets live in the block.
+class DataBlockHashIndex {
+ public:
+  DataBlockHashIndex() : num_buckets_(0) {}
+
+  // data/size cover the block up to, but excluding, the block footer.
+  // Sets *map_offset to the offset of the first bucket within data. Returns
+  // false if the index is malformed.
+  bool Initialize(const char* data, uint32_t size, uint32_t* map_offset);
+
+  // Returns the restart index for the user key, kNoEntry or kCollision.
+  uint8_t Lookup(const char* data, uint32_t map_offset,
+                 const Slice& user_key) const;
+
+  bool Valid() const { return num_buckets_ != 0; }
+
+ private:
+  uint16_t num_buckets_;
+};
+
+}  // namespace rocksdb
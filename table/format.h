@@ -205,12 +205,14 @@ struct BlockContents {
 
 // Read the block identified by "handle" from "file".  On failure
 // return non-OK.  On success fill *result and return OK.
+// "compression_dict" is the dictionary the block was compressed with, if any.
 extern Status ReadBlockContents(RandomAccessFileReader* file,
                                 const Footer& footer,
                                 const ReadOptions& options,
                                 const BlockHandle& handle,
                                 BlockContents* contents, Env* env,
-                                bool do_uncompress);
+                                bool do_uncompress,
+                                const Slice& compression_dict = Slice());
 
 // The 'data' points to the raw block contents read in from file.
 // This method allocates a new heap buffer and the raw block
@@ -219,9 +221,11 @@ extern Status ReadBlockContents(RandomAccessFileReader* file,
 // free this buffer.
 // For description of compress_format_version and possible values, see
 // util/compression.h
-extern Status UncompressBlockContents(const char* data, size_t n,
-                                      BlockContents* contents,
-                                      uint32_t compress_format_version);
+// "compression_dict" is the dictionary the block was compressed with, if any.
+extern Status UncompressBlockContents(
+    const char* data, size_t n, BlockContents* contents,
+    uint32_t compress_format_version,
+    const Slice& compression_dict = Slice());
 
 // Implementation details follow.  Clients should ignore,
 
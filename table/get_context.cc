@@ -45,7 +45,9 @@ GetContext::GetContext(const Comparator* ucmp,
       value_found_(value_found),
       merge_context_(merge_context),
       env_(env),
-      replay_log_(nullptr) {}
+      replay_log_(nullptr),
+      max_covering_tombstone_seq_(0),
+      row_cache_frequency_(0) {}
 
 // Called from TableCache::Get and Table::Get when file/block in which
 // key may exist are not there in TableCache/BlockCache respectively. In this
@@ -72,10 +74,15 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
   assert((state_ != kMerge && parsed_key.type != kTypeMerge) ||
          merge_context_ != nullptr);
   if (ucmp_->Equal(parsed_key.user_key, user_key_)) {
-    appendToReplayLog(replay_log_, parsed_key.type, value);
+    ValueType type = parsed_key.type;
+    if (parsed_key.sequence < max_covering_tombstone_seq_) {
+      // Deleted by a range tombstone of the same file
+      type = kTypeDeletion;
+    }
+    appendToReplayLog(replay_log_, type, value);
 
     // Key matches. Process it
-    switch (parsed_key.type) {
+    switch (type) {
       case kTypeValue:
         assert(state_ == kNotFound || state_ == kMerge);
         if (kNotFound == state_) {
@@ -143,6 +150,30 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
   return false;
 }
 
+void GetContext::MarkKeyDeletedByRangeTombstone() {
+  if (kNotFound == state_) {
+    appendToReplayLog(replay_log_, kTypeDeletion, Slice());
+    state_ = kDeleted;
+  } else if (kMerge == state_) {
+    appendToReplayLog(replay_log_, kTypeDeletion, Slice());
+    assert(merge_operator_ != nullptr);
+    state_ = kFound;
+    bool merge_success = false;
+    {
+      StopWatchNano timer(env_, statistics_ != nullptr);
+      PERF_TIMER_GUARD(merge_operator_time_nanos);
+      merge_success = merge_operator_->FullMerge(
+          user_key_, nullptr, merge_context_->GetOperands(), value_, logger_);
+      RecordTick(statistics_, MERGE_OPERATION_TOTAL_TIME,
+                 timer.ElapsedNanosSafe());
+    }
+    if (!merge_success) {
+      RecordTick(statistics_, NUMBER_MERGE_FAILURES);
+      state_ = kCorrupt;
+    }
+  }
+}
+
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
                          GetContext* get_context) {
 #ifndef ROCKSDB_LITE
@@ -5,6 +5,7 @@
 
 #pragma once
 #include <string>
+#include "db/dbformat.h"
 #include "db/merge_context.h"
 #include "rocksdb/env.h"
 
@@ -31,11 +32,31 @@ class GetContext {
   bool SaveValue(const ParsedInternalKey& parsed_key, const Slice& value);
   GetState State() const { return state_; }
 
+  // Entries older than "seq" are treated as deleted. Set by the table cache
+  // to the newest range tombstone of the file being searched that covers the
+  // key, and reset to 0 once the file has been searched.
+  void SetMaxCoveringTombstoneSeq(SequenceNumber seq) {
+    max_covering_tombstone_seq_ = seq;
+  }
+  // Resolves a lookup that found no older entry than a covering range
+  // tombstone: the key is deleted, and pending merge operands are applied on
+  // top of nothing.
+  void MarkKeyDeletedByRangeTombstone();
+
   // If a non-null string is passed, all the SaveValue calls will be
   // logged into the string. The operations can then be replayed on
   // another GetContext with replayGetContextLog.
   void SetReplayLog(std::string* replay_log) { replay_log_ = replay_log; }
 
+  // The number of recent lookups of the key, as estimated by the row cache
+  // admission filter, or 0 if not recorded yet. The table cache records the
+  // lookup on the first file it searches, so that a lookup that goes through
+  // several files counts once.
+  uint32_t row_cache_frequency() const { return row_cache_frequency_; }
+  void set_row_cache_frequency(uint32_t frequency) {
+    row_cache_frequency_ = frequency;
+  }
+
  private:
   const Comparator* ucmp_;
   const MergeOperator* merge_operator_;
@@ -50,6 +71,8 @@ class GetContext {
   MergeContext* merge_context_;
   Env* env_;
   std::string* replay_log_;
+  SequenceNumber max_covering_tombstone_seq_;
+  uint32_t row_cache_frequency_;
 };
 
 void replayGetContextLog(const Slice& replay_log, const Slice& user_key,
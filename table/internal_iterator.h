@@ -11,6 +11,8 @@
 
 namespace rocksdb {
 
+class PinnedIteratorsManager;
+
 class InternalIterator : public Cleanable {
  public:
   InternalIterator() {}
@@ -60,6 +62,26 @@ class InternalIterator : public Cleanable {
   // satisfied without doing some IO, then this returns Status::Incomplete().
   virtual Status status() const = 0;
 
+  // Pass the PinnedIteratorsManager to the iterator. Iterators that own
+  // other iterators propagate it to them, and hand the iterators they are
+  // done with to the manager instead of deleting them while pinning is
+  // enabled.
+  virtual void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) {}
+
+  // If true, the Slice returned by key() stays valid for as long as the
+  // iterator is alive and the PinnedIteratorsManager it was given has not
+  // released its pinned iterators.
+  // REQUIRES: Valid()
+  virtual bool IsKeyPinned() const { return false; }
+
+  // Same as IsKeyPinned(), for the Slice returned by value().
+  // REQUIRES: Valid()
+  virtual bool IsValuePinned() const { return false; }
+
+  // Approximate number of bytes of block data the iterator references,
+  // which stay in memory for as long as the iterator is pinned.
+  virtual size_t ApproximateMemoryUsage() const { return 0; }
+
  private:
   // No copying allowed
   InternalIterator(const InternalIterator&) = delete;
@@ -26,16 +26,18 @@ class IteratorWrapper {
   ~IteratorWrapper() {}
   InternalIterator* iter() const { return iter_; }
 
-  // Takes ownership of "iter" and will delete it when destroyed, or
-  // when Set() is invoked again.
-  void Set(InternalIterator* _iter) {
-    delete iter_;
+  // Set the underlying Iterator to _iter and return
+  // previous underlying Iterator.
+  InternalIterator* Set(InternalIterator* _iter) {
+    InternalIterator* old_iter = iter_;
+
     iter_ = _iter;
     if (iter_ == nullptr) {
       valid_ = false;
     } else {
       Update();
     }
+    return old_iter;
   }
 
   void DeleteIter(bool is_arena_mode) {
@@ -52,6 +54,15 @@ class IteratorWrapper {
   Slice value() const       { assert(Valid()); return iter_->value(); }
   // Methods below require iter() != nullptr
   Status status() const     { assert(iter_); return iter_->status(); }
+  bool IsKeyPinned() const  { assert(Valid()); return iter_->IsKeyPinned(); }
+  bool IsValuePinned() const {
+    assert(Valid());
+    return iter_->IsValuePinned();
+  }
+  void SetPinnedItersMgr(PinnedIteratorsManager* pinned_iters_mgr) {
+    assert(iter_);
+    iter_->SetPinnedItersMgr(pinned_iters_mgr);
+  }
   void Next()               { assert(iter_); iter_->Next();        Update(); }
   void Prev()               { assert(iter_); iter_->Prev();        Update(); }
   void Seek(const Slice& k) { assert(iter_); iter_->Seek(k);       Update(); }
@@ -0,0 +1,65 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+//
+#pragma once
+
+#include <assert.h>
+#include <vector>
+
+#include "table/internal_iterator.h"
+
+namespace rocksdb {
+
+// PinnedIteratorsManager keeps the iterators, and through them the data
+// blocks, that an iterator created with ReadOptions::pin_data moves away
+// from, so that the keys and values already returned stay valid. They are
+// deleted when the pinned data is released, at the latest when the manager
+// is destroyed.
+class PinnedIteratorsManager {
+ public:
+  PinnedIteratorsManager()
+      : pinning_enabled_(false), pinned_memory_usage_(0) {}
+  ~PinnedIteratorsManager() { ReleasePinnedIterators(); }
+
+  // Enable pinning. Iterators given to this manager are then kept alive
+  // until ReleasePinnedIterators() is called.
+  void StartPinning() {
+    assert(!pinning_enabled_);
+    pinning_enabled_ = true;
+  }
+
+  bool PinningEnabled() const { return pinning_enabled_; }
+
+  // Take ownership of "iter" and delete it when the pinned data is released.
+  void PinIterator(InternalIterator* iter) {
+    assert(pinning_enabled_);
+    pinned_memory_usage_ += iter->ApproximateMemoryUsage();
+    pinned_iters_.push_back(iter);
+  }
+
+  // Approximate number of bytes of block data held by the pinned iterators.
+  size_t PinnedMemoryUsage() const { return pinned_memory_usage_; }
+
+  // Delete the pinned iterators and disable pinning.
+  void ReleasePinnedIterators() {
+    pinning_enabled_ = false;
+    for (auto* iter : pinned_iters_) {
+      delete iter;
+    }
+    pinned_iters_.clear();
+    pinned_memory_usage_ = 0;
+  }
+
+ private:
+  bool pinning_enabled_;
+  size_t pinned_memory_usage_;
+  std::vector<InternalIterator*> pinned_iters_;
+
+  // No copying allowed
+  PinnedIteratorsManager(const PinnedIteratorsManager&) = delete;
+  void operator=(const PinnedIteratorsManager&) = delete;
+};
+
+}  // namespace rocksdb
@@ -15,6 +15,7 @@
 #include <vector>
 #include "db/table_properties_collector.h"
 #include "rocksdb/options.h"
+#include "rocksdb/status.h"
 #include "rocksdb/table_properties.h"
 #include "util/file_reader_writer.h"
 #include "util/mutable_cf_options.h"
@@ -44,13 +45,15 @@ struct TableBuilderOptions {
       const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
           _int_tbl_prop_collector_factories,
       CompressionType _compression_type,
-      const CompressionOptions& _compression_opts, bool _skip_filters)
+      const CompressionOptions& _compression_opts, bool _skip_filters,
+      const std::string* _compression_dict = nullptr)
       : ioptions(_ioptions),
         internal_comparator(_internal_comparator),
         int_tbl_prop_collector_factories(_int_tbl_prop_collector_factories),
         compression_type(_compression_type),
         compression_opts(_compression_opts),
-        skip_filters(_skip_filters) {}
+        skip_filters(_skip_filters),
+        compression_dict(_compression_dict) {}
   const ImmutableCFOptions& ioptions;
   const InternalKeyComparator& internal_comparator;
   const std::vector<std::unique_ptr<IntTblPropCollectorFactory>>*
@@ -58,6 +61,9 @@ struct TableBuilderOptions {
   CompressionType compression_type;
   const CompressionOptions& compression_opts;
   bool skip_filters = false;
+  // Dictionary used to compress the data blocks, or nullptr. Must outlive
+  // the table builder.
+  const std::string* compression_dict;
 };
 
 // TableBuilder provides the interface used to build a Table
@@ -77,6 +83,16 @@ class TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   virtual void Add(const Slice& key, const Slice& value) = 0;
 
+  // Add a range tombstone, keyed by its (start key, sequence number,
+  // kTypeRangeDeletion) internal key, with the exclusive end key as value.
+  // Tombstones are kept apart from the entries passed to Add().
+  // REQUIRES: key is after any previously added tombstone key.
+  // REQUIRES: Finish(), Abandon() have not been called
+  virtual Status AddRangeTombstone(const Slice& key, const Slice& value) {
+    return Status::NotSupported(
+        "Range tombstones are not supported by this table format");
+  }
+
   // Return non-ok iff some error has been detected.
   virtual Status status() const = 0;
 
@@ -101,6 +117,10 @@ class TableBuilder {
   // be further compacted.
   virtual bool NeedCompact() const { return false; }
 
+  // The time at which the newest entry of the file was written, as reported
+  // by the table properties collectors, or 0 if it is unknown.
+  virtual uint64_t NewestEntryTime() const { return 0; }
+
   // Returns table properties
   virtual TableProperties GetTableProperties() const = 0;
 };
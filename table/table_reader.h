@@ -9,6 +9,9 @@
 
 #pragma once
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace rocksdb {
 
@@ -20,6 +23,7 @@ struct ReadOptions;
 struct TableProperties;
 class GetContext;
 class InternalIterator;
+class FragmentedRangeTombstoneList;
 
 // A Table is a sorted map from strings to strings.  Tables are
 // immutable and persistent.  A Table may be safely accessed from
@@ -38,6 +42,21 @@ class TableReader {
   virtual InternalIterator* NewIterator(const ReadOptions&,
                                         Arena* arena = nullptr) = 0;
 
+  // Returns a new iterator over the range tombstones of the table, or nullptr
+  // if the table has none. Keys are internal keys of the begin key of each
+  // range and values are the exclusive end keys.
+  virtual InternalIterator* NewRangeTombstoneIterator(
+      const ReadOptions& read_options) {
+    return nullptr;
+  }
+
+  // Returns the range tombstones of the table fragmented for point lookups,
+  // or nullptr if the table has none. Owned by the table.
+  virtual const FragmentedRangeTombstoneList* GetFragmentedRangeTombstones()
+      const {
+    return nullptr;
+  }
+
   // Given a key, return an approximate byte offset in the file where
   // the data for that key begins (or would begin if the key were
   // present in the file).  The returned value is in terms of file
@@ -82,6 +101,20 @@ class TableReader {
     return Status::OK();
   }
 
+  // Appends to "ranges" the internal key ranges [first, second] covered by
+  // the data blocks of this table that are in the block cache. The ranges of
+  // adjacent blocks are merged. An empty first key stands for the beginning
+  // of the table.
+  virtual void GetCachedRanges(
+      std::vector<std::pair<std::string, std::string>>* ranges) {
+    (void) ranges;
+  }
+
+  // Erases the blocks of this table from the block caches, including the
+  // index and filter blocks when they are cached, for tables that are about
+  // to be deleted.
+  virtual void EraseFromBlockCache() {}
+
   // convert db file to a human readable form
   virtual Status DumpTable(WritableFile* out_file) {
     return Status::NotSupported("DumpTable() not supported");
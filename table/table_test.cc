@@ -317,6 +317,10 @@ class TableConstructor: public Constructor {
     return table_reader_->ApproximateOffsetOf(key);
   }
 
+  test::StringSink* GetSink() {
+    return static_cast<test::StringSink*>(file_writer_->writable_file());
+  }
+
   virtual Status Reopen(const ImmutableCFOptions& ioptions) {
     file_reader_.reset(test::GetRandomAccessFileReader(new test::StringSource(
         GetSink()->contents(), uniq_id_, ioptions.allow_mmap_reads)));
@@ -341,10 +345,6 @@ class TableConstructor: public Constructor {
     file_reader_.reset();
   }
 
-  test::StringSink* GetSink() {
-    return static_cast<test::StringSink*>(file_writer_->writable_file());
-  }
-
   uint64_t uniq_id_;
   unique_ptr<WritableFileWriter> file_writer_;
   unique_ptr<RandomAccessFileReader> file_reader_;
@@ -1698,6 +1698,43 @@ TEST_F(BlockBasedTableTest, FilterBlockInBlockCache) {
   props.AssertFilterBlockStat(0, 0);
 }
 
+TEST_F(BlockBasedTableTest, EraseFromBlockCache) {
+  Options options;
+  options.compression = kNoCompression;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.block_cache = NewLRUCache(16 * 1024 * 1024);
+  table_options.cache_index_and_filter_blocks = true;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  TableConstructor c(BytewiseComparator(), true);
+  for (int i = 0; i < 100; i++) {
+    c.Add("k" + ToString(1000 + i), std::string(100, 'v'));
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  const ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto* reader = dynamic_cast<BlockBasedTable*>(c.GetTableReader());
+  // the index and the filter are only in the block cache
+  ASSERT_TRUE(!reader->TEST_filter_block_preloaded());
+  ASSERT_TRUE(!reader->TEST_index_reader_preloaded());
+
+  {
+    unique_ptr<InternalIterator> iter(c.NewIterator());
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    }
+    ASSERT_OK(iter->status());
+  }
+  ASSERT_GT(table_options.block_cache->GetUsage(), 0U);
+
+  // the data, index and filter blocks are all gone
+  reader->EraseFromBlockCache();
+  ASSERT_EQ(0U, table_options.block_cache->GetUsage());
+}
+
 TEST_F(BlockBasedTableTest, BlockReadCountTest) {
   // bloom_filter_type = 0 -- block-based filter
   // bloom_filter_type = 0 -- full filter
@@ -1771,6 +1808,117 @@ TEST_F(BlockBasedTableTest, BlockReadCountTest) {
   }
 }
 
+TEST_F(BlockBasedTableTest, DataBlockHashIndexGet) {
+  Options options;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.block_restart_interval = 4;
+  table_options.data_block_hash_index = true;
+  options.table_factory.reset(new BlockBasedTableFactory(table_options));
+
+  TableConstructor c(BytewiseComparator());
+  for (int i = 0; i < 1000; i += 2) {
+    char user_key[16];
+    snprintf(user_key, sizeof(user_key), "key%06d", i);
+    c.Add(InternalKey(user_key, 0, kTypeValue).Encode().ToString(),
+          std::string(user_key) + "-value");
+  }
+  std::vector<std::string> keys;
+  stl_wrappers::KVMap kvmap;
+  ImmutableCFOptions ioptions(options);
+  c.Finish(options, ioptions, table_options,
+           GetPlainInternalComparator(options.comparator), &keys, &kvmap);
+  auto reader = c.GetTableReader();
+
+  // Odd keys are absent and fall between the keys of a block, between
+  // blocks or past the last key
+  for (int i = 0; i < 1000; i++) {
+    char user_key[16];
+    snprintf(user_key, sizeof(user_key), "key%06d", i);
+    std::string value;
+    GetContext get_context(options.comparator, nullptr, nullptr, nullptr,
+                           GetContext::kNotFound, user_key, &value, nullptr,
+                           nullptr, nullptr);
+    ASSERT_OK(reader->Get(ReadOptions(),
+                          InternalKey(user_key, 0, kTypeValue).Encode(),
+                          &get_context));
+    if (i % 2 == 0) {
+      ASSERT_EQ(get_context.State(), GetContext::kFound);
+      ASSERT_EQ(std::string(user_key) + "-value", value);
+    } else {
+      ASSERT_EQ(get_context.State(), GetContext::kNotFound);
+    }
+  }
+}
+
+TEST_F(BlockBasedTableTest, DataBlockHashIndexComparator) {
+  BlockBasedTableOptions table_options;
+  table_options.data_block_hash_index = true;
+  std::unique_ptr<TableFactory> factory(
+      NewBlockBasedTableFactory(table_options));
+
+  ColumnFamilyOptions cf_opts;
+  ASSERT_OK(factory->SanitizeOptions(DBOptions(), cf_opts));
+  cf_opts.comparator = ReverseBytewiseComparator();
+  ASSERT_OK(factory->SanitizeOptions(DBOptions(), cf_opts));
+  // other comparators may treat different bytes as equal keys
+  cf_opts.comparator = test::Uint64Comparator();
+  ASSERT_TRUE(
+      factory->SanitizeOptions(DBOptions(), cf_opts).IsInvalidArgument());
+}
+
+TEST_F(BlockBasedTableTest, ParallelCompression) {
+  if (!Zlib_Supported()) {
+    fprintf(stderr, "skipping zlib compression test\n");
+    return;
+  }
+  Random rnd(301);
+  stl_wrappers::KVMap kvmap;
+  for (int i = 0; i < 2000; i++) {
+    char key[16];
+    snprintf(key, sizeof(key), "key%06d", i);
+    // Compressible values, so that most blocks end up compressed
+    kvmap[key] = test::RandomHumanReadableString(&rnd, 20) +
+                 std::string(100, 'a' + (i % 26));
+  }
+
+  // The same table must be produced with and without parallel compression.
+  std::string contents[2];
+  for (int i = 0; i < 2; i++) {
+    Options options;
+    options.compression = kZlibCompression;
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    table_options.parallel_compression_threads = i == 0 ? 1 : 4;
+    table_options.filter_policy.reset(NewBloomFilterPolicy(10, false));
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+    TableConstructor c(BytewiseComparator(), true /* convert_to_internal_key */);
+    for (const auto& kv : kvmap) {
+      c.Add(kv.first, kv.second);
+    }
+    std::vector<std::string> keys;
+    stl_wrappers::KVMap result_kvmap;
+    const ImmutableCFOptions ioptions(options);
+    c.Finish(options, ioptions, table_options,
+             GetPlainInternalComparator(options.comparator), &keys,
+             &result_kvmap);
+    contents[i] = c.GetSink()->contents();
+    ASSERT_GT(c.GetTableReader()->GetTableProperties()->num_data_blocks, 10U);
+
+    std::unique_ptr<InternalIterator> iter(c.NewIterator());
+    auto expected = kvmap.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != kvmap.end());
+      ASSERT_EQ(expected->first, iter->key().ToString());
+      ASSERT_EQ(expected->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected == kvmap.end());
+  }
+  ASSERT_EQ(contents[0], contents[1]);
+}
+
 TEST_F(BlockBasedTableTest, BlockCacheLeak) {
   // Check that when we reopen a table we don't lose access to blocks already
   // in the cache. This test checks whether the Table actually makes use of the
@@ -9,6 +9,13 @@
 
 #include "rocksdb/filter_policy.h"
 
+#include <string.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE4_1__)
+#include <smmintrin.h>
+#endif
+
 #include "rocksdb/slice.h"
 #include "table/block_based_filter_block.h"
 #include "table/full_filter_block.h"
@@ -254,12 +261,189 @@ bool FullFilterBitsReader::HashMayMatch(const uint32_t& hash,
   return true;
 }
 
+// Cache-line-blocked full filter, selected by use_blocked_full_filter in
+// NewBloomFilterPolicy().
+//
+// Like the legacy full filter, every probe for a key lands in one line, but
+// the line size is fixed on disk rather than taken from CACHE_LINE_SIZE, the
+// probe positions are derived from an independent rehash of the key hash, and
+// the lookup tests the whole line against a probe mask with vector
+// instructions instead of branching on every probe.
+// +----------------------------------------------------------------+
+// |        filter data: num_lines * kBlockedLineBytes bytes        |
+// +----------------------------------------------------------------+
+// | ...  | num_probes : 1 byte | 0 : 1 byte | num_lines : 4 bytes  |
+// +----------------------------------------------------------------+
+// The zero byte sits where the legacy format keeps num_probes, so readers
+// that predate this format see a broken filter and always report a match.
+const uint32_t kBlockedLineBytes = 64;
+const uint32_t kBlockedLineBits = kBlockedLineBytes * 8;
+const uint32_t kBlockedTrailerSize = 6;
+
+// Returns true if the filter contents use the cache-line-blocked format.
+bool IsBlockedFullFilter(const Slice& filter) {
+  return filter.size() >= kBlockedTrailerSize &&
+         filter.data()[filter.size() - 5] == 0;
+}
+
+// Map a hash onto [0, num_lines) without a division.
+inline uint32_t BlockedLineIndex(uint32_t h, uint32_t num_lines) {
+  return static_cast<uint32_t>((static_cast<uint64_t>(h) * num_lines) >> 32);
+}
+
+// Fill mask, an image of one filter line, with the bits probed for hash h.
+inline void BlockedProbeMask(uint32_t h, size_t num_probes, char* mask) {
+  memset(mask, 0, kBlockedLineBytes);
+  uint32_t x = (h >> 17) | (h << 15);  // Rotate right 17 bits
+  for (size_t i = 0; i < num_probes; ++i) {
+    // The top bits of a multiplicative hash are the well mixed ones.
+    x *= 0x9e3779b9U;
+    const uint32_t bitpos = x >> 23;  // [0, kBlockedLineBits)
+    mask[bitpos / 8] |= static_cast<char>(1 << (bitpos % 8));
+  }
+}
+
+// Returns true if every bit set in mask is also set in line.
+inline bool BlockedLineContains(const char* line, const char* mask) {
+#if defined(__AVX2__)
+  const __m256i* l = reinterpret_cast<const __m256i*>(line);
+  const __m256i* m = reinterpret_cast<const __m256i*>(mask);
+  // testc computes ((~line & mask) == 0)
+  return _mm256_testc_si256(_mm256_loadu_si256(l),
+                            _mm256_loadu_si256(m)) &
+         _mm256_testc_si256(_mm256_loadu_si256(l + 1),
+                            _mm256_loadu_si256(m + 1));
+#elif defined(__SSE4_1__)
+  const __m128i* l = reinterpret_cast<const __m128i*>(line);
+  const __m128i* m = reinterpret_cast<const __m128i*>(mask);
+  int found = 1;
+  for (uint32_t i = 0; i < kBlockedLineBytes / 16; ++i) {
+    found &= _mm_testc_si128(_mm_loadu_si128(l + i), _mm_loadu_si128(m + i));
+  }
+  return found != 0;
+#else
+  uint64_t missing = 0;
+  for (uint32_t i = 0; i < kBlockedLineBytes; i += 8) {
+    uint64_t l, m;
+    memcpy(&l, line + i, sizeof(l));
+    memcpy(&m, mask + i, sizeof(m));
+    missing |= m & ~l;
+  }
+  return missing == 0;
+#endif
+}
+
+class BlockedFullFilterBitsBuilder : public FilterBitsBuilder {
+ public:
+  explicit BlockedFullFilterBitsBuilder(const size_t bits_per_key,
+                                        const size_t num_probes)
+      : bits_per_key_(bits_per_key),
+        num_probes_(num_probes) {
+    assert(bits_per_key_);
+  }
+
+  ~BlockedFullFilterBitsBuilder() {}
+
+  virtual void AddKey(const Slice& key) override {
+    uint32_t hash = BloomHash(key);
+    if (hash_entries_.size() == 0 || hash != hash_entries_.back()) {
+      hash_entries_.push_back(hash);
+    }
+  }
+
+  virtual Slice Finish(std::unique_ptr<const char[]>* buf) override {
+    uint32_t num_lines = 0;
+    if (!hash_entries_.empty()) {
+      uint64_t total_bits =
+          static_cast<uint64_t>(hash_entries_.size()) * bits_per_key_;
+      num_lines = static_cast<uint32_t>(
+          (total_bits + kBlockedLineBits - 1) / kBlockedLineBits);
+    }
+
+    uint32_t data_len = num_lines * kBlockedLineBytes;
+    char* data = new char[data_len + kBlockedTrailerSize];
+    memset(data, 0, data_len + kBlockedTrailerSize);
+
+    char mask[kBlockedLineBytes];
+    for (auto h : hash_entries_) {
+      char* line = data + BlockedLineIndex(h, num_lines) * kBlockedLineBytes;
+      BlockedProbeMask(h, num_probes_, mask);
+      for (uint32_t i = 0; i < kBlockedLineBytes; ++i) {
+        line[i] |= mask[i];
+      }
+    }
+    data[data_len] = static_cast<char>(num_probes_);
+    data[data_len + 1] = 0;
+    EncodeFixed32(data + data_len + 2, num_lines);
+
+    const char* const_data = data;
+    buf->reset(const_data);
+    hash_entries_.clear();
+
+    return Slice(data, data_len + kBlockedTrailerSize);
+  }
+
+ private:
+  size_t bits_per_key_;
+  size_t num_probes_;
+  std::vector<uint32_t> hash_entries_;
+
+  // No Copy allowed
+  BlockedFullFilterBitsBuilder(const BlockedFullFilterBitsBuilder&);
+  void operator=(const BlockedFullFilterBitsBuilder&);
+};
+
+class BlockedFullFilterBitsReader : public FilterBitsReader {
+ public:
+  explicit BlockedFullFilterBitsReader(const Slice& contents)
+      : data_(contents.data()),
+        num_probes_(0),
+        num_lines_(0),
+        broken_(false) {
+    assert(IsBlockedFullFilter(contents));
+    const size_t len = contents.size();
+    num_probes_ = static_cast<unsigned char>(data_[len - 6]);
+    num_lines_ = DecodeFixed32(data_ + len - 4);
+    // Sanitize broken parameter
+    if (len - kBlockedTrailerSize !=
+            static_cast<uint64_t>(num_lines_) * kBlockedLineBytes ||
+        num_probes_ == 0) {
+      broken_ = true;
+    }
+  }
+
+  ~BlockedFullFilterBitsReader() {}
+
+  virtual bool MayMatch(const Slice& entry) override {
+    // A broken filter is regarded as match
+    if (broken_) return true;
+    if (num_lines_ == 0) return false;  // empty filter
+    uint32_t hash = BloomHash(entry);
+    char mask[kBlockedLineBytes];
+    BlockedProbeMask(hash, num_probes_, mask);
+    return BlockedLineContains(
+        data_ + BlockedLineIndex(hash, num_lines_) * kBlockedLineBytes, mask);
+  }
+
+ private:
+  const char* data_;
+  size_t num_probes_;
+  uint32_t num_lines_;
+  bool broken_;
+
+  // No Copy allowed
+  BlockedFullFilterBitsReader(const BlockedFullFilterBitsReader&);
+  void operator=(const BlockedFullFilterBitsReader&);
+};
+
 // An implementation of filter policy
 class BloomFilterPolicy : public FilterPolicy {
  public:
-  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder)
+  explicit BloomFilterPolicy(int bits_per_key, bool use_block_based_builder,
+                             bool use_blocked_full_filter)
       : bits_per_key_(bits_per_key), hash_func_(BloomHash),
-        use_block_based_builder_(use_block_based_builder) {
+        use_block_based_builder_(use_block_based_builder),
+        use_blocked_full_filter_(use_blocked_full_filter) {
     initialize();
   }
 
@@ -331,11 +515,19 @@ class BloomFilterPolicy : public FilterPolicy {
       return nullptr;
     }
 
+    if (use_blocked_full_filter_) {
+      return new BlockedFullFilterBitsBuilder(bits_per_key_, num_probes_);
+    }
     return new FullFilterBitsBuilder(bits_per_key_, num_probes_);
   }
 
+  // The format is detected from the contents, so filters written with
+  // either setting remain readable.
   virtual FilterBitsReader* GetFilterBitsReader(const Slice& contents)
       const override {
+    if (IsBlockedFullFilter(contents)) {
+      return new BlockedFullFilterBitsReader(contents);
+    }
     return new FullFilterBitsReader(contents);
   }
 
@@ -348,6 +540,7 @@ class BloomFilterPolicy : public FilterPolicy {
   uint32_t (*hash_func_)(const Slice& key);
 
   const bool use_block_based_builder_;
+  const bool use_blocked_full_filter_;
 
   void initialize() {
     // We intentionally round down to reduce probing cost a little bit
@@ -360,8 +553,10 @@ class BloomFilterPolicy : public FilterPolicy {
 }  // namespace
 
 const FilterPolicy* NewBloomFilterPolicy(int bits_per_key,
-                                         bool use_block_based_builder) {
-  return new BloomFilterPolicy(bits_per_key, use_block_based_builder);
+                                         bool use_block_based_builder,
+                                         bool use_blocked_full_filter) {
+  return new BloomFilterPolicy(bits_per_key, use_block_based_builder,
+                               use_blocked_full_filter);
 }
 
 }  // namespace rocksdb
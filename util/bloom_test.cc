@@ -189,6 +189,13 @@ class FullBloomTest : public testing::Test {
     Reset();
   }
 
+  explicit FullBloomTest(bool use_blocked_full_filter) :
+      policy_(NewBloomFilterPolicy(FLAGS_bits_per_key, false,
+                                   use_blocked_full_filter)),
+      filter_size_(0) {
+    Reset();
+  }
+
   ~FullBloomTest() {
     delete policy_;
   }
@@ -289,6 +296,92 @@ TEST_F(FullBloomTest, FullVaryingLengths) {
   ASSERT_LE(mediocre_filters, good_filters/5);
 }
 
+class BlockedFullBloomTest : public FullBloomTest {
+ public:
+  BlockedFullBloomTest() : FullBloomTest(true) {}
+};
+
+TEST_F(BlockedFullBloomTest, BlockedEmptyFilter) {
+  ASSERT_TRUE(!Matches("hello"));
+  ASSERT_TRUE(!Matches("world"));
+}
+
+TEST_F(BlockedFullBloomTest, BlockedSmall) {
+  Add("hello");
+  Add("world");
+  ASSERT_TRUE(Matches("hello"));
+  ASSERT_TRUE(Matches("world"));
+  ASSERT_TRUE(!Matches("x"));
+  ASSERT_TRUE(!Matches("foo"));
+}
+
+TEST_F(BlockedFullBloomTest, BlockedVaryingLengths) {
+  char buffer[sizeof(int)];
+
+  // Count number of filters that significantly exceed the false positive rate
+  int mediocre_filters = 0;
+  int good_filters = 0;
+
+  for (int length = 1; length <= 10000; length = NextLength(length)) {
+    Reset();
+    for (int i = 0; i < length; i++) {
+      Add(Key(i, buffer));
+    }
+    Build();
+
+    ASSERT_LE(FilterSize(), (size_t)((length * 10 / 8) + 64 + 6)) << length;
+
+    // All added keys must match
+    for (int i = 0; i < length; i++) {
+      ASSERT_TRUE(Matches(Key(i, buffer)))
+          << "Length " << length << "; key " << i;
+    }
+
+    // Check false positive rate
+    double rate = FalsePositiveRate();
+    if (kVerbose >= 1) {
+      fprintf(stderr, "False positives: %5.2f%% @ length = %6d ; bytes = %6d\n",
+              rate*100.0, length, static_cast<int>(FilterSize()));
+    }
+    ASSERT_LE(rate, 0.02);   // Must not be over 2%
+    if (rate > 0.0125)
+      mediocre_filters++;  // Allowed, but not too often
+    else
+      good_filters++;
+  }
+  if (kVerbose >= 1) {
+    fprintf(stderr, "Filters: %d good, %d mediocre\n",
+            good_filters, mediocre_filters);
+  }
+  ASSERT_LE(mediocre_filters, good_filters/5);
+}
+
+TEST_F(BlockedFullBloomTest, ReadAcrossFormats) {
+  char buffer[sizeof(int)];
+  std::unique_ptr<const FilterPolicy> legacy_policy(
+      NewBloomFilterPolicy(FLAGS_bits_per_key, false, false));
+  std::unique_ptr<const FilterPolicy> blocked_policy(
+      NewBloomFilterPolicy(FLAGS_bits_per_key, false, true));
+
+  for (auto* writer : {legacy_policy.get(), blocked_policy.get()}) {
+    std::unique_ptr<FilterBitsBuilder> builder(writer->GetFilterBitsBuilder());
+    for (int i = 0; i < 1000; i++) {
+      builder->AddKey(Key(i, buffer));
+    }
+    std::unique_ptr<const char[]> buf;
+    Slice filter = builder->Finish(&buf);
+
+    // Either policy must read filters written in either format
+    for (auto* reader_policy : {legacy_policy.get(), blocked_policy.get()}) {
+      std::unique_ptr<FilterBitsReader> reader(
+          reader_policy->GetFilterBitsReader(filter));
+      for (int i = 0; i < 1000; i++) {
+        ASSERT_TRUE(reader->MayMatch(Key(i, buffer)));
+      }
+    }
+  }
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -14,6 +14,7 @@
 #include <string>
 
 #include "rocksdb/options.h"
+#include "rocksdb/slice.h"
 #include "util/coding.h"
 
 #ifdef SNAPPY
@@ -181,10 +182,14 @@ inline bool GetDecompressedSizeInfo(const char** input_data,
 // block header
 // compress_format_version == 2 -- decompressed size is included in the block
 // header in varint32 format
+//
+// "compression_dict", if not empty, primes the compressor. The same
+// dictionary has to be passed to Zlib_Uncompress().
 inline bool Zlib_Compress(const CompressionOptions& opts,
                           uint32_t compress_format_version,
                           const char* input, size_t length,
-                          ::std::string* output) {
+                          ::std::string* output,
+                          const Slice& compression_dict = Slice()) {
 #ifdef ZLIB
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -214,6 +219,17 @@ inline bool Zlib_Compress(const CompressionOptions& opts,
     return false;
   }
 
+  if (compression_dict.size()) {
+    // Initialize the compression library's dictionary
+    st = deflateSetDictionary(
+        &_stream, reinterpret_cast<const Bytef*>(compression_dict.data()),
+        static_cast<unsigned int>(compression_dict.size()));
+    if (st != Z_OK) {
+      deflateEnd(&_stream);
+      return false;
+    }
+  }
+
   // Compress the input, and put compressed data in output.
   _stream.next_in = (Bytef *)input;
   _stream.avail_in = static_cast<unsigned int>(length);
@@ -254,6 +270,7 @@ inline bool Zlib_Compress(const CompressionOptions& opts,
 inline char* Zlib_Uncompress(const char* input_data, size_t input_length,
                              int* decompress_size,
                              uint32_t compress_format_version,
+                             const Slice& compression_dict = Slice(),
                              int windowBits = -14) {
 #ifdef ZLIB
   uint32_t output_len = 0;
@@ -283,6 +300,18 @@ inline char* Zlib_Uncompress(const char* input_data, size_t input_length,
     return nullptr;
   }
 
+  // A raw deflate stream does not ask for its dictionary, so it has to be set
+  // up front. Streams with a zlib header report Z_NEED_DICT instead.
+  if (compression_dict.size() && windowBits < 0) {
+    st = inflateSetDictionary(
+        &_stream, reinterpret_cast<const Bytef*>(compression_dict.data()),
+        static_cast<unsigned int>(compression_dict.size()));
+    if (st != Z_OK) {
+      inflateEnd(&_stream);
+      return nullptr;
+    }
+  }
+
   _stream.next_in = (Bytef *)input_data;
   _stream.avail_in = static_cast<unsigned int>(input_length);
 
@@ -316,6 +345,17 @@ inline char* Zlib_Uncompress(const char* input_data, size_t input_length,
         _stream.avail_out = static_cast<unsigned int>(output_len - old_sz);
         break;
       }
+      case Z_NEED_DICT:
+        if (compression_dict.size() &&
+            inflateSetDictionary(
+                &_stream,
+                reinterpret_cast<const Bytef*>(compression_dict.data()),
+                static_cast<unsigned int>(compression_dict.size())) == Z_OK) {
+          break;
+        }
+        delete[] output;
+        inflateEnd(&_stream);
+        return nullptr;
       case Z_BUF_ERROR:
       default:
         delete[] output;
@@ -482,9 +522,13 @@ inline char* BZip2_Uncompress(const char* input_data, size_t input_length,
 // block header using memcpy, which makes database non-portable)
 // compress_format_version == 2 -- decompressed size is included in the block
 // header in varint32 format
+//
+// "compression_dict", if not empty, primes the compressor. The same
+// dictionary has to be passed to LZ4_Uncompress().
 inline bool LZ4_Compress(const CompressionOptions& opts,
                          uint32_t compress_format_version, const char* input,
-                         size_t length, ::std::string* output) {
+                         size_t length, ::std::string* output,
+                         const Slice& compression_dict = Slice()) {
 #ifdef LZ4
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -507,9 +551,25 @@ inline bool LZ4_Compress(const CompressionOptions& opts,
 
   int compressBound = LZ4_compressBound(static_cast<int>(length));
   output->resize(static_cast<size_t>(output_header_len + compressBound));
-  int outlen =
-      LZ4_compress_limitedOutput(input, &(*output)[output_header_len],
-                                 static_cast<int>(length), compressBound);
+  int outlen;
+#if LZ4_VERSION_NUMBER >= 10400  // r124+
+  if (compression_dict.size()) {
+    LZ4_stream_t* stream = LZ4_createStream();
+    LZ4_loadDict(stream, compression_dict.data(),
+                 static_cast<int>(compression_dict.size()));
+    outlen = LZ4_compress_limitedOutput_continue(
+        stream, input, &(*output)[output_header_len], static_cast<int>(length),
+        compressBound);
+    LZ4_freeStream(stream);
+  } else {
+    outlen = LZ4_compress_limitedOutput(input, &(*output)[output_header_len],
+                                        static_cast<int>(length),
+                                        compressBound);
+  }
+#else   // up to r123
+  outlen = LZ4_compress_limitedOutput(input, &(*output)[output_header_len],
+                                      static_cast<int>(length), compressBound);
+#endif  // LZ4_VERSION_NUMBER >= 10400
   if (outlen == 0) {
     return false;
   }
@@ -525,7 +585,8 @@ inline bool LZ4_Compress(const CompressionOptions& opts,
 // header in varint32 format
 inline char* LZ4_Uncompress(const char* input_data, size_t input_length,
                             int* decompress_size,
-                            uint32_t compress_format_version) {
+                            uint32_t compress_format_version,
+                            const Slice& compression_dict = Slice()) {
 #ifdef LZ4
   uint32_t output_len = 0;
   if (compress_format_version == 2) {
@@ -545,9 +606,22 @@ inline char* LZ4_Uncompress(const char* input_data, size_t input_length,
     input_data += 8;
   }
   char* output = new char[output_len];
+#if LZ4_VERSION_NUMBER >= 10400  // r124+
+  if (compression_dict.size()) {
+    *decompress_size = LZ4_decompress_safe_usingDict(
+        input_data, output, static_cast<int>(input_length),
+        static_cast<int>(output_len), compression_dict.data(),
+        static_cast<int>(compression_dict.size()));
+  } else {
+    *decompress_size =
+        LZ4_decompress_safe(input_data, output, static_cast<int>(input_length),
+                            static_cast<int>(output_len));
+  }
+#else   // up to r123
   *decompress_size =
       LZ4_decompress_safe(input_data, output, static_cast<int>(input_length),
                           static_cast<int>(output_len));
+#endif  // LZ4_VERSION_NUMBER >= 10400
   if (*decompress_size < 0) {
     delete[] output;
     return nullptr;
@@ -562,9 +636,13 @@ inline char* LZ4_Uncompress(const char* input_data, size_t input_length,
 // block header using memcpy, which makes database non-portable)
 // compress_format_version == 2 -- decompressed size is included in the block
 // header in varint32 format
+//
+// "compression_dict", if not empty, primes the compressor. The same
+// dictionary has to be passed to LZ4_Uncompress().
 inline bool LZ4HC_Compress(const CompressionOptions& opts,
                            uint32_t compress_format_version, const char* input,
-                           size_t length, ::std::string* output) {
+                           size_t length, ::std::string* output,
+                           const Slice& compression_dict = Slice()) {
 #ifdef LZ4
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -588,7 +666,22 @@ inline bool LZ4HC_Compress(const CompressionOptions& opts,
   int compressBound = LZ4_compressBound(static_cast<int>(length));
   output->resize(static_cast<size_t>(output_header_len + compressBound));
   int outlen;
-#ifdef LZ4_VERSION_MAJOR  // they only started defining this since r113
+#if LZ4_VERSION_NUMBER >= 10400  // r124+
+  if (compression_dict.size()) {
+    LZ4_streamHC_t* stream = LZ4_createStreamHC();
+    LZ4_resetStreamHC(stream, opts.level);
+    LZ4_loadDictHC(stream, compression_dict.data(),
+                   static_cast<int>(compression_dict.size()));
+    outlen = LZ4_compressHC_limitedOutput_continue(
+        stream, input, &(*output)[output_header_len], static_cast<int>(length),
+        compressBound);
+    LZ4_freeStreamHC(stream);
+  } else {
+    outlen = LZ4_compressHC2_limitedOutput(
+        input, &(*output)[output_header_len], static_cast<int>(length),
+        compressBound, opts.level);
+  }
+#elif defined(LZ4_VERSION_MAJOR)  // they only started defining this since r113
   outlen = LZ4_compressHC2_limitedOutput(input, &(*output)[output_header_len],
                                          static_cast<int>(length),
                                          compressBound, opts.level);
@@ -606,8 +699,12 @@ inline bool LZ4HC_Compress(const CompressionOptions& opts,
   return false;
 }
 
+// "compression_dict", if not empty, primes the compressor. The same
+// dictionary has to be passed to ZSTD_Uncompress(). Dictionaries need ZSTD
+// 0.5 or newer and are ignored by older versions.
 inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
-                          size_t length, ::std::string* output) {
+                          size_t length, ::std::string* output,
+                          const Slice& compression_dict = Slice()) {
 #ifdef ZSTD
   if (length > std::numeric_limits<uint32_t>::max()) {
     // Can't compress more than 4GB
@@ -619,9 +716,23 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
 
   size_t compressBound = ZSTD_compressBound(length);
   output->resize(static_cast<size_t>(output_header_len + compressBound));
-  size_t outlen = ZSTD_compress(&(*output)[output_header_len], compressBound,
-                                input, length);
-  if (outlen == 0) {
+  size_t outlen;
+#if ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
+  if (compression_dict.size()) {
+    ZSTD_CCtx* context = ZSTD_createCCtx();
+    outlen = ZSTD_compress_usingDict(
+        context, &(*output)[output_header_len], compressBound, input, length,
+        compression_dict.data(), compression_dict.size(), 1 /* level */);
+    ZSTD_freeCCtx(context);
+  } else {
+    outlen = ZSTD_compress(&(*output)[output_header_len], compressBound, input,
+                           length, 1 /* level */);
+  }
+#else   // up to v0.4.x
+  outlen = ZSTD_compress(&(*output)[output_header_len], compressBound, input,
+                         length);
+#endif  // ZSTD_VERSION_NUMBER >= 500
+  if (outlen == 0 || ZSTD_isError(outlen)) {
     return false;
   }
   output->resize(output_header_len + outlen);
@@ -631,7 +742,8 @@ inline bool ZSTD_Compress(const CompressionOptions& opts, const char* input,
 }
 
 inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
-                             int* decompress_size) {
+                             int* decompress_size,
+                             const Slice& compression_dict = Slice()) {
 #ifdef ZSTD
   uint32_t output_len = 0;
   if (!compression::GetDecompressedSizeInfo(&input_data, &input_length,
@@ -640,8 +752,22 @@ inline char* ZSTD_Uncompress(const char* input_data, size_t input_length,
   }
 
   char* output = new char[output_len];
-  size_t actual_output_length =
+  size_t actual_output_length;
+#if ZSTD_VERSION_NUMBER >= 500  // v0.5.0+
+  if (compression_dict.size()) {
+    ZSTD_DCtx* context = ZSTD_createDCtx();
+    actual_output_length = ZSTD_decompress_usingDict(
+        context, output, output_len, input_data, input_length,
+        compression_dict.data(), compression_dict.size());
+    ZSTD_freeDCtx(context);
+  } else {
+    actual_output_length =
+        ZSTD_decompress(output, output_len, input_data, input_length);
+  }
+#else   // up to v0.4.x
+  actual_output_length =
       ZSTD_decompress(output, output_len, input_data, input_length);
+#endif  // ZSTD_VERSION_NUMBER >= 500
   assert(actual_output_length == output_len);
   *decompress_size = static_cast<int>(actual_output_length);
   return output;
@@ -276,6 +276,22 @@ class PosixRandomAccessFile: public RandomAccessFile {
     }
   }
 
+  virtual Status Prefetch(uint64_t offset, size_t n) override {
+#ifndef OS_LINUX
+    return Status::OK();
+#else
+    if (!use_os_buffer_) {
+      // The pages would be dropped before they are read.
+      return Status::OK();
+    }
+    int ret = Fadvise(fd_, static_cast<off_t>(offset), n, POSIX_FADV_WILLNEED);
+    if (ret == 0) {
+      return Status::OK();
+    }
+    return IOError(filename_, errno);
+#endif
+  }
+
   virtual Status InvalidateCache(size_t offset, size_t length) override {
 #ifndef OS_LINUX
     return Status::OK();
@@ -0,0 +1,73 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/frequency_sketch.h"
+
+#include <algorithm>
+
+namespace rocksdb {
+
+const uint32_t FrequencySketch::kMaxFrequency;
+const int FrequencySketch::kDepth;
+
+FrequencySketch::FrequencySketch(size_t num_counters) : num_recorded_(0) {
+  size_t width = 16;
+  while (width < num_counters) {
+    width <<= 1;
+  }
+  mask_ = width - 1;
+  sample_size_ = 10 * width;
+  counters_.reset(new std::atomic<uint8_t>[kDepth * width]);
+  for (size_t i = 0; i < kDepth * width; i++) {
+    counters_[i].store(0, std::memory_order_relaxed);
+  }
+}
+
+size_t FrequencySketch::Index(uint32_t hash, int row) const {
+  // Double hashing, as in the bloom filters
+  const uint32_t delta = (hash >> 17) | (hash << 15) | 1;
+  return static_cast<size_t>(row) * (mask_ + 1) +
+         ((hash + static_cast<uint32_t>(row) * delta) & mask_);
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  uint32_t frequency = kMaxFrequency;
+  for (int row = 0; row < kDepth; row++) {
+    frequency = std::min<uint32_t>(
+        frequency,
+        counters_[Index(hash, row)].load(std::memory_order_relaxed));
+  }
+  return frequency;
+}
+
+uint32_t FrequencySketch::Record(uint32_t hash) {
+  // Conservative update: only the smallest counters are incremented, which
+  // keeps collisions from inflating the estimates of other hashes.
+  const uint32_t frequency = Estimate(hash);
+  if (frequency < kMaxFrequency) {
+    for (int row = 0; row < kDepth; row++) {
+      auto& counter = counters_[Index(hash, row)];
+      if (counter.load(std::memory_order_relaxed) == frequency) {
+        counter.store(static_cast<uint8_t>(frequency + 1),
+                      std::memory_order_relaxed);
+      }
+    }
+  }
+  if (num_recorded_.fetch_add(1, std::memory_order_relaxed) + 1 ==
+      sample_size_) {
+    Age();
+  }
+  return std::min(frequency + 1, kMaxFrequency);
+}
+
+void FrequencySketch::Age() {
+  for (size_t i = 0; i < kDepth * (mask_ + 1); i++) {
+    counters_[i].store(counters_[i].load(std::memory_order_relaxed) >> 1,
+                       std::memory_order_relaxed);
+  }
+  num_recorded_.fetch_sub(sample_size_ / 2, std::memory_order_relaxed);
+}
+
+}  // namespace rocksdb
@@ -0,0 +1,54 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+
+namespace rocksdb {
+
+// A count-min sketch that estimates how often a hash was recorded recently,
+// as used by TinyLFU cache admission. The counters are bytes that saturate at
+// kMaxFrequency. Once the number of recorded hashes reaches ten times the
+// number of counters per row, all counters are halved, so that the estimates
+// favor recent accesses.
+//
+// Multithreaded access is OK. Concurrent updates may be lost, which only
+// makes the estimates a bit less accurate.
+class FrequencySketch {
+ public:
+  static const uint32_t kMaxFrequency = 15;
+
+  // "num_counters" is the number of counters per row, rounded up to a power
+  // of two. It should be about the number of distinct hashes that are
+  // expected to be frequent at the same time.
+  explicit FrequencySketch(size_t num_counters);
+
+  // Records an access to "hash" and returns the estimated number of recent
+  // accesses to it, including this one, up to kMaxFrequency.
+  uint32_t Record(uint32_t hash);
+
+  // Returns the estimated number of recent accesses to "hash".
+  uint32_t Estimate(uint32_t hash) const;
+
+  size_t ApproximateMemoryUsage() const { return kDepth * (mask_ + 1); }
+
+ private:
+  static const int kDepth = 4;
+
+  size_t Index(uint32_t hash, int row) const;
+  void Age();
+
+  size_t mask_;
+  size_t sample_size_;
+  std::unique_ptr<std::atomic<uint8_t>[]> counters_;
+  std::atomic<size_t> num_recorded_;
+};
+
+}  // namespace rocksdb
@@ -0,0 +1,71 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#include "util/frequency_sketch.h"
+
+#include "rocksdb/slice.h"
+#include "util/hash.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+
+namespace rocksdb {
+
+class FrequencySketchTest : public testing::Test {};
+
+static uint32_t KeyHash(int i) {
+  std::string key = "key" + ToString(i);
+  return Hash(key.data(), key.size(), 0);
+}
+
+TEST_F(FrequencySketchTest, Estimate) {
+  FrequencySketch sketch(1024);
+  ASSERT_EQ(0U, sketch.Estimate(KeyHash(0)));
+  for (uint32_t i = 1; i <= 5; i++) {
+    ASSERT_EQ(i, sketch.Record(KeyHash(0)));
+  }
+  ASSERT_EQ(5U, sketch.Estimate(KeyHash(0)));
+  ASSERT_EQ(0U, sketch.Estimate(KeyHash(1)));
+
+  for (int i = 0; i < 100; i++) {
+    sketch.Record(KeyHash(1));
+  }
+  ASSERT_EQ(FrequencySketch::kMaxFrequency, sketch.Estimate(KeyHash(1)));
+}
+
+TEST_F(FrequencySketchTest, FewCollisions) {
+  FrequencySketch sketch(1024);
+  for (int i = 0; i < 256; i++) {
+    sketch.Record(KeyHash(i));
+  }
+  int overestimated = 0;
+  for (int i = 0; i < 256; i++) {
+    uint32_t estimate = sketch.Estimate(KeyHash(i));
+    ASSERT_GE(estimate, 1U);
+    if (estimate > 1) {
+      overestimated++;
+    }
+  }
+  ASSERT_LT(overestimated, 5);
+}
+
+TEST_F(FrequencySketchTest, Aging) {
+  FrequencySketch sketch(1024);
+  for (int i = 0; i < 8; i++) {
+    sketch.Record(KeyHash(0));
+  }
+  ASSERT_EQ(8U, sketch.Estimate(KeyHash(0)));
+  // Recording ten times the width halves all the counters
+  for (int i = 8; i < 10 * 1024; i++) {
+    sketch.Record(KeyHash(i));
+  }
+  ASSERT_EQ(4U, sketch.Estimate(KeyHash(0)));
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
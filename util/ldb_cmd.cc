@@ -1407,6 +1407,13 @@ class InMemoryHandler : public WriteBatch::Handler {
     row_ << LDBCommand::StringToHex(key.ToString()) << " ";
   }
 
+  virtual void DeleteRange(const Slice& begin_key,
+                           const Slice& end_key) override {
+    row_ << ",DELETE_RANGE : ";
+    row_ << LDBCommand::StringToHex(begin_key.ToString()) << " ";
+    row_ << LDBCommand::StringToHex(end_key.ToString()) << " ";
+  }
+
   virtual ~InMemoryHandler() {}
 
  private:
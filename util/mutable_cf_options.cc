@@ -76,6 +76,8 @@ void MutableCFOptions::Dump(Logger* log) const {
       memtable_prefix_bloom_probes);
   Log(log, " memtable_prefix_bloom_huge_page_tlb_size: %" ROCKSDB_PRIszt,
       memtable_prefix_bloom_huge_page_tlb_size);
+  Log(log, "             memtable_whole_key_filtering: %d",
+      memtable_whole_key_filtering);
   Log(log, "                    max_successive_merges: %" ROCKSDB_PRIszt,
       max_successive_merges);
   Log(log, "                           filter_deletes: %d",
@@ -84,6 +86,8 @@ void MutableCFOptions::Dump(Logger* log) const {
       disable_auto_compactions);
   Log(log, "                          soft_rate_limit: %lf",
       soft_rate_limit);
+  Log(log, "      soft_pending_compaction_bytes_limit: %" PRIu64,
+      soft_pending_compaction_bytes_limit);
   Log(log, "      hard_pending_compaction_bytes_limit: %" PRIu64,
       hard_pending_compaction_bytes_limit);
   Log(log, "       level0_file_num_compaction_trigger: %d",
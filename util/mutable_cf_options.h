@@ -20,11 +20,14 @@ struct MutableCFOptions {
         memtable_prefix_bloom_probes(options.memtable_prefix_bloom_probes),
         memtable_prefix_bloom_huge_page_tlb_size(
             options.memtable_prefix_bloom_huge_page_tlb_size),
+        memtable_whole_key_filtering(options.memtable_whole_key_filtering),
         max_successive_merges(options.max_successive_merges),
         filter_deletes(options.filter_deletes),
         inplace_update_num_locks(options.inplace_update_num_locks),
         disable_auto_compactions(options.disable_auto_compactions),
         soft_rate_limit(options.soft_rate_limit),
+        soft_pending_compaction_bytes_limit(
+            options.soft_pending_compaction_bytes_limit),
         hard_pending_compaction_bytes_limit(
             options.hard_pending_compaction_bytes_limit),
         level0_file_num_compaction_trigger(
@@ -58,11 +61,13 @@ struct MutableCFOptions {
         memtable_prefix_bloom_bits(0),
         memtable_prefix_bloom_probes(0),
         memtable_prefix_bloom_huge_page_tlb_size(0),
+        memtable_whole_key_filtering(false),
         max_successive_merges(0),
         filter_deletes(false),
         inplace_update_num_locks(0),
         disable_auto_compactions(false),
         soft_rate_limit(0),
+        soft_pending_compaction_bytes_limit(0),
         hard_pending_compaction_bytes_limit(0),
         level0_file_num_compaction_trigger(0),
         level0_slowdown_writes_trigger(0),
@@ -108,6 +113,7 @@ struct MutableCFOptions {
   uint32_t memtable_prefix_bloom_bits;
   uint32_t memtable_prefix_bloom_probes;
   size_t memtable_prefix_bloom_huge_page_tlb_size;
+  bool memtable_whole_key_filtering;
   size_t max_successive_merges;
   bool filter_deletes;
   size_t inplace_update_num_locks;
@@ -115,6 +121,7 @@ struct MutableCFOptions {
   // Compaction related options
   bool disable_auto_compactions;
   double soft_rate_limit;
+  uint64_t soft_pending_compaction_bytes_limit;
   uint64_t hard_pending_compaction_bytes_limit;
   int level0_file_num_compaction_trigger;
   int level0_slowdown_writes_trigger;
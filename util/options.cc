@@ -53,6 +53,7 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
       allow_mmap_reads(options.allow_mmap_reads),
       allow_mmap_writes(options.allow_mmap_writes),
       db_paths(options.db_paths),
+      level_path_ids(options.level_path_ids),
       memtable_factory(options.memtable_factory.get()),
       table_factory(options.table_factory.get()),
       table_properties_collector_factories(
@@ -75,7 +76,11 @@ ImmutableCFOptions::ImmutableCFOptions(const Options& options)
       num_levels(options.num_levels),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
       listeners(options.listeners),
-      row_cache(options.row_cache) {}
+      row_cache(options.row_cache),
+      row_cache_admission_filter(options.row_cache_admission_filter),
+      row_cache_budget(options.row_cache_budget),
+      compaction_warm_block_cache(options.compaction_warm_block_cache),
+      expired_files_ttl(options.expired_files_ttl) {}
 
 ColumnFamilyOptions::ColumnFamilyOptions()
     : comparator(BytewiseComparator()),
@@ -103,6 +108,7 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       max_grandparent_overlap_factor(10),
       soft_rate_limit(0.0),
       hard_rate_limit(0.0),
+      soft_pending_compaction_bytes_limit(0),
       hard_pending_compaction_bytes_limit(0),
       rate_limit_delay_max_milliseconds(1000),
       arena_block_size(0),
@@ -122,12 +128,16 @@ ColumnFamilyOptions::ColumnFamilyOptions()
       memtable_prefix_bloom_bits(0),
       memtable_prefix_bloom_probes(6),
       memtable_prefix_bloom_huge_page_tlb_size(0),
+      memtable_whole_key_filtering(false),
       bloom_locality(0),
       max_successive_merges(0),
       min_partial_merge_operands(2),
       optimize_filters_for_hits(false),
       paranoid_file_checks(false),
-      compaction_measure_io_stats(false) {
+      compaction_measure_io_stats(false),
+      row_cache_budget(0),
+      compaction_warm_block_cache(false),
+      expired_files_ttl(0) {
   assert(memtable_factory.get() != nullptr);
 }
 
@@ -159,10 +169,13 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       max_bytes_for_level_multiplier(options.max_bytes_for_level_multiplier),
       max_bytes_for_level_multiplier_additional(
           options.max_bytes_for_level_multiplier_additional),
+      level_path_ids(options.level_path_ids),
       expanded_compaction_factor(options.expanded_compaction_factor),
       source_compaction_factor(options.source_compaction_factor),
       max_grandparent_overlap_factor(options.max_grandparent_overlap_factor),
       soft_rate_limit(options.soft_rate_limit),
+      soft_pending_compaction_bytes_limit(
+          options.soft_pending_compaction_bytes_limit),
       hard_pending_compaction_bytes_limit(
           options.hard_pending_compaction_bytes_limit),
       rate_limit_delay_max_milliseconds(
@@ -189,12 +202,16 @@ ColumnFamilyOptions::ColumnFamilyOptions(const Options& options)
       memtable_prefix_bloom_probes(options.memtable_prefix_bloom_probes),
       memtable_prefix_bloom_huge_page_tlb_size(
           options.memtable_prefix_bloom_huge_page_tlb_size),
+      memtable_whole_key_filtering(options.memtable_whole_key_filtering),
       bloom_locality(options.bloom_locality),
       max_successive_merges(options.max_successive_merges),
       min_partial_merge_operands(options.min_partial_merge_operands),
       optimize_filters_for_hits(options.optimize_filters_for_hits),
       paranoid_file_checks(options.paranoid_file_checks),
-      compaction_measure_io_stats(options.compaction_measure_io_stats) {
+      compaction_measure_io_stats(options.compaction_measure_io_stats),
+      row_cache_budget(options.row_cache_budget),
+      compaction_warm_block_cache(options.compaction_warm_block_cache),
+      expired_files_ttl(options.expired_files_ttl) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
       static_cast<unsigned int>(num_levels)) {
@@ -218,6 +235,7 @@ DBOptions::DBOptions()
 #endif  // NDEBUG
       max_open_files(5000),
       max_file_opening_threads(1),
+      open_files_lazily(false),
       max_total_wal_size(0),
       statistics(nullptr),
       disableDataSync(false),
@@ -255,7 +273,8 @@ DBOptions::DBOptions()
       enable_thread_tracking(false),
       delayed_write_rate(1024U * 1024U),
       skip_stats_update_on_db_open(false),
-      wal_recovery_mode(WALRecoveryMode::kTolerateCorruptedTailRecords) {
+      wal_recovery_mode(WALRecoveryMode::kTolerateCorruptedTailRecords),
+      row_cache_admission_filter(false) {
 }
 
 DBOptions::DBOptions(const Options& options)
@@ -270,6 +289,7 @@ DBOptions::DBOptions(const Options& options)
       info_log_level(options.info_log_level),
       max_open_files(options.max_open_files),
       max_file_opening_threads(options.max_file_opening_threads),
+      open_files_lazily(options.open_files_lazily),
       max_total_wal_size(options.max_total_wal_size),
       statistics(options.statistics),
       disableDataSync(options.disableDataSync),
@@ -311,7 +331,8 @@ DBOptions::DBOptions(const Options& options)
       delayed_write_rate(options.delayed_write_rate),
       skip_stats_update_on_db_open(options.skip_stats_update_on_db_open),
       wal_recovery_mode(options.wal_recovery_mode),
-      row_cache(options.row_cache) {}
+      row_cache(options.row_cache),
+      row_cache_admission_filter(options.row_cache_admission_filter) {}
 
 static const char* const access_hints[] = {
   "NONE", "NORMAL", "SEQUENTIAL", "WILLNEED"
@@ -326,6 +347,7 @@ void DBOptions::Dump(Logger* log) const {
     Header(log, "          Options.max_open_files: %d", max_open_files);
     Header(log,
         "Options.max_file_opening_threads: %d", max_file_opening_threads);
+    Header(log, "       Options.open_files_lazily: %d", open_files_lazily);
     Header(log,
         "      Options.max_total_wal_size: %" PRIu64, max_total_wal_size);
     Header(log, "       Options.disableDataSync: %d", disableDataSync);
@@ -409,6 +431,8 @@ void DBOptions::Dump(Logger* log) const {
     } else {
       Header(log, "                               Options.row_cache: None");
     }
+    Header(log, "              Options.row_cache_admission_filter: %d",
+        row_cache_admission_filter);
 }  // DBOptions::Dump
 
 void ColumnFamilyOptions::Dump(Logger* log) const {
@@ -448,6 +472,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
         compression_opts.level);
     Header(log, "              Options.compression_opts.strategy: %d",
         compression_opts.strategy);
+    Header(log, "        Options.compression_opts.max_dict_bytes: %" PRIu32,
+        compression_opts.max_dict_bytes);
     Header(log, "     Options.level0_file_num_compaction_trigger: %d",
         level0_file_num_compaction_trigger);
     Header(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -471,6 +497,11 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                 "]: %d",
            i, max_bytes_for_level_multiplier_additional[i]);
     }
+    for (size_t i = 0; i < level_path_ids.size(); i++) {
+      Header(log, "                    Options.level_path_ids[%" ROCKSDB_PRIszt
+                  "]: %" PRIu32,
+             i, level_path_ids[i]);
+    }
     Header(log, "      Options.max_sequential_skip_in_iterations: %" PRIu64,
         max_sequential_skip_in_iterations);
     Header(log, "             Options.expanded_compaction_factor: %d",
@@ -485,6 +516,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
          arena_block_size);
     Header(log, "                      Options.soft_rate_limit: %.2f",
         soft_rate_limit);
+    Header(log, "  Options.soft_pending_compaction_bytes_limit: %" PRIu64,
+         soft_pending_compaction_bytes_limit);
     Header(log, "  Options.hard_pending_compaction_bytes_limit: %" PRIu64,
          hard_pending_compaction_bytes_limit);
     Header(log, "      Options.rate_limit_delay_max_milliseconds: %u",
@@ -537,6 +570,8 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     Header(log,
          "  Options.memtable_prefix_bloom_huge_page_tlb_size: %" ROCKSDB_PRIszt,
          memtable_prefix_bloom_huge_page_tlb_size);
+    Header(log, "            Options.memtable_whole_key_filtering: %d",
+        memtable_whole_key_filtering);
     Header(log, "                          Options.bloom_locality: %d",
         bloom_locality);
 
@@ -549,6 +584,12 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
          paranoid_file_checks);
     Header(log, "               Options.compaction_measure_io_stats: %d",
          compaction_measure_io_stats);
+    Header(log, "                        Options.row_cache_budget: %" PRIu64,
+         row_cache_budget);
+    Header(log, "             Options.compaction_warm_block_cache: %d",
+         compaction_warm_block_cache);
+    Header(log, "                       Options.expired_files_ttl: %" PRIu64,
+         expired_files_ttl);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
@@ -684,7 +725,9 @@ ReadOptions::ReadOptions()
       read_tier(kReadAllTier),
       tailing(false),
       managed(false),
-      total_order_seek(false) {
+      total_order_seek(false),
+      readahead_size(0),
+      pin_data(false) {
   XFUNC_TEST("", "managed_options", managed_options, xf_manage_options,
              reinterpret_cast<ReadOptions*>(this));
 }
@@ -697,7 +740,9 @@ ReadOptions::ReadOptions(bool cksum, bool cache)
       read_tier(kReadAllTier),
       tailing(false),
       managed(false),
-      total_order_seek(false) {
+      total_order_seek(false),
+      readahead_size(0),
+      pin_data(false) {
   XFUNC_TEST("", "managed_options", managed_options, xf_manage_options,
              reinterpret_cast<ReadOptions*>(this));
 }
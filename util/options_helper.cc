@@ -590,6 +590,8 @@ bool ParseMemtableOptions(const std::string& name, const std::string& value,
   } else if (name == "memtable_prefix_bloom_huge_page_tlb_size") {
     new_options->memtable_prefix_bloom_huge_page_tlb_size =
       ParseSizeT(value);
+  } else if (name == "memtable_whole_key_filtering") {
+    new_options->memtable_whole_key_filtering = ParseBoolean(name, value);
   } else if (name == "max_successive_merges") {
     new_options->max_successive_merges = ParseSizeT(value);
   } else if (name == "filter_deletes") {
@@ -611,6 +613,8 @@ bool ParseCompactionOptions(const std::string& name, const std::string& value,
     new_options->disable_auto_compactions = ParseBoolean(name, value);
   } else if (name == "soft_rate_limit") {
     new_options->soft_rate_limit = ParseDouble(value);
+  } else if (name == "soft_pending_compaction_bytes_limit") {
+    new_options->soft_pending_compaction_bytes_limit = ParseUint64(value);
   } else if (name == "hard_pending_compaction_bytes_limit") {
     new_options->hard_pending_compaction_bytes_limit = ParseUint64(value);
   } else if (name == "hard_rate_limit") {
@@ -793,6 +797,21 @@ bool ParseColumnFamilyOption(const std::string& name,
           start = end + 1;
         }
       }
+    } else if (name == "level_path_ids") {
+      new_options->level_path_ids.clear();
+      size_t start = 0;
+      while (true) {
+        size_t end = value.find(':', start);
+        if (end == std::string::npos) {
+          new_options->level_path_ids.push_back(
+              ParseUint32(value.substr(start)));
+          break;
+        } else {
+          new_options->level_path_ids.push_back(
+              ParseUint32(value.substr(start, end - start)));
+          start = end + 1;
+        }
+      }
     } else if (name == "block_based_table_factory") {
       // Nested options
       BlockBasedTableOptions table_opt, base_table_options;
@@ -826,8 +845,18 @@ bool ParseColumnFamilyOption(const std::string& name,
       if (start >= value.size()) {
         return false;
       }
+      end = value.find(':', start);
       new_options->compression_opts.strategy =
-          ParseInt(value.substr(start, value.size() - start));
+          ParseInt(value.substr(start, end - start));
+      // max_dict_bytes is optional for backwards compatibility
+      if (end != std::string::npos) {
+        start = end + 1;
+        if (start >= value.size()) {
+          return false;
+        }
+        new_options->compression_opts.max_dict_bytes =
+            ParseUint32(value.substr(start, value.size() - start));
+      }
     } else if (name == "compaction_options_universal") {
       // TODO(ljin): add support
       return false;
@@ -1034,7 +1063,7 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       return "";
     } else if (name == "filter_policy") {
       // Expect the following format
-      // bloomfilter:int:bool
+      // bloomfilter:int:bool[:bool]
       const std::string kName = "bloomfilter:";
       if (value.compare(0, kName.size(), kName) != 0) {
         return "Invalid filter policy name";
@@ -1045,10 +1074,19 @@ std::string ParseBlockBasedTableOption(const std::string& name,
       }
       int bits_per_key =
           ParseInt(trim(value.substr(kName.size(), pos - kName.size())));
-      bool use_block_based_builder =
-          ParseBoolean("use_block_based_builder", trim(value.substr(pos + 1)));
-      new_options->filter_policy.reset(
-          NewBloomFilterPolicy(bits_per_key, use_block_based_builder));
+      size_t blocked_pos = value.find(':', pos + 1);
+      bool use_block_based_builder = ParseBoolean(
+          "use_block_based_builder",
+          trim(value.substr(pos + 1, blocked_pos == std::string::npos
+                                         ? std::string::npos
+                                         : blocked_pos - pos - 1)));
+      bool use_blocked_full_filter = false;
+      if (blocked_pos != std::string::npos) {
+        use_blocked_full_filter = ParseBoolean(
+            "use_blocked_full_filter", trim(value.substr(blocked_pos + 1)));
+      }
+      new_options->filter_policy.reset(NewBloomFilterPolicy(
+          bits_per_key, use_block_based_builder, use_blocked_full_filter));
       return "";
     }
   }
@@ -174,6 +174,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"skip_stats_update_on_db_open",
      {offsetof(struct DBOptions, skip_stats_update_on_db_open),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"row_cache_admission_filter",
+     {offsetof(struct DBOptions, row_cache_admission_filter),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"new_table_reader_for_compaction_inputs",
      {offsetof(struct DBOptions, new_table_reader_for_compaction_inputs),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
@@ -195,6 +198,9 @@ static std::unordered_map<std::string, OptionTypeInfo> db_options_type_info = {
     {"max_file_opening_threads",
      {offsetof(struct DBOptions, max_file_opening_threads), OptionType::kInt,
       OptionVerificationType::kNormal}},
+    {"open_files_lazily",
+     {offsetof(struct DBOptions, open_files_lazily), OptionType::kBoolean,
+      OptionVerificationType::kNormal}},
     {"max_open_files",
      {offsetof(struct DBOptions, max_open_files), OptionType::kInt,
       OptionVerificationType::kNormal}},
@@ -266,6 +272,7 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
                                      Slice delta_value,
                                      std::string* merged_value);
     std::vector<int> max_bytes_for_level_multiplier_additional;
+    std::vector<uint32_t> level_path_ids;
      */
     {"compaction_measure_io_stats",
      {offsetof(struct ColumnFamilyOptions, compaction_measure_io_stats),
@@ -279,6 +286,9 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"inplace_update_support",
      {offsetof(struct ColumnFamilyOptions, inplace_update_support),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"memtable_whole_key_filtering",
+     {offsetof(struct ColumnFamilyOptions, memtable_whole_key_filtering),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"level_compaction_dynamic_level_bytes",
      {offsetof(struct ColumnFamilyOptions,
                level_compaction_dynamic_level_bytes),
@@ -295,6 +305,18 @@ static std::unordered_map<std::string, OptionTypeInfo> cf_options_type_info = {
     {"verify_checksums_in_compaction",
      {offsetof(struct ColumnFamilyOptions, verify_checksums_in_compaction),
       OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"soft_pending_compaction_bytes_limit",
+     {offsetof(struct ColumnFamilyOptions, soft_pending_compaction_bytes_limit),
+      OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"row_cache_budget",
+     {offsetof(struct ColumnFamilyOptions, row_cache_budget),
+      OptionType::kUInt64T, OptionVerificationType::kNormal}},
+    {"compaction_warm_block_cache",
+     {offsetof(struct ColumnFamilyOptions, compaction_warm_block_cache),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"expired_files_ttl",
+     {offsetof(struct ColumnFamilyOptions, expired_files_ttl),
+      OptionType::kUInt64T, OptionVerificationType::kNormal}},
     {"hard_pending_compaction_bytes_limit",
      {offsetof(struct ColumnFamilyOptions, hard_pending_compaction_bytes_limit),
       OptionType::kUInt64T, OptionVerificationType::kNormal}},
@@ -447,6 +469,16 @@ static std::unordered_map<std::string,
     {"block_restart_interval",
      {offsetof(struct BlockBasedTableOptions, block_restart_interval),
       OptionType::kInt, OptionVerificationType::kNormal}},
+    {"use_delta_encoding",
+     {offsetof(struct BlockBasedTableOptions, use_delta_encoding),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"data_block_hash_index",
+     {offsetof(struct BlockBasedTableOptions, data_block_hash_index),
+      OptionType::kBoolean, OptionVerificationType::kNormal}},
+    {"data_block_hash_table_util_ratio",
+     {offsetof(struct BlockBasedTableOptions,
+               data_block_hash_table_util_ratio),
+      OptionType::kDouble, OptionVerificationType::kNormal}},
     {"filter_policy",
      {offsetof(struct BlockBasedTableOptions, filter_policy),
       OptionType::kFilterPolicy, OptionVerificationType::kByName}},
@@ -455,6 +487,9 @@ static std::unordered_map<std::string,
       OptionType::kBoolean, OptionVerificationType::kNormal}},
     {"format_version",
      {offsetof(struct BlockBasedTableOptions, format_version),
+      OptionType::kUInt32T, OptionVerificationType::kNormal}},
+    {"parallel_compression_threads",
+     {offsetof(struct BlockBasedTableOptions, parallel_compression_threads),
       OptionType::kUInt32T, OptionVerificationType::kNormal}}};
 }  // namespace rocksdb
 
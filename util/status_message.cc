@@ -11,7 +11,8 @@ const char* Status::msgs[] = {
     "",                                                  // kNone
     "Timeout Acquiring Mutex",                           // kMutexTimeout
     "Timeout waiting to lock key",                       // kLockTimeout
-    "Failed to acquire lock due to max_num_locks limit"  // kLockLimit
+    "Failed to acquire lock due to max_num_locks limit", // kLockLimit
+    "Deadlock detected while waiting to lock key"        // kDeadlock
 };
 
 }  // namespace rocksdb
@@ -11,6 +11,7 @@
 
 #include "rocksdb/utilities/backupable_db.h"
 #include "db/filename.h"
+#include "util/aligned_buffer.h"
 #include "util/channel.h"
 #include "util/coding.h"
 #include "util/crc32c.h"
@@ -269,6 +270,8 @@ class BackupEngineImpl : public BackupEngine {
 
   Status PutLatestBackupFileContents(uint32_t latest_backup);
   // if size_limit == 0, there is no size limit, copy everything
+  // The source is read on a separate thread, so that reading the next
+  // buffer overlaps with checksumming and writing the previous one.
   Status CopyFile(const std::string& src, const std::string& dst, Env* src_env,
                   Env* dst_env, bool sync, RateLimiter* rate_limiter,
                   uint64_t* size = nullptr, uint32_t* checksum_value = nullptr,
@@ -285,8 +288,29 @@ class BackupEngineImpl : public BackupEngine {
     uint32_t checksum_value;
     Status status;
   };
+  // A buffer of the file being copied, handed from the reading thread to
+  // the writing one and back
+  struct CopyChunk {
+    AlignedBuffer buf;
+    Slice data;
+    // Bytes requested from the source file, accounted for the progress
+    // callback
+    size_t read_size = 0;
+    Status status;
+
+    CopyChunk() {}
+    CopyChunk(CopyChunk&& o) ROCKSDB_NOEXCEPT { *this = std::move(o); }
+    CopyChunk& operator=(CopyChunk&& o) ROCKSDB_NOEXCEPT {
+      buf = std::move(o.buf);
+      data = o.data;
+      read_size = o.read_size;
+      status = std::move(o.status);
+      return *this;
+    }
+  };
   struct CopyWorkItem {
     std::string src_path;
+    // If empty, the work item only calculates the checksum of src_path
     std::string dst_path;
     Env* src_env;
     Env* dst_env;
@@ -397,7 +421,8 @@ class BackupEngineImpl : public BackupEngine {
       const std::string& src_fname,  // starts with "/"
       RateLimiter* rate_limiter, uint64_t size_limit = 0,
       bool shared_checksum = false,
-      std::function<void()> progress_callback = []() {});
+      std::function<void()> progress_callback = []() {},
+      const CopyResult* src_checksum = nullptr);
 
   // backup state data
   BackupID latest_backup_id_;
@@ -420,6 +445,9 @@ class BackupEngineImpl : public BackupEngine {
   unique_ptr<Directory> private_directory_;
 
   static const size_t kDefaultCopyFileBufferSize = 5 * 1024 * 1024LL;  // 5MB
+  static const size_t kCopyFileBufferAlignment = 4096;
+  // Buffers in flight between the reading and the writing thread of a copy
+  static const int kCopyFileBuffers = 3;
   size_t copy_file_buffer_size_;
   bool read_only_;
   BackupStatistics backup_statistics_;
@@ -575,11 +603,18 @@ Status BackupEngineImpl::Initialize() {
       CopyWorkItem work_item;
       while (files_to_copy_.read(work_item)) {
         CopyResult result;
-        result.status =
-            CopyFile(work_item.src_path, work_item.dst_path, work_item.src_env,
-                     work_item.dst_env, work_item.sync, work_item.rate_limiter,
-                     &result.size, &result.checksum_value, work_item.size_limit,
-                     work_item.progress_callback);
+        if (work_item.dst_path.empty()) {
+          result.size = 0;
+          result.status =
+              CalculateChecksum(work_item.src_path, work_item.src_env,
+                                work_item.size_limit, &result.checksum_value);
+        } else {
+          result.status = CopyFile(
+              work_item.src_path, work_item.dst_path, work_item.src_env,
+              work_item.dst_env, work_item.sync, work_item.rate_limiter,
+              &result.size, &result.checksum_value, work_item.size_limit,
+              work_item.progress_callback);
+        }
         work_item.result.set_value(std::move(result));
       }
     });
@@ -648,6 +683,25 @@ Status BackupEngineImpl::CreateNewBackup(
   std::unordered_set<std::string> live_dst_paths;
   live_dst_paths.reserve(live_files.size() + live_wal_files.size());
 
+  // With share_files_with_checksum, the names of the table files in the
+  // backup depend on their checksums. Calculate them on the background
+  // threads rather than one by one before each copy is queued.
+  std::vector<std::future<CopyResult>> table_file_checksums(live_files.size());
+  if (options_.share_table_files && options_.share_files_with_checksum) {
+    for (size_t i = 0; i < live_files.size(); ++i) {
+      uint64_t number;
+      FileType type;
+      if (ParseFileName(live_files[i], &number, &type) &&
+          type == kTableFile) {
+        CopyWorkItem checksum_work_item(
+            db->GetName() + live_files[i], "" /* only checksum */, db_env_,
+            nullptr, false, nullptr, 0 /* size_limit */);
+        table_file_checksums[i] = checksum_work_item.result.get_future();
+        files_to_copy_.write(std::move(checksum_work_item));
+      }
+    }
+  }
+
   std::vector<BackupAfterCopyWorkItem> backup_items_to_finish;
   // Add a CopyWorkItem to the channel for each live file
   for (size_t i = 0; s.ok() && i < live_files.size(); ++i) {
@@ -662,6 +716,12 @@ Status BackupEngineImpl::CreateNewBackup(
     assert(type == kTableFile || type == kDescriptorFile ||
            type == kCurrentFile);
 
+    CopyResult src_checksum;
+    const bool has_src_checksum = table_file_checksums[i].valid();
+    if (has_src_checksum) {
+      src_checksum = table_file_checksums[i].get();
+    }
+
     // rules:
     // * if it's kTableFile, then it's shared
     // * if it's kDescriptorFile, limit the size to manifest_file_size
@@ -671,7 +731,7 @@ Status BackupEngineImpl::CreateNewBackup(
         live_files[i], rate_limiter.get(),
         (type == kDescriptorFile) ? manifest_file_size : 0,
         options_.share_files_with_checksum && type == kTableFile,
-        progress_callback);
+        progress_callback, has_src_checksum ? &src_checksum : nullptr);
   }
   // Add a CopyWorkItem to the channel for each WAL file
   for (size_t i = 0; s.ok() && i < live_wal_files.size(); ++i) {
@@ -1112,41 +1172,77 @@ Status BackupEngineImpl::CopyFile(const std::string& src,
       new WritableFileWriter(std::move(dst_file), env_options));
   unique_ptr<SequentialFileReader> src_reader(
       new SequentialFileReader(std::move(src_file)));
-  unique_ptr<char[]> buf(new char[copy_file_buffer_size_]);
-  Slice data;
-
-  uint64_t processed_buffer_size = 0;
-  do {
-    if (stop_backup_.load(std::memory_order_acquire)) {
-      return Status::Incomplete("Backup stopped");
-    }
-    size_t buffer_to_read = (copy_file_buffer_size_ < size_limit) ?
-      copy_file_buffer_size_ : size_limit;
-    s = src_reader->Read(buffer_to_read, &data, buf.get());
-    size_limit -= data.size();
 
-    if (!s.ok()) {
-      return s;
+  // The reading thread takes buffers from free_chunks, fills them and passes
+  // them on through full_chunks. This thread checksums and writes them, and
+  // returns them to free_chunks.
+  const size_t buffer_size = copy_file_buffer_size_;
+  channel<CopyChunk> free_chunks;
+  channel<CopyChunk> full_chunks;
+  for (int i = 0; i < kCopyFileBuffers; i++) {
+    CopyChunk chunk;
+    chunk.buf.Alignment(kCopyFileBufferAlignment);
+    chunk.buf.AllocateNewBuffer(buffer_size);
+    free_chunks.write(std::move(chunk));
+  }
+  std::thread reader([&]() {
+    uint64_t remaining = size_limit;
+    CopyChunk chunk;
+    while (free_chunks.read(chunk)) {
+      if (stop_backup_.load(std::memory_order_acquire)) {
+        chunk.status = Status::Incomplete("Backup stopped");
+        chunk.data = Slice();
+        chunk.read_size = 0;
+      } else {
+        chunk.read_size = static_cast<size_t>(
+            std::min(static_cast<uint64_t>(buffer_size), remaining));
+        chunk.status =
+            src_reader->Read(chunk.read_size, &chunk.data,
+                             chunk.buf.Destination());
+        remaining -= chunk.data.size();
+      }
+      const bool done =
+          !chunk.status.ok() || chunk.data.size() == 0 || remaining == 0;
+      full_chunks.write(std::move(chunk));
+      if (done) {
+        break;
+      }
     }
+    full_chunks.sendEof();
+  });
 
-    if (size != nullptr) {
-      *size += data.size();
+  uint64_t processed_buffer_size = 0;
+  CopyChunk chunk;
+  while (full_chunks.read(chunk)) {
+    s = chunk.status;
+    const Slice& data = chunk.data;
+    if (s.ok()) {
+      if (size != nullptr) {
+        *size += data.size();
+      }
+      if (checksum_value != nullptr) {
+        *checksum_value = crc32c::Extend(*checksum_value, data.data(),
+                                         data.size());
+      }
+      s = dest_writer->Append(data);
     }
-    if (checksum_value != nullptr) {
-      *checksum_value = crc32c::Extend(*checksum_value, data.data(),
-                                       data.size());
+    if (!s.ok()) {
+      // Stops the reading thread once it consumed the remaining buffers
+      free_chunks.sendEof();
+      break;
     }
-    s = dest_writer->Append(data);
     if (rate_limiter != nullptr) {
       rate_limiter->Request(data.size(), Env::IO_LOW);
     }
-    processed_buffer_size += buffer_to_read;
+    processed_buffer_size += chunk.read_size;
     if (processed_buffer_size > options_.callback_trigger_interval_size) {
       processed_buffer_size -= options_.callback_trigger_interval_size;
       std::lock_guard<std::mutex> lock(byte_report_mutex_);
       progress_callback();
     }
-  } while (s.ok() && data.size() > 0 && size_limit > 0);
+    free_chunks.write(std::move(chunk));
+  }
+  reader.join();
 
   if (s.ok() && sync) {
     s = dest_writer->Sync(false);
@@ -1162,7 +1258,7 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
     BackupID backup_id, bool shared, const std::string& src_dir,
     const std::string& src_fname, RateLimiter* rate_limiter,
     uint64_t size_limit, bool shared_checksum,
-    std::function<void()> progress_callback) {
+    std::function<void()> progress_callback, const CopyResult* src_checksum) {
   assert(src_fname.size() > 0 && src_fname[0] == '/');
   std::string dst_relative = src_fname.substr(1);
   std::string dst_relative_tmp;
@@ -1172,10 +1268,13 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
 
   if (shared && shared_checksum) {
     // add checksum and file length to the file name
-    s = CalculateChecksum(src_dir + src_fname,
-                          db_env_,
-                          size_limit,
-                          &checksum_value);
+    if (src_checksum != nullptr) {
+      s = src_checksum->status;
+      checksum_value = src_checksum->checksum_value;
+    } else {
+      s = CalculateChecksum(src_dir + src_fname, db_env_, size_limit,
+                            &checksum_value);
+    }
     if (s.ok()) {
         s = db_env_->GetFileSize(src_dir + src_fname, &size);
     }
@@ -1233,7 +1332,10 @@ Status BackupEngineImpl::AddBackupFileWorkItem(
       need_to_copy = true;
       backup_env_->DeleteFile(dst_path);
     } else {
-      // the file is present and referenced by a backup
+      // the file is present and referenced by a backup. Its name does not
+      // tell whether it holds the same contents as the live file, e.g. after
+      // the DB was restored or recreated, so calculate the checksum to let
+      // BackupMeta::AddFile() catch a mismatch.
       db_env_->GetFileSize(src_dir + src_fname, &size);  // Ignore error
       Log(options_.info_log, "%s already present, calculate checksum",
           src_fname.c_str());
@@ -1027,6 +1027,27 @@ TEST_F(BackupableDBTest, ShareTableFilesWithChecksums) {
   }
 }
 
+// Verify that table file checksums calculated ahead of the copies by the
+// background threads match the ones of the backed up files
+TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsMultiThreaded) {
+  const int keys_iteration = 5000;
+  backupable_options_->max_background_operations = 4;
+  OpenDBAndBackupEngine(true, false, true, true);
+  for (int i = 0; i < 5; ++i) {
+    FillDB(db_.get(), keys_iteration * i, keys_iteration * (i + 1));
+    ASSERT_OK(backup_engine_->CreateNewBackup(db_.get(), true));
+  }
+  for (int i = 0; i < 5; ++i) {
+    ASSERT_OK(backup_engine_->VerifyBackup(i + 1));
+  }
+  CloseDBAndBackupEngine();
+
+  for (int i = 0; i < 5; ++i) {
+    AssertBackupConsistency(i + 1, 0, keys_iteration * (i + 1),
+                            keys_iteration * 6);
+  }
+}
+
 // Verify that you can backup and restore using share_files_with_checksum set to
 // false and then transition this option to true
 TEST_F(BackupableDBTest, ShareTableFilesWithChecksumsTransition) {
@@ -0,0 +1,1038 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+
+#include "utilities/blob_db/blob_db_impl.h"
+
+#ifndef __STDC_FORMAT_MACROS
+#define __STDC_FORMAT_MACROS
+#endif
+
+#include <inttypes.h>
+#include <algorithm>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/convenience.h"
+#include "rocksdb/iterator.h"
+#include "rocksdb/write_batch.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace rocksdb {
+
+namespace {
+
+enum ValueType : char {
+  kInlineValue = 0x0,
+  kBlobIndex = 0x1,
+};
+
+// Read ahead of an iterator starts with this many bytes and doubles on every
+// sequential access, up to BlobDBOptions::scan_readahead_size.
+const size_t kInitialScanReadaheadSize = 8 << 10;
+
+void EncodeBlobIndex(uint64_t file_number, uint64_t offset,
+                     uint64_t value_size, std::string* dst) {
+  dst->clear();
+  dst->push_back(kBlobIndex);
+  PutVarint64(dst, file_number);
+  PutVarint64(dst, offset);
+  PutVarint64(dst, value_size);
+}
+
+// Returns true if "index_entry" points into a value log file.
+bool DecodeBlobIndex(Slice index_entry, uint64_t* file_number,
+                     uint64_t* offset, uint64_t* value_size) {
+  if (index_entry.empty() || index_entry[0] != kBlobIndex) {
+    return false;
+  }
+  index_entry.remove_prefix(1);
+  return GetVarint64(&index_entry, file_number) &&
+         GetVarint64(&index_entry, offset) &&
+         GetVarint64(&index_entry, value_size) && index_entry.empty();
+}
+
+// Adds the size of the record "index_entry" points to, if any, to the garbage
+// of its file.
+void AddRecordGarbage(const Slice& key, const Slice& index_entry,
+                      std::map<uint64_t, uint64_t>* garbage) {
+  uint64_t file_number;
+  uint64_t offset;
+  uint64_t value_size;
+  if (DecodeBlobIndex(index_entry, &file_number, &offset, &value_size)) {
+    (*garbage)[file_number] += BlobFile::RecordSize(key.size(), value_size);
+  }
+}
+
+}  // namespace
+
+Status BlobFile::ReadValue(const Slice& key, uint64_t offset,
+                           uint64_t value_size, std::string* value) const {
+  std::string buf;
+  Slice record_key;
+  Slice record_value;
+  Status s = ReadRecord(offset, &record_key, &record_value, &buf);
+  if (!s.ok()) {
+    return s;
+  }
+  if (record_key != key || record_value.size() != value_size) {
+    return Status::Corruption("Value log record does not match its key");
+  }
+  value->assign(record_value.data(), record_value.size());
+  return Status::OK();
+}
+
+Status BlobFile::ReadRecord(uint64_t offset, Slice* key, Slice* value,
+                            std::string* buf) const {
+  char header[kRecordHeaderSize];
+  Slice result;
+  Status s = reader_->Read(offset, kRecordHeaderSize, &result, header);
+  if (!s.ok()) {
+    return s;
+  }
+  if (result.size() != kRecordHeaderSize) {
+    return Status::Corruption("Truncated value log record");
+  }
+  const uint32_t expected_crc = crc32c::Unmask(DecodeFixed32(result.data()));
+  const uint64_t key_size = DecodeFixed32(result.data() + 4);
+  const uint64_t value_size = DecodeFixed64(result.data() + 8);
+  const uint64_t record_size = RecordSize(key_size, value_size);
+  if (record_size > port::kMaxSizet) {
+    return Status::Corruption("Value log record too large");
+  }
+  buf->resize(static_cast<size_t>(record_size));
+  s = reader_->Read(offset, buf->size(), &result, &(*buf)[0]);
+  if (!s.ok()) {
+    return s;
+  }
+  if (result.size() != record_size) {
+    return Status::Corruption("Truncated value log record");
+  }
+  if (crc32c::Value(result.data() + 4, result.size() - 4) != expected_crc) {
+    return Status::Corruption("Value log record checksum mismatch");
+  }
+  *key = Slice(result.data() + kRecordHeaderSize, key_size);
+  *value = Slice(key->data() + key_size, value_size);
+  return Status::OK();
+}
+
+// Resolves the values of the underlying iterator. The blob file map is pinned
+// for the lifetime of the iterator, so that it can read from files that are
+// garbage collected meanwhile.
+class BlobDBIterator : public Iterator {
+ public:
+  BlobDBIterator(Iterator* iter,
+                 std::shared_ptr<const BlobDBImpl::BlobFileMap> blob_files,
+                 size_t max_readahead_size)
+      : iter_(iter),
+        blob_files_(std::move(blob_files)),
+        max_readahead_size_(max_readahead_size),
+        readahead_size_(0),
+        readahead_file_(0),
+        readahead_limit_(0),
+        last_file_(0),
+        last_record_end_(0) {
+    assert(iter_);
+  }
+
+  ~BlobDBIterator() { delete iter_; }
+
+  bool Valid() const override { return iter_->Valid() && status_.ok(); }
+
+  void SeekToFirst() override {
+    iter_->SeekToFirst();
+    UpdateValue();
+  }
+
+  void SeekToLast() override {
+    iter_->SeekToLast();
+    UpdateValue();
+  }
+
+  void Seek(const Slice& target) override {
+    iter_->Seek(target);
+    UpdateValue();
+  }
+
+  void Next() override {
+    iter_->Next();
+    UpdateValue();
+  }
+
+  void Prev() override {
+    iter_->Prev();
+    UpdateValue();
+  }
+
+  Slice key() const override { return iter_->key(); }
+
+  Slice value() const override { return value_; }
+
+  Status status() const override {
+    if (!status_.ok()) {
+      return status_;
+    }
+    return iter_->status();
+  }
+
+ private:
+  void UpdateValue() {
+    status_ = Status::OK();
+    if (!iter_->Valid()) {
+      return;
+    }
+    uint64_t file_number;
+    uint64_t offset;
+    uint64_t value_size;
+    if (DecodeBlobIndex(iter_->value(), &file_number, &offset, &value_size)) {
+      MaybeReadahead(file_number, offset,
+                     BlobFile::RecordSize(iter_->key().size(), value_size));
+    }
+    status_ = BlobDBImpl::ResolveValue(*blob_files_, iter_->key(),
+                                       iter_->value(), &value_);
+  }
+
+  // Values that were written in key order are laid out back to back, so a
+  // scan reads them sequentially. Ask the file system to read ahead once a
+  // record directly follows the previous one.
+  void MaybeReadahead(uint64_t file_number, uint64_t offset,
+                      uint64_t record_size) {
+    const bool sequential =
+        file_number == last_file_ && offset == last_record_end_;
+    last_file_ = file_number;
+    last_record_end_ = offset + record_size;
+    if (max_readahead_size_ == 0) {
+      return;
+    }
+    if (!sequential) {
+      readahead_size_ = 0;
+      return;
+    }
+    if (file_number == readahead_file_ && last_record_end_ <= readahead_limit_) {
+      return;
+    }
+    readahead_size_ = readahead_size_ == 0
+                          ? kInitialScanReadaheadSize
+                          : std::min(readahead_size_ * 2, max_readahead_size_);
+    auto iter = blob_files_->find(file_number);
+    if (iter == blob_files_->end()) {
+      return;
+    }
+    const size_t n = std::max(readahead_size_, static_cast<size_t>(record_size));
+    // Read ahead is only a hint
+    iter->second->Prefetch(offset, n);
+    readahead_file_ = file_number;
+    readahead_limit_ = offset + n;
+  }
+
+  Iterator* iter_;
+  std::shared_ptr<const BlobDBImpl::BlobFileMap> blob_files_;
+  const size_t max_readahead_size_;
+  std::string value_;
+  Status status_;
+
+  size_t readahead_size_;
+  uint64_t readahead_file_;
+  uint64_t readahead_limit_;
+  uint64_t last_file_;
+  uint64_t last_record_end_;
+};
+
+// Converts a write batch into the batch written to the LSM tree, appending
+// the large values to the value log.
+class BlobDBImpl::WriteHandler : public WriteBatch::Handler {
+ public:
+  explicit WriteHandler(BlobDBImpl* impl) : impl_(impl) {}
+
+  virtual Status PutCF(uint32_t column_family_id, const Slice& key,
+                       const Slice& value) override {
+    Status s = CheckColumnFamily(column_family_id);
+    if (s.ok()) {
+      s = AddGarbage(key);
+    }
+    std::string index_entry;
+    if (s.ok()) {
+      s = impl_->EncodeValue(key, value, &index_entry);
+    }
+    if (s.ok()) {
+      batch_.Put(key, index_entry);
+      written_[key.ToString()] = index_entry;
+    }
+    return s;
+  }
+
+  virtual Status DeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+    Status s = CheckColumnFamily(column_family_id);
+    if (s.ok()) {
+      s = AddGarbage(key);
+    }
+    if (s.ok()) {
+      batch_.Delete(key);
+      written_[key.ToString()].clear();
+    }
+    return s;
+  }
+
+  virtual Status SingleDeleteCF(uint32_t column_family_id,
+                                const Slice& key) override {
+    Status s = CheckColumnFamily(column_family_id);
+    if (s.ok()) {
+      s = AddGarbage(key);
+    }
+    if (s.ok()) {
+      batch_.SingleDelete(key);
+      written_[key.ToString()].clear();
+    }
+    return s;
+  }
+
+  virtual Status DeleteRangeCF(uint32_t column_family_id,
+                               const Slice& begin_key,
+                               const Slice& end_key) override {
+    Status s = CheckColumnFamily(column_family_id);
+    if (!s.ok()) {
+      return s;
+    }
+    const Comparator* ucmp = impl_->comparator_;
+    // Keys written earlier in this batch are not visible to the iterator
+    for (auto& entry : written_) {
+      if (ucmp->Compare(entry.first, begin_key) >= 0 &&
+          ucmp->Compare(entry.first, end_key) < 0) {
+        AddRecordGarbage(entry.first, entry.second, &overwritten_);
+        entry.second.clear();
+      }
+    }
+    std::unique_ptr<Iterator> iter(impl_->db_->NewIterator(ReadOptions()));
+    for (iter->Seek(begin_key);
+         iter->Valid() && ucmp->Compare(iter->key(), end_key) < 0;
+         iter->Next()) {
+      if (written_.find(iter->key().ToString()) == written_.end()) {
+        AddRecordGarbage(iter->key(), iter->value(), &garbage_);
+      }
+    }
+    s = iter->status();
+    if (s.ok()) {
+      batch_.DeleteRange(begin_key, end_key);
+    }
+    return s;
+  }
+
+  virtual Status MergeCF(uint32_t column_family_id, const Slice& key,
+                         const Slice& value) override {
+    return Status::NotSupported("Merge is not supported by BlobDB");
+  }
+
+  virtual void LogData(const Slice& blob) override { batch_.PutLogData(blob); }
+
+  WriteBatch* batch() { return &batch_; }
+
+  // The bytes of the values that become garbage once the batch is written.
+  const std::map<uint64_t, uint64_t>& garbage() const { return garbage_; }
+  const std::map<uint64_t, uint64_t>& overwritten() const {
+    return overwritten_;
+  }
+
+  // Returns the bytes appended to the value log for a batch that will not be
+  // written. Nothing points to them.
+  std::map<uint64_t, uint64_t> AbandonedRecords() const {
+    std::map<uint64_t, uint64_t> abandoned;
+    for (const auto& entry : written_) {
+      AddRecordGarbage(entry.first, entry.second, &abandoned);
+    }
+    for (const auto& overwritten : overwritten_) {
+      abandoned[overwritten.first] += overwritten.second;
+    }
+    return abandoned;
+  }
+
+ private:
+  Status CheckColumnFamily(uint32_t column_family_id) const {
+    if (column_family_id != 0) {
+      return Status::NotSupported(
+          "BlobDB only supports the default column family");
+    }
+    return Status::OK();
+  }
+
+  // The value a key had before this write is either in the DB or was written
+  // earlier in the same batch.
+  Status AddGarbage(const Slice& key) {
+    auto iter = written_.find(key.ToString());
+    if (iter != written_.end()) {
+      AddRecordGarbage(key, iter->second, &overwritten_);
+      return Status::OK();
+    }
+    std::string index_entry;
+    ReadOptions read_options;
+    read_options.fill_cache = false;
+    Status s = impl_->db_->Get(read_options, key, &index_entry);
+    if (s.IsNotFound()) {
+      return Status::OK();
+    }
+    if (s.ok()) {
+      AddRecordGarbage(key, index_entry, &garbage_);
+    }
+    return s;
+  }
+
+  BlobDBImpl* impl_;
+  WriteBatch batch_;
+  // The index entries written by this batch so far. Deleted keys map to an
+  // empty entry.
+  std::map<std::string, std::string> written_;
+  // Garbage in the value log files that existed before the batch.
+  std::map<uint64_t, uint64_t> garbage_;
+  // Values appended by this batch and overwritten later in it.
+  std::map<uint64_t, uint64_t> overwritten_;
+};
+
+Status BlobDB::Open(const Options& options,
+                    const BlobDBOptions& blob_db_options,
+                    const std::string& dbname, BlobDB** blob_db) {
+  *blob_db = nullptr;
+  std::string blob_dir = blob_db_options.blob_dir;
+  if (blob_dir.empty() || blob_dir[0] != '/') {
+    blob_dir = dbname + "/" + blob_dir;
+  }
+  DB* db;
+  Status s = DB::Open(options, dbname, &db);
+  if (!s.ok()) {
+    return s;
+  }
+  s = options.env->CreateDirIfMissing(blob_dir);
+  if (!s.ok()) {
+    delete db;
+    return s;
+  }
+  BlobDBImpl* impl = new BlobDBImpl(db, options, blob_db_options, blob_dir);
+  s = impl->OpenBlobFiles();
+  if (!s.ok()) {
+    delete impl;
+    return s;
+  }
+  *blob_db = impl;
+  return s;
+}
+
+BlobDBImpl::BlobDBImpl(DB* db, const Options& options,
+                       const BlobDBOptions& blob_db_options,
+                       const std::string& blob_dir)
+    : BlobDB(db),
+      blob_db_options_(blob_db_options),
+      blob_dir_(blob_dir),
+      comparator_(options.comparator),
+      env_(db->GetEnv()),
+      env_options_(db->GetDBOptions()),
+      blob_files_(std::make_shared<const BlobFileMap>()),
+      writer_file_number_(0),
+      writer_offset_(0),
+      next_file_number_(1),
+      bg_gc_scheduled_(false),
+      shutting_down_(false) {}
+
+BlobDBImpl::~BlobDBImpl() {
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  shutting_down_ = true;
+  while (bg_gc_scheduled_) {
+    bg_cv_.wait(lock);
+  }
+  if (writer_) {
+    writer_->Close();
+  }
+  DeleteObsoleteFiles();
+}
+
+std::string BlobDBImpl::BlobFileName(uint64_t number) const {
+  char buf[100];
+  snprintf(buf, sizeof(buf), "/%06" PRIu64 ".blob", number);
+  return blob_dir_ + buf;
+}
+
+Status BlobDBImpl::OpenBlobFiles() {
+  std::vector<std::string> children;
+  Status s = env_->GetChildren(blob_dir_, &children);
+  if (!s.ok()) {
+    return s;
+  }
+  std::map<uint64_t, uint64_t> file_sizes;
+  for (const auto& child : children) {
+    uint64_t number;
+    char suffix;
+    if (sscanf(child.c_str(), "%" SCNu64 ".blo%c", &number, &suffix) != 2 ||
+        suffix != 'b' || BlobFileName(number) != blob_dir_ + "/" + child) {
+      continue;
+    }
+    uint64_t file_size;
+    s = env_->GetFileSize(BlobFileName(number), &file_size);
+    if (!s.ok()) {
+      return s;
+    }
+    file_sizes[number] = file_size;
+    next_file_number_ = std::max(next_file_number_, number + 1);
+  }
+
+  // A value is live if the LSM tree points to it; everything else in a file
+  // is garbage, including the tail of a record that was cut by a crash.
+  std::map<uint64_t, uint64_t> live_bytes;
+  {
+    ReadOptions read_options;
+    read_options.fill_cache = false;
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      uint64_t file_number;
+      uint64_t offset;
+      uint64_t value_size;
+      if (DecodeBlobIndex(iter->value(), &file_number, &offset,
+                          &value_size)) {
+        live_bytes[file_number] +=
+            BlobFile::RecordSize(iter->key().size(), value_size);
+      }
+    }
+    s = iter->status();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  auto blob_files = std::make_shared<BlobFileMap>();
+  for (const auto& file : file_sizes) {
+    const uint64_t number = file.first;
+    auto live = live_bytes.find(number);
+    if (live == live_bytes.end()) {
+      env_->DeleteFile(BlobFileName(number));
+      continue;
+    }
+    std::unique_ptr<RandomAccessFile> file_ptr;
+    s = env_->NewRandomAccessFile(BlobFileName(number), &file_ptr,
+                                  env_options_);
+    if (!s.ok()) {
+      return s;
+    }
+    std::unique_ptr<RandomAccessFileReader> reader(
+        new RandomAccessFileReader(std::move(file_ptr), env_));
+    (*blob_files)[number] = std::make_shared<BlobFile>(number, std::move(reader));
+    FileStats& stats = file_stats_[number];
+    stats.total_bytes = file.second > BlobFile::kHeaderSize
+                            ? file.second - BlobFile::kHeaderSize
+                            : 0;
+    stats.garbage_bytes =
+        stats.total_bytes > live->second ? stats.total_bytes - live->second : 0;
+  }
+  for (const auto& live : live_bytes) {
+    if (blob_files->find(live.first) == blob_files->end()) {
+      return Status::Corruption("Missing value log file " +
+                                BlobFileName(live.first));
+    }
+  }
+  blob_files_ = blob_files;
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  s = NewWritableBlobFile();
+  if (s.ok()) {
+    MaybeScheduleGarbageCollection();
+  }
+  return s;
+}
+
+std::shared_ptr<const BlobDBImpl::BlobFileMap> BlobDBImpl::GetBlobFiles()
+    const {
+  return std::atomic_load(&blob_files_);
+}
+
+Status BlobDBImpl::NewWritableBlobFile() {
+  if (writer_) {
+    Status s = writer_->Close();
+    writer_.reset();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const uint64_t number = next_file_number_++;
+  const std::string fname = BlobFileName(number);
+  std::unique_ptr<WritableFile> file;
+  Status s = env_->NewWritableFile(fname, &file, env_options_);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<WritableFileWriter> writer(
+      new WritableFileWriter(std::move(file), env_options_));
+  std::string header;
+  PutFixed32(&header, BlobFile::kMagicNumber);
+  PutFixed32(&header, BlobFile::kVersion);
+  s = writer->Append(header);
+  if (s.ok()) {
+    s = writer->Flush();
+  }
+  std::unique_ptr<RandomAccessFile> read_file;
+  if (s.ok()) {
+    s = env_->NewRandomAccessFile(fname, &read_file, env_options_);
+  }
+  if (!s.ok()) {
+    writer.reset();
+    env_->DeleteFile(fname);
+    return s;
+  }
+  std::unique_ptr<RandomAccessFileReader> reader(
+      new RandomAccessFileReader(std::move(read_file), env_));
+
+  auto blob_files = std::make_shared<BlobFileMap>(*GetBlobFiles());
+  (*blob_files)[number] = std::make_shared<BlobFile>(number, std::move(reader));
+  std::atomic_store(&blob_files_,
+                    std::shared_ptr<const BlobFileMap>(blob_files));
+  file_stats_[number] = FileStats();
+  writer_ = std::move(writer);
+  writer_file_number_ = number;
+  writer_offset_ = BlobFile::kHeaderSize;
+  return Status::OK();
+}
+
+Status BlobDBImpl::AppendRecord(const Slice& key, const Slice& value,
+                                uint64_t* file_number, uint64_t* offset) {
+  if (!bg_error_.ok()) {
+    return bg_error_;
+  }
+  const uint64_t record_size = BlobFile::RecordSize(key.size(), value.size());
+  if (writer_offset_ > BlobFile::kHeaderSize &&
+      writer_offset_ + record_size > blob_db_options_.blob_file_size) {
+    Status s = NewWritableBlobFile();
+    if (!s.ok()) {
+      return s;
+    }
+    MaybeScheduleGarbageCollection();
+  }
+
+  std::string header;
+  header.reserve(BlobFile::kRecordHeaderSize);
+  PutFixed32(&header, 0);
+  PutFixed32(&header, static_cast<uint32_t>(key.size()));
+  PutFixed64(&header, value.size());
+  uint32_t crc = crc32c::Value(header.data() + 4, header.size() - 4);
+  crc = crc32c::Extend(crc, key.data(), key.size());
+  crc = crc32c::Extend(crc, value.data(), value.size());
+  EncodeFixed32(&header[0], crc32c::Mask(crc));
+
+  Status s = writer_->Append(header);
+  if (s.ok()) {
+    s = writer_->Append(key);
+  }
+  if (s.ok()) {
+    s = writer_->Append(value);
+  }
+  // Readers read the file through a separate handle, so the record has to
+  // leave the write buffer before the LSM tree points to it.
+  if (s.ok()) {
+    s = writer_->Flush();
+  }
+  if (!s.ok()) {
+    // The file may end with a partial record now; never append to it again.
+    bg_error_ = s;
+    return s;
+  }
+  *file_number = writer_file_number_;
+  *offset = writer_offset_;
+  writer_offset_ += record_size;
+  file_stats_[writer_file_number_].total_bytes += record_size;
+  return s;
+}
+
+Status BlobDBImpl::SyncBlobFile(const WriteOptions& options) {
+  if (!options.sync || !writer_) {
+    return Status::OK();
+  }
+  return writer_->Sync(GetDBOptions().use_fsync);
+}
+
+Status BlobDBImpl::EncodeValue(const Slice& key, const Slice& value,
+                               std::string* index_entry) {
+  if (value.size() < blob_db_options_.min_blob_size) {
+    index_entry->clear();
+    index_entry->reserve(value.size() + 1);
+    index_entry->push_back(kInlineValue);
+    index_entry->append(value.data(), value.size());
+    return Status::OK();
+  }
+  uint64_t file_number;
+  uint64_t offset;
+  Status s = AppendRecord(key, value, &file_number, &offset);
+  if (s.ok()) {
+    EncodeBlobIndex(file_number, offset, value.size(), index_entry);
+  }
+  return s;
+}
+
+void BlobDBImpl::AddGarbageBytes(
+    const std::map<uint64_t, uint64_t>& garbage) {
+  for (const auto& bytes : garbage) {
+    auto iter = file_stats_.find(bytes.first);
+    if (iter != file_stats_.end()) {
+      iter->second.garbage_bytes += bytes.second;
+    }
+  }
+}
+
+bool BlobDBImpl::IsDefaultColumnFamily(
+    ColumnFamilyHandle* column_family) const {
+  return column_family->GetID() == DefaultColumnFamily()->GetID();
+}
+
+Status BlobDBImpl::Put(const WriteOptions& options,
+                       ColumnFamilyHandle* column_family, const Slice& key,
+                       const Slice& value) {
+  WriteBatch batch;
+  batch.Put(column_family, key, value);
+  return Write(options, &batch);
+}
+
+Status BlobDBImpl::Delete(const WriteOptions& options,
+                          ColumnFamilyHandle* column_family,
+                          const Slice& key) {
+  WriteBatch batch;
+  batch.Delete(column_family, key);
+  return Write(options, &batch);
+}
+
+Status BlobDBImpl::SingleDelete(const WriteOptions& options,
+                                ColumnFamilyHandle* column_family,
+                                const Slice& key) {
+  WriteBatch batch;
+  batch.SingleDelete(column_family, key);
+  return Write(options, &batch);
+}
+
+Status BlobDBImpl::DeleteRange(const WriteOptions& options,
+                               ColumnFamilyHandle* column_family,
+                               const Slice& begin_key, const Slice& end_key) {
+  WriteBatch batch;
+  batch.DeleteRange(column_family, begin_key, end_key);
+  return Write(options, &batch);
+}
+
+Status BlobDBImpl::Merge(const WriteOptions& options,
+                         ColumnFamilyHandle* column_family, const Slice& key,
+                         const Slice& value) {
+  return Status::NotSupported("Merge is not supported by BlobDB");
+}
+
+Status BlobDBImpl::Write(const WriteOptions& options, WriteBatch* updates) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  WriteHandler handler(this);
+  Status s = updates->Iterate(&handler);
+  if (s.ok()) {
+    s = SyncBlobFile(options);
+  }
+  if (s.ok()) {
+    s = db_->Write(options, handler.batch());
+  }
+  if (s.ok()) {
+    AddGarbageBytes(handler.garbage());
+    AddGarbageBytes(handler.overwritten());
+    MaybeScheduleGarbageCollection();
+  } else {
+    AddGarbageBytes(handler.AbandonedRecords());
+  }
+  return s;
+}
+
+Status BlobDBImpl::ResolveValue(const BlobFileMap& blob_files,
+                                const Slice& key, const Slice& index_entry,
+                                std::string* value, uint64_t* file_number,
+                                uint64_t* offset) {
+  if (index_entry.empty()) {
+    return Status::Corruption("Empty BlobDB index entry");
+  }
+  if (index_entry[0] == kInlineValue) {
+    value->assign(index_entry.data() + 1, index_entry.size() - 1);
+    return Status::OK();
+  }
+  uint64_t number;
+  uint64_t record_offset;
+  uint64_t value_size;
+  if (!DecodeBlobIndex(index_entry, &number, &record_offset, &value_size)) {
+    return Status::Corruption("Corrupted BlobDB index entry");
+  }
+  if (file_number != nullptr) {
+    *file_number = number;
+  }
+  if (offset != nullptr) {
+    *offset = record_offset;
+  }
+  auto iter = blob_files.find(number);
+  if (iter == blob_files.end()) {
+    return Status::Corruption("BlobDB index entry points to a missing file");
+  }
+  return iter->second->ReadValue(key, record_offset, value_size, value);
+}
+
+Status BlobDBImpl::Get(const ReadOptions& options,
+                       ColumnFamilyHandle* column_family, const Slice& key,
+                       std::string* value) {
+  if (!IsDefaultColumnFamily(column_family)) {
+    return Status::NotSupported(
+        "BlobDB only supports the default column family");
+  }
+  // Pin the files before reading the pointer, so that a concurrent garbage
+  // collection cannot close the file it points to.
+  auto blob_files = GetBlobFiles();
+  std::string index_entry;
+  Status s = db_->Get(options, column_family, key, &index_entry);
+  if (s.ok()) {
+    s = ResolveValue(*blob_files, key, index_entry, value);
+  }
+  return s;
+}
+
+std::vector<Status> BlobDBImpl::MultiGet(
+    const ReadOptions& options,
+    const std::vector<ColumnFamilyHandle*>& column_family,
+    const std::vector<Slice>& keys, std::vector<std::string>* values) {
+  values->resize(keys.size());
+  std::vector<Status> statuses;
+  statuses.reserve(keys.size());
+  for (size_t i = 0; i < keys.size(); i++) {
+    statuses.push_back(Get(options, column_family[i], keys[i], &(*values)[i]));
+  }
+  return statuses;
+}
+
+bool BlobDBImpl::KeyMayExist(const ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& key, std::string* value,
+                             bool* value_found) {
+  if (!IsDefaultColumnFamily(column_family)) {
+    return false;
+  }
+  auto blob_files = GetBlobFiles();
+  std::string index_entry;
+  bool may_exist =
+      db_->KeyMayExist(options, column_family, key, &index_entry, value_found);
+  if (value != nullptr && value_found != nullptr && *value_found) {
+    *value_found =
+        ResolveValue(*blob_files, key, index_entry, value).ok();
+  }
+  return may_exist;
+}
+
+Iterator* BlobDBImpl::NewIterator(const ReadOptions& options,
+                                  ColumnFamilyHandle* column_family) {
+  if (!IsDefaultColumnFamily(column_family)) {
+    return NewErrorIterator(Status::NotSupported(
+        "BlobDB only supports the default column family"));
+  }
+  auto blob_files = GetBlobFiles();
+  return new BlobDBIterator(db_->NewIterator(options, column_family),
+                            blob_files, blob_db_options_.scan_readahead_size);
+}
+
+Status BlobDBImpl::CreateColumnFamily(const ColumnFamilyOptions& options,
+                                      const std::string& column_family_name,
+                                      ColumnFamilyHandle** handle) {
+  return Status::NotSupported("BlobDB only supports the default column family");
+}
+
+uint64_t BlobDBImpl::PickFileToCollect(double min_ratio) {
+  uint64_t picked = 0;
+  double picked_ratio = 0;
+  for (const auto& stats : file_stats_) {
+    if (stats.first == writer_file_number_ || stats.second.total_bytes == 0 ||
+        stats.second.garbage_bytes == 0) {
+      continue;
+    }
+    const double ratio = static_cast<double>(stats.second.garbage_bytes) /
+                         stats.second.total_bytes;
+    if (ratio >= min_ratio && ratio > picked_ratio) {
+      picked = stats.first;
+      picked_ratio = ratio;
+    }
+  }
+  return picked;
+}
+
+void BlobDBImpl::MaybeScheduleGarbageCollection() {
+  DeleteObsoleteFiles();
+  if (bg_gc_scheduled_ || shutting_down_ || !bg_error_.ok()) {
+    return;
+  }
+  if (PickFileToCollect(blob_db_options_.garbage_collection_ratio) == 0) {
+    return;
+  }
+  bg_gc_scheduled_ = true;
+  env_->Schedule(&BlobDBImpl::BGWorkGarbageCollect, this, Env::Priority::LOW,
+                 this);
+}
+
+void BlobDBImpl::BGWorkGarbageCollect(void* arg) {
+  BlobDBImpl* impl = reinterpret_cast<BlobDBImpl*>(arg);
+  Status s;
+  while (s.ok()) {
+    uint64_t file_number;
+    {
+      std::lock_guard<std::mutex> lock(impl->write_mutex_);
+      if (impl->shutting_down_) {
+        break;
+      }
+      file_number = impl->PickFileToCollect(
+          impl->blob_db_options_.garbage_collection_ratio);
+    }
+    if (file_number == 0) {
+      break;
+    }
+    s = impl->CollectFile(file_number);
+  }
+  std::lock_guard<std::mutex> lock(impl->write_mutex_);
+  if (!s.ok() && !impl->shutting_down_) {
+    Log(InfoLogLevel::ERROR_LEVEL, impl->GetDBOptions().info_log,
+        "[BlobDB] Garbage collection failed: %s", s.ToString().c_str());
+  }
+  impl->bg_gc_scheduled_ = false;
+  impl->bg_cv_.notify_all();
+}
+
+Status BlobDBImpl::GarbageCollect() {
+  Status s;
+  while (s.ok()) {
+    uint64_t file_number;
+    {
+      std::lock_guard<std::mutex> lock(write_mutex_);
+      file_number = PickFileToCollect(0);
+    }
+    if (file_number == 0) {
+      break;
+    }
+    s = CollectFile(file_number);
+  }
+  return s;
+}
+
+Status BlobDBImpl::CollectFile(uint64_t file_number) {
+  std::lock_guard<std::mutex> gc_lock(gc_mutex_);
+  std::shared_ptr<BlobFile> file;
+  uint64_t file_size;
+  {
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    auto stats = file_stats_.find(file_number);
+    if (stats == file_stats_.end()) {
+      // Collected by someone else meanwhile
+      return Status::OK();
+    }
+    file_size = stats->second.total_bytes + BlobFile::kHeaderSize;
+    file = GetBlobFiles()->at(file_number);
+  }
+
+  ReadOptions read_options;
+  read_options.fill_cache = false;
+  std::string buf;
+  std::string index_entry;
+  std::string new_index_entry;
+  uint64_t offset = BlobFile::kHeaderSize;
+  while (offset < file_size) {
+    Slice key;
+    Slice value;
+    Status s = file->ReadRecord(offset, &key, &value, &buf);
+    if (!s.ok()) {
+      // The tail of a file written before a crash may be cut short. Records
+      // in it are not referenced by the LSM tree, so they are garbage.
+      if (s.IsCorruption()) {
+        break;
+      }
+      return s;
+    }
+    const uint64_t record_offset = offset;
+    offset += BlobFile::RecordSize(key.size(), value.size());
+
+    // A record is live if the key still points to it. Writers cannot change
+    // the key between the check and the rewrite, since they hold the same
+    // mutex.
+    std::lock_guard<std::mutex> lock(write_mutex_);
+    if (shutting_down_) {
+      return Status::ShutdownInProgress();
+    }
+    s = db_->Get(read_options, key, &index_entry);
+    if (s.IsNotFound()) {
+      continue;
+    }
+    if (!s.ok()) {
+      return s;
+    }
+    uint64_t current_file;
+    uint64_t current_offset;
+    uint64_t value_size;
+    if (!DecodeBlobIndex(index_entry, &current_file, &current_offset,
+                         &value_size) ||
+        current_file != file_number || current_offset != record_offset) {
+      continue;
+    }
+    uint64_t new_file;
+    uint64_t new_offset;
+    s = AppendRecord(key, value, &new_file, &new_offset);
+    if (!s.ok()) {
+      return s;
+    }
+    EncodeBlobIndex(new_file, new_offset, value.size(), &new_index_entry);
+    s = db_->Put(WriteOptions(), key, new_index_entry);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  // The moved values must survive a crash before the file can go away.
+  Status s = writer_->Sync(GetDBOptions().use_fsync);
+  if (!s.ok()) {
+    return s;
+  }
+  // The file stays readable until DeleteObsoleteFiles() deletes it, since
+  // reads at a snapshot may still resolve old pointers into it.
+  file_stats_.erase(file_number);
+  obsolete_files_.push_back(file_number);
+  DeleteObsoleteFiles();
+  return Status::OK();
+}
+
+void BlobDBImpl::DeleteObsoleteFiles() {
+  if (obsolete_files_.empty()) {
+    return;
+  }
+  // A snapshot may still read the old pointers into a collected file.
+  uint64_t num_snapshots = 0;
+  if (!db_->GetIntProperty(DB::Properties::kNumSnapshots, &num_snapshots) ||
+      num_snapshots > 0) {
+    return;
+  }
+  auto blob_files = std::make_shared<BlobFileMap>(*GetBlobFiles());
+  for (uint64_t number : obsolete_files_) {
+    blob_files->erase(number);
+    env_->DeleteFile(BlobFileName(number));
+  }
+  std::atomic_store(&blob_files_,
+                    std::shared_ptr<const BlobFileMap>(blob_files));
+  obsolete_files_.clear();
+}
+
+uint64_t BlobDBImpl::TEST_GetGarbageBytes(uint64_t file_number) {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  auto iter = file_stats_.find(file_number);
+  return iter == file_stats_.end() ? 0 : iter->second.garbage_bytes;
+}
+
+std::vector<uint64_t> BlobDBImpl::TEST_GetBlobFileNumbers() {
+  std::lock_guard<std::mutex> lock(write_mutex_);
+  std::vector<uint64_t> numbers;
+  for (const auto& stats : file_stats_) {
+    numbers.push_back(stats.first);
+  }
+  return numbers;
+}
+
+void BlobDBImpl::TEST_WaitForBackgroundWork() {
+  std::unique_lock<std::mutex> lock(write_mutex_);
+  while (bg_gc_scheduled_) {
+    bg_cv_.wait(lock);
+  }
+}
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
@@ -0,0 +1,244 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#pragma once
+#ifndef ROCKSDB_LITE
+
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/utilities/blob_db.h"
+#include "util/file_reader_writer.h"
+
+namespace rocksdb {
+
+// Layout of a value log file:
+//
+//   header: magic (fixed32) | version (fixed32)
+//   record: crc (fixed32) | key size (fixed32) | value size (fixed64) |
+//           key | value
+//
+// The crc is the masked crc32c of everything in the record after it. The
+// LSM tree stores, for every key, a value of one of the forms
+//
+//   kInlineValue | value
+//   kBlobIndex | file number (varint64) | record offset (varint64) |
+//       value size (varint64)
+//
+// The size of a record follows from the sizes of its key and value, so the
+// index does not need to store it.
+class BlobFile {
+ public:
+  static const uint32_t kMagicNumber = 0x626c6f62;  // "blob"
+  static const uint32_t kVersion = 1;
+  static const uint64_t kHeaderSize = 8;
+  static const uint64_t kRecordHeaderSize = 16;
+
+  static uint64_t RecordSize(uint64_t key_size, uint64_t value_size) {
+    return kRecordHeaderSize + key_size + value_size;
+  }
+
+  BlobFile(uint64_t number, std::unique_ptr<RandomAccessFileReader>&& reader)
+      : number_(number), reader_(std::move(reader)) {}
+
+  uint64_t number() const { return number_; }
+
+  // Reads the record at "offset" and checks that it belongs to "key".
+  Status ReadValue(const Slice& key, uint64_t offset, uint64_t value_size,
+                   std::string* value) const;
+
+  // Reads the record at "offset". "key" and "value" point into "buf".
+  Status ReadRecord(uint64_t offset, Slice* key, Slice* value,
+                    std::string* buf) const;
+
+  Status Prefetch(uint64_t offset, size_t n) const {
+    return reader_->Prefetch(offset, n);
+  }
+
+ private:
+  const uint64_t number_;
+  std::unique_ptr<RandomAccessFileReader> reader_;
+};
+
+class BlobDBImpl : public BlobDB {
+ public:
+  BlobDBImpl(DB* db, const Options& options,
+             const BlobDBOptions& blob_db_options, const std::string& blob_dir);
+
+  virtual ~BlobDBImpl();
+
+  // Opens the existing value log files, rebuilds their garbage statistics
+  // from the LSM tree and starts a new value log file.
+  Status OpenBlobFiles();
+
+  using BlobDB::Put;
+  virtual Status Put(const WriteOptions& options,
+                     ColumnFamilyHandle* column_family, const Slice& key,
+                     const Slice& value) override;
+
+  using BlobDB::Delete;
+  virtual Status Delete(const WriteOptions& options,
+                        ColumnFamilyHandle* column_family,
+                        const Slice& key) override;
+
+  using BlobDB::SingleDelete;
+  virtual Status SingleDelete(const WriteOptions& options,
+                              ColumnFamilyHandle* column_family,
+                              const Slice& key) override;
+
+  using BlobDB::DeleteRange;
+  virtual Status DeleteRange(const WriteOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             const Slice& begin_key,
+                             const Slice& end_key) override;
+
+  using BlobDB::Merge;
+  virtual Status Merge(const WriteOptions& options,
+                       ColumnFamilyHandle* column_family, const Slice& key,
+                       const Slice& value) override;
+
+  virtual Status Write(const WriteOptions& options,
+                       WriteBatch* updates) override;
+
+  using BlobDB::Get;
+  virtual Status Get(const ReadOptions& options,
+                     ColumnFamilyHandle* column_family, const Slice& key,
+                     std::string* value) override;
+
+  using BlobDB::MultiGet;
+  virtual std::vector<Status> MultiGet(
+      const ReadOptions& options,
+      const std::vector<ColumnFamilyHandle*>& column_family,
+      const std::vector<Slice>& keys,
+      std::vector<std::string>* values) override;
+
+  using BlobDB::KeyMayExist;
+  virtual bool KeyMayExist(const ReadOptions& options,
+                           ColumnFamilyHandle* column_family, const Slice& key,
+                           std::string* value,
+                           bool* value_found = nullptr) override;
+
+  using BlobDB::NewIterator;
+  virtual Iterator* NewIterator(const ReadOptions& options,
+                                ColumnFamilyHandle* column_family) override;
+
+  using BlobDB::CreateColumnFamily;
+  virtual Status CreateColumnFamily(const ColumnFamilyOptions& options,
+                                    const std::string& column_family_name,
+                                    ColumnFamilyHandle** handle) override;
+
+  virtual Status GarbageCollect() override;
+
+  virtual BlobDBOptions GetBlobDBOptions() const override {
+    return blob_db_options_;
+  }
+
+  // The value log files that may be referenced by the LSM tree, including
+  // collected files that reads at a snapshot may still need. Readers hold
+  // on to a map while they resolve pointers, so that a garbage collection
+  // cannot close a file they read from.
+  typedef std::map<uint64_t, std::shared_ptr<BlobFile>> BlobFileMap;
+
+  std::shared_ptr<const BlobFileMap> GetBlobFiles() const;
+
+  // Decodes a value read from the LSM tree into the user value, reading it
+  // from "blob_files" if needed.
+  static Status ResolveValue(const BlobFileMap& blob_files, const Slice& key,
+                             const Slice& index_entry, std::string* value,
+                             uint64_t* file_number = nullptr,
+                             uint64_t* offset = nullptr);
+
+  // For tests
+  uint64_t TEST_GetGarbageBytes(uint64_t file_number);
+  std::vector<uint64_t> TEST_GetBlobFileNumbers();
+  void TEST_WaitForBackgroundWork();
+
+ private:
+  struct FileStats {
+    FileStats() : total_bytes(0), garbage_bytes(0) {}
+    // Bytes of records in the file.
+    uint64_t total_bytes;
+    // Bytes of records that are no longer referenced by the LSM tree.
+    uint64_t garbage_bytes;
+  };
+
+  class WriteHandler;
+
+  static void BGWorkGarbageCollect(void* arg);
+
+  bool IsDefaultColumnFamily(ColumnFamilyHandle* column_family) const;
+
+  // Encodes "value" for the LSM tree, appending it to the current value log
+  // file if it is large enough.
+  // REQUIRES: write_mutex_ held
+  Status EncodeValue(const Slice& key, const Slice& value,
+                     std::string* index_entry);
+
+  // Adds bytes per file number to the garbage of the value log files.
+  // REQUIRES: write_mutex_ held
+  void AddGarbageBytes(const std::map<uint64_t, uint64_t>& garbage);
+
+  // REQUIRES: write_mutex_ held
+  Status AppendRecord(const Slice& key, const Slice& value,
+                      uint64_t* file_number, uint64_t* offset);
+  // Closes the current value log file, if any, and opens a new one.
+  // REQUIRES: write_mutex_ held
+  Status NewWritableBlobFile();
+  // REQUIRES: write_mutex_ held
+  Status SyncBlobFile(const WriteOptions& options);
+
+  // Moves the live records of "file_number" to the current value log file
+  // and deletes it.
+  Status CollectFile(uint64_t file_number);
+  // Schedules a background garbage collection if a full file reached the
+  // garbage ratio.
+  // REQUIRES: write_mutex_ held
+  void MaybeScheduleGarbageCollection();
+  // Picks the full file with the most garbage, ignoring files with a garbage
+  // ratio below "min_ratio". Returns 0 if there is none.
+  // REQUIRES: write_mutex_ held
+  uint64_t PickFileToCollect(double min_ratio);
+  // Deletes the collected files if no snapshot may still reference them.
+  // REQUIRES: write_mutex_ held
+  void DeleteObsoleteFiles();
+
+  std::string BlobFileName(uint64_t number) const;
+
+  const BlobDBOptions blob_db_options_;
+  const std::string blob_dir_;
+  const Comparator* const comparator_;
+  Env* env_;
+  EnvOptions env_options_;
+
+  // Serializes writes and protects all the members below.
+  std::mutex write_mutex_;
+  std::condition_variable bg_cv_;
+  // Held while a file is collected, so that only one collection runs at a
+  // time. Acquired before write_mutex_.
+  std::mutex gc_mutex_;
+
+  std::shared_ptr<const BlobFileMap> blob_files_;
+  std::map<uint64_t, FileStats> file_stats_;
+  // Collected files waiting for the snapshots to be released.
+  std::vector<uint64_t> obsolete_files_;
+
+  std::unique_ptr<WritableFileWriter> writer_;
+  uint64_t writer_file_number_;
+  uint64_t writer_offset_;
+  uint64_t next_file_number_;
+
+  bool bg_gc_scheduled_;
+  bool shutting_down_;
+  Status bg_error_;
+};
+
+}  // namespace rocksdb
+#endif  // ROCKSDB_LITE
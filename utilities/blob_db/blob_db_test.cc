@@ -0,0 +1,275 @@
+//  Copyright (c) 2016, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under the BSD-style license found in the
+//  LICENSE file in the root directory of this source tree. An additional grant
+//  of patent rights can be found in the PATENTS file in the same directory.
+
+#ifndef ROCKSDB_LITE
+#include "utilities/blob_db/blob_db_impl.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "util/random.h"
+#include "util/string_util.h"
+#include "util/testharness.h"
+#include "util/testutil.h"
+
+namespace rocksdb {
+
+namespace {
+std::string RandomString(Random* rnd, int len) {
+  std::string r;
+  test::RandomString(rnd, len, &r);
+  return r;
+}
+}  // namespace
+
+class BlobDBTest : public testing::Test {
+ public:
+  BlobDBTest() : env_(Env::Default()), blob_db_(nullptr) {
+    dbname_ = test::TmpDir(env_) + "/blob_db_test";
+    options_.create_if_missing = true;
+    blob_db_options_.min_blob_size = 100;
+    blob_db_options_.blob_file_size = 16 << 10;
+    DestroyBlobDB();
+    Reopen();
+  }
+
+  ~BlobDBTest() {
+    delete blob_db_;
+    DestroyBlobDB();
+  }
+
+  void Reopen() {
+    delete blob_db_;
+    blob_db_ = nullptr;
+    ASSERT_OK(BlobDB::Open(options_, blob_db_options_, dbname_, &blob_db_));
+  }
+
+  void DestroyBlobDB() {
+    const std::string blob_dir = dbname_ + "/" + blob_db_options_.blob_dir;
+    std::vector<std::string> children;
+    if (env_->GetChildren(blob_dir, &children).ok()) {
+      for (const auto& child : children) {
+        env_->DeleteFile(blob_dir + "/" + child);
+      }
+      env_->DeleteDir(blob_dir);
+    }
+    ASSERT_OK(DestroyDB(dbname_, options_));
+  }
+
+  BlobDBImpl* impl() { return reinterpret_cast<BlobDBImpl*>(blob_db_); }
+
+  std::string Get(const std::string& key) {
+    std::string value;
+    Status s = blob_db_->Get(ReadOptions(), key, &value);
+    if (s.IsNotFound()) {
+      return "NOT_FOUND";
+    }
+    EXPECT_OK(s);
+    return value;
+  }
+
+  uint64_t TotalGarbageBytes() {
+    uint64_t total = 0;
+    for (uint64_t number : impl()->TEST_GetBlobFileNumbers()) {
+      total += impl()->TEST_GetGarbageBytes(number);
+    }
+    return total;
+  }
+
+  void VerifyIterator(const std::map<std::string, std::string>& expected) {
+    std::unique_ptr<Iterator> iter(blob_db_->NewIterator(ReadOptions()));
+    auto expected_iter = expected.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected_iter) {
+      ASSERT_TRUE(expected_iter != expected.end());
+      ASSERT_EQ(expected_iter->first, iter->key().ToString());
+      ASSERT_EQ(expected_iter->second, iter->value().ToString());
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_TRUE(expected_iter == expected.end());
+  }
+
+  Env* env_;
+  std::string dbname_;
+  Options options_;
+  BlobDBOptions blob_db_options_;
+  BlobDB* blob_db_;
+};
+
+TEST_F(BlobDBTest, PutGetDelete) {
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int i = 0; i < 100; i++) {
+    std::string key = "key" + ToString(i);
+    // Every other value is small enough to stay in the LSM tree
+    std::string value = RandomString(&rnd, i % 2 == 0 ? 10 : 1000);
+    ASSERT_OK(blob_db_->Put(WriteOptions(), key, value));
+    expected[key] = value;
+  }
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+  ASSERT_GT(impl()->TEST_GetBlobFileNumbers().size(), 1U);
+  VerifyIterator(expected);
+
+  ASSERT_OK(blob_db_->Delete(WriteOptions(), "key1"));
+  expected.erase("key1");
+  ASSERT_EQ("NOT_FOUND", Get("key1"));
+
+  // The LSM tree only holds pointers, which survive flushes, compactions and
+  // reopening.
+  ASSERT_OK(blob_db_->Flush(FlushOptions()));
+  ASSERT_OK(blob_db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  Reopen();
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+  VerifyIterator(expected);
+
+  ASSERT_TRUE(
+      blob_db_->Merge(WriteOptions(), "key0", "value").IsNotSupported());
+}
+
+TEST_F(BlobDBTest, WriteBatch) {
+  Random rnd(301);
+  std::string value1 = RandomString(&rnd, 1000);
+  std::string value2 = RandomString(&rnd, 1000);
+  WriteBatch batch;
+  batch.Put("a", value1);
+  batch.Put("b", value1);
+  // Overwritten in the same batch
+  batch.Put("a", value2);
+  batch.Put("c", "small");
+  batch.Delete("b");
+  ASSERT_OK(blob_db_->Write(WriteOptions(), &batch));
+  ASSERT_EQ(value2, Get("a"));
+  ASSERT_EQ("NOT_FOUND", Get("b"));
+  ASSERT_EQ("small", Get("c"));
+  // The first value of "a" and the value of "b" are garbage already
+  ASSERT_EQ(2 * BlobFile::RecordSize(1, 1000), TotalGarbageBytes());
+}
+
+TEST_F(BlobDBTest, GarbageAccounting) {
+  Random rnd(301);
+  const size_t kValueSize = 1000;
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(blob_db_->Put(WriteOptions(), "key" + ToString(i),
+                            RandomString(&rnd, kValueSize)));
+  }
+  ASSERT_EQ(0U, TotalGarbageBytes());
+  const uint64_t record_size = BlobFile::RecordSize(4, kValueSize);
+
+  ASSERT_OK(blob_db_->Put(WriteOptions(), "key0",
+                          RandomString(&rnd, kValueSize)));
+  ASSERT_EQ(record_size, TotalGarbageBytes());
+  ASSERT_OK(blob_db_->Delete(WriteOptions(), "key1"));
+  ASSERT_EQ(2 * record_size, TotalGarbageBytes());
+  // Replacing a value by a small one frees the old one as well
+  ASSERT_OK(blob_db_->Put(WriteOptions(), "key2", "small"));
+  ASSERT_EQ(3 * record_size, TotalGarbageBytes());
+  ASSERT_OK(blob_db_->DeleteRange(WriteOptions(), "key3", "key5"));
+  ASSERT_EQ(5 * record_size, TotalGarbageBytes());
+  ASSERT_EQ("NOT_FOUND", Get("key4"));
+
+  // The garbage is recomputed from the LSM tree on open
+  Reopen();
+  ASSERT_EQ(5 * record_size, TotalGarbageBytes());
+}
+
+TEST_F(BlobDBTest, GarbageCollection) {
+  blob_db_options_.garbage_collection_ratio = 2;
+  Reopen();
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int round = 0; round < 3; round++) {
+    for (int i = 0; i < 50; i++) {
+      if (round > 0 && i % 3 != 0) {
+        continue;
+      }
+      std::string key = "key" + ToString(i);
+      std::string value = RandomString(&rnd, 1000);
+      ASSERT_OK(blob_db_->Put(WriteOptions(), key, value));
+      expected[key] = value;
+    }
+  }
+  // Nothing reached the garbage collection ratio
+  impl()->TEST_WaitForBackgroundWork();
+  auto files = impl()->TEST_GetBlobFileNumbers();
+  const uint64_t first_file = files[0];
+  char first_file_name[32];
+  snprintf(first_file_name, sizeof(first_file_name), "/blob/%06d.blob",
+           static_cast<int>(first_file));
+  const uint64_t garbage_before = TotalGarbageBytes();
+  ASSERT_GT(garbage_before, 0U);
+
+  // A snapshot keeps the collected files on disk and readable
+  const Snapshot* snapshot = blob_db_->GetSnapshot();
+  ASSERT_OK(blob_db_->GarbageCollect());
+  ASSERT_LT(TotalGarbageBytes(), garbage_before);
+  files = impl()->TEST_GetBlobFileNumbers();
+  ASSERT_NE(first_file, files[0]);
+  VerifyIterator(expected);
+  ASSERT_OK(env_->FileExists(dbname_ + first_file_name));
+  ReadOptions snapshot_options;
+  snapshot_options.snapshot = snapshot;
+  for (const auto& kv : expected) {
+    std::string value;
+    ASSERT_OK(blob_db_->Get(snapshot_options, kv.first, &value));
+    ASSERT_EQ(kv.second, value);
+  }
+  blob_db_->ReleaseSnapshot(snapshot);
+
+  ASSERT_OK(blob_db_->Put(WriteOptions(), "key1", "small"));
+  expected["key1"] = "small";
+  ASSERT_TRUE(env_->FileExists(dbname_ + first_file_name).IsNotFound());
+
+  Reopen();
+  for (const auto& kv : expected) {
+    ASSERT_EQ(kv.second, Get(kv.first));
+  }
+}
+
+TEST_F(BlobDBTest, BackgroundGarbageCollection) {
+  blob_db_options_.garbage_collection_ratio = 0.5;
+  Reopen();
+  const uint64_t first_file = impl()->TEST_GetBlobFileNumbers()[0];
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  // Overwrite the same keys until the first files are mostly garbage
+  for (int round = 0; round < 5; round++) {
+    for (int i = 0; i < 20; i++) {
+      std::string key = "key" + ToString(i);
+      std::string value = RandomString(&rnd, 1000);
+      ASSERT_OK(blob_db_->Put(WriteOptions(), key, value));
+      expected[key] = value;
+    }
+  }
+  impl()->TEST_WaitForBackgroundWork();
+  ASSERT_NE(first_file, impl()->TEST_GetBlobFileNumbers()[0]);
+  VerifyIterator(expected);
+}
+
+TEST_F(BlobDBTest, NotSupported) {
+  ColumnFamilyHandle* handle;
+  ASSERT_TRUE(blob_db_->CreateColumnFamily(ColumnFamilyOptions(), "cf", &handle)
+                  .IsNotSupported());
+}
+
+}  // namespace rocksdb
+
+int main(int argc, char** argv) {
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
+
+#else
+#include <stdio.h>
+
+int main(int argc, char** argv) {
+  fprintf(stderr, "SKIPPED as BlobDB is not supported in ROCKSDB_LITE\n");
+  return 0;
+}
+
+#endif  // !ROCKSDB_LITE
@@ -7,6 +7,11 @@
 
 #include "rocksdb/utilities/document_db.h"
 
+#include <algorithm>
+#include <atomic>
+#include <thread>
+#include <unordered_set>
+
 #include "rocksdb/cache.h"
 #include "rocksdb/table.h"
 #include "rocksdb/filter_policy.h"
@@ -16,6 +21,7 @@
 #include "rocksdb/utilities/json_document.h"
 #include "util/coding.h"
 #include "util/mutexlock.h"
+#include "util/sync_point.h"
 #include "port/port.h"
 
 namespace rocksdb {
@@ -710,9 +716,10 @@ class DocumentDBImpl : public DocumentDB {
   DocumentDBImpl(
       DB* db, ColumnFamilyHandle* primary_key_column_family,
       const std::vector<std::pair<Index*, ColumnFamilyHandle*>>& indexes,
-      const Options& rocksdb_options)
+      const DocumentDBOptions& options, const Options& rocksdb_options)
       : DocumentDB(db),
         primary_key_column_family_(primary_key_column_family),
+        index_build_threads_(std::max(options.index_build_threads, 1)),
         rocksdb_options_(rocksdb_options) {
     for (const auto& index : indexes) {
       name_to_index_.insert(
@@ -745,31 +752,76 @@ class DocumentDBImpl : public DocumentDB {
       return s;
     }
 
-    MutexLock l(&write_mutex_);
-
-    std::unique_ptr<CursorFromIterator> cursor(new CursorFromIterator(
-        DocumentDB::NewIterator(ReadOptions(), primary_key_column_family_)));
+    // The ranges are handed out to the threads one at a time, so there are a
+    // few more of them than threads to even out their sizes.
+    std::vector<std::string> split_keys =
+        GetIndexBuildSplitKeys(4 * index_build_threads_);
+    const size_t num_ranges = split_keys.size() + 1;
 
-    WriteBatch batch;
-    for (; cursor->Valid(); cursor->Next()) {
-      std::string secondary_index_key;
-      index_obj->GetIndexKey(cursor->document(), &secondary_index_key);
-      IndexKey index_key(Slice(secondary_index_key), cursor->key());
-      batch.Put(cf_handle, index_key.GetSliceParts(), SliceParts());
+    // From now on writers maintain the new index and remember the documents
+    // they modify, so that the scan below, which reads the documents as of
+    // the snapshot, does not overwrite their index entries with stale ones.
+    const Snapshot* snapshot;
+    {
+      MutexLock l(&write_mutex_);
+      snapshot = GetSnapshot();
+      IndexBuild& build = index_builds_[index.name];
+      build.split_keys = split_keys;
+      build.ranges.resize(num_ranges);
+      MutexLock l_nti(&name_to_index_mutex_);
+      name_to_index_.insert(
+          {index.name, IndexColumnFamily(index_obj, cf_handle, true)});
     }
-
-    if (!cursor->status().ok()) {
-      delete index_obj;
-      return cursor->status();
+    std::atomic<size_t> next_range(0);
+    port::Mutex status_mutex;
+    std::vector<std::thread> threads;
+    for (size_t i = 0;
+         i < std::min(num_ranges, static_cast<size_t>(index_build_threads_));
+         ++i) {
+      threads.emplace_back([&] {
+        while (true) {
+          size_t range = next_range.fetch_add(1);
+          if (range >= num_ranges) {
+            break;
+          }
+          Status t = BuildIndexRange(
+              write_options, snapshot, index.name, index_obj, cf_handle, range,
+              range == 0 ? nullptr : &split_keys[range - 1],
+              range == num_ranges - 1 ? nullptr : &split_keys[range]);
+          if (!t.ok()) {
+            MutexLock l(&status_mutex);
+            if (s.ok()) {
+              s = t;
+            }
+            // let the other threads run out of ranges
+            next_range.store(num_ranges);
+            break;
+          }
+        }
+      });
+    }
+    for (auto& t : threads) {
+      t.join();
     }
 
     {
+      MutexLock l(&write_mutex_);
+      index_builds_.erase(index.name);
+      ReleaseSnapshot(snapshot);
       MutexLock l_nti(&name_to_index_mutex_);
-      name_to_index_.insert(
-          {index.name, IndexColumnFamily(index_obj, cf_handle)});
+      if (s.ok()) {
+        name_to_index_.find(index.name)->second.building = false;
+      } else {
+        name_to_index_.erase(index.name);
+      }
     }
 
-    return DocumentDB::Write(write_options, &batch);
+    if (!s.ok()) {
+      DropColumnFamily(cf_handle);
+      delete cf_handle;
+      delete index_obj;
+    }
+    return s;
   }
 
   virtual Status DropIndex(const std::string& name) override {
@@ -779,6 +831,9 @@ class DocumentDBImpl : public DocumentDB {
     if (index_iter == name_to_index_.end()) {
       return Status::InvalidArgument("No such index");
     }
+    if (index_iter->second.building) {
+      return Status::Busy("Index is being built");
+    }
 
     Status s = DropColumnFamily(index_iter->second.column_family);
     if (!s.ok()) {
@@ -843,7 +898,11 @@ class DocumentDBImpl : public DocumentDB {
                 SliceParts());
     }
 
-    return DocumentDB::Write(options, &batch);
+    s = DocumentDB::Write(options, &batch);
+    if (s.ok()) {
+      TrackIndexBuildWrite(primary_key_slice);
+    }
+    return s;
   }
 
   virtual Status Remove(const ReadOptions& read_options,
@@ -854,6 +913,7 @@ class DocumentDBImpl : public DocumentDB {
         ConstructFilterCursor(read_options, nullptr, query));
 
     WriteBatch batch;
+    std::vector<std::string> primary_keys;
     for (; cursor->status().ok() && cursor->Valid(); cursor->Next()) {
       const auto& document = cursor->document();
       if (!document.IsObject()) {
@@ -878,6 +938,7 @@ class DocumentDBImpl : public DocumentDB {
       }
       Slice primary_key_slice(primary_key_encoded);
       batch.Delete(primary_key_column_family_, primary_key_slice);
+      primary_keys.push_back(primary_key_encoded);
 
       for (const auto& iter : name_to_index_) {
         std::string secondary_index_key;
@@ -891,7 +952,7 @@ class DocumentDBImpl : public DocumentDB {
       return cursor->status();
     }
 
-    return DocumentDB::Write(write_options, &batch);
+    return WriteAndTrack(write_options, &batch, primary_keys);
   }
 
   virtual Status Update(const ReadOptions& read_options,
@@ -906,6 +967,7 @@ class DocumentDBImpl : public DocumentDB {
         return Status::Corruption("Bad update document format");
     }
     WriteBatch batch;
+    std::vector<std::string> primary_keys;
     for (; cursor->status().ok() && cursor->Valid(); cursor->Next()) {
       const auto& old_document = cursor->document();
       JSONDocument new_document(old_document);
@@ -973,20 +1035,26 @@ class DocumentDBImpl : public DocumentDB {
       Slice primary_key_slice(primary_key_encoded);
       batch.Put(primary_key_column_family_, primary_key_slice,
                 encoded_document);
+      primary_keys.push_back(primary_key_encoded);
 
       for (const auto& iter : name_to_index_) {
         std::string old_key, new_key;
         iter.second.index->GetIndexKey(old_document, &old_key);
         iter.second.index->GetIndexKey(new_document, &new_key);
-        if (old_key == new_key) {
-          // don't need to update this secondary index
+        if (old_key == new_key && !iter.second.building) {
+          // don't need to update this secondary index. An index that is being
+          // built may not have the entry yet, and its build skips this
+          // document from now on.
           continue;
         }
 
         IndexKey old_index_key(Slice(old_key), primary_key_slice);
         IndexKey new_index_key(Slice(new_key), primary_key_slice);
 
-        batch.Delete(iter.second.column_family, old_index_key.GetSliceParts());
+        if (old_key != new_key) {
+          batch.Delete(iter.second.column_family,
+                       old_index_key.GetSliceParts());
+        }
         batch.Put(iter.second.column_family, new_index_key.GetSliceParts(),
                   SliceParts());
       }
@@ -996,7 +1064,7 @@ class DocumentDBImpl : public DocumentDB {
       return cursor->status();
     }
 
-    return DocumentDB::Write(write_options, &batch);
+    return WriteAndTrack(write_options, &batch, primary_keys);
   }
 
   virtual Cursor* Query(const ReadOptions& read_options,
@@ -1059,6 +1127,167 @@ class DocumentDBImpl : public DocumentDB {
   }
 
  private:
+  // Splits the primary key range into at most max_ranges ranges at the
+  // smallest keys of the SST files, so that the ranges hold about the same
+  // number of files.
+  std::vector<std::string> GetIndexBuildSplitKeys(size_t max_ranges) {
+    ColumnFamilyMetaData metadata;
+    GetColumnFamilyMetaData(primary_key_column_family_, &metadata);
+    std::vector<std::string> file_keys;
+    for (const auto& level : metadata.levels) {
+      for (const auto& file : level.files) {
+        file_keys.push_back(file.smallestkey);
+      }
+    }
+    const Comparator* ucmp = rocksdb_options_.comparator;
+    std::sort(file_keys.begin(), file_keys.end(),
+              [ucmp](const std::string& a, const std::string& b) {
+                return ucmp->Compare(a, b) < 0;
+              });
+
+    std::vector<std::string> split_keys;
+    for (size_t i = 1; i < max_ranges; ++i) {
+      size_t pos = i * file_keys.size() / max_ranges;
+      // the range before the first file would be empty
+      if (pos == 0) {
+        continue;
+      }
+      if (split_keys.empty() ||
+          ucmp->Compare(split_keys.back(), file_keys[pos]) < 0) {
+        split_keys.push_back(file_keys[pos]);
+      }
+    }
+    return split_keys;
+  }
+
+  // Creates the index entries of the documents in [begin, end), the range-th
+  // range of the build, as of snapshot. nullptr means an unbounded side.
+  Status BuildIndexRange(const WriteOptions& write_options,
+                         const Snapshot* snapshot, const std::string& name,
+                         const Index* index, ColumnFamilyHandle* cf_handle,
+                         size_t range, const std::string* begin,
+                         const std::string* end) {
+    ReadOptions read_options;
+    read_options.snapshot = snapshot;
+    read_options.fill_cache = false;
+    std::unique_ptr<Iterator> iter(
+        DocumentDB::NewIterator(read_options, primary_key_column_family_));
+    const Comparator* ucmp = rocksdb_options_.comparator;
+
+    // pairs of primary key and secondary key
+    std::vector<std::pair<std::string, std::string>> entries;
+    size_t entries_size = 0;
+    if (begin == nullptr) {
+      iter->SeekToFirst();
+    } else {
+      iter->Seek(*begin);
+    }
+    for (; iter->Valid(); iter->Next()) {
+      if (end != nullptr && ucmp->Compare(iter->key(), *end) >= 0) {
+        break;
+      }
+      std::unique_ptr<JSONDocument> document(
+          JSONDocument::Deserialize(iter->value()));
+      if (document.get() == nullptr) {
+        return Status::Corruption("JSON deserialization failed");
+      }
+      entries.emplace_back(iter->key().ToString(), std::string());
+      index->GetIndexKey(*document, &entries.back().second);
+      entries_size += entries.back().first.size() +
+                      entries.back().second.size() + sizeof(uint32_t);
+      if (entries_size >= kIndexBuildBatchSize) {
+        Status s = WriteIndexEntries(write_options, name, cf_handle, range,
+                                     false /* range_done */, &entries);
+        if (!s.ok()) {
+          return s;
+        }
+        entries_size = 0;
+      }
+    }
+    if (!iter->status().ok()) {
+      return iter->status();
+    }
+    return WriteIndexEntries(write_options, name, cf_handle, range,
+                             true /* range_done */, &entries);
+  }
+
+  // Writes the index entries of documents that were not modified since the
+  // index build started, and clears entries. The entries are the next ones
+  // of the range-th range in key order; range_done means they are its last.
+  Status WriteIndexEntries(
+      const WriteOptions& write_options, const std::string& name,
+      ColumnFamilyHandle* cf_handle, size_t range, bool range_done,
+      std::vector<std::pair<std::string, std::string>>* entries) {
+    TEST_SYNC_POINT_CALLBACK("DocumentDBImpl::WriteIndexEntries", cf_handle);
+    WriteBatch batch;
+    // Writers are only blocked while one batch is written
+    MutexLock l(&write_mutex_);
+    IndexBuild& build = index_builds_[name];
+    for (const auto& entry : *entries) {
+      if (build.modified_keys.erase(entry.first) > 0) {
+        // a writer already created the entry of the current document
+        continue;
+      }
+      IndexKey index_key(Slice(entry.second), Slice(entry.first));
+      batch.Put(cf_handle, index_key.GetSliceParts(), SliceParts());
+    }
+    Status s = DocumentDB::Write(write_options, &batch);
+    if (!s.ok()) {
+      return s;
+    }
+
+    // Writes of the documents the scan has passed need not be tracked any
+    // more. The keys still tracked in a finished range are of documents
+    // created after the snapshot.
+    IndexBuild::RangeProgress& progress = build.ranges[range];
+    if (range_done) {
+      progress.done = true;
+      for (auto iter = build.modified_keys.begin();
+           iter != build.modified_keys.end();) {
+        if (build.RangeOf(*iter, rocksdb_options_.comparator) == range) {
+          iter = build.modified_keys.erase(iter);
+        } else {
+          ++iter;
+        }
+      }
+    } else if (!entries->empty()) {
+      progress.started = true;
+      progress.last_key = entries->back().first;
+    }
+    entries->clear();
+    return s;
+  }
+
+  // Writes batch and, once it succeeded, tells the index builds about the
+  // documents it modified
+  Status WriteAndTrack(const WriteOptions& write_options, WriteBatch* batch,
+                       const std::vector<std::string>& primary_keys) {
+    Status s = DocumentDB::Write(write_options, batch);
+    if (s.ok()) {
+      for (const auto& primary_key : primary_keys) {
+        TrackIndexBuildWrite(primary_key);
+      }
+    }
+    return s;
+  }
+
+  // Remembers that a document was written, unless every index build has
+  // already scanned it. REQUIRES: write_mutex_ held
+  void TrackIndexBuildWrite(const Slice& primary_key) {
+    const Comparator* ucmp = rocksdb_options_.comparator;
+    for (auto& iter : index_builds_) {
+      IndexBuild& build = iter.second;
+      const IndexBuild::RangeProgress& progress =
+          build.ranges[build.RangeOf(primary_key, ucmp)];
+      if (progress.done ||
+          (progress.started &&
+           ucmp->Compare(primary_key, progress.last_key) <= 0)) {
+        continue;
+      }
+      build.modified_keys.insert(primary_key.ToString());
+    }
+  }
+
   Cursor* ConstructFilterCursor(ReadOptions read_options, Cursor* cursor,
                                 const JSONDocument& query) {
     std::unique_ptr<const Filter> filter(Filter::ParseFilter(query));
@@ -1075,7 +1304,8 @@ class DocumentDBImpl : public DocumentDB {
           auto index_name = query["$index"];
           MutexLock l(&name_to_index_mutex_);
           auto index_iter = name_to_index_.find(index_name.GetString());
-          if (index_iter != name_to_index_.end()) {
+          if (index_iter != name_to_index_.end() &&
+              !index_iter->second.building) {
             tmp_storage = index_iter->second;
             index_column_family = &tmp_storage;
           } else {
@@ -1119,11 +1349,16 @@ class DocumentDBImpl : public DocumentDB {
   port::Mutex write_mutex_;
   port::Mutex name_to_index_mutex_;
   const char* kPrimaryKey = "_id";
+  // Index builds write the entries of this many bytes of keys at a time
+  const size_t kIndexBuildBatchSize = 1 << 20;
   struct IndexColumnFamily {
-    IndexColumnFamily(Index* _index, ColumnFamilyHandle* _column_family)
-        : index(_index), column_family(_column_family) {}
+    IndexColumnFamily(Index* _index, ColumnFamilyHandle* _column_family,
+                      bool _building = false)
+        : index(_index), column_family(_column_family), building(_building) {}
     Index* index;
     ColumnFamilyHandle* column_family;
+    // true while CreateIndex() is scanning the documents
+    bool building;
   };
 
 
@@ -1131,7 +1366,36 @@ class DocumentDBImpl : public DocumentDB {
   // 1) when writing -- 1. lock write_mutex_, 2. lock name_to_index_mutex_
   // 2) when reading -- lock name_to_index_mutex_ OR write_mutex_
   std::unordered_map<std::string, IndexColumnFamily> name_to_index_;
+  struct IndexBuild {
+    // How far the scan of one range got
+    struct RangeProgress {
+      RangeProgress() : started(false), done(false) {}
+      // the entries up to last_key were written
+      bool started;
+      std::string last_key;
+      bool done;
+    };
+
+    // Returns the index of the range holding primary_key
+    size_t RangeOf(const Slice& primary_key, const Comparator* ucmp) const {
+      return std::upper_bound(split_keys.begin(), split_keys.end(),
+                              primary_key,
+                              [ucmp](const Slice& a, const std::string& b) {
+                                return ucmp->Compare(a, b) < 0;
+                              }) -
+             split_keys.begin();
+    }
+
+    std::vector<std::string> split_keys;
+    std::vector<RangeProgress> ranges;
+    // The primary keys of the documents written since the build started that
+    // the scan has not reached yet
+    std::unordered_set<std::string> modified_keys;
+  };
+  // The index builds in progress by index name. Protected by write_mutex_.
+  std::unordered_map<std::string, IndexBuild> index_builds_;
   ColumnFamilyHandle* primary_key_column_family_;
+  const int index_build_threads_;
   Options rocksdb_options_;
 };
 
@@ -1184,7 +1448,8 @@ Status DocumentDB::Open(const DocumentDBOptions& options,
                                                    indexes[i].name);
     index_cf[i] = {index, handles[i + 1]};
   }
-  *db = new DocumentDBImpl(base_db, handles[0], index_cf, rocksdb_options);
+  *db = new DocumentDBImpl(base_db, handles[0], index_cf, options,
+                           rocksdb_options);
   return Status::OK();
 }
 
@@ -6,10 +6,13 @@
 #ifndef ROCKSDB_LITE
 
 #include <algorithm>
+#include <atomic>
 
 #include "rocksdb/utilities/json_document.h"
 #include "rocksdb/utilities/document_db.h"
 
+#include "util/string_util.h"
+#include "util/sync_point.h"
 #include "util/testharness.h"
 #include "util/testutil.h"
 
@@ -318,6 +321,90 @@ TEST_F(DocumentDBTest, ComplexQueryTest) {
   ASSERT_OK(db_->DropIndex("priority"));
 }
 
+TEST_F(DocumentDBTest, OnlineIndexBuildTest) {
+  DocumentDBOptions options;
+  options.index_build_threads = 3;
+  ASSERT_OK(DocumentDB::Open(options, dbname_, {}, &db_));
+
+  // several files, so that the build splits the documents into ranges
+  for (int i = 0; i < 400; ++i) {
+    std::unique_ptr<JSONDocument> document(Parse(
+        "{'_id': " + ToString(i) + ", 'group': " + ToString(i % 10) + "}"));
+    ASSERT_OK(db_->Insert(WriteOptions(), *document));
+    if (i % 100 == 99) {
+      ASSERT_OK(db_->Flush(FlushOptions()));
+    }
+  }
+
+  DocumentDB::IndexDescriptor index;
+  index.description = Parse("{'group': 1}");
+  index.name = "group";
+
+  // write while the index is being built
+  std::atomic<bool> written(false);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "DocumentDBImpl::WriteIndexEntries", [&](void* arg) {
+        if (written.exchange(true)) {
+          return;
+        }
+        std::unique_ptr<JSONDocument> query(
+            Parse("[{'$filter': {'group': 1, '$index': 'group'}}]"));
+        std::unique_ptr<Cursor> cursor(db_->Query(ReadOptions(), *query));
+        ASSERT_TRUE(cursor->status().IsInvalidArgument());
+        ASSERT_TRUE(db_->DropIndex("group").IsBusy());
+
+        std::unique_ptr<JSONDocument> filter(Parse("{'_id': {'$lt': 50}}"));
+        std::unique_ptr<JSONDocument> updates(
+            Parse("{'$set': {'group': 100}}"));
+        ASSERT_OK(db_->Update(ReadOptions(), WriteOptions(), *filter,
+                              *updates));
+        // doesn't change the index key
+        filter.reset(Parse("{'_id': {'$gte': 50, '$lt': 100}}"));
+        updates.reset(Parse("{'$set': {'other': 1}}"));
+        ASSERT_OK(db_->Update(ReadOptions(), WriteOptions(), *filter,
+                              *updates));
+        // a failed write must not keep the build from indexing the documents
+        WriteOptions failing_options;
+        failing_options.timeout_hint_us = 1;
+        filter.reset(Parse("{'_id': {'$gte': 100, '$lt': 150}}"));
+        updates.reset(Parse("{'$set': {'group': 200}}"));
+        ASSERT_TRUE(db_->Update(ReadOptions(), failing_options, *filter,
+                                *updates).IsInvalidArgument());
+        filter.reset(Parse("{'_id': {'$gte': 350}}"));
+        ASSERT_OK(db_->Remove(ReadOptions(), WriteOptions(), *filter));
+        std::unique_ptr<JSONDocument> document(
+            Parse("{'_id': 1000, 'group': 100}"));
+        ASSERT_OK(db_->Insert(WriteOptions(), *document));
+      });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+  CreateIndexes({index});
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_TRUE(written.load());
+  delete index.description;
+
+  for (int group = 0; group <= 100; group += (group < 9 ? 1 : 91)) {
+    std::vector<int64_t> expected;
+    if (group == 100) {
+      for (int i = 0; i < 50; ++i) {
+        expected.push_back(i);
+      }
+      expected.push_back(1000);
+    } else {
+      for (int i = 50 + group; i < 350; i += 10) {
+        expected.push_back(i);
+      }
+    }
+    std::unique_ptr<JSONDocument> query(
+        Parse("[{'$filter': {'group': " + ToString(group) +
+              ", '$index': 'group'}}]"));
+    std::unique_ptr<Cursor> cursor(db_->Query(ReadOptions(), *query));
+    ASSERT_OK(cursor->status());
+    AssertCursorIDs(cursor.get(), expected);
+  }
+  ASSERT_OK(db_->DropIndex("group"));
+}
+
 }  //  namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -15,7 +15,11 @@
 #include <map>
 #include <string>
 #include <limits>
+#include <unordered_map>
 #include "db/filename.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/immutable_options.h"
+#include "rocksdb/sst_file_writer.h"
 #include "util/coding.h"
 #include "util/string_util.h"
 
@@ -51,7 +55,14 @@ GeoDBImpl::~GeoDBImpl() {
 
 Status GeoDBImpl::Insert(const GeoObject& obj) {
   WriteBatch batch;
+  Status status = AddToBatch(obj, &batch);
+  if (!status.ok()) {
+    return status;
+  }
+  return db_->Write(woptions_, &batch);
+}
 
+Status GeoDBImpl::AddToBatch(const GeoObject& obj, WriteBatch* batch) {
   // It is possible that this id is already associated with
   // with a different position. We first have to remove that
   // association before we can insert the new one.
@@ -64,8 +75,8 @@ Status GeoDBImpl::Insert(const GeoObject& obj) {
     std::string quadkey = PositionToQuad(old.position, Detail);
     std::string key1 = MakeKey1(old.position, old.id, quadkey);
     std::string key2 = MakeKey2(old.id);
-    batch.Delete(Slice(key1));
-    batch.Delete(Slice(key2));
+    batch->Delete(Slice(key1));
+    batch->Delete(Slice(key2));
   } else if (status.IsNotFound()) {
     // What if another thread is trying to insert the same ID concurrently?
   } else {
@@ -76,9 +87,91 @@ Status GeoDBImpl::Insert(const GeoObject& obj) {
   std::string quadkey = PositionToQuad(obj.position, Detail);
   std::string key1 = MakeKey1(obj.position, obj.id, quadkey);
   std::string key2 = MakeKey2(obj.id);
-  batch.Put(Slice(key1), Slice(obj.value));
-  batch.Put(Slice(key2), Slice(quadkey));
-  return db_->Write(woptions_, &batch);
+  batch->Put(Slice(key1), Slice(obj.value));
+  batch->Put(Slice(key2), Slice(quadkey));
+  return Status::OK();
+}
+
+Status GeoDBImpl::BulkInsert(const std::vector<GeoObject>& objects) {
+  // Keep the last object of every id and sort them by quadkey, so that
+  // the location table is written in key order
+  std::unordered_map<std::string, size_t> last_index;
+  for (size_t i = 0; i < objects.size(); i++) {
+    last_index[objects[i].id] = i;
+  }
+  std::vector<std::pair<std::string, size_t>> sorted;
+  sorted.reserve(last_index.size());
+  for (size_t i = 0; i < objects.size(); i++) {
+    if (last_index[objects[i].id] == i) {
+      sorted.emplace_back(PositionToQuad(objects[i].position, Detail), i);
+    }
+  }
+  std::sort(sorted.begin(), sorted.end());
+
+  // A db without writes nor table files has no object that could have to be
+  // overwritten, so the keys can be loaded from a table file. The sequence
+  // number alone stays 0 after a previous load through AddFile().
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+  if (db_->GetLatestSequenceNumber() == 0 && live_files.empty() &&
+      !sorted.empty()) {
+    std::vector<std::pair<std::string, std::string>> kvs;
+    kvs.reserve(2 * sorted.size());
+    for (const auto& entry : sorted) {
+      const GeoObject& obj = objects[entry.second];
+      kvs.emplace_back(MakeKey1(obj.position, obj.id, entry.first),
+                       obj.value);
+      kvs.emplace_back(MakeKey2(obj.id), entry.first);
+    }
+    std::sort(kvs.begin(), kvs.end());
+    Status s = AddSortedFile(kvs);
+    if (!s.IsNotSupported()) {
+      return s;
+    }
+  }
+
+  WriteBatch batch;
+  for (size_t i = 0; i < sorted.size(); i++) {
+    Status s = AddToBatch(objects[sorted[i].second], &batch);
+    if (!s.ok()) {
+      return s;
+    }
+    if ((i + 1) % kBulkInsertBatchSize == 0 || i + 1 == sorted.size()) {
+      s = db_->Write(woptions_, &batch);
+      if (!s.ok()) {
+        return s;
+      }
+      batch.Clear();
+    }
+  }
+  return Status::OK();
+}
+
+Status GeoDBImpl::AddSortedFile(
+    const std::vector<std::pair<std::string, std::string>>& kvs) {
+  const Options options = db_->GetOptions();
+  const ImmutableCFOptions ioptions(options);
+  Env* env = options.env;
+  std::string file_path = db_->GetName() + "/geodb_bulk_insert_" +
+                          ToString(env->NowMicros()) + ".sst";
+
+  // The prefix scans of the GeoDB keys rely on the bytewise order
+  SstFileWriter writer(EnvOptions(), ioptions, BytewiseComparator());
+  Status s = writer.Open(file_path);
+  for (size_t i = 0; s.ok() && i < kvs.size(); i++) {
+    s = writer.Add(kvs[i].first, kvs[i].second);
+  }
+  ExternalSstFileInfo file_info;
+  if (s.ok()) {
+    s = writer.Finish(&file_info);
+  }
+  if (s.ok()) {
+    s = db_->AddFile(&file_info, true /* move_file */);
+  }
+  if (!s.ok()) {
+    env->DeleteFile(file_path);
+  }
+  return s;
 }
 
 Status GeoDBImpl::GetByPosition(const GeoPosition& pos,
@@ -163,9 +256,11 @@ Status GeoDBImpl::SearchRadial(const GeoPosition& pos,
   double radius,
   std::vector<GeoObject>* values,
   int number_of_values) {
-  // Gather all bounding quadkeys
+  // Gather the bounding box and all its bounding quadkeys
+  GeoPosition topLeft, bottomRight;
+  boundingBox(pos, radius, &topLeft, &bottomRight);
   std::vector<std::string> qids;
-  Status s = searchQuadIds(pos, radius, &qids);
+  Status s = searchQuadIds(topLeft, bottomRight, &qids);
   if (!s.ok()) {
     return s;
   }
@@ -174,7 +269,7 @@ Status GeoDBImpl::SearchRadial(const GeoPosition& pos,
   Iterator* iter = db_->NewIterator(ReadOptions());
 
   // Process each prospective quadkey
-  for (std::string qid : qids) {
+  for (const std::string& qid : qids) {
     // The user is interested in only these many objects.
     if (number_of_values == 0) {
       break;
@@ -186,29 +281,37 @@ Status GeoDBImpl::SearchRadial(const GeoPosition& pos,
     for (iter->Seek(dbkey);
          number_of_values > 0 && iter->Valid() && iter->status().ok();
          iter->Next()) {
-      // split the key into p + quadkey + id + lat + lon
+      // The keys of all the objects inside the tile start with its
+      // quadkey
       Slice key = iter->key();
+      if (!key.starts_with(dbkey)) {
+        break;
+      }
+
+      // split the key into p + quadkey + id + lat + lon
       std::vector<std::string> parts = StringSplit(key.ToString(), ':');
       assert(parts.size() == 5);
       assert(parts[0] == "p");
-      std::string* quadkey = &parts[1];
-
-      // If the key we are looking for is a prefix of the key
-      // we found from the database, then this is one of the keys
-      // we are looking for.
-      auto res = std::mismatch(qid.begin(), qid.end(), quadkey->begin());
-      if (res.first == qid.end()) {
-        GeoPosition obj_pos(atof(parts[3].c_str()), atof(parts[4].c_str()));
-        GeoObject obj(obj_pos, parts[4], iter->value().ToString());
-        values->push_back(obj);
-        number_of_values--;
-      } else {
-        break;
+      GeoPosition obj_pos(atof(parts[3].c_str()), atof(parts[4].c_str()));
+
+      // The tiles stick out of the bounding box, which is cheaper to
+      // check than the exact distance
+      if (obj_pos.latitude < topLeft.latitude ||
+          obj_pos.latitude > bottomRight.latitude ||
+          obj_pos.longitude < topLeft.longitude ||
+          obj_pos.longitude > bottomRight.longitude ||
+          distance(pos.latitude, pos.longitude, obj_pos.latitude,
+                   obj_pos.longitude) > radius) {
+        continue;
       }
+      GeoObject obj(obj_pos, parts[2], iter->value().ToString());
+      values->push_back(obj);
+      number_of_values--;
     }
   }
+  s = iter->status();
   delete iter;
-  return Status::OK();
+  return s;
 }
 
 std::string GeoDBImpl::MakeKey1(const GeoPosition& pos, Slice id,
@@ -236,10 +339,13 @@ std::string GeoDBImpl::MakeKey2(Slice id) {
 std::string GeoDBImpl::MakeKey1Prefix(std::string quadkey,
                                       Slice id) {
   std::string key = "p:";
-  key.reserve(3 + quadkey.size() + id.size());
+  key.reserve(4 + quadkey.size() + id.size());
   key.append(quadkey);
   key.append(":");
   key.append(id.ToString());
+  // Without the delimiter, the keys of longer ids starting with this id
+  // could sort first
+  key.append(":");
   return key;
 }
 
@@ -267,12 +373,22 @@ std::string GeoDBImpl::PositionToQuad(const GeoPosition& pos,
   return TileToQuadKey(tile, levelOfDetail);
 }
 
-GeoPosition GeoDBImpl::displaceLatLon(double lat, double lon,
-                                      double deltay, double deltax) {
-  double dLat = deltay / EarthRadius;
-  double dLon = deltax / (EarthRadius * cos(radians(lat)));
-  return GeoPosition(lat + degrees(dLat),
-                     lon + degrees(dLon));
+void GeoDBImpl::boundingBox(const GeoPosition& in, double radius,
+                            GeoPosition* topLeft, GeoPosition* bottomRight) {
+  double dLat = degrees(radius / EarthRadius);
+  topLeft->latitude = in.latitude - dLat;
+  bottomRight->latitude = in.latitude + dLat;
+
+  // A position within the radius is at most dLon away at the latitude of
+  // the box closest to a pole. The box covers all longitudes if it
+  // includes a pole.
+  double widest = fmax(fabs(topLeft->latitude), fabs(bottomRight->latitude));
+  double dLon = 360;
+  if (widest < 90) {
+    dLon = fmin(dLon, degrees(radius / (EarthRadius * cos(radians(widest)))));
+  }
+  topLeft->longitude = in.longitude - dLon;
+  bottomRight->longitude = in.longitude + dLon;
 }
 
 //
@@ -293,21 +409,23 @@ double GeoDBImpl::distance(double lat1, double lon1,
 //
 // Returns all the quadkeys inside the search range
 //
-Status GeoDBImpl::searchQuadIds(const GeoPosition& position,
-                                double radius,
+Status GeoDBImpl::searchQuadIds(const GeoPosition& topLeftPos,
+                                const GeoPosition& bottomRightPos,
                                 std::vector<std::string>* quadKeys) {
-  // get the outline of the search square
-  GeoPosition topLeftPos = boundingTopLeft(position, radius);
-  GeoPosition bottomRightPos = boundingBottomRight(position, radius);
-
   Pixel topLeft =  PositionToPixel(topLeftPos, Detail);
   Pixel bottomRight =  PositionToPixel(bottomRightPos, Detail);
 
-  // how many level of details to look for
-  int numberOfTilesAtMaxDepth = floor((bottomRight.x - topLeft.x) / 256);
-  int zoomLevelsToRise = floor(::log(numberOfTilesAtMaxDepth) / ::log(2));
-  zoomLevelsToRise++;
-  int levels = std::max(0, Detail - zoomLevelsToRise);
+  // how many level of details to look for: rise until a tile, which is
+  // 256 pixels wide at its own level, spans the box in both directions
+  unsigned int width = bottomRight.x > topLeft.x ?
+                       bottomRight.x - topLeft.x : topLeft.x - bottomRight.x;
+  unsigned int height = bottomRight.y > topLeft.y ?
+                        bottomRight.y - topLeft.y : topLeft.y - bottomRight.y;
+  unsigned int extent = std::max(width, height);
+  int levels = Detail;
+  while (levels > 0 && (256U << (Detail - levels)) < extent) {
+    levels--;
+  }
 
   quadKeys->push_back(PositionToQuad(GeoPosition(topLeftPos.latitude,
                                                  topLeftPos.longitude),
@@ -321,6 +439,11 @@ Status GeoDBImpl::searchQuadIds(const GeoPosition& position,
   quadKeys->push_back(PositionToQuad(GeoPosition(bottomRightPos.latitude,
                                                  bottomRightPos.longitude),
                                      levels));
+
+  // Small boxes often fit in fewer tiles
+  std::sort(quadKeys->begin(), quadKeys->end());
+  quadKeys->erase(std::unique(quadKeys->begin(), quadKeys->end()),
+                  quadKeys->end());
   return Status::OK();
 }
 
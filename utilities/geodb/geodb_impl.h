@@ -12,6 +12,7 @@
 #include <string>
 #include <sstream>
 #include <stdexcept>
+#include <utility>
 #include <vector>
 
 #include "rocksdb/utilities/geo_db.h"
@@ -32,6 +33,10 @@ class GeoDBImpl : public GeoDB {
   // is a blob that is associated with this object.
   virtual Status Insert(const GeoObject& object) override;
 
+  // Insert many objects at once, loading them from a sorted table file
+  // when the db is still empty.
+  virtual Status BulkInsert(const std::vector<GeoObject>& objects) override;
+
   // Retrieve the value of the object located at the specified GPS
   // location and is identified by the 'id'.
   virtual Status GetByPosition(const GeoPosition& pos, const Slice& id,
@@ -45,7 +50,8 @@ class GeoDBImpl : public GeoDB {
   virtual Status Remove(const Slice& id) override;
 
   // Returns a list of all items within a circular radius from the
-  // specified gps location
+  // specified gps location. Candidates outside of the bounding box of the
+  // circle are skipped before their exact distance is computed.
   virtual Status SearchRadial(const GeoPosition& pos, double radius,
                               std::vector<GeoObject>* values,
                               int number_of_values) override;
@@ -56,6 +62,19 @@ class GeoDBImpl : public GeoDB {
   const WriteOptions woptions_;
   const ReadOptions roptions_;
 
+  // Number of objects per write batch when BulkInsert() cannot load a
+  // table file.
+  static const size_t kBulkInsertBatchSize = 1000;
+
+  // Add the deletion of the previous location of obj.id, if any, and the
+  // keys of obj to the batch
+  Status AddToBatch(const GeoObject& obj, WriteBatch* batch);
+
+  // Write the sorted key-values to a table file and add it to the db.
+  // Returns NotSupported if the db does not accept the file.
+  Status AddSortedFile(
+      const std::vector<std::pair<std::string, std::string>>& kvs);
+
   // MSVC requires the definition for this static const to be in .CC file
   // The value of PI
   static const double PI;
@@ -143,30 +162,22 @@ class GeoDBImpl : public GeoDB {
   // Return the distance between two positions on the earth
   static double distance(double lat1, double lon1,
                          double lat2, double lon2);
-  static GeoPosition displaceLatLon(double lat, double lon,
-                                    double deltay, double deltax);
 
   //
-  // Returns the top left position after applying the delta to
-  // the specified position
+  // Returns the bounding box of all positions within a radius of the
+  // specified position. The longitude span is computed at the latitude of
+  // the box closest to a pole, where it is the widest.
   //
-  static GeoPosition boundingTopLeft(const GeoPosition& in, double radius) {
-    return displaceLatLon(in.latitude, in.longitude, -radius, -radius);
-  }
-
-  //
-  // Returns the bottom right position after applying the delta to
-  // the specified position
-  static GeoPosition boundingBottomRight(const GeoPosition& in,
-                                         double radius) {
-    return displaceLatLon(in.latitude, in.longitude, radius, radius);
-  }
+  static void boundingBox(const GeoPosition& in, double radius,
+                          GeoPosition* topLeft, GeoPosition* bottomRight);
 
   //
-  // Get all quadkeys within a radius of a specified position
+  // Get the quadkeys of the tiles covering a bounding box. Their level is
+  // the deepest one whose tiles are at least as large as the box, so that
+  // the box overlaps at most 2x2 of them.
   //
-  Status searchQuadIds(const GeoPosition& position,
-                       double radius,
+  Status searchQuadIds(const GeoPosition& topLeft,
+                       const GeoPosition& bottomRight,
                        std::vector<std::string>* quadKeys);
 
   //
@@ -7,6 +7,9 @@
 #include "utilities/geodb/geodb_impl.h"
 
 #include <cctype>
+#include <cmath>
+#include <set>
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 namespace rocksdb {
@@ -116,6 +119,96 @@ TEST_F(GeoDBTest, Search) {
   ASSERT_EQ(values.size(), 0U);
 }
 
+// SearchRadial() returns exactly the objects of a grid that are within the
+// radius, whatever quadkey level the radius maps to
+TEST_F(GeoDBTest, SearchMatchesDistance) {
+  std::vector<GeoObject> objects;
+  for (int i = 0; i < 40; i++) {
+    for (int j = 0; j < 40; j++) {
+      GeoPosition pos(44 + i * 0.05, 44 + j * 0.05);
+      objects.emplace_back(pos, "id" + ToString(i * 40 + j), "value");
+      ASSERT_OK(getdb()->Insert(objects.back()));
+    }
+  }
+
+  const double kEarthRadius = 6378137;
+  GeoPosition center(45.01, 44.98);
+  for (double radius : {10.0, 3000.0, 20000.0, 75000.0, 500000.0}) {
+    std::set<std::string> expected;
+    for (const auto& obj : objects) {
+      // haversine distance
+      double lat1 = center.latitude * M_PI / 180;
+      double lat2 = obj.position.latitude * M_PI / 180;
+      double dlat = lat2 - lat1;
+      double dlon = (obj.position.longitude - center.longitude) * M_PI / 180;
+      double a = sin(dlat / 2) * sin(dlat / 2) +
+                 cos(lat1) * cos(lat2) * sin(dlon / 2) * sin(dlon / 2);
+      if (2 * atan2(sqrt(a), sqrt(1 - a)) * kEarthRadius <= radius) {
+        expected.insert(obj.id);
+      }
+    }
+
+    std::vector<GeoObject> values;
+    ASSERT_OK(getdb()->SearchRadial(center, radius, &values));
+    std::set<std::string> found;
+    for (const auto& obj : values) {
+      ASSERT_TRUE(found.insert(obj.id).second) << "duplicate " << obj.id;
+      GeoObject stored;
+      ASSERT_OK(getdb()->GetById(obj.id, &stored));
+      ASSERT_EQ(stored.position.latitude, obj.position.latitude);
+      ASSERT_EQ(stored.position.longitude, obj.position.longitude);
+    }
+    ASSERT_TRUE(expected == found) << radius;
+  }
+}
+
+TEST_F(GeoDBTest, BulkInsert) {
+  std::vector<GeoObject> objects;
+  for (int i = 0; i < 500; i++) {
+    GeoPosition pos(40 + (i * 7919 % 100) * 0.1, -70 - (i % 50) * 0.1);
+    objects.emplace_back(pos, "id" + ToString(i), "value" + ToString(i));
+  }
+  // The last object of an id wins
+  objects.emplace_back(GeoPosition(10, 10), "id0", "moved");
+
+  // An empty db loads the objects from a table file without writing them
+  ASSERT_OK(getdb()->BulkInsert(objects));
+  ASSERT_EQ(0U, getdb()->GetLatestSequenceNumber());
+  GeoObject obj;
+  for (int i = 1; i < 500; i++) {
+    ASSERT_OK(getdb()->GetById("id" + ToString(i), &obj));
+    ASSERT_EQ(objects[i].position.latitude, obj.position.latitude);
+    ASSERT_EQ(objects[i].position.longitude, obj.position.longitude);
+    ASSERT_EQ(objects[i].value, obj.value);
+  }
+  ASSERT_OK(getdb()->GetById("id0", &obj));
+  ASSERT_EQ("moved", obj.value);
+  std::string value;
+  ASSERT_TRUE(getdb()->GetByPosition(objects[0].position, "id0", &value)
+                  .IsNotFound());
+  std::vector<GeoObject> values;
+  ASSERT_OK(getdb()->SearchRadial(GeoPosition(10, 10), 1000, &values));
+  ASSERT_EQ(1U, values.size());
+  ASSERT_EQ("id0", values[0].id);
+
+  // Loading into a db holding objects moves the existing ones
+  objects.clear();
+  for (int i = 0; i < 2500; i++) {
+    objects.emplace_back(GeoPosition(-30 + (i % 60) * 0.1, 150),
+                         "id" + ToString(i), "second" + ToString(i));
+  }
+  ASSERT_OK(getdb()->BulkInsert(objects));
+  ASSERT_GT(getdb()->GetLatestSequenceNumber(), 0U);
+  for (int i = 0; i < 2500; i++) {
+    ASSERT_OK(getdb()->GetById("id" + ToString(i), &obj));
+    ASSERT_EQ(objects[i].position.latitude, obj.position.latitude);
+    ASSERT_EQ("second" + ToString(i), obj.value);
+  }
+  values.clear();
+  ASSERT_OK(getdb()->SearchRadial(GeoPosition(45, -72), 1000000, &values));
+  ASSERT_EQ(0U, values.size());
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char* argv[]) {
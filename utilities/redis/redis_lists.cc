@@ -5,18 +5,21 @@
  *
  * @throws All functions may throw a RedisListException on error/corruption.
  *
- * @notes Internally, the set of lists is stored in a rocksdb database,
- *        mapping keys to values. Each "value" is the list itself, storing
- *        some kind of internal representation of the data. All the
- *        representation details are handled by the RedisListIterator class.
- *        The present file should be oblivious to the representation details,
- *        handling only the client (Redis) API, and the calls to rocksdb.
+ * @notes Internally, the set of lists is stored in a rocksdb database.
+ *        Every list is split into segments of up to kSegmentSize
+ *        consecutive elements, each stored under its own key, plus a small
+ *        metadata entry with the positions of the first and one past the
+ *        last element. The representation of a segment is handled by the
+ *        RedisListIterator class.
  *
- * @TODO  Presently, all operations take at least O(NV) time where
- *        N is the number of elements in the list, and V is the average
- *        number of bytes per value in the list. So maybe, with merge operator
- *        we can improve this to an optimal O(V) amortized time, since we
- *        wouldn't have to read and re-write the entire list.
+ *        Pushes and pops only touch the metadata and the segment at the
+ *        head or tail of the list, which they update with a merge operand,
+ *        so they take O(V) time where V is the number of bytes of the value.
+ *        Index, Range and Set only read the segments they need.
+ *
+ * @TODO  Insert and Remove still take O(NV) time where N is the number of
+ *        elements in the list, since they shift the positions of the
+ *        elements after the one they insert or remove.
  *
  * @author Deon Nicholas (dnicholas@fb.com)
  */
@@ -24,16 +27,145 @@
 #ifndef ROCKSDB_LITE
 #include "redis_lists.h"
 
+#include <algorithm>
+#include <deque>
 #include <iostream>
 #include <memory>
 #include <cmath>
 
+#include "rocksdb/env.h"
+#include "rocksdb/merge_operator.h"
 #include "rocksdb/slice.h"
 #include "util/coding.h"
 
 namespace rocksdb
 {
 
+namespace {
+
+// The keys of a list: a metadata key, and segment keys that sort by segment
+// number after the length-prefixed list key.
+const char kMetaKeyPrefix = 'm';
+const char kSegmentKeyPrefix = 's';
+
+// Maximum number of elements per segment
+const uint64_t kSegmentSize = 128;
+
+// Position of the first element pushed onto an empty list. Leaves room for
+// pushing to the left.
+const uint64_t kInitialPosition = 1ull << 63;
+
+// Merge operands of a segment. Pushes are followed by the element.
+const char kAppendOp = 'R';
+const char kPrependOp = 'L';
+const char kDropLastOp = 'r';
+const char kDropFirstOp = 'l';
+
+std::string MetaKey(const std::string& key) {
+  std::string result;
+  result.reserve(key.size() + 1);
+  result.push_back(kMetaKeyPrefix);
+  result.append(key);
+  return result;
+}
+
+std::string SegmentKey(const std::string& key, uint64_t segment) {
+  std::string result;
+  result.push_back(kSegmentKeyPrefix);
+  PutLengthPrefixedSlice(&result, key);
+  // Big endian, so that the segments are sorted
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    result.push_back(static_cast<char>((segment >> shift) & 0xff));
+  }
+  return result;
+}
+
+std::string MergeOperand(char op, const std::string& value = "") {
+  std::string result;
+  result.reserve(value.size() + 1);
+  result.push_back(op);
+  result.append(value);
+  return result;
+}
+
+// Append the elements of a segment to *elements. They point into data.
+template <class Container>
+void DecodeSegment(const std::string& data, Container* elements) {
+  Slice elem;
+  for (RedisListIterator it(data); !it.Done(); it.Skip()) {
+    it.GetCurrent(&elem);
+    elements->push_back(elem);
+  }
+}
+
+template <class Iter>
+std::string EncodeSegment(Iter begin, Iter end) {
+  const std::string empty;
+  RedisListIterator it(empty);
+  for (; begin != end; ++begin) {
+    it.InsertElement(*begin);
+  }
+  return it.WriteResult().ToString();
+}
+
+// Applies the pushes and pops of the list to a segment
+class SegmentMergeOperator : public MergeOperator {
+ public:
+  virtual bool FullMerge(const Slice& key, const Slice* existing_value,
+                         const std::deque<std::string>& operand_list,
+                         std::string* new_value,
+                         Logger* logger) const override {
+    try {
+      std::string existing;
+      if (existing_value != nullptr) {
+        existing = existing_value->ToString();
+      }
+      std::deque<Slice> elements;
+      DecodeSegment(existing, &elements);
+      for (const std::string& operand : operand_list) {
+        if (operand.empty()) {
+          return false;
+        }
+        Slice elem(operand.data() + 1, operand.size() - 1);
+        switch (operand[0]) {
+          case kAppendOp:
+            elements.push_back(elem);
+            break;
+          case kPrependOp:
+            elements.push_front(elem);
+            break;
+          case kDropLastOp:
+            if (elements.empty()) {
+              return false;
+            }
+            elements.pop_back();
+            break;
+          case kDropFirstOp:
+            if (elements.empty()) {
+              return false;
+            }
+            elements.pop_front();
+            break;
+          default:
+            return false;
+        }
+      }
+      *new_value = EncodeSegment(elements.begin(), elements.end());
+      return true;
+    } catch (const RedisListException&) {
+      Log(InfoLogLevel::ERROR_LEVEL, logger,
+          "Corrupt segment of a Redis list");
+      return false;
+    }
+  }
+
+  virtual const char* Name() const override {
+    return "RedisListSegmentMergeOperator";
+  }
+};
+
+}  // namespace
+
 /// Constructors
 
 RedisLists::RedisLists(const std::string& db_path,
@@ -49,6 +181,9 @@ RedisLists::RedisLists(const std::string& db_path,
     DestroyDB(db_name_, Options());
   }
 
+  // Pushes and pops are merged into the segments
+  options.merge_operator = std::make_shared<SegmentMergeOperator>();
+
   // Now open and deal with the db
   DB* db;
   Status s = DB::Open(options, db_name_, &db);
@@ -66,13 +201,7 @@ RedisLists::RedisLists(const std::string& db_path,
 // Number of elements in the list associated with key
 //   : throws RedisListException
 int RedisLists::Length(const std::string& key) {
-  // Extract the string data representing the list.
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Return the length
-  RedisListIterator it(data);
-  return it.Length();
+  return GetMeta(key).Length();
 }
 
 // Get the element at the specified index in the (list: key)
@@ -80,35 +209,23 @@ int RedisLists::Length(const std::string& key) {
 //   : throws RedisListException
 bool RedisLists::Index(const std::string& key, int32_t index,
                        std::string* result) {
-  // Extract the string data representing the list.
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
 
-  // Handle REDIS negative indices (from the end); fast iff Length() takes O(1)
+  // Handle REDIS negative indices (from the end)
   if (index < 0) {
-    index = Length(key) - (-index);  //replace (-i) with (N-i).
+    index = meta.Length() - (-index);  //replace (-i) with (N-i).
   }
-
-  // Iterate through the list until the desired index is found.
-  int curIndex = 0;
-  RedisListIterator it(data);
-  while(curIndex < index && !it.Done()) {
-    ++curIndex;
-    it.Skip();
+  if (index < 0 || index >= meta.Length()) {
+    return false;
   }
 
-  // If we actually found the index
-  if (curIndex == index && !it.Done()) {
-    Slice elem;
-    it.GetCurrent(&elem);
-    if (result != NULL) {
-      *result = elem.ToString();
-    }
-
-    return true;
-  } else {
-    return false;
+  // Read the segment holding the element
+  std::vector<std::string> elements;
+  ReadElements(key, meta, index, index, &elements);
+  if (result != NULL) {
+    *result = elements[0];
   }
+  return true;
 }
 
 // Return a truncated version of the list.
@@ -118,12 +235,10 @@ bool RedisLists::Index(const std::string& key, int32_t index,
 //   : throws RedisListException
 std::vector<std::string> RedisLists::Range(const std::string& key,
                                            int32_t first, int32_t last) {
-  // Extract the string data representing the list.
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
 
   // Handle negative bounds (-1 means last element, etc.)
-  int listLen = Length(key);
+  int listLen = meta.Length();
   if (first < 0) {
     first = listLen - (-first);           // Replace (-x) with (N-x)
   }
@@ -134,55 +249,28 @@ std::vector<std::string> RedisLists::Range(const std::string& key,
   // Verify bounds (and truncate the range so that it is valid)
   first = std::max(first, 0);
   last = std::min(last, listLen-1);
-  int len = std::max(last-first+1, 0);
-
-  // Initialize the resulting list
-  std::vector<std::string> result(len);
 
-  // Traverse the list and update the vector
-  int curIdx = 0;
-  Slice elem;
-  for (RedisListIterator it(data); !it.Done() && curIdx<=last; it.Skip()) {
-    if (first <= curIdx && curIdx <= last) {
-      it.GetCurrent(&elem);
-      result[curIdx-first].assign(elem.data(),elem.size());
-    }
-
-    ++curIdx;
+  // Read the segments holding the range. Might be empty
+  std::vector<std::string> result;
+  if (first <= last) {
+    result.reserve(last - first + 1);
+    ReadElements(key, meta, first, last, &result);
   }
-
-  // Return the result. Might be empty
   return result;
 }
 
 // Print the (list: key) out to stdout. For debugging mostly. Public for now.
 void RedisLists::Print(const std::string& key) {
-  // Extract the string data representing the list.
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
   // Iterate through the list and print the items
-  Slice elem;
-  for (RedisListIterator it(data); !it.Done(); it.Skip()) {
-    it.GetCurrent(&elem);
-    std::cout << "ITEM " << elem.ToString() << std::endl;
-  }
-
-  //Now print the byte data
-  RedisListIterator it(data);
-  std::cout << "==Printing data==" << std::endl;
-  std::cout << data.size() << std::endl;
-  std::cout << it.Size() << " " << it.Length() << std::endl;
-  Slice result = it.WriteResult();
-  std::cout << result.data() << std::endl;
-  if (true) {
-    std::cout << "size: " << result.size() << std::endl;
-    const char* val = result.data();
-    for(int i=0; i<(int)result.size(); ++i) {
-      std::cout << (int)val[i] << " " << (val[i]>=32?val[i]:' ') << std::endl;
-    }
-    std::cout << std::endl;
+  for (const std::string& elem : Range(key, 0, -1)) {
+    std::cout << "ITEM " << elem << std::endl;
   }
+
+  // Now print the metadata
+  ListMeta meta = GetMeta(key);
+  std::cout << "==Printing metadata==" << std::endl;
+  std::cout << "head: " << meta.head << " tail: " << meta.tail
+            << " length: " << meta.Length() << std::endl;
 }
 
 /// Insert/Update Functions
@@ -202,77 +290,68 @@ int RedisLists::InsertAfter(const std::string& key, const std::string& pivot,
 // Prepend value onto beginning of (list: key)
 //   : throws RedisListException
 int RedisLists::PushLeft(const std::string& key, const std::string& value) {
-  // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Construct the result
-  RedisListIterator it(data);
-  it.Reserve(it.Size() + it.SizeOf(value));
-  it.InsertElement(value);
-
-  // Push the data back to the db and return the length
-  db_->Put(put_option_, key, it.WriteResult());
-  return it.Length();
+  ListMeta meta = GetMeta(key);
+  --meta.head;
+
+  // Prepend the element to the segment of the new head
+  WriteBatch batch;
+  batch.Merge(SegmentKey(key, meta.head / kSegmentSize),
+              MergeOperand(kPrependOp, value));
+  PutMeta(key, meta, &batch);
+  db_->Write(put_option_, &batch);
+  return meta.Length();
 }
 
 // Append value onto end of (list: key)
-// TODO: Make this O(1) time. Might require MergeOperator.
 //   : throws RedisListException
 int RedisLists::PushRight(const std::string& key, const std::string& value) {
-  // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Create an iterator to the data and seek to the end.
-  RedisListIterator it(data);
-  it.Reserve(it.Size() + it.SizeOf(value));
-  while (!it.Done()) {
-    it.Push();    // Write each element as we go
-  }
-
-  // Insert the new element at the current position (the end)
-  it.InsertElement(value);
-
-  // Push it back to the db, and return length
-  db_->Put(put_option_, key, it.WriteResult());
-  return it.Length();
+  ListMeta meta = GetMeta(key);
+
+  // Append the element to the segment of the old tail
+  WriteBatch batch;
+  batch.Merge(SegmentKey(key, meta.tail / kSegmentSize),
+              MergeOperand(kAppendOp, value));
+  ++meta.tail;
+  PutMeta(key, meta, &batch);
+  db_->Write(put_option_, &batch);
+  return meta.Length();
 }
 
 // Set (list: key)[idx] = val. Return true on success, false on fail.
 //   : throws RedisListException
 bool RedisLists::Set(const std::string& key, int32_t index,
                      const std::string& value) {
-  // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
 
   // Handle negative index for REDIS (meaning -index from end of list)
   if (index < 0) {
-    index = Length(key) - (-index);
+    index = meta.Length() - (-index);
   }
 
-  // Iterate through the list until we find the element we want
-  int curIndex = 0;
-  RedisListIterator it(data);
-  it.Reserve(it.Size() + it.SizeOf(value));  // Over-estimate is fine
-  while(curIndex < index && !it.Done()) {
-    it.Push();
-    ++curIndex;
-  }
-
-  // If not found, return false (this occurs when index was invalid)
-  if (it.Done() || curIndex != index) {
+  // Return false when index was invalid
+  if (index < 0 || index >= meta.Length()) {
     return false;
   }
 
-  // Write the new element value, and drop the previous element value
-  it.InsertElement(value);
-  it.Skip();
+  // Only rewrite the segment holding the element
+  const uint64_t position = meta.head + index;
+  const uint64_t segment = position / kSegmentSize;
+  std::string data;
+  if (!db_->Get(get_option_, SegmentKey(key, segment), &data).ok()) {
+    throw RedisListException();
+  }
+  std::vector<Slice> elements;
+  DecodeSegment(data, &elements);
+  const uint64_t offset =
+      position - std::max(segment * kSegmentSize, meta.head);
+  if (offset >= elements.size()) {
+    throw RedisListException();
+  }
+  elements[offset] = value;
 
-  // Write the data to the database
   // Check status, since it needs to return true/false guarantee
-  Status s = db_->Put(put_option_, key, it.WriteResult());
+  Status s = db_->Put(put_option_, SegmentKey(key, segment),
+                      EncodeSegment(elements.begin(), elements.end()));
 
   // Success
   return s.ok();
@@ -285,12 +364,10 @@ bool RedisLists::Set(const std::string& key, int32_t index,
 //  or the portion of the list that fits in this interval
 //   : throws RedisListException
 bool RedisLists::Trim(const std::string& key, int32_t start, int32_t stop) {
-  // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
 
   // Handle negative indices in REDIS
-  int listLen = Length(key);
+  int listLen = meta.Length();
   if (start < 0) {
     start = listLen - (-start);
   }
@@ -302,98 +379,110 @@ bool RedisLists::Trim(const std::string& key, int32_t start, int32_t stop) {
   start = std::max(start, 0);
   stop = std::min(stop, listLen-1);
 
-  // Construct an iterator for the list. Drop all undesired elements.
-  int curIndex = 0;
-  RedisListIterator it(data);
-  it.Reserve(it.Size());          // Over-estimate
-  while(!it.Done()) {
-    // If not within the range, just skip the item (drop it).
-    // Otherwise, continue as usual.
-    if (start <= curIndex && curIndex <= stop) {
-      it.Push();
-    } else {
-      it.Skip();
-    }
-
-    // Increment the current index
-    ++curIndex;
+  ListMeta new_meta = meta;
+  if (start <= stop) {
+    new_meta.head = meta.head + start;
+    new_meta.tail = meta.head + stop + 1;
+  } else {
+    new_meta.head = new_meta.tail;
   }
 
-  // Write the (possibly empty) result to the database
-  Status s = db_->Put(put_option_, key, it.WriteResult());
+  // Drop the segments outside of the new bounds, and the dropped elements of
+  // the segments at the bounds.
+  WriteBatch batch;
+  if (meta.head < meta.tail) {
+    const uint64_t last_segment = (meta.tail - 1) / kSegmentSize;
+    for (uint64_t segment = meta.head / kSegmentSize;
+         segment <= last_segment; ++segment) {
+      const uint64_t first = std::max(segment * kSegmentSize, meta.head);
+      const uint64_t end = std::min((segment + 1) * kSegmentSize, meta.tail);
+      const uint64_t keep_first = std::max(first, new_meta.head);
+      const uint64_t keep_end = std::min(end, new_meta.tail);
+      if (keep_first >= keep_end) {
+        batch.Delete(SegmentKey(key, segment));
+      } else if (keep_first != first || keep_end != end) {
+        std::string data;
+        if (!db_->Get(get_option_, SegmentKey(key, segment), &data).ok()) {
+          throw RedisListException();
+        }
+        std::vector<Slice> elements;
+        DecodeSegment(data, &elements);
+        if (elements.size() != end - first) {
+          throw RedisListException();
+        }
+        batch.Put(SegmentKey(key, segment),
+                  EncodeSegment(elements.begin() + (keep_first - first),
+                                elements.begin() + (keep_end - first)));
+      }
+    }
+  }
+  PutMeta(key, new_meta, &batch);
 
   // Return true as long as the write succeeded
+  Status s = db_->Write(put_option_, &batch);
   return s.ok();
 }
 
 // Return and remove the first element in the list (or "" if empty)
 //   : throws RedisListException
 bool RedisLists::PopLeft(const std::string& key, std::string* result) {
-  // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Point to first element in the list (if it exists), and get its value/size
-  RedisListIterator it(data);
-  if (it.Length() > 0) {            // Proceed only if list is non-empty
-    Slice elem;
-    it.GetCurrent(&elem);           // Store the value of the first element
-    it.Reserve(it.Size() - it.SizeOf(elem));
-    it.Skip();                      // DROP the first item and move to next
-
-    // Update the db
-    db_->Put(put_option_, key, it.WriteResult());
-
-    // Return the value
-    if (result != NULL) {
-      *result = elem.ToString();
-    }
-    return true;
-  } else {
+  ListMeta meta = GetMeta(key);
+  if (meta.Length() == 0) {
     return false;
   }
+
+  // Store the value of the first element
+  std::vector<std::string> elements;
+  ReadElements(key, meta, 0, 0, &elements);
+
+  // Drop it from its segment, or drop the segment if it was the last element
+  const uint64_t segment = meta.head / kSegmentSize;
+  ++meta.head;
+  WriteBatch batch;
+  if (meta.head == meta.tail || meta.head % kSegmentSize == 0) {
+    batch.Delete(SegmentKey(key, segment));
+  } else {
+    batch.Merge(SegmentKey(key, segment), MergeOperand(kDropFirstOp));
+  }
+  PutMeta(key, meta, &batch);
+  db_->Write(put_option_, &batch);
+
+  // Return the value
+  if (result != NULL) {
+    *result = elements[0];
+  }
+  return true;
 }
 
 // Remove and return the last element in the list (or "" if empty)
-// TODO: Make this O(1). Might require MergeOperator.
 //   : throws RedisListException
 bool RedisLists::PopRight(const std::string& key, std::string* result) {
-  // Extract the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Construct an iterator to the data and move to last element
-  RedisListIterator it(data);
-  it.Reserve(it.Size());
-  int len = it.Length();
-  int curIndex = 0;
-  while(curIndex < (len-1) && !it.Done()) {
-    it.Push();
-    ++curIndex;
+  ListMeta meta = GetMeta(key);
+  if (meta.Length() == 0) {
+    return false;
   }
 
-  // Extract and drop/skip the last element
-  if (curIndex == len-1) {
-    assert(!it.Done());         // Sanity check. Should not have ended here.
+  // Store the value of the last element
+  std::vector<std::string> elements;
+  ReadElements(key, meta, meta.Length() - 1, meta.Length() - 1, &elements);
 
-    // Extract and pop the element
-    Slice elem;
-    it.GetCurrent(&elem);       // Save value of element.
-    it.Skip();                  // Skip the element
-
-    // Write the result to the database
-    db_->Put(put_option_, key, it.WriteResult());
-
-    // Return the value
-    if (result != NULL) {
-      *result = elem.ToString();
-    }
-    return true;
+  // Drop it from its segment, or drop the segment if it was the last element
+  const uint64_t segment = (meta.tail - 1) / kSegmentSize;
+  --meta.tail;
+  WriteBatch batch;
+  if (meta.tail == meta.head || meta.tail % kSegmentSize == 0) {
+    batch.Delete(SegmentKey(key, segment));
   } else {
-    // Must have been an empty list
-    assert(it.Done() && len==0 && curIndex == 0);
-    return false;
+    batch.Merge(SegmentKey(key, segment), MergeOperand(kDropLastOp));
   }
+  PutMeta(key, meta, &batch);
+  db_->Write(put_option_, &batch);
+
+  // Return the value
+  if (result != NULL) {
+    *result = elements[0];
+  }
+  return true;
 }
 
 // Remove the (first or last) "num" occurrences of value in (list: key)
@@ -418,29 +507,26 @@ int RedisLists::RemoveFirst(const std::string& key, int32_t num,
   assert(num >= 0);
 
   // Extract the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
+  std::vector<std::string> elements;
+  ReadElements(key, meta, 0, meta.Length() - 1, &elements);
 
-  // Traverse the list, appending all but the desired occurrences of value
+  // Keep all but the desired occurrences of value
   int numSkipped = 0;         // Keep track of the number of times value is seen
-  Slice elem;
-  RedisListIterator it(data);
-  it.Reserve(it.Size());
-  while (!it.Done()) {
-    it.GetCurrent(&elem);
-
+  std::vector<std::string> result;
+  result.reserve(elements.size());
+  for (std::string& elem : elements) {
     if (elem == value && numSkipped < num) {
-      // Drop this item if desired
-      it.Skip();
       ++numSkipped;
     } else {
-      // Otherwise keep the item and proceed as normal
-      it.Push();
+      result.push_back(std::move(elem));
     }
   }
 
   // Put the result back to the database
-  db_->Put(put_option_, key, it.WriteResult());
+  if (numSkipped > 0) {
+    WriteList(key, meta, result);
+  }
 
   // Return the number of elements removed
   return numSkipped;
@@ -448,7 +534,6 @@ int RedisLists::RemoveFirst(const std::string& key, int32_t num,
 
 
 // Remove the last "num" occurrences of value in (list: key).
-// TODO: I traverse the list 2x. Make faster. Might require MergeOperator.
 //   : throws RedisListException
 int RedisLists::RemoveLast(const std::string& key, int32_t num,
                            const std::string& value) {
@@ -456,50 +541,36 @@ int RedisLists::RemoveLast(const std::string& key, int32_t num,
   assert(num >= 0);
 
   // Extract the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
-
-  // Temporary variable to hold the "current element" in the blocks below
-  Slice elem;
+  ListMeta meta = GetMeta(key);
+  std::vector<std::string> elements;
+  ReadElements(key, meta, 0, meta.Length() - 1, &elements);
 
   // Count the total number of occurrences of value
-  int totalOccs = 0;
-  for (RedisListIterator it(data); !it.Done(); it.Skip()) {
-    it.GetCurrent(&elem);
-    if (elem == value) {
-      ++totalOccs;
-    }
-  }
-
-  // Construct an iterator to the data. Reserve enough space for the result.
-  RedisListIterator it(data);
-  int bytesRemoved = std::min(num,totalOccs)*it.SizeOf(value);
-  it.Reserve(it.Size() - bytesRemoved);
+  int totalOccs = static_cast<int>(
+      std::count(elements.begin(), elements.end(), value));
 
-  // Traverse the list, appending all but the desired occurrences of value.
+  // Keep all but the desired occurrences of value.
   // Note: "Drop the last k occurrences" is equivalent to
   //  "keep only the first n-k occurrences", where n is total occurrences.
   int numKept = 0;          // Keep track of the number of times value is kept
-  while(!it.Done()) {
-    it.GetCurrent(&elem);
-
-    // If we are within the deletion range and equal to value, drop it.
-    // Otherwise, append/keep/push it.
+  std::vector<std::string> result;
+  result.reserve(elements.size());
+  for (std::string& elem : elements) {
     if (elem == value) {
       if (numKept < totalOccs - num) {
-        it.Push();
+        result.push_back(std::move(elem));
         ++numKept;
-      } else {
-        it.Skip();
       }
     } else {
       // Always append the others
-      it.Push();
+      result.push_back(std::move(elem));
     }
   }
 
   // Put the result back to the database
-  db_->Put(put_option_, key, it.WriteResult());
+  if (numKept < totalOccs) {
+    WriteList(key, meta, result);
+  }
 
   // Return the number of elements removed
   return totalOccs - numKept;
@@ -513,39 +584,118 @@ int RedisLists::RemoveLast(const std::string& key, int32_t num,
 int RedisLists::Insert(const std::string& key, const std::string& pivot,
                        const std::string& value, bool insert_after) {
   // Get the original list data
-  std::string data;
-  db_->Get(get_option_, key, &data);
+  ListMeta meta = GetMeta(key);
+  std::vector<std::string> elements;
+  ReadElements(key, meta, 0, meta.Length() - 1, &elements);
+
+  // Find the element we want
+  auto it = std::find(elements.begin(), elements.end(), pivot);
+  if (it == elements.end()) {
+    // Returns the unchanged length of the list
+    return meta.Length();
+  }
+  if (insert_after == true) {       // Skip one more, if inserting after it
+    ++it;
+  }
+  elements.insert(it, value);
 
-  // Construct an iterator to the data and reserve enough space for result.
-  RedisListIterator it(data);
-  it.Reserve(it.Size() + it.SizeOf(value));
+  // Put the data into the database, and return the new length
+  WriteList(key, meta, elements);
+  return static_cast<int>(elements.size());
+}
 
-  // Iterate through the list until we find the element we want
-  Slice elem;
-  bool found = false;
-  while(!it.Done() && !found) {
-    it.GetCurrent(&elem);
+RedisLists::ListMeta RedisLists::GetMeta(const std::string& key) {
+  ListMeta meta;
+  meta.head = meta.tail = kInitialPosition;
+  std::string data;
+  Status s = db_->Get(get_option_, MetaKey(key), &data);
+  if (s.IsNotFound()) {
+    return meta;
+  }
+  if (!s.ok() || data.size() != 2 * sizeof(uint64_t)) {
+    throw RedisListException();
+  }
+  meta.head = DecodeFixed64(data.data());
+  meta.tail = DecodeFixed64(data.data() + sizeof(uint64_t));
+  if (meta.head > meta.tail) {
+    throw RedisListException();
+  }
+  return meta;
+}
 
-    // When we find the element, insert the element and mark found
-    if (elem == pivot) {                // Found it!
-      found = true;
-      if (insert_after == true) {       // Skip one more, if inserting after it
-        it.Push();
-      }
-      it.InsertElement(value);
-    } else {
-      it.Push();
-    }
+void RedisLists::PutMeta(const std::string& key, const ListMeta& meta,
+                         WriteBatch* batch) {
+  if (meta.head == meta.tail) {
+    // Empty lists start over at kInitialPosition
+    batch->Delete(MetaKey(key));
+    return;
+  }
+  std::string data;
+  PutFixed64(&data, meta.head);
+  PutFixed64(&data, meta.tail);
+  batch->Put(MetaKey(key), data);
+}
 
+void RedisLists::ReadElements(const std::string& key, const ListMeta& meta,
+                              int first, int last,
+                              std::vector<std::string>* elements) {
+  uint64_t position = meta.head + first;
+  const uint64_t end = meta.head + last + 1;
+  std::string data;
+  std::vector<Slice> segment_elements;
+  while (position < end) {
+    const uint64_t segment = position / kSegmentSize;
+    data.clear();
+    if (!db_->Get(get_option_, SegmentKey(key, segment), &data).ok()) {
+      throw RedisListException();
+    }
+    segment_elements.clear();
+    DecodeSegment(data, &segment_elements);
+
+    // The first segment starts at the head, the last one ends at the tail
+    const uint64_t segment_first =
+        std::max(segment * kSegmentSize, meta.head);
+    const uint64_t segment_end =
+        std::min((segment + 1) * kSegmentSize, meta.tail);
+    if (segment_elements.size() != segment_end - segment_first) {
+      throw RedisListException();
+    }
+    for (; position < end && position < segment_end; ++position) {
+      elements->push_back(
+          segment_elements[position - segment_first].ToString());
+    }
   }
+}
 
-  // Put the data (string) into the database
-  if (found) {
-    db_->Put(put_option_, key, it.WriteResult());
+bool RedisLists::WriteList(const std::string& key, const ListMeta& meta,
+                           const std::vector<std::string>& elements) {
+  WriteBatch batch;
+
+  // Drop the old segments, then write the new ones from the same head
+  if (meta.head < meta.tail) {
+    const uint64_t last_segment = (meta.tail - 1) / kSegmentSize;
+    for (uint64_t segment = meta.head / kSegmentSize;
+         segment <= last_segment; ++segment) {
+      batch.Delete(SegmentKey(key, segment));
+    }
   }
+  ListMeta new_meta = meta;
+  new_meta.tail = meta.head + elements.size();
+  uint64_t position = new_meta.head;
+  auto it = elements.begin();
+  while (it != elements.end()) {
+    const uint64_t segment = position / kSegmentSize;
+    const uint64_t n =
+        std::min(static_cast<uint64_t>(elements.end() - it),
+                 (segment + 1) * kSegmentSize - position);
+    batch.Put(SegmentKey(key, segment), EncodeSegment(it, it + n));
+    it += n;
+    position += n;
+  }
+  PutMeta(key, new_meta, &batch);
 
-  // Returns the new (possibly unchanged) length of the list
-  return it.Length();
+  Status s = db_->Write(put_option_, &batch);
+  return s.ok();
 }
 
 }  // namespace rocksdb
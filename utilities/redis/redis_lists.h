@@ -12,7 +12,9 @@
 #pragma once
 
 #include <string>
+#include <vector>
 #include "rocksdb/db.h"
+#include "rocksdb/write_batch.h"
 #include "redis_list_iterator.h"
 #include "redis_list_exception.h"
 
@@ -92,15 +94,40 @@ class RedisLists {
   /// Calls InsertBefore or InsertAfter
   int Insert(const std::string& key, const std::string& pivot,
              const std::string& value, bool insert_after);
+
+  /// The elements of a list have consecutive positions in [head, tail).
+  /// Position p is stored in segment p / kSegmentSize.
+  struct ListMeta {
+    uint64_t head;
+    uint64_t tail;
+    int Length() const { return static_cast<int>(tail - head); }
+  };
+
+  /// Read the metadata of (list: key). Missing lists are empty.
+  ListMeta GetMeta(const std::string& key);
+  /// Add the update of the metadata to batch. Empty lists are deleted.
+  void PutMeta(const std::string& key, const ListMeta& meta,
+               WriteBatch* batch);
+
+  /// Read the elements first..last (inclusive, 0-based) of (list: key)
+  /// and append them to *elements. Only reads the segments holding them.
+  void ReadElements(const std::string& key, const ListMeta& meta,
+                    int first, int last, std::vector<std::string>* elements);
+
+  /// Replace (list: key) by elements, rewriting all of its segments.
+  bool WriteList(const std::string& key, const ListMeta& meta,
+                 const std::vector<std::string>& elements);
+
  private:
   std::string db_name_;       // The actual database name/path
   WriteOptions put_option_;
   ReadOptions get_option_;
 
   /// The backend rocksdb database.
-  /// Map : key --> list
-  ///       where a list is a sequence of elements
-  ///       and an element is a 4-byte integer (n), followed by n bytes of data
+  /// Map : metadata key --> (head, tail) of the list
+  ///       segment key  --> up to kSegmentSize consecutive elements
+  ///       where an element is a 4-byte integer (n), followed by n bytes of
+  ///       data. Pushes and pops are merge operands of the segments.
   std::unique_ptr<DB> db_;
 };
 
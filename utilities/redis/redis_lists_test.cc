@@ -19,10 +19,12 @@
 
 #include <iostream>
 #include <cctype>
+#include <deque>
 
 #include "redis_lists.h"
 #include "util/testharness.h"
 #include "util/random.h"
+#include "util/string_util.h"
 
 using namespace rocksdb;
 using namespace std;
@@ -741,6 +743,76 @@ TEST_F(RedisListsTest, PersistenceMultiKeyTest) {
   }
 }
 
+// Lists that span many segments
+TEST_F(RedisListsTest, LargeListTest) {
+  const std::string kKey = "large";
+  std::deque<std::string> expected;
+  string tempv;
+
+  {
+    RedisLists redis(kDefaultDbName, options, true);   // Destructive
+
+    // Push onto both ends
+    for (int i = 0; i < 1000; ++i) {
+      if (i % 3 == 0) {
+        expected.push_front(ToString(i));
+        ASSERT_EQ(redis.PushLeft(kKey, ToString(i)), i + 1);
+      } else {
+        expected.push_back(ToString(i));
+        ASSERT_EQ(redis.PushRight(kKey, ToString(i)), i + 1);
+      }
+    }
+    ASSERT_EQ(redis.Length(kKey), 1000);
+
+    for (int index : {0, 1, 127, 128, 129, 333, 334, 500, 999}) {
+      ASSERT_TRUE(redis.Index(kKey, index, &tempv));
+      ASSERT_EQ(tempv, expected[index]);
+      ASSERT_TRUE(redis.Index(kKey, index - 1000, &tempv));
+      ASSERT_EQ(tempv, expected[index]);
+    }
+    ASSERT_FALSE(redis.Index(kKey, 1000, &tempv));
+    ASSERT_FALSE(redis.Index(kKey, -1001, &tempv));
+
+    AssertListEq(redis.Range(kKey, 300, 700),
+                 std::vector<std::string>(expected.begin() + 300,
+                                          expected.begin() + 701));
+
+    // Pop across segment boundaries
+    for (int i = 0; i < 200; ++i) {
+      ASSERT_TRUE(redis.PopLeft(kKey, &tempv));
+      ASSERT_EQ(tempv, expected.front());
+      expected.pop_front();
+      ASSERT_TRUE(redis.PopRight(kKey, &tempv));
+      ASSERT_EQ(tempv, expected.back());
+      expected.pop_back();
+    }
+    ASSERT_EQ(redis.Length(kKey), 600);
+
+    ASSERT_TRUE(redis.Set(kKey, 250, "set"));
+    expected[250] = "set";
+    ASSERT_TRUE(redis.Trim(kKey, 100, 449));
+    expected.erase(expected.begin() + 450, expected.end());
+    expected.erase(expected.begin(), expected.begin() + 100);
+    ASSERT_EQ(redis.InsertAfter(kKey, "set", "after"), 351);
+    expected.insert(expected.begin() + 151, "after");
+  }
+
+  // Reopen and check the whole list
+  {
+    RedisLists redis(kDefaultDbName, options, false); // Persistent
+    AssertListEq(redis.Range(kKey, 0, -1),
+                 std::vector<std::string>(expected.begin(), expected.end()));
+
+    // Empty the list, then reuse it
+    while (redis.PopRight(kKey, &tempv)) {
+    }
+    ASSERT_EQ(redis.Length(kKey), 0);
+    ASSERT_EQ(redis.PushLeft(kKey, "a"), 1);
+    ASSERT_EQ(redis.PushRight(kKey, "b"), 2);
+    AssertListEq(redis.Range(kKey, 0, -1), {"a", "b"});
+  }
+}
+
 /// THE manual REDIS TEST begins here
 /// THIS WILL ONLY OCCUR IF YOU RUN: ./redis_test -m
 
@@ -351,31 +351,24 @@ class SpatialIndexCursor : public Cursor {
   SpatialIndexCursor(Iterator* spatial_iterator, ValueGetter* value_getter,
                      const BoundingBox<uint64_t>& tile_bbox, uint32_t tile_bits)
       : value_getter_(value_getter), valid_(true) {
-    // calculate quad keys we'll need to query
-    std::vector<uint64_t> quad_keys;
-    quad_keys.reserve((tile_bbox.max_x - tile_bbox.min_x + 1) *
-                      (tile_bbox.max_y - tile_bbox.min_y + 1));
-    for (uint64_t x = tile_bbox.min_x; x <= tile_bbox.max_x; ++x) {
-      for (uint64_t y = tile_bbox.min_y; y <= tile_bbox.max_y; ++y) {
-        quad_keys.push_back(GetQuadKeyFromTile(x, y, tile_bits));
-      }
-    }
-    std::sort(quad_keys.begin(), quad_keys.end());
-
-    // load primary key ids for all quad keys
-    for (auto quad_key : quad_keys) {
-      std::string encoded_quad_key;
-      PutFixed64BigEndian(&encoded_quad_key, quad_key);
-      Slice slice_quad_key(encoded_quad_key);
-
-      // If CheckQuadKey is true, there is no need to reseek, since
-      // spatial_iterator is already pointing at the correct quad key. This is
-      // an optimization.
-      if (!CheckQuadKey(spatial_iterator, slice_quad_key)) {
-        spatial_iterator->Seek(slice_quad_key);
+    // load primary key ids for all the ranges of quad keys covering the
+    // bounding box, in increasing order
+    bool seeked = false;
+    for (QuadKeyRangeIterator ranges(tile_bbox, tile_bits);
+         valid_ && ranges.Valid(); ranges.Next()) {
+      // If spatial_iterator is already at or after the start of the range,
+      // there is no need to reseek. This is an optimization.
+      uint64_t quad_key;
+      if (!seeked || (GetQuadKey(spatial_iterator, &quad_key) &&
+                      quad_key < ranges.first())) {
+        std::string encoded_quad_key;
+        PutFixed64BigEndian(&encoded_quad_key, ranges.first());
+        spatial_iterator->Seek(encoded_quad_key);
+        seeked = true;
       }
 
-      while (CheckQuadKey(spatial_iterator, slice_quad_key)) {
+      while (GetQuadKey(spatial_iterator, &quad_key) &&
+             quad_key <= ranges.last()) {
         // extract ID from spatial_iterator
         uint64_t id;
         bool ok = GetFixed64BigEndian(
@@ -390,6 +383,10 @@ class SpatialIndexCursor : public Cursor {
         primary_key_ids_.insert(id);
         spatial_iterator->Next();
       }
+      if (!spatial_iterator->Valid()) {
+        // no quad keys left
+        break;
+      }
     }
 
     if (!spatial_iterator->status().ok()) {
@@ -433,11 +430,10 @@ class SpatialIndexCursor : public Cursor {
   }
 
  private:
-  // * returns true if spatial iterator is on the current quad key and all is
+  // * returns true and stores the quad key spatial iterator is on if all is
   // well
-  // * returns false if spatial iterator is not on current, or iterator is
-  // invalid or corruption
-  bool CheckQuadKey(Iterator* spatial_iterator, const Slice& quad_key) {
+  // * returns false if iterator is invalid or corruption
+  bool GetQuadKey(Iterator* spatial_iterator, uint64_t* quad_key) {
     if (!spatial_iterator->Valid()) {
       return false;
     }
@@ -446,14 +442,7 @@ class SpatialIndexCursor : public Cursor {
       valid_ = false;
       return false;
     }
-    Slice spatial_iterator_quad_key(spatial_iterator->key().data(),
-                                    sizeof(uint64_t));
-    if (spatial_iterator_quad_key != quad_key) {
-      // caller needs to reseek
-      return false;
-    }
-    // if we come to here, we have found the quad key
-    return true;
+    return GetFixed64BigEndian(spatial_iterator->key(), quad_key);
   }
 
   void ExtractData() {
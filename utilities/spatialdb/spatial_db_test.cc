@@ -5,6 +5,7 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <algorithm>
 #include <vector>
 #include <string>
 #include <set>
@@ -14,6 +15,7 @@
 #include "util/testharness.h"
 #include "util/testutil.h"
 #include "util/random.h"
+#include "utilities/spatialdb/utils.h"
 
 namespace rocksdb {
 namespace spatial {
@@ -283,6 +285,49 @@ TEST_F(SpatialDBTest, RandomizedTest) {
   delete db_;
 }
 
+TEST_F(SpatialDBTest, QuadKeyRangeTest) {
+  const uint32_t kTileBits = 5;
+  const uint64_t kTiles = 1 << kTileBits;
+  Random rnd(301);
+
+  for (int i = 0; i < 200; ++i) {
+    uint64_t x1 = rnd.Uniform(kTiles), x2 = rnd.Uniform(kTiles);
+    uint64_t y1 = rnd.Uniform(kTiles), y2 = rnd.Uniform(kTiles);
+    BoundingBox<uint64_t> bbox(std::min(x1, x2), std::min(y1, y2),
+                               std::max(x1, x2), std::max(y1, y2));
+    std::vector<uint64_t> expected;
+    for (uint64_t x = bbox.min_x; x <= bbox.max_x; ++x) {
+      for (uint64_t y = bbox.min_y; y <= bbox.max_y; ++y) {
+        expected.push_back(GetQuadKeyFromTile(x, y, kTileBits));
+      }
+    }
+    std::sort(expected.begin(), expected.end());
+
+    // The ranges are sorted, maximal, and cover exactly the bounding box
+    std::vector<uint64_t> quad_keys;
+    for (QuadKeyRangeIterator ranges(bbox, kTileBits); ranges.Valid();
+         ranges.Next()) {
+      ASSERT_LE(ranges.first(), ranges.last());
+      if (!quad_keys.empty()) {
+        ASSERT_GT(ranges.first(), quad_keys.back() + 1);
+      }
+      for (uint64_t q = ranges.first(); q <= ranges.last(); ++q) {
+        quad_keys.push_back(q);
+      }
+    }
+    ASSERT_TRUE(quad_keys == expected);
+  }
+
+  // The whole space is a single range
+  QuadKeyRangeIterator ranges(
+      BoundingBox<uint64_t>(0, 0, kTiles - 1, kTiles - 1), kTileBits);
+  ASSERT_TRUE(ranges.Valid());
+  ASSERT_EQ(0U, ranges.first());
+  ASSERT_EQ(kTiles * kTiles - 1, ranges.last());
+  ranges.Next();
+  ASSERT_TRUE(!ranges.Valid());
+}
+
 }  // namespace spatial
 }  // namespace rocksdb
 
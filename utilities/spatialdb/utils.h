@@ -4,8 +4,10 @@
 //  of patent rights can be found in the PATENTS file in the same directory.
 
 #pragma once
+#include <assert.h>
 #include <string>
 #include <algorithm>
+#include <vector>
 
 #include "rocksdb/utilities/spatial_db.h"
 
@@ -34,6 +36,110 @@ inline uint64_t GetQuadKeyFromTile(uint64_t tile_x, uint64_t tile_y,
   return quad_key;
 }
 
+// Decomposes an (inclusive) bounding box of tiles into the maximal ranges of
+// consecutive quad keys whose tiles are all inside it, in increasing order.
+// Walks the quad tree depth first, merging the nodes of any size that follow
+// each other, so it only needs O(tile_bits) memory whatever the size of the
+// bounding box. The number of ranges grows with its perimeter, not its area.
+class QuadKeyRangeIterator {
+ public:
+  QuadKeyRangeIterator(const BoundingBox<uint64_t>& tile_bbox,
+                       uint32_t tile_bits)
+      : tile_bbox_(tile_bbox),
+        tile_bits_(tile_bits),
+        valid_(false),
+        first_(0),
+        last_(0),
+        has_pending_(false),
+        pending_first_(0),
+        pending_last_(0) {
+    stack_.reserve(3 * tile_bits + 1);
+    stack_.push_back({0, 0, tile_bits});
+    has_pending_ = NextNode(&pending_first_, &pending_last_);
+    Next();
+  }
+
+  bool Valid() const { return valid_; }
+
+  void Next() {
+    valid_ = has_pending_;
+    if (!valid_) {
+      return;
+    }
+    first_ = pending_first_;
+    last_ = pending_last_;
+    has_pending_ = false;
+    uint64_t first, last;
+    while (NextNode(&first, &last)) {
+      if (first != last_ + 1) {
+        pending_first_ = first;
+        pending_last_ = last;
+        has_pending_ = true;
+        break;
+      }
+      last_ = last;
+    }
+  }
+
+  // The range is [first(), last()]
+  uint64_t first() const { return first_; }
+  uint64_t last() const { return last_; }
+
+ private:
+  // The tiles [x, x + 2^level) x [y, y + 2^level), whose quad keys are
+  // consecutive
+  struct Node {
+    uint64_t x;
+    uint64_t y;
+    uint32_t level;
+  };
+
+  // Returns the quad keys of the next node inside the bounding box
+  bool NextNode(uint64_t* first, uint64_t* last) {
+    while (!stack_.empty()) {
+      Node node = stack_.back();
+      stack_.pop_back();
+      const uint64_t side_minus_one =
+          (static_cast<uint64_t>(1) << node.level) - 1;
+      if (node.x > tile_bbox_.max_x || node.y > tile_bbox_.max_y ||
+          node.x + side_minus_one < tile_bbox_.min_x ||
+          node.y + side_minus_one < tile_bbox_.min_y) {
+        continue;
+      }
+      if (node.x >= tile_bbox_.min_x && node.y >= tile_bbox_.min_y &&
+          node.x + side_minus_one <= tile_bbox_.max_x &&
+          node.y + side_minus_one <= tile_bbox_.max_y) {
+        *first = GetQuadKeyFromTile(node.x, node.y, tile_bits_);
+        *last = *first + (node.level >= 32
+                              ? ~static_cast<uint64_t>(0)
+                              : (static_cast<uint64_t>(1) << (2 * node.level)) -
+                                    1);
+        return true;
+      }
+      // Partially covered, visit the children in quad key order
+      assert(node.level > 0);
+      const uint32_t level = node.level - 1;
+      const uint64_t half = static_cast<uint64_t>(1) << level;
+      stack_.push_back({node.x + half, node.y + half, level});
+      stack_.push_back({node.x, node.y + half, level});
+      stack_.push_back({node.x + half, node.y, level});
+      stack_.push_back({node.x, node.y, level});
+    }
+    return false;
+  }
+
+  const BoundingBox<uint64_t> tile_bbox_;
+  const uint32_t tile_bits_;
+  std::vector<Node> stack_;
+  bool valid_;
+  uint64_t first_;
+  uint64_t last_;
+  // The node following the current range, if any
+  bool has_pending_;
+  uint64_t pending_first_;
+  uint64_t pending_last_;
+};
+
 inline BoundingBox<uint64_t> GetTileBoundingBox(
     const SpatialIndexOptions& spatial_index, BoundingBox<double> bbox) {
   return BoundingBox<uint64_t>(
@@ -40,7 +40,7 @@ class OptimisticTransactionImpl : public TransactionBaseImpl {
 
  protected:
   Status TryLock(ColumnFamilyHandle* column_family, const Slice& key,
-                 bool untracked = false) override;
+                 bool untracked = false, bool exclusive = true) override;
 
  private:
   OptimisticTransactionDB* const txn_db_;
@@ -11,6 +11,7 @@
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
 #include "util/logging.h"
+#include "util/string_util.h"
 #include "util/testharness.h"
 
 using std::string;
@@ -1114,6 +1115,61 @@ TEST_F(OptimisticTransactionTest, SavepointTest) {
   delete txn;
 }
 
+TEST_F(OptimisticTransactionTest, ManyKeysTest) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  OptimisticTransactionOptions txn_options;
+  string value;
+  Status s;
+
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    s = db->Put(write_options, "key" + ToString(i), "value");
+    ASSERT_OK(s);
+  }
+
+  // No writes since the keys were read, nothing to look up
+  Transaction* txn = txn_db->BeginTransaction(write_options);
+  for (int i = 0; i < kNumKeys; i++) {
+    s = txn->GetForUpdate(read_options, "key" + ToString(i), &value);
+    ASSERT_OK(s);
+    txn->Put("key" + ToString(i), "txn1");
+  }
+  s = txn->Commit();
+  ASSERT_OK(s);
+  delete txn;
+
+  // Writes to other keys don't conflict
+  txn_options.set_snapshot = true;
+  txn = txn_db->BeginTransaction(write_options, txn_options);
+  for (int i = 0; i < kNumKeys; i += 2) {
+    txn->Put("key" + ToString(i), "txn2");
+  }
+  s = db->Put(write_options, "key1", "outside");
+  ASSERT_OK(s);
+  s = txn->Commit();
+  ASSERT_OK(s);
+  delete txn;
+
+  // A single written key among many conflicts
+  txn = txn_db->BeginTransaction(write_options, txn_options);
+  for (int i = 0; i < kNumKeys; i++) {
+    txn->Put("key" + ToString(i), "txn3");
+  }
+  s = db->Put(write_options, "key500", "outside");
+  ASSERT_OK(s);
+  s = txn->Commit();
+  ASSERT_TRUE(s.IsBusy());
+  delete txn;
+
+  db->Get(read_options, "key0", &value);
+  ASSERT_EQ(value, "txn2");
+  db->Get(read_options, "key1", &value);
+  ASSERT_EQ(value, "outside");
+  db->Get(read_options, "key3", &value);
+  ASSERT_EQ(value, "txn1");
+}
+
 }  // namespace rocksdb
 
 int main(int argc, char** argv) {
@@ -120,8 +120,9 @@ Status TransactionBaseImpl::Get(const ReadOptions& read_options,
 
 Status TransactionBaseImpl::GetForUpdate(const ReadOptions& read_options,
                                          ColumnFamilyHandle* column_family,
-                                         const Slice& key, std::string* value) {
-  Status s = TryLock(column_family, key);
+                                         const Slice& key, std::string* value,
+                                         bool exclusive) {
+  Status s = TryLock(column_family, key, false /* untracked */, exclusive);
 
   if (s.ok() && value != nullptr) {
     s = Get(read_options, column_family, key, value);
@@ -370,18 +371,23 @@ uint64_t TransactionBaseImpl::GetNumKeys() const {
 }
 
 void TransactionBaseImpl::TrackKey(uint32_t cfh_id, const std::string& key,
-                                   SequenceNumber seq) {
+                                   SequenceNumber seq, bool exclusive) {
   auto iter = tracked_keys_[cfh_id].find(key);
   if (iter == tracked_keys_[cfh_id].end()) {
-    tracked_keys_[cfh_id].insert({key, seq});
+    tracked_keys_[cfh_id].insert({key, TransactionKeyMapInfo(seq, exclusive)});
 
     if (save_points_ != nullptr && !save_points_->empty()) {
       // Aren't tracking this key, add it.
-      save_points_->top().new_keys_[cfh_id][key] = seq;
+      save_points_->top().new_keys_[cfh_id].insert(
+          {key, TransactionKeyMapInfo(seq, exclusive)});
+    }
+  } else {
+    if (seq < iter->second.seq) {
+      // Now tracking this key with an earlier sequence number
+      iter->second.seq = seq;
     }
-  } else if (seq < iter->second) {
-    // Now tracking this key with an earlier sequence number
-    iter->second = seq;
+    // A shared lock may have been upgraded, but locks are never downgraded
+    iter->second.exclusive = iter->second.exclusive || exclusive;
   }
 }
 
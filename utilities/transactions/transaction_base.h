@@ -35,9 +35,10 @@ class TransactionBaseImpl : public Transaction {
   // Called before executing Put, Merge, Delete, and GetForUpdate.  If TryLock
   // returns non-OK, the Put/Merge/Delete/GetForUpdate will be failed.
   // untracked will be true if called from PutUntracked, DeleteUntracked, or
-  // MergeUntracked.
+  // MergeUntracked.  exclusive is false if called from a shared
+  // GetForUpdate.
   virtual Status TryLock(ColumnFamilyHandle* column_family, const Slice& key,
-                         bool untracked = false) = 0;
+                         bool untracked = false, bool exclusive = true) = 0;
 
   void SetSavePoint() override;
 
@@ -53,11 +54,12 @@ class TransactionBaseImpl : public Transaction {
 
   Status GetForUpdate(const ReadOptions& options,
                       ColumnFamilyHandle* column_family, const Slice& key,
-                      std::string* value) override;
+                      std::string* value, bool exclusive = true) override;
 
   Status GetForUpdate(const ReadOptions& options, const Slice& key,
-                      std::string* value) override {
-    return GetForUpdate(options, db_->DefaultColumnFamily(), key, value);
+                      std::string* value, bool exclusive = true) override {
+    return GetForUpdate(options, db_->DefaultColumnFamily(), key, value,
+                        exclusive);
   }
 
   std::vector<Status> MultiGet(
@@ -192,7 +194,9 @@ class TransactionBaseImpl : public Transaction {
  protected:
   // Add a key to the list of tracked keys.
   // seqno is the earliest seqno this key was involved with this transaction.
-  void TrackKey(uint32_t cfh_id, const std::string& key, SequenceNumber seqno);
+  // exclusive is whether the key is locked in exclusive mode.
+  void TrackKey(uint32_t cfh_id, const std::string& key, SequenceNumber seqno,
+                bool exclusive);
 
   const TransactionKeyMap* GetTrackedKeysSinceSavePoint();
 
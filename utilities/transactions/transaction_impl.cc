@@ -42,7 +42,9 @@ TransactionImpl::TransactionImpl(TransactionDB* txn_db,
       expiration_time_(txn_options.expiration >= 0
                            ? start_time_ + txn_options.expiration * 1000
                            : 0),
-      lock_timeout_(txn_options.lock_timeout * 1000) {
+      lock_timeout_(txn_options.lock_timeout * 1000),
+      deadlock_detect_(txn_options.deadlock_detect),
+      deadlock_detect_depth_(txn_options.deadlock_detect_depth) {
   txn_db_impl_ = dynamic_cast<TransactionDBImpl*>(txn_db);
   assert(txn_db_impl_);
 
@@ -189,11 +191,12 @@ Status TransactionImpl::LockBatch(WriteBatch* batch,
     for (const auto& key_iter : cfh_keys) {
       const std::string& key = key_iter;
 
-      s = txn_db_impl_->TryLock(this, cfh_id, key);
+      s = txn_db_impl_->TryLock(this, cfh_id, key, true /* exclusive */);
       if (!s.ok()) {
         break;
       }
-      (*keys_to_unlock)[cfh_id].insert({std::move(key), kMaxSequenceNumber});
+      (*keys_to_unlock)[cfh_id].insert(
+          {key, TransactionKeyMapInfo(kMaxSequenceNumber, true)});
     }
 
     if (!s.ok()) {
@@ -214,10 +217,12 @@ Status TransactionImpl::LockBatch(WriteBatch* batch,
 // this key will only be locked if there have been no writes to this key since
 // the snapshot time.
 Status TransactionImpl::TryLock(ColumnFamilyHandle* column_family,
-                                const Slice& key, bool untracked) {
+                                const Slice& key, bool untracked,
+                                bool exclusive) {
   uint32_t cfh_id = GetColumnFamilyID(column_family);
   std::string key_str = key.ToString();
   bool previously_locked;
+  bool lock_upgrade = false;
   Status s;
 
   // lock this key if this transactions hasn't already locked it
@@ -234,13 +239,15 @@ Status TransactionImpl::TryLock(ColumnFamilyHandle* column_family,
       previously_locked = false;
     } else {
       previously_locked = true;
-      current_seqno = iter->second;
+      current_seqno = iter->second.seq;
+      // a shared lock has to be upgraded before this key can be written
+      lock_upgrade = exclusive && !iter->second.exclusive;
     }
   }
 
   // lock this key if this transactions hasn't already locked it
-  if (!previously_locked) {
-    s = txn_db_impl_->TryLock(this, cfh_id, key_str);
+  if (!previously_locked || lock_upgrade) {
+    s = txn_db_impl_->TryLock(this, cfh_id, key_str, exclusive);
   }
 
   SetSnapshotIfNeeded();
@@ -249,8 +256,6 @@ Status TransactionImpl::TryLock(ColumnFamilyHandle* column_family,
   // we still need to take a lock to make sure we do not cause a conflict with
   // some other write.  However, we do not need to check if there have been
   // any writes since this transaction's snapshot.
-  // TODO(agiardullo): could optimize by supporting shared txn locks in the
-  // future
   if (untracked || snapshot_ == nullptr) {
     // Need to remember the earliest sequence number that we know that this
     // key has not been modified after.  This is useful if this same
@@ -281,7 +286,7 @@ Status TransactionImpl::TryLock(ColumnFamilyHandle* column_family,
 
   if (s.ok()) {
     // Let base class know we've conflict checked this key.
-    TrackKey(cfh_id, key_str, new_seqno);
+    TrackKey(cfh_id, key_str, new_seqno, exclusive);
   }
 
   return s;
@@ -66,9 +66,13 @@ class TransactionImpl : public TransactionBaseImpl {
     lock_timeout_ = timeout * 1000;
   }
 
+  bool IsDeadlockDetect() const { return deadlock_detect_; }
+
+  int64_t GetDeadlockDetectDepth() const { return deadlock_detect_depth_; }
+
  protected:
   Status TryLock(ColumnFamilyHandle* column_family, const Slice& key,
-                 bool untracked = false) override;
+                 bool untracked = false, bool exclusive = true) override;
 
  private:
   TransactionDBImpl* txn_db_impl_;
@@ -86,6 +90,12 @@ class TransactionImpl : public TransactionBaseImpl {
   // Timeout in microseconds when locking a key or -1 if there is no timeout.
   int64_t lock_timeout_;
 
+  // Whether to check for deadlocks before waiting for a lock
+  const bool deadlock_detect_;
+
+  // Number of waiting transactions deadlock detection follows
+  const int64_t deadlock_detect_depth_;
+
   void Clear() override;
 
   Status ValidateSnapshot(ColumnFamilyHandle* column_family, const Slice& key,
@@ -24,20 +24,27 @@
 #include "rocksdb/utilities/transaction_db_mutex.h"
 #include "util/autovector.h"
 #include "util/murmurhash.h"
+#include "util/sync_point.h"
 #include "util/thread_local.h"
 
 namespace rocksdb {
 
 struct LockInfo {
-  TransactionID txn_id;
+  bool exclusive;
+  // Transactions holding this lock.  Only shared locks have more than one.
+  autovector<TransactionID> txn_ids;
 
   // Transaction locks are not valid after this time in us
   uint64_t expiration_time;
 
-  LockInfo(TransactionID id, uint64_t time)
-      : txn_id(id), expiration_time(time) {}
+  LockInfo(TransactionID id, uint64_t time, bool ex)
+      : exclusive(ex), expiration_time(time) {
+    txn_ids.push_back(id);
+  }
   LockInfo(const LockInfo& lock_info)
-      : txn_id(lock_info.txn_id), expiration_time(lock_info.expiration_time) {}
+      : exclusive(lock_info.exclusive),
+        txn_ids(lock_info.txn_ids),
+        expiration_time(lock_info.expiration_time) {}
 };
 
 struct LockMapStripe {
@@ -96,6 +103,11 @@ void UnrefLockMapsCache(void* ptr) {
       static_cast<std::unordered_map<uint32_t, std::shared_ptr<LockMap>>*>(ptr);
   delete lock_maps_cache;
 }
+
+// Expiration time of a lock held by two transactions, 0 means never.
+uint64_t LaterExpirationTime(uint64_t a, uint64_t b) {
+  return (a == 0 || b == 0) ? 0 : std::max(a, b);
+}
 }  // anonymous namespace
 
 TransactionLockMgr::TransactionLockMgr(
@@ -205,7 +217,8 @@ bool TransactionLockMgr::IsLockExpired(const LockInfo& lock_info, Env* env,
 
 Status TransactionLockMgr::TryLock(const TransactionImpl* txn,
                                    uint32_t column_family_id,
-                                   const std::string& key, Env* env) {
+                                   const std::string& key, Env* env,
+                                   bool exclusive) {
   // Lookup lock map for this column family id
   std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
   LockMap* lock_map = lock_map_ptr.get();
@@ -222,14 +235,16 @@ Status TransactionLockMgr::TryLock(const TransactionImpl* txn,
   assert(lock_map->lock_map_stripes_.size() > stripe_num);
   LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
-  LockInfo lock_info(txn->GetTxnID(), txn->GetExpirationTime());
+  LockInfo lock_info(txn->GetTxnID(), txn->GetExpirationTime(), exclusive);
   int64_t timeout = txn->GetLockTimeout();
 
-  return AcquireWithTimeout(lock_map, stripe, key, env, timeout, lock_info);
+  return AcquireWithTimeout(txn, lock_map, stripe, key, env, timeout,
+                            lock_info);
 }
 
 // Helper function for TryLock().
-Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
+Status TransactionLockMgr::AcquireWithTimeout(const TransactionImpl* txn,
+                                              LockMap* lock_map,
                                               LockMapStripe* stripe,
                                               const std::string& key, Env* env,
                                               int64_t timeout,
@@ -257,8 +272,10 @@ Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
 
   // Acquire lock if we are able to
   uint64_t expire_time_hint = 0;
-  result =
-      AcquireLocked(lock_map, stripe, key, env, lock_info, &expire_time_hint);
+  // Transactions holding the lock if we are not able to
+  autovector<TransactionID> wait_ids;
+  result = AcquireLocked(lock_map, stripe, key, env, lock_info,
+                         &expire_time_hint, &wait_ids);
 
   if (!result.ok() && timeout != 0) {
     // If we weren't able to acquire the lock, we will keep retrying as long
@@ -277,6 +294,15 @@ Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
         cv_end_time = end_time;
       }
 
+      // Waiting for a transaction that waits for us, directly or through
+      // other transactions, would only end with the timeout.
+      bool detect_deadlock = txn->IsDeadlockDetect() && !wait_ids.empty();
+      if (detect_deadlock && IncrementWaiters(txn, wait_ids)) {
+        result = Status::Busy(Status::SubCode::kDeadlock);
+        break;
+      }
+
+      TEST_SYNC_POINT("TransactionLockMgr::AcquireWithTimeout:WaitingTxn");
       if (cv_end_time < 0) {
         // Wait indefinitely
         result = stripe->stripe_cv->Wait(stripe->stripe_mutex);
@@ -288,6 +314,10 @@ Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
         }
       }
 
+      if (detect_deadlock) {
+        DecrementWaiters(txn, wait_ids);
+      }
+
       if (result.IsTimedOut()) {
           timed_out = true;
           // Even though we timed out, we will still make one more attempt to
@@ -297,7 +327,7 @@ Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
 
       if (result.ok() || result.IsTimedOut()) {
         result = AcquireLocked(lock_map, stripe, key, env, lock_info,
-                               &expire_time_hint);
+                               &expire_time_hint, &wait_ids);
       }
     } while (!result.ok() && !timed_out);
   }
@@ -307,30 +337,111 @@ Status TransactionLockMgr::AcquireWithTimeout(LockMap* lock_map,
   return result;
 }
 
+bool TransactionLockMgr::IncrementWaiters(
+    const TransactionImpl* txn, const autovector<TransactionID>& wait_ids) {
+  const TransactionID id = txn->GetTxnID();
+  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
+  assert(wait_txn_map_.find(id) == wait_txn_map_.end());
+  wait_txn_map_[id] = wait_ids;
+  for (auto wait_id : wait_ids) {
+    rev_wait_txn_map_[wait_id]++;
+  }
+
+  // Nobody waits for this transaction, so there can't be a cycle through it
+  if (rev_wait_txn_map_.find(id) == rev_wait_txn_map_.end()) {
+    return false;
+  }
+
+  // Breadth-first search of the transactions this one waits for, directly or
+  // indirectly.
+  std::vector<TransactionID> queue;
+  for (auto wait_id : wait_ids) {
+    queue.push_back(wait_id);
+  }
+  for (size_t head = 0; head < queue.size(); head++) {
+    const TransactionID next = queue[head];
+    if (next == id ||
+        static_cast<int64_t>(head) >= txn->GetDeadlockDetectDepth()) {
+      // Either a cycle, or the chain of waiting transactions is too long to
+      // follow, in which case we assume a deadlock as well.
+      DecrementWaitersImpl(txn, wait_ids);
+      return true;
+    }
+    auto iter = wait_txn_map_.find(next);
+    if (iter != wait_txn_map_.end()) {
+      for (auto wait_id : iter->second) {
+        queue.push_back(wait_id);
+      }
+    }
+  }
+  return false;
+}
+
+void TransactionLockMgr::DecrementWaiters(
+    const TransactionImpl* txn, const autovector<TransactionID>& wait_ids) {
+  std::lock_guard<std::mutex> lock(wait_txn_map_mutex_);
+  DecrementWaitersImpl(txn, wait_ids);
+}
+
+void TransactionLockMgr::DecrementWaitersImpl(
+    const TransactionImpl* txn, const autovector<TransactionID>& wait_ids) {
+  wait_txn_map_.erase(txn->GetTxnID());
+  for (auto wait_id : wait_ids) {
+    auto iter = rev_wait_txn_map_.find(wait_id);
+    assert(iter != rev_wait_txn_map_.end() && iter->second > 0);
+    if (--iter->second == 0) {
+      rev_wait_txn_map_.erase(iter);
+    }
+  }
+}
+
 // Try to lock this key after we have acquired the mutex.
 // Sets *expire_time to the expiration time in microseconds
 //  or 0 if no expiration.
+// If the key is locked by other transactions, sets *wait_ids to them.
 // REQUIRED:  Stripe mutex must be held.
 Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
                                          LockMapStripe* stripe,
                                          const std::string& key, Env* env,
                                          const LockInfo& txn_lock_info,
-                                         uint64_t* expire_time) {
+                                         uint64_t* expire_time,
+                                         autovector<TransactionID>* wait_ids) {
+  assert(txn_lock_info.txn_ids.size() == 1);
+  const TransactionID txn_id = txn_lock_info.txn_ids[0];
   Status result;
   // Check if this key is already locked
-  if (stripe->keys.find(key) != stripe->keys.end()) {
+  auto stripe_iter = stripe->keys.find(key);
+  if (stripe_iter != stripe->keys.end()) {
     // Lock already held
-
-    LockInfo& lock_info = stripe->keys.at(key);
-    if (lock_info.txn_id != txn_lock_info.txn_id) {
-      // locked by another txn.  Check if it's expired
-      if (IsLockExpired(lock_info, env, expire_time)) {
-        // lock is expired, can steal it
-        lock_info.txn_id = txn_lock_info.txn_id;
-        lock_info.expiration_time = txn_lock_info.expiration_time;
-        // lock_cnt does not change
-      } else {
-        result = Status::TimedOut(Status::SubCode::kLockTimeout);
+    LockInfo& lock_info = stripe_iter->second;
+    assert(lock_info.txn_ids.size() == 1 || !lock_info.exclusive);
+
+    if (!lock_info.exclusive && !txn_lock_info.exclusive) {
+      // Shared locks can be held by any number of transactions
+      if (std::find(lock_info.txn_ids.begin(), lock_info.txn_ids.end(),
+                    txn_id) == lock_info.txn_ids.end()) {
+        lock_info.txn_ids.push_back(txn_id);
+      }
+      lock_info.expiration_time = LaterExpirationTime(
+          lock_info.expiration_time, txn_lock_info.expiration_time);
+    } else if (lock_info.txn_ids.size() == 1 &&
+               lock_info.txn_ids[0] == txn_id) {
+      // Locked by this txn only, possibly upgrading a shared lock
+      lock_info.exclusive = lock_info.exclusive || txn_lock_info.exclusive;
+      lock_info.expiration_time = txn_lock_info.expiration_time;
+    } else if (IsLockExpired(lock_info, env, expire_time)) {
+      // lock is expired, can steal it
+      lock_info.txn_ids = txn_lock_info.txn_ids;
+      lock_info.exclusive = txn_lock_info.exclusive;
+      lock_info.expiration_time = txn_lock_info.expiration_time;
+      // lock_cnt does not change
+    } else {
+      result = Status::TimedOut(Status::SubCode::kLockTimeout);
+      wait_ids->clear();
+      for (auto id : lock_info.txn_ids) {
+        if (id != txn_id) {
+          wait_ids->push_back(id);
+        }
       }
     }
   } else {  // Lock not held.
@@ -352,6 +463,41 @@ Status TransactionLockMgr::AcquireLocked(LockMap* lock_map,
   return result;
 }
 
+// Releases txn's hold on key, which may leave a shared lock held by other
+// transactions.
+// REQUIRED:  Stripe mutex must be held.
+void TransactionLockMgr::UnLockKey(const TransactionImpl* txn,
+                                   const std::string& key,
+                                   LockMapStripe* stripe, LockMap* lock_map,
+                                   Env* env) {
+  TransactionID txn_id = txn->GetTxnID();
+
+  auto stripe_iter = stripe->keys.find(key);
+  if (stripe_iter != stripe->keys.end()) {
+    auto& txns = stripe_iter->second.txn_ids;
+    auto txn_it = std::find(txns.begin(), txns.end(), txn_id);
+    // Found the key we locked.  unlock it.
+    if (txn_it != txns.end()) {
+      if (txns.size() == 1) {
+        stripe->keys.erase(stripe_iter);
+        if (max_num_locks_ > 0) {
+          // Maintain lock count if there is a limit on the number of locks.
+          assert(lock_map->lock_cnt.load(std::memory_order_relaxed) > 0);
+          lock_map->lock_cnt--;
+        }
+      } else {
+        *txn_it = txns.back();
+        txns.pop_back();
+      }
+      return;
+    }
+  }
+  // This key is either not locked or locked by someone else.  This should
+  // only happen if the unlocking transaction has expired.
+  assert(txn->GetExpirationTime() > 0 &&
+         txn->GetExpirationTime() < env->NowMicros());
+}
+
 void TransactionLockMgr::UnLock(TransactionImpl* txn, uint32_t column_family_id,
                                 const std::string& key, Env* env) {
   std::shared_ptr<LockMap> lock_map_ptr = GetLockMap(column_family_id);
@@ -366,26 +512,8 @@ void TransactionLockMgr::UnLock(TransactionImpl* txn, uint32_t column_family_id,
   assert(lock_map->lock_map_stripes_.size() > stripe_num);
   LockMapStripe* stripe = lock_map->lock_map_stripes_.at(stripe_num);
 
-  TransactionID txn_id = txn->GetTxnID();
-
   stripe->stripe_mutex->Lock();
-
-  const auto& iter = stripe->keys.find(key);
-  if (iter != stripe->keys.end() && iter->second.txn_id == txn_id) {
-    // Found the key we locked.  unlock it.
-    stripe->keys.erase(iter);
-    if (max_num_locks_ > 0) {
-      // Maintain lock count if there is a limit on the number of locks.
-      assert(lock_map->lock_cnt.load(std::memory_order_relaxed) > 0);
-      lock_map->lock_cnt--;
-    }
-  } else {
-    // This key is either not locked or locked by someone else.  This should
-    // only happen if the unlocking transaction has expired.
-    assert(txn->GetExpirationTime() > 0 &&
-           txn->GetExpirationTime() < env->NowMicros());
-  }
-
+  UnLockKey(txn, key, stripe, lock_map, env);
   stripe->stripe_mutex->UnLock();
 
   // Signal waiting threads to retry locking
@@ -394,8 +522,6 @@ void TransactionLockMgr::UnLock(TransactionImpl* txn, uint32_t column_family_id,
 
 void TransactionLockMgr::UnLock(const TransactionImpl* txn,
                                 const TransactionKeyMap* key_map, Env* env) {
-  TransactionID txn_id = txn->GetTxnID();
-
   for (auto& key_map_iter : *key_map) {
     uint32_t column_family_id = key_map_iter.first;
     auto& keys = key_map_iter.second;
@@ -430,22 +556,7 @@ void TransactionLockMgr::UnLock(const TransactionImpl* txn,
       stripe->stripe_mutex->Lock();
 
       for (const std::string* key : stripe_keys) {
-        const auto& iter = stripe->keys.find(*key);
-        if (iter != stripe->keys.end() && iter->second.txn_id == txn_id) {
-          // Found the key we locked.  unlock it.
-          stripe->keys.erase(iter);
-          if (max_num_locks_ > 0) {
-            // Maintain lock count if there is a limit on the number of locks.
-            assert(lock_map->lock_cnt.load(std::memory_order_relaxed) > 0);
-            lock_map->lock_cnt--;
-          }
-        } else {
-          // This key is either not locked or locked by someone else.  This
-          // should only
-          // happen if the unlocking transaction has expired.
-          assert(txn->GetExpirationTime() > 0 &&
-                 txn->GetExpirationTime() < env->NowMicros());
-        }
+        UnLockKey(txn, *key, stripe, lock_map, env);
       }
 
       stripe->stripe_mutex->UnLock();
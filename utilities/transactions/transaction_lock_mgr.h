@@ -7,11 +7,13 @@
 #ifndef ROCKSDB_LITE
 
 #include <chrono>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <vector>
 
 #include "rocksdb/utilities/transaction.h"
+#include "util/autovector.h"
 #include "util/instrumented_mutex.h"
 #include "util/thread_local.h"
 #include "utilities/transactions/transaction_impl.h"
@@ -40,10 +42,12 @@ class TransactionLockMgr {
   // this column family is no longer in use.
   void RemoveColumnFamily(uint32_t column_family_id);
 
-  // Attempt to lock key.  If OK status is returned, the caller is responsible
-  // for calling UnLock() on this key.
+  // Attempt to lock key, in shared mode if exclusive is false.  If OK status
+  // is returned, the caller is responsible for calling UnLock() on this key.
+  // A transaction holding a shared lock can call it again with exclusive set
+  // to upgrade its lock.
   Status TryLock(const TransactionImpl* txn, uint32_t column_family_id,
-                 const std::string& key, Env* env);
+                 const std::string& key, Env* env, bool exclusive);
 
   // Unlock a key locked by TryLock().  txn must be the same Transaction that
   // locked this key.
@@ -73,17 +77,44 @@ class TransactionLockMgr {
   // to avoid acquiring a mutex in order to look up a LockMap
   std::unique_ptr<ThreadLocalPtr> lock_maps_cache_;
 
+  // Must be held when accessing/modifying wait_txn_map_ and
+  // rev_wait_txn_map_.  Acquired after a stripe mutex.
+  std::mutex wait_txn_map_mutex_;
+
+  // Maps a transaction that waits for a lock, and does deadlock detection,
+  // to the transactions holding that lock.
+  std::unordered_map<TransactionID, autovector<TransactionID>> wait_txn_map_;
+
+  // Maps a transaction to the number of transactions in wait_txn_map_ that
+  // wait for it.
+  std::unordered_map<TransactionID, int> rev_wait_txn_map_;
+
   bool IsLockExpired(const LockInfo& lock_info, Env* env, uint64_t* wait_time);
 
   std::shared_ptr<LockMap> GetLockMap(uint32_t column_family_id);
 
-  Status AcquireWithTimeout(LockMap* lock_map, LockMapStripe* stripe,
-                            const std::string& key, Env* env, int64_t timeout,
+  Status AcquireWithTimeout(const TransactionImpl* txn, LockMap* lock_map,
+                            LockMapStripe* stripe, const std::string& key,
+                            Env* env, int64_t timeout,
                             const LockInfo& lock_info);
 
   Status AcquireLocked(LockMap* lock_map, LockMapStripe* stripe,
                        const std::string& key, Env* env,
-                       const LockInfo& lock_info, uint64_t* wait_time);
+                       const LockInfo& lock_info, uint64_t* wait_time,
+                       autovector<TransactionID>* wait_ids);
+
+  void UnLockKey(const TransactionImpl* txn, const std::string& key,
+                 LockMapStripe* stripe, LockMap* lock_map, Env* env);
+
+  // Records that txn waits for the transactions in wait_ids.  Returns true,
+  // and forgets about the wait again, if this would deadlock.
+  bool IncrementWaiters(const TransactionImpl* txn,
+                        const autovector<TransactionID>& wait_ids);
+  void DecrementWaiters(const TransactionImpl* txn,
+                        const autovector<TransactionID>& wait_ids);
+  // REQUIRES: wait_txn_map_mutex_ held
+  void DecrementWaitersImpl(const TransactionImpl* txn,
+                            const autovector<TransactionID>& wait_ids);
 
   // No copying allowed
   TransactionLockMgr(const TransactionLockMgr&);
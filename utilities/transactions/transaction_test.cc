@@ -5,12 +5,15 @@
 
 #ifndef ROCKSDB_LITE
 
+#include <atomic>
 #include <string>
+#include <thread>
 
 #include "rocksdb/db.h"
 #include "rocksdb/utilities/transaction.h"
 #include "rocksdb/utilities/transaction_db.h"
 #include "util/logging.h"
+#include "util/sync_point.h"
 #include "util/testharness.h"
 #include "utilities/merge_operators.h"
 #include "utilities/merge_operators/string_append/stringappend.h"
@@ -1182,6 +1185,116 @@ TEST_F(TransactionTest, LockLimitTest) {
   delete txn2;
 }
 
+TEST_F(TransactionTest, SharedLocks) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  string value;
+  Status s;
+
+  ASSERT_OK(db->Put(write_options, "foo", "bar"));
+
+  Transaction* txn1 = db->BeginTransaction(write_options);
+  Transaction* txn2 = db->BeginTransaction(write_options);
+  Transaction* txn3 = db->BeginTransaction(write_options);
+  ASSERT_TRUE(txn1 && txn2 && txn3);
+
+  // Any number of transactions can hold a shared lock
+  s = txn1->GetForUpdate(read_options, "foo", &value, false);
+  ASSERT_OK(s);
+  ASSERT_EQ("bar", value);
+  s = txn2->GetForUpdate(read_options, "foo", &value, false);
+  ASSERT_OK(s);
+  s = txn2->GetForUpdate(read_options, "foo", &value, false);
+  ASSERT_OK(s);
+
+  // but nobody can write the key
+  s = txn3->Put("foo", "bar3");
+  ASSERT_TRUE(s.IsTimedOut());
+  s = txn3->GetForUpdate(read_options, "foo", &value);
+  ASSERT_TRUE(s.IsTimedOut());
+  // not even a holder, which would need to upgrade its lock
+  s = txn1->Put("foo", "bar1");
+  ASSERT_TRUE(s.IsTimedOut());
+
+  ASSERT_OK(txn2->Commit());
+  s = txn1->Put("foo", "bar1");
+  ASSERT_OK(s);
+
+  // the upgraded lock is exclusive
+  s = txn3->GetForUpdate(read_options, "foo", &value, false);
+  ASSERT_TRUE(s.IsTimedOut());
+  ASSERT_OK(txn1->Commit());
+
+  s = txn3->GetForUpdate(read_options, "foo", &value, false);
+  ASSERT_OK(s);
+  ASSERT_EQ("bar1", value);
+  s = txn3->Put("foo", "bar3");
+  ASSERT_OK(s);
+  ASSERT_OK(txn3->Commit());
+
+  s = db->Get(read_options, "foo", &value);
+  ASSERT_OK(s);
+  ASSERT_EQ("bar3", value);
+
+  delete txn1;
+  delete txn2;
+  delete txn3;
+}
+
+TEST_F(TransactionTest, DeadlockDetection) {
+  WriteOptions write_options;
+  ReadOptions read_options;
+  TransactionOptions txn_options;
+  string value;
+
+  // Without deadlock detection, the deadlock below would only end with this
+  // timeout
+  txn_options.lock_timeout = 60 * 1000;
+  txn_options.deadlock_detect = true;
+
+  ASSERT_OK(db->Put(write_options, "a", "a"));
+  ASSERT_OK(db->Put(write_options, "b", "b"));
+
+  Transaction* txn1 = db->BeginTransaction(write_options, txn_options);
+  Transaction* txn2 = db->BeginTransaction(write_options, txn_options);
+  ASSERT_TRUE(txn1 && txn2);
+
+  ASSERT_OK(txn1->GetForUpdate(read_options, "a", &value));
+  ASSERT_OK(txn2->GetForUpdate(read_options, "b", &value, false));
+
+  std::atomic<bool> waiting(false);
+  rocksdb::SyncPoint::GetInstance()->SetCallBack(
+      "TransactionLockMgr::AcquireWithTimeout:WaitingTxn",
+      [&](void* arg) { waiting.store(true); });
+  rocksdb::SyncPoint::GetInstance()->EnableProcessing();
+
+  // txn1 waits for txn2
+  std::thread t([&] { ASSERT_OK(txn1->Put("b", "b1")); });
+  while (!waiting.load()) {
+    Env::Default()->SleepForMicroseconds(1000);
+  }
+
+  // txn2 waiting for txn1 would close the cycle
+  uint64_t start = Env::Default()->NowMicros();
+  Status s = txn2->Put("a", "a2");
+  ASSERT_TRUE(s.IsBusy());
+  ASSERT_EQ(Status::SubCode::kDeadlock, s.subcode());
+  ASSERT_LT(Env::Default()->NowMicros() - start, 30 * 1000 * 1000U);
+
+  // The victim rolls back, which lets txn1 continue
+  txn2->Rollback();
+  t.join();
+  rocksdb::SyncPoint::GetInstance()->DisableProcessing();
+  rocksdb::SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_OK(txn1->Commit());
+
+  ASSERT_OK(db->Get(read_options, "b", &value));
+  ASSERT_EQ("b1", value);
+
+  delete txn1;
+  delete txn2;
+}
+
 TEST_F(TransactionTest, IteratorTest) {
   WriteOptions write_options;
   ReadOptions read_options, snapshot_read_options;
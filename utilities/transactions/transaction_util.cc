@@ -12,6 +12,7 @@
 #include "utilities/transactions/transaction_util.h"
 
 #include <inttypes.h>
+#include <algorithm>
 #include <string>
 #include <vector>
 
@@ -53,6 +54,15 @@ Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
                                  SequenceNumber earliest_seq,
                                  SequenceNumber key_seq,
                                  const std::string& key) {
+  Status result = CheckMemTableHistory(earliest_seq, key_seq);
+  if (result.ok()) {
+    result = CheckLatestSequence(db_impl, sv, key_seq, key);
+  }
+  return result;
+}
+
+Status TransactionUtil::CheckMemTableHistory(SequenceNumber earliest_seq,
+                                             SequenceNumber key_seq) {
   Status result;
 
   // Since it would be too slow to check the SST files, we will only use
@@ -86,15 +96,19 @@ Status TransactionUtil::CheckKey(DBImpl* db_impl, SuperVersion* sv,
              "of this error.",
              key_seq, earliest_seq);
     result = Status::TryAgain(msg);
-  } else {
-    SequenceNumber seq = kMaxSequenceNumber;
-    Status s = db_impl->GetLatestSequenceForKeyFromMemtable(sv, key, &seq);
-    if (!s.ok()) {
-      result = s;
-    } else if (seq != kMaxSequenceNumber && seq > key_seq) {
-      // Write Conflict
-      result = Status::Busy();
-    }
+  }
+
+  return result;
+}
+
+Status TransactionUtil::CheckLatestSequence(DBImpl* db_impl, SuperVersion* sv,
+                                            SequenceNumber key_seq,
+                                            const std::string& key) {
+  SequenceNumber seq = kMaxSequenceNumber;
+  Status result = db_impl->GetLatestSequenceForKeyFromMemtable(sv, key, &seq);
+  if (result.ok() && seq != kMaxSequenceNumber && seq > key_seq) {
+    // Write Conflict
+    result = Status::Busy();
   }
 
   return result;
@@ -104,10 +118,30 @@ Status TransactionUtil::CheckKeysForConflicts(
     DBImpl* db_impl, const TransactionKeyMap& key_map) {
   Status result;
 
+  // Nothing was written after the latest sequence number, so keys tracked at
+  // it or later can not conflict and do not need to be looked up.  This is
+  // the common case for keys a transaction without a snapshot locked after
+  // the last write to the DB.
+  const SequenceNumber latest_seq = db_impl->GetLatestSequenceNumber();
+  std::vector<std::pair<const std::string*, SequenceNumber>> keys_to_check;
+
   for (auto& key_map_iter : key_map) {
     uint32_t cf_id = key_map_iter.first;
     const auto& keys = key_map_iter.second;
 
+    keys_to_check.clear();
+    SequenceNumber min_key_seq = kMaxSequenceNumber;
+    for (const auto& key_iter : keys) {
+      const SequenceNumber key_seq = key_iter.second.seq;
+      if (key_seq < latest_seq) {
+        keys_to_check.emplace_back(&key_iter.first, key_seq);
+        min_key_seq = std::min(min_key_seq, key_seq);
+      }
+    }
+    if (keys_to_check.empty()) {
+      continue;
+    }
+
     SuperVersion* sv = db_impl->GetAndRefSuperVersion(cf_id);
     if (sv == nullptr) {
       result = Status::InvalidArgument("Could not access column family " +
@@ -115,19 +149,31 @@ Status TransactionUtil::CheckKeysForConflicts(
       break;
     }
 
+    // The memtables are only checked once for a long enough history: if they
+    // cover the oldest sequence number, they cover all of them.
     SequenceNumber earliest_seq =
         db_impl->GetEarliestMemTableSequenceNumber(sv, true);
-
-    // For each of the keys in this transaction, check to see if someone has
-    // written to this key since the start of the transaction.
-    for (const auto& key_iter : keys) {
-      const auto& key = key_iter.first;
-      const SequenceNumber key_seq = key_iter.second;
-
-      result = CheckKey(db_impl, sv, earliest_seq, key_seq, key);
-
-      if (!result.ok()) {
-        break;
+    result = CheckMemTableHistory(earliest_seq, min_key_seq);
+
+    if (result.ok()) {
+      // Look the keys up in order, so that consecutive lookups walk mostly
+      // the same memtable nodes.
+      const Comparator* ucmp =
+          sv->mem->GetInternalKeyComparator().user_comparator();
+      std::sort(keys_to_check.begin(), keys_to_check.end(),
+                [ucmp](const std::pair<const std::string*, SequenceNumber>& a,
+                       const std::pair<const std::string*, SequenceNumber>& b) {
+                  return ucmp->Compare(*a.first, *b.first) < 0;
+                });
+
+      // For each of the keys in this transaction, check to see if someone has
+      // written to this key since the start of the transaction.
+      for (const auto& key : keys_to_check) {
+        result = CheckLatestSequence(db_impl, sv, key.second, *key.first);
+
+        if (!result.ok()) {
+          break;
+        }
       }
     }
 
@@ -141,7 +187,6 @@ Status TransactionUtil::CheckKeysForConflicts(
   return result;
 }
 
-
 }  // namespace rocksdb
 
 #endif  // ROCKSDB_LITE
@@ -17,9 +17,21 @@
 
 namespace rocksdb {
 
+struct TransactionKeyMapInfo {
+  // Earliest sequence number that is relevant to this transaction for this key
+  SequenceNumber seq;
+
+  // Whether this transaction holds the lock of this key in exclusive mode.
+  // Only used by pessimistic transactions.
+  bool exclusive;
+
+  TransactionKeyMapInfo(SequenceNumber seq_no, bool _exclusive)
+      : seq(seq_no), exclusive(_exclusive) {}
+};
+
 using TransactionKeyMap =
     std::unordered_map<uint32_t,
-                       std::unordered_map<std::string, SequenceNumber>>;
+                       std::unordered_map<std::string, TransactionKeyMapInfo>>;
 
 class DBImpl;
 struct SuperVersion;
@@ -53,6 +65,16 @@ class TransactionUtil {
   static Status CheckKey(DBImpl* db_impl, SuperVersion* sv,
                          SequenceNumber earliest_seq, SequenceNumber key_seq,
                          const std::string& key);
+
+  // Returns TryAgain if the memtables, whose earliest sequence number is
+  // earliest_seq, can't tell whether a key was written after key_seq.
+  static Status CheckMemTableHistory(SequenceNumber earliest_seq,
+                                     SequenceNumber key_seq);
+
+  // Returns Busy if the memtables hold a write to key after key_seq.
+  static Status CheckLatestSequence(DBImpl* db_impl, SuperVersion* sv,
+                                    SequenceNumber key_seq,
+                                    const std::string& key);
 };
 
 }  // namespace rocksdb
@@ -30,8 +30,17 @@ void DBWithTTLImpl::SanitizeOptions(int32_t ttl, ColumnFamilyOptions* options,
     options->merge_operator.reset(
         new TtlMergeOperator(options->merge_operator, env));
   }
+
+  options->table_properties_collector_factories.emplace_back(
+      new TtlTablePropertiesCollectorFactory());
+  options->expired_files_ttl = ttl > 0 ? static_cast<uint64_t>(ttl) : 0;
 }
 
+const char* TtlTablePropertiesCollector::kMinTimestamp =
+    "rocksdb.ttl.min-timestamp";
+const char* TtlTablePropertiesCollector::kMaxTimestamp =
+    "rocksdb.ttl.max-timestamp";
+
 // Open the db inside DBWithTTLImpl because options needs pointer to its ttl
 DBWithTTLImpl::DBWithTTLImpl(DB* db) : DBWithTTL(db) {}
 
@@ -90,6 +99,10 @@ Status DBWithTTL::Open(
     DBWithTTLImpl::SanitizeOptions(
         ttls[i], &column_families_sanitized[i].options,
         db_options.env == nullptr ? Env::Default() : db_options.env);
+    if (read_only) {
+      // Expired files are neither dropped nor skipped in read-only mode
+      column_families_sanitized[i].options.expired_files_ttl = 0;
+    }
   }
   DB* db;
 
@@ -277,6 +290,13 @@ Status DBWithTTLImpl::Write(const WriteOptions& opts, WriteBatch* updates) {
       WriteBatchInternal::Delete(&updates_ttl, column_family_id, key);
       return Status::OK();
     }
+    virtual Status DeleteRangeCF(uint32_t column_family_id,
+                                 const Slice& begin_key,
+                                 const Slice& end_key) override {
+      WriteBatchInternal::DeleteRange(&updates_ttl, column_family_id,
+                                      begin_key, end_key);
+      return Status::OK();
+    }
     virtual void LogData(const Slice& blob) override {
       updates_ttl.PutLogData(blob);
     }
@@ -13,9 +13,12 @@
 #include "rocksdb/env.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/table_properties.h"
 #include "rocksdb/utilities/utility_db.h"
 #include "rocksdb/utilities/db_ttl.h"
 #include "db/db_impl.h"
+#include "util/coding.h"
+#include "util/string_util.h"
 
 #ifdef _WIN32
 // Windows API macro interference
@@ -325,5 +328,81 @@ class TtlMergeOperator : public MergeOperator {
   std::shared_ptr<MergeOperator> user_merge_op_;
   Env* env_;
 };
+
+// Records the oldest and newest timestamps of the values of a table file.
+// A file that only holds Puts reports its newest timestamp as
+// NewestEntryTime(), so that it is dropped as a whole once all its values
+// expired. Deletions and merge operands carry no reliable timestamp, so a
+// file holding any of them is left to the compaction filter.
+class TtlTablePropertiesCollector : public TablePropertiesCollector {
+ public:
+  static const char* kMinTimestamp;
+  static const char* kMaxTimestamp;
+
+  TtlTablePropertiesCollector()
+      : min_timestamp_(0), max_timestamp_(0), puts_only_(true) {}
+
+  virtual Status AddUserKey(const Slice& key, const Slice& value,
+                            EntryType type, SequenceNumber seq,
+                            uint64_t file_size) override {
+    if (type != kEntryPut ||
+        !DBWithTTLImpl::SanityCheckTimestamp(value).ok()) {
+      puts_only_ = false;
+      return Status::OK();
+    }
+    const uint64_t timestamp = DecodeFixed32(
+        value.data() + value.size() - DBWithTTLImpl::kTSLength);
+    if (min_timestamp_ == 0 || timestamp < min_timestamp_) {
+      min_timestamp_ = timestamp;
+    }
+    max_timestamp_ = std::max(max_timestamp_, timestamp);
+    return Status::OK();
+  }
+
+  virtual Status Finish(UserCollectedProperties* properties) override {
+    if (max_timestamp_ != 0) {
+      std::string min_timestamp, max_timestamp;
+      PutVarint64(&min_timestamp, min_timestamp_);
+      PutVarint64(&max_timestamp, max_timestamp_);
+      properties->insert({kMinTimestamp, min_timestamp});
+      properties->insert({kMaxTimestamp, max_timestamp});
+    }
+    return Status::OK();
+  }
+
+  virtual UserCollectedProperties GetReadableProperties() const override {
+    if (max_timestamp_ == 0) {
+      return UserCollectedProperties();
+    }
+    return {{kMinTimestamp, ToString(min_timestamp_)},
+            {kMaxTimestamp, ToString(max_timestamp_)}};
+  }
+
+  virtual const char* Name() const override {
+    return "TtlTablePropertiesCollector";
+  }
+
+  virtual uint64_t NewestEntryTime() const override {
+    return puts_only_ ? max_timestamp_ : 0;
+  }
+
+ private:
+  uint64_t min_timestamp_;
+  uint64_t max_timestamp_;
+  bool puts_only_;
+};
+
+class TtlTablePropertiesCollectorFactory
+    : public TablePropertiesCollectorFactory {
+ public:
+  virtual TablePropertiesCollector* CreateTablePropertiesCollector(
+      TablePropertiesCollectorFactory::Context context) override {
+    return new TtlTablePropertiesCollector();
+  }
+
+  virtual const char* Name() const override {
+    return "TtlTablePropertiesCollectorFactory";
+  }
+};
 }
 #endif  // ROCKSDB_LITE
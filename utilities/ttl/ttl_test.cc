@@ -9,7 +9,9 @@
 #include "rocksdb/utilities/db_ttl.h"
 #include "util/testharness.h"
 #include "util/logging.h"
+#include "utilities/ttl/db_ttl_impl.h"
 #include <map>
+#include <set>
 #ifndef OS_WIN
 #include <unistd.h>
 #endif
@@ -115,6 +117,13 @@ class TtlTest : public testing::Test {
               num_entries);  // check all insertions done
   }
 
+  // Returns the key at position pos of kvmap_
+  std::string KeyAt(int64_t pos) {
+    auto it = kvmap_.begin();
+    advance(it, pos);
+    return it->first;
+  }
+
   // Makes a write-batch with key-vals from kvmap_ and 'Write''s it
   void MakePutWriteBatch(const BatchOperation* batch_ops, int64_t num_ops) {
     ASSERT_LE(num_ops, static_cast<int64_t>(kvmap_.size()));
@@ -365,9 +374,9 @@ class TtlTest : public testing::Test {
   std::string dbname_;
   DBWithTTL* db_ttl_;
   unique_ptr<SpecialTimeEnv> env_;
+  Options options_;
 
  private:
-  Options options_;
   KVMap kvmap_;
   KVMap::iterator kv_it_;
   const std::string kNewValue_ = "new_value";
@@ -526,6 +535,22 @@ TEST_F(TtlTest, WriteBatchTest) {
   CloseTtl();
 }
 
+// Range deletions in a batch are passed through to the db
+TEST_F(TtlTest, WriteBatchDeleteRange) {
+  OpenTtl();
+  WriteBatch batch;
+  batch.Put("a", "v");
+  batch.Put("b", "v");
+  batch.Put("c", "v");
+  batch.DeleteRange("b", "c");
+  ASSERT_OK(db_ttl_->Write(WriteOptions(), &batch));
+  std::string value;
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), "a", &value));
+  ASSERT_TRUE(db_ttl_->Get(ReadOptions(), "b", &value).IsNotFound());
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), "c", &value));
+  CloseTtl();
+}
+
 // Checks user's compaction filter for correctness with TTL logic
 TEST_F(TtlTest, CompactionFilter) {
   MakeKVMap(kSampleSize_);
@@ -569,6 +594,107 @@ TEST_F(TtlTest, MultiGetTest) {
   CloseTtl();
 }
 
+// Drops the files whose values all expired without compacting them
+TEST_F(TtlTest, DropExpiredFiles) {
+  MakeKVMap(kSampleSize_);
+  int64_t boundary = kSampleSize_ / 2;
+
+  OpenTtl(10);
+  PutValues(0, boundary);                        // T=0: Insert Set1 in File1
+  env_->Sleep(5);
+  PutValues(boundary, kSampleSize_ - boundary);  // T=5: Insert Set2 in File2
+
+  std::vector<LiveFileMetaData> files;
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2U, files.size());
+  if (files[0].largest_seqno > files[1].largest_seqno) {
+    std::swap(files[0], files[1]);
+  }
+  TablePropertiesCollection props;
+  ASSERT_OK(db_ttl_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(2U, props.size());
+  for (const auto& p : props) {
+    ASSERT_EQ(1U, p.second->user_collected_properties.count(
+                      TtlTablePropertiesCollector::kMaxTimestamp));
+  }
+
+  // T=12: File1 expired, Get skips it before it is dropped
+  env_->Sleep(7);
+  std::string value;
+  ASSERT_TRUE(db_ttl_->Get(ReadOptions(), KeyAt(0), &value).IsNotFound());
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), KeyAt(kSampleSize_ - 1), &value));
+
+  // The next flush schedules the compaction that drops File1
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "keymock", "valuemock"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  reinterpret_cast<DBImpl*>(db_ttl_->GetBaseDB())->TEST_WaitForCompact();
+  std::vector<LiveFileMetaData> new_files;
+  db_ttl_->GetLiveFilesMetaData(&new_files);
+  ASSERT_EQ(2U, new_files.size());
+  std::set<std::string> names;
+  for (const auto& f : new_files) {
+    names.insert(f.name);
+  }
+  ASSERT_EQ(0U, names.count(files[0].name));
+  ASSERT_EQ(1U, names.count(files[1].name));
+
+  SleepCompactCheck(0, 0, boundary, false);
+  SleepCompactCheck(0, boundary, kSampleSize_ - boundary, true);
+  CloseTtl();
+}
+
+// An expired file is neither skipped nor dropped while it hides an older
+// version of one of its keys in a file that did not expire
+TEST_F(TtlTest, ExpiredFileShadowingOlderVersion) {
+  // Keep the L1->L2 compaction of "zz" from pulling in the file of "key"
+  options_.expanded_compaction_factor = 0;
+  OpenTtl(10);
+  DBImpl* dbi = reinterpret_cast<DBImpl*>(db_ttl_->GetBaseDB());
+  Slice zz("zz");
+
+  // T=0: "key" and "zz" in L2
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "key", "old"));
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "zz", "old"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  ASSERT_OK(dbi->TEST_CompactRange(0, nullptr, nullptr));
+  ASSERT_OK(dbi->TEST_CompactRange(1, nullptr, nullptr));
+
+  // T=1: the new version of "key" in L1
+  env_->Sleep(1);
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "key", "new"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  ASSERT_OK(dbi->TEST_CompactRange(0, nullptr, nullptr));
+
+  // T=8: a new version of "zz" keeps the L2 file alive
+  env_->Sleep(7);
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "zz", "new"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  ASSERT_OK(dbi->TEST_CompactRange(0, &zz, &zz));
+  ASSERT_OK(dbi->TEST_CompactRange(1, &zz, &zz));
+  std::vector<LiveFileMetaData> files;
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(2U, files.size());
+  for (const auto& f : files) {
+    ASSERT_EQ(f.largestkey == "key" ? 1 : 2, f.level);
+  }
+
+  // T=12: the L1 file expired but the old version of "key" did not.
+  // DBWithTTL returns expired values until a compaction removes them.
+  env_->Sleep(4);
+  std::string value;
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ("new", value);
+  ASSERT_OK(db_ttl_->Put(WriteOptions(), "keymock", "valuemock"));
+  ASSERT_OK(db_ttl_->Flush(FlushOptions()));
+  dbi->TEST_WaitForCompact();
+  files.clear();
+  db_ttl_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(3U, files.size());
+  ASSERT_OK(db_ttl_->Get(ReadOptions(), "key", &value));
+  ASSERT_EQ("new", value);
+  CloseTtl();
+}
+
 TEST_F(TtlTest, ColumnFamiliesTest) {
   DB* db;
   Options options;
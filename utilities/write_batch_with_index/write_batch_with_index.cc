@@ -311,13 +311,13 @@ class WBWIIteratorImpl : public WBWIIterator {
 
   virtual void SeekToFirst() override {
     WriteBatchIndexEntry search_entry(WriteBatchIndexEntry::kFlagMin,
-                                      column_family_id_);
+                                      column_family_id_, 0);
     skip_list_iter_.Seek(&search_entry);
   }
 
   virtual void SeekToLast() override {
     WriteBatchIndexEntry search_entry(WriteBatchIndexEntry::kFlagMin,
-                                      column_family_id_ + 1);
+                                      column_family_id_ + 1, 0);
     skip_list_iter_.Seek(&search_entry);
     if (!skip_list_iter_.Valid()) {
       skip_list_iter_.SeekToLast();
@@ -396,9 +396,9 @@ struct WriteBatchWithIndex::Rep {
   void AddOrUpdateIndex(ColumnFamilyHandle* column_family, const Slice& key);
   void AddOrUpdateIndex(const Slice& key);
 
-  // Allocate an index entry pointing to the last entry in the write batch and
-  // put it to skip list.
-  void AddNewEntry(uint32_t column_family_id);
+  // Allocate an index entry pointing to the last entry in the write batch,
+  // whose key is "key", and put it to skip list.
+  void AddNewEntry(uint32_t column_family_id, const Slice& key);
 
   // Clear all updates buffered in this batch.
   void Clear();
@@ -432,6 +432,9 @@ bool WriteBatchWithIndex::Rep::UpdateExistingEntryWithCfId(
   WriteBatchIndexEntry* non_const_entry =
       const_cast<WriteBatchIndexEntry*>(iter.GetRawEntry());
   non_const_entry->offset = last_entry_offset;
+  non_const_entry->key_size = static_cast<uint32_t>(key.size());
+  assert(memcmp(write_batch.Data().data() + non_const_entry->key_offset(),
+                key.data(), key.size()) == 0);
   return true;
 }
 
@@ -443,20 +446,23 @@ void WriteBatchWithIndex::Rep::AddOrUpdateIndex(
     if (cf_cmp != nullptr) {
       comparator.SetComparatorForCF(cf_id, cf_cmp);
     }
-    AddNewEntry(cf_id);
+    AddNewEntry(cf_id, key);
   }
 }
 
 void WriteBatchWithIndex::Rep::AddOrUpdateIndex(const Slice& key) {
   if (!UpdateExistingEntryWithCfId(0, key)) {
-    AddNewEntry(0);
+    AddNewEntry(0, key);
   }
 }
 
-void WriteBatchWithIndex::Rep::AddNewEntry(uint32_t column_family_id) {
-    auto* mem = arena.Allocate(sizeof(WriteBatchIndexEntry));
-    auto* index_entry =
-        new (mem) WriteBatchIndexEntry(last_entry_offset, column_family_id);
+void WriteBatchWithIndex::Rep::AddNewEntry(uint32_t column_family_id,
+                                           const Slice& key) {
+    auto* mem = arena.AllocateAligned(sizeof(WriteBatchIndexEntry));
+    auto* index_entry = new (mem) WriteBatchIndexEntry(
+        last_entry_offset, column_family_id, static_cast<uint32_t>(key.size()));
+    assert(memcmp(write_batch.Data().data() + index_entry->key_offset(),
+                  key.data(), key.size()) == 0);
     skip_list.Insert(index_entry);
   }
 
@@ -515,7 +521,7 @@ void WriteBatchWithIndex::Rep::AddNewEntry(uint32_t column_family_id) {
         case kTypeMerge:
           found++;
           if (!UpdateExistingEntryWithCfId(column_family_id, key)) {
-            AddNewEntry(column_family_id);
+            AddNewEntry(column_family_id, key);
           }
           break;
         case kTypeLogData:
@@ -659,6 +665,32 @@ Status WriteBatchWithIndex::GetFromBatch(ColumnFamilyHandle* column_family,
   return s;
 }
 
+namespace {
+// Merges the operands found in the batch into the value of key read from the
+// DB, which is nullptr if the DB does not have the key.
+Status MergeWithDBValue(
+    const DBOptions& options, ColumnFamilyHandle* column_family,
+    const Slice& key, const std::string* db_value,
+    const MergeContext& merge_context, std::string* value) {
+  auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
+  const MergeOperator* merge_operator = cfh->cfd()->ioptions()->merge_operator;
+  Statistics* statistics = options.statistics.get();
+  Env* env = options.env;
+  Logger* logger = options.info_log.get();
+
+  Slice db_slice;
+  Slice* merge_data = nullptr;
+  if (db_value != nullptr) {
+    db_slice = *db_value;
+    merge_data = &db_slice;
+  }
+  return MergeHelper::TimedFullMerge(key, merge_data,
+                                     merge_context.GetOperands(),
+                                     merge_operator, statistics, env, logger,
+                                     value);
+}
+}  // namespace
+
 Status WriteBatchWithIndex::GetFromBatchAndDB(DB* db,
                                               const ReadOptions& read_options,
                                               const Slice& key,
@@ -709,30 +741,92 @@ Status WriteBatchWithIndex::GetFromBatchAndDB(DB* db,
   if (s.ok() || s.IsNotFound()) {  // DB Get Suceeded
     if (result == WriteBatchWithIndexInternal::Result::kMergeInProgress) {
       // Merge result from DB with merges in Batch
-      auto cfh = reinterpret_cast<ColumnFamilyHandleImpl*>(column_family);
-      const MergeOperator* merge_operator =
-          cfh->cfd()->ioptions()->merge_operator;
-      Statistics* statistics = options.statistics.get();
-      Env* env = options.env;
-      Logger* logger = options.info_log.get();
-
-      Slice db_slice(*value);
-      Slice* merge_data;
-      if (s.ok()) {
-        merge_data = &db_slice;
-      } else {  // Key not present in db (s.IsNotFound())
-        merge_data = nullptr;
-      }
-
-      s = MergeHelper::TimedFullMerge(
-          key, merge_data, merge_context.GetOperands(), merge_operator,
-          statistics, env, logger, value);
+      std::string db_value;
+      db_value.swap(*value);
+      s = MergeWithDBValue(options, column_family, key,
+                           s.ok() ? &db_value : nullptr, merge_context,
+                           value);
     }
   }
 
   return s;
 }
 
+std::vector<Status> WriteBatchWithIndex::MultiGetFromBatchAndDB(
+    DB* db, const ReadOptions& read_options, const std::vector<Slice>& keys,
+    std::vector<std::string>* values) {
+  return MultiGetFromBatchAndDB(
+      db, read_options,
+      std::vector<ColumnFamilyHandle*>(keys.size(), db->DefaultColumnFamily()),
+      keys, values);
+}
+
+std::vector<Status> WriteBatchWithIndex::MultiGetFromBatchAndDB(
+    DB* db, const ReadOptions& read_options,
+    const std::vector<ColumnFamilyHandle*>& column_families,
+    const std::vector<Slice>& keys, std::vector<std::string>* values) {
+  assert(column_families.size() == keys.size());
+  const DBOptions& options = db->GetDBOptions();
+  const size_t num_keys = keys.size();
+  std::vector<Status> statuses(num_keys);
+  std::vector<MergeContext> merge_contexts(num_keys);
+  std::vector<WriteBatchWithIndexInternal::Result> results(num_keys);
+  values->clear();
+  values->resize(num_keys);
+
+  // The keys that the batch cannot resolve on its own are looked up in the
+  // DB with a single MultiGet().
+  std::vector<size_t> db_key_indexes;
+  std::vector<ColumnFamilyHandle*> db_column_families;
+  std::vector<Slice> db_keys;
+  for (size_t i = 0; i < num_keys; i++) {
+    results[i] = WriteBatchWithIndexInternal::GetFromBatch(
+        options, this, column_families[i], keys[i], &merge_contexts[i],
+        &rep->comparator, &(*values)[i], rep->overwrite_key, &statuses[i]);
+    switch (results[i]) {
+      case WriteBatchWithIndexInternal::Result::kFound:
+      case WriteBatchWithIndexInternal::Result::kError:
+        break;
+      case WriteBatchWithIndexInternal::Result::kDeleted:
+        statuses[i] = Status::NotFound();
+        break;
+      case WriteBatchWithIndexInternal::Result::kMergeInProgress:
+        if (rep->overwrite_key) {
+          // See GetFromBatchAndDB()
+          statuses[i] = Status::MergeInProgress();
+          break;
+        }
+      // intentional fallthrough
+      case WriteBatchWithIndexInternal::Result::kNotFound:
+        db_key_indexes.push_back(i);
+        db_column_families.push_back(column_families[i]);
+        db_keys.push_back(keys[i]);
+        break;
+    }
+  }
+  if (db_keys.empty()) {
+    return statuses;
+  }
+
+  std::vector<std::string> db_values;
+  std::vector<Status> db_statuses =
+      db->MultiGet(read_options, db_column_families, db_keys, &db_values);
+  for (size_t j = 0; j < db_keys.size(); j++) {
+    const size_t i = db_key_indexes[j];
+    Status s = db_statuses[j];
+    if (results[i] == WriteBatchWithIndexInternal::Result::kMergeInProgress &&
+        (s.ok() || s.IsNotFound())) {
+      s = MergeWithDBValue(options, column_families[i], keys[i],
+                           s.ok() ? &db_values[j] : nullptr,
+                           merge_contexts[i], &(*values)[i]);
+    } else {
+      (*values)[i].swap(db_values[j]);
+    }
+    statuses[i] = s;
+  }
+  return statuses;
+}
+
 void WriteBatchWithIndex::SetSavePoint() { rep->write_batch.SetSavePoint(); }
 
 Status WriteBatchWithIndex::RollbackToSavePoint() {
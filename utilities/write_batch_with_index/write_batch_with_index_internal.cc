@@ -86,27 +86,17 @@ int WriteBatchEntryComparator::operator()(
     return 1;
   }
 
-  Status s;
+  // The buffer of the write batch may be reallocated by every write, so the
+  // keys are located from their offsets.
+  const char* data = write_batch_->Data().data();
   Slice key1, key2;
   if (entry1->search_key == nullptr) {
-    Slice value, blob;
-    WriteType write_type;
-    s = write_batch_->GetEntryFromDataOffset(entry1->offset, &write_type, &key1,
-                                             &value, &blob);
-    if (!s.ok()) {
-      return 1;
-    }
+    key1 = Slice(data + entry1->key_offset(), entry1->key_size);
   } else {
     key1 = *(entry1->search_key);
   }
   if (entry2->search_key == nullptr) {
-    Slice value, blob;
-    WriteType write_type;
-    s = write_batch_->GetEntryFromDataOffset(entry2->offset, &write_type, &key2,
-                                             &value, &blob);
-    if (!s.ok()) {
-      return -1;
-    }
+    key2 = Slice(data + entry2->key_offset(), entry2->key_size);
   } else {
     key2 = *(entry2->search_key);
   }
@@ -16,6 +16,7 @@
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
 #include "port/port.h"
+#include "util/coding.h"
 
 namespace rocksdb {
 
@@ -23,18 +24,32 @@ class MergeContext;
 struct Options;
 
 // Key used by skip list, as the binary searchable index of WriteBatchWithIndex.
+// The entries are allocated from the arena of the index. They record the
+// size of the key of their write batch entry, which tells where the key is,
+// so that comparing them does not decode the write batch entry.
 struct WriteBatchIndexEntry {
-  WriteBatchIndexEntry(size_t o, uint32_t c)
-      : offset(o), column_family(c), search_key(nullptr) {}
+  WriteBatchIndexEntry(size_t o, uint32_t c, uint32_t ksz)
+      : offset(o), column_family(c), key_size(ksz), search_key(nullptr) {}
   WriteBatchIndexEntry(const Slice* sk, uint32_t c)
-      : offset(0), column_family(c), search_key(sk) {}
+      : offset(0), column_family(c), key_size(0), search_key(sk) {}
 
   // If this flag appears in the offset, it indicates a key that is smaller
   // than any other entry for the same column family
   static const size_t kFlagMin = port::kMaxSizet;
 
+  // Offset of the key in write batch's string buffer. A write batch record
+  // starts with its tag, followed by its column family unless it is the
+  // default one, and by the varint32 size of its key.
+  size_t key_offset() const {
+    return offset + 1 +
+           (column_family == 0 ? 0 : VarintLength(column_family)) +
+           VarintLength(key_size);
+  }
+
   size_t offset;           // offset of an entry in write batch's string buffer.
   uint32_t column_family;  // column family of the entry
+  uint32_t key_size;       // size of the key of the entry, stored in what
+                           // would be padding
   const Slice* search_key;  // if not null, instead of reading keys from
                             // write batch, use it to compare. This is used
                             // for lookup key.
@@ -1293,6 +1293,81 @@ TEST_F(WriteBatchWithIndexTest, TestGetFromBatchAndDBMerge2) {
   DestroyDB(dbname, options);
 }
 
+TEST_F(WriteBatchWithIndexTest, TestMultiGetFromBatchAndDB) {
+  DB* db;
+  Options options;
+
+  options.create_if_missing = true;
+  std::string dbname = test::TmpDir() + "/write_batch_with_index_test";
+
+  options.merge_operator = MergeOperators::CreateFromStringId("stringappend");
+
+  DestroyDB(dbname, options);
+  Status s = DB::Open(options, dbname, &db);
+  assert(s.ok());
+
+  WriteBatchWithIndex batch;
+  ReadOptions read_options;
+  WriteOptions write_options;
+
+  ASSERT_OK(db->Put(write_options, "a", "a0"));
+  ASSERT_OK(db->Put(write_options, "b", "b0"));
+  ASSERT_OK(db->Put(write_options, "c", "c0"));
+  ASSERT_OK(db->Merge(write_options, "d", "d0"));
+
+  batch.Put("a", "a1");
+  batch.Delete("b");
+  batch.Merge("d", "d1");
+  batch.Merge("e", "e0");
+  batch.Put("f", "f0");
+  batch.Merge("f", "f1");
+
+  std::vector<Slice> keys = {"a", "b", "c", "d", "e", "f", "g"};
+  std::vector<std::string> values;
+  std::vector<Status> statuses =
+      batch.MultiGetFromBatchAndDB(db, read_options, keys, &values);
+  ASSERT_EQ(keys.size(), statuses.size());
+  ASSERT_EQ(keys.size(), values.size());
+  ASSERT_OK(statuses[0]);
+  ASSERT_EQ("a1", values[0]);
+  ASSERT_TRUE(statuses[1].IsNotFound());
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ("c0", values[2]);
+  ASSERT_OK(statuses[3]);
+  ASSERT_EQ("d0,d1", values[3]);
+  ASSERT_OK(statuses[4]);
+  ASSERT_EQ("e0", values[4]);
+  ASSERT_OK(statuses[5]);
+  ASSERT_EQ("f0,f1", values[5]);
+  ASSERT_TRUE(statuses[6].IsNotFound());
+
+  // The results match the ones of GetFromBatchAndDB()
+  for (size_t i = 0; i < keys.size(); i++) {
+    std::string value;
+    s = batch.GetFromBatchAndDB(db, read_options, keys[i], &value);
+    ASSERT_EQ(s.ToString(), statuses[i].ToString());
+    if (s.ok()) {
+      ASSERT_EQ(value, values[i]);
+    }
+  }
+
+  // With overwrite_key, merges that need the DB cannot be resolved
+  WriteBatchWithIndex overwrite_batch(BytewiseComparator(), 0, true);
+  overwrite_batch.Merge("a", "a1");
+  overwrite_batch.Put("b", "b1");
+  keys = {"a", "b", "c"};
+  statuses =
+      overwrite_batch.MultiGetFromBatchAndDB(db, read_options, keys, &values);
+  ASSERT_TRUE(statuses[0].IsMergeInProgress());
+  ASSERT_OK(statuses[1]);
+  ASSERT_EQ("b1", values[1]);
+  ASSERT_OK(statuses[2]);
+  ASSERT_EQ("c0", values[2]);
+
+  delete db;
+  DestroyDB(dbname, options);
+}
+
 void AssertKey(std::string key, WBWIIterator* iter) {
   ASSERT_TRUE(iter->Valid());
   ASSERT_EQ(key, iter->Entry().key.ToString());